@@ -31,7 +31,17 @@
 #include <opm/material/components/Brine.hpp>
 #include <opm/material/components/H2O.hpp>
 #include <opm/material/components/CO2.hpp>
+#include <opm/material/components/co2/SpanWagner.hpp>
 #include <opm/material/IdealGas.hpp>
+#include <opm/material/common/MathToolbox.hpp>
+
+#include <opm/common/ErrorMacros.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <exception>
+#include <stdexcept>
+#include <vector>
 
 namespace Opm {
 namespace BinaryCoeff {
@@ -105,7 +115,19 @@ public:
                                        Evaluation& xlCO2,
                                        Evaluation& ygH2O)
     {
-        Evaluation A = computeA_(temperature, pg);
+        // the molality of CO2 in pure water is only required if both phases are
+        // present
+        Evaluation A;
+        Evaluation m0_CO2;
+        Evaluation* m0_CO2Ptr = (knownPhaseIdx < 0) ? &m0_CO2 : nullptr;
+        unsigned i, j;
+        if (findSolubilityTableCell_(temperature, pg, i, j))
+            interpolateSolubilityTables_(temperature, pg, i, j, A, m0_CO2Ptr);
+        else {
+            A = computeA_(temperature, pg);
+            if (m0_CO2Ptr)
+                *m0_CO2Ptr = molalityCO2inPureWater_(temperature, pg, A);
+        }
 
         /* salinity: conversion from mass fraction to mol fraction */
         Scalar x_NaCl = salinityToMolFrac_(salinity);
@@ -114,7 +136,6 @@ public:
         // with the mutual solubility function
         if (knownPhaseIdx < 0) {
             Scalar molalityNaCl = moleFracToMolality_(x_NaCl); // molality of NaCl //CHANGED
-            Evaluation m0_CO2 = molalityCO2inPureWater_(temperature, pg); // molality of CO2 in pure water
             Evaluation gammaStar = activityCoefficient_(temperature, pg, molalityNaCl);// activity coefficient of CO2 in brine
             Evaluation m_CO2 = m0_CO2 / gammaStar; // molality of CO2 in brine
             xlCO2 = m_CO2 / (molalityNaCl + 55.508 + m_CO2); // mole fraction of CO2 in brine
@@ -135,6 +156,199 @@ public:
             xlCO2 = 1 - x_NaCl - ygH2O / A;
     }
 
+    /*!
+     * \brief Calculates the mutual solubilities of brine and CO2 for a batch of
+     *        cells in which both phases are present.
+     *
+     * This is equivalent to calling calculateMoleFractions() with a \c knownPhaseIdx
+     * of -1 for each cell, but the conversion of the salinity is only done once. If
+     * OpenMP is enabled, the cells are processed in parallel.
+     *
+     * \param temperature the temperatures of the cells [K]
+     * \param pg the gas phase pressures of the cells [Pa]
+     * \param salinity the salinity [kg NaCl / kg solution]
+     * \param xlCO2 mole fractions of CO2 in brine [mol/mol]
+     * \param ygH2O mole fractions of water in the gas phase [mol/mol]
+     */
+    template <class Evaluation>
+    static void calculateMoleFractionsBatch(const std::vector<Evaluation>& temperature,
+                                            const std::vector<Evaluation>& pg,
+                                            Scalar salinity,
+                                            std::vector<Evaluation>& xlCO2,
+                                            std::vector<Evaluation>& ygH2O)
+    {
+        assert(temperature.size() == pg.size());
+
+        xlCO2.resize(temperature.size());
+        ygH2O.resize(temperature.size());
+
+        const Scalar x_NaCl = salinityToMolFrac_(salinity);
+        const Scalar molalityNaCl = moleFracToMolality_(x_NaCl);
+
+        // exceptions must not leave the parallel region, so the first one is stored
+        // and re-thrown afterwards
+        std::exception_ptr error;
+        int numCells = static_cast<int>(temperature.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+        for (int cellIdx = 0; cellIdx < numCells; ++cellIdx) {
+            try {
+                const Evaluation& T = temperature[cellIdx];
+                const Evaluation& p = pg[cellIdx];
+
+                Evaluation A;
+                Evaluation m0_CO2;
+                unsigned i, j;
+                if (findSolubilityTableCell_(T, p, i, j))
+                    interpolateSolubilityTables_(T, p, i, j, A, &m0_CO2);
+                else {
+                    A = computeA_(T, p);
+                    m0_CO2 = molalityCO2inPureWater_(T, p, A);
+                }
+
+                const Evaluation& m_CO2 = m0_CO2 / activityCoefficient_(T, p, molalityNaCl);
+                xlCO2[cellIdx] = m_CO2 / (molalityNaCl + 55.508 + m_CO2);
+                ygH2O[cellIdx] = A * (1 - xlCO2[cellIdx] - x_NaCl);
+            }
+            catch (...) {
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+                {
+                    if (!error)
+                        error = std::current_exception();
+                }
+            }
+        }
+
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    /*!
+     * \brief Tabulate the parts of the mutual solubility of brine and CO2 which do not
+     *        depend on the salinity.
+     *
+     * Within the tabulated range, calculateMoleFractions() then interpolates the
+     * parameter \f$A\f$ of Spycher et al. and the molality of CO2 in pure water
+     * bi-linearly instead of evaluating the fugacity coefficients and the
+     * equilibrium constants. The derivatives are the exact ones of the
+     * interpolation. The influence of the salinity is always computed from the
+     * activity coefficient, i.e., the tables can be used for any salinity. Outside
+     * of the tabulated range, the correlations are used as before.
+     *
+     * Below the critical temperature, the density of CO2 and thus both tabulated
+     * quantities jump at the vapor pressure. Interpolating across this jump leads to
+     * errors of tens of percent, so the correlations are also used within the cells
+     * of the tables which are crossed by the vapor pressure curve of CO2 and within
+     * the cells in which the interpolation deviates from the correlations by more
+     * than 0.1 percent at the center. (The latter are the cells next to the vapor
+     * pressure curve and the ones close to the critical point.)
+     *
+     * Since the CO2 density is required, the range must be within the one of the CO2
+     * tables and these must be initialized before this method is called.
+     *
+     * \param tempMin The minimum temperature of the tables [K]
+     * \param tempMax The maximum temperature of the tables [K]
+     * \param nTemp The number of temperature sampling points
+     * \param pressMin The minimum pressure of the tables [Pa]
+     * \param pressMax The maximum pressure of the tables [Pa]
+     * \param nPress The number of pressure sampling points
+     */
+    static void initSolubilityTables(Scalar tempMin, Scalar tempMax, unsigned nTemp,
+                                     Scalar pressMin, Scalar pressMax, unsigned nPress)
+    {
+        if (nTemp < 2 || nPress < 2 || !(tempMin < tempMax) || !(pressMin < pressMax))
+            OPM_THROW(std::invalid_argument,
+                      "The range of the solubility tables must be non-empty and "
+                      "include at least two sampling points in each direction");
+
+        tempMin_ = tempMin;
+        tempMax_ = tempMax;
+        nTemp_ = nTemp;
+        pressMin_ = pressMin;
+        pressMax_ = pressMax;
+        nPress_ = nPress;
+        solubilityTable_.resize(2*nTemp*nPress);
+        correlationCells_.assign((nTemp - 1)*(nPress - 1), 0);
+
+        // exceptions must not leave the parallel region, so the first one is stored
+        // and re-thrown afterwards. the cells which are affected by the vapor pressure
+        // of CO2 are marked in a second pass because this requires the values at
+        // both ends of the cells.
+        std::exception_ptr error;
+        int nPressInt = static_cast<int>(nPress);
+        for (int pass = 0; pass < 2 && !error; ++pass) {
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+            for (int j = 0; j < nPressInt - pass; ++j) {
+                try {
+                    if (pass == 1) {
+                        markCorrelationCells_(static_cast<unsigned>(j));
+                        continue;
+                    }
+
+                    Scalar pg = pressMin + (pressMax - pressMin)*j/(nPress - 1);
+                    for (unsigned i = 0; i < nTemp; ++i) {
+                        Scalar temperature = tempMin + (tempMax - tempMin)*i/(nTemp - 1);
+                        Scalar A = computeA_(temperature, pg);
+
+                        // A is inversely proportional to the pressure for low
+                        // pressures, so A*p is tabulated instead.
+                        Scalar* v = solubilityTable_.data() + 2*(i + j*nTemp);
+                        v[0] = A*pg/1e5;
+                        v[1] = molalityCO2inPureWater_(temperature, pg, A);
+                    }
+                }
+                catch (...) {
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+                    {
+                        if (!error)
+                            error = std::current_exception();
+                    }
+                }
+            }
+        }
+
+        if (error) {
+            disableSolubilityTables();
+            std::rethrow_exception(error);
+        }
+    }
+
+    /*!
+     * \brief Stop using the solubility tables.
+     *
+     * calculateMoleFractions() evaluates the correlations for all temperatures and
+     * pressures afterwards.
+     */
+    static void disableSolubilityTables()
+    {
+        nTemp_ = 0;
+        nPress_ = 0;
+        solubilityTable_.clear();
+        correlationCells_.clear();
+    }
+
+    /*!
+     * \brief Returns true iff the solubility tables have been initialized and are
+     *        used for a given temperature and pressure.
+     *
+     * This is the case if the temperature and the pressure are within the range of
+     * the tables and the cell which contains them has not been marked to use the
+     * correlations by initSolubilityTables().
+     */
+    template <class Evaluation>
+    static bool solubilityTablesApply(const Evaluation& temperature, const Evaluation& pg)
+    {
+        unsigned i, j;
+        return findSolubilityTableCell_(temperature, pg, i, j);
+    }
+
     /*!
      * \brief Henry coefficent \f$\mathrm{[N/m^2]}\f$ for CO2 in brine.
      */
@@ -214,6 +428,123 @@ public:
     }
 
 private:
+    /*!
+     * \brief Find the cell of the solubility tables which contains a given
+     *        temperature and pressure.
+     *
+     * Returns false if the tables do not apply, i.e., if they have not been
+     * initialized, if the temperature or the pressure are out of range or if the
+     * correlations must be used within the cell.
+     */
+    template <class Evaluation>
+    static bool findSolubilityTableCell_(const Evaluation& temperature,
+                                         const Evaluation& pg,
+                                         unsigned& i,
+                                         unsigned& j)
+    {
+        typedef MathToolbox<Evaluation> Toolbox;
+
+        if (solubilityTable_.empty())
+            return false;
+
+        Scalar T = Toolbox::value(temperature);
+        Scalar p = Toolbox::value(pg);
+        if (!(tempMin_ <= T && T <= tempMax_ && pressMin_ <= p && p <= pressMax_))
+            return false;
+
+        Scalar alpha = (T - tempMin_)*((nTemp_ - 1)/(tempMax_ - tempMin_));
+        Scalar beta = (p - pressMin_)*((nPress_ - 1)/(pressMax_ - pressMin_));
+        i = std::min(nTemp_ - 2, static_cast<unsigned>(std::max<Scalar>(0.0, alpha)));
+        j = std::min(nPress_ - 2, static_cast<unsigned>(std::max<Scalar>(0.0, beta)));
+        return !correlationCells_[i + j*(nTemp_ - 1)];
+    }
+
+    /*!
+     * \brief Marks the cells of the solubility tables between the j-th and the
+     *        (j+1)-th pressure in which the correlations must be used.
+     *
+     * These are the cells which are crossed by the vapor pressure curve of CO2 and
+     * the ones in which the bi-linear interpolation deviates from the correlations by
+     * more than 0.1 percent at the center. The latter covers the cells in which the
+     * jump at the vapor pressure is smeared out by the interpolation of the CO2
+     * tables.
+     */
+    static void markCorrelationCells_(unsigned j)
+    {
+        typedef Opm::SpanWagner<double> SpanWagner;
+
+        Scalar pLow = pressMin_ + (pressMax_ - pressMin_)*j/(nPress_ - 1);
+        Scalar pHigh = pressMin_ + (pressMax_ - pressMin_)*(j + 1)/(nPress_ - 1);
+        for (unsigned i = 0; i + 1 < nTemp_; ++i) {
+            Scalar TLow = tempMin_ + (tempMax_ - tempMin_)*i/(nTemp_ - 1);
+            Scalar THigh = tempMin_ + (tempMax_ - tempMin_)*(i + 1)/(nTemp_ - 1);
+
+            // the vapor pressure increases with the temperature
+            Scalar TSat = std::min<Scalar>(THigh, SpanWagner::criticalTemperature());
+            bool crossed =
+                TLow < SpanWagner::criticalTemperature()
+                && SpanWagner::vaporPressure(TLow) <= pHigh
+                && pLow <= SpanWagner::vaporPressure(TSat);
+
+            if (!crossed) {
+                Scalar T = (TLow + THigh)/2;
+                Scalar pg = (pLow + pHigh)/2;
+                Scalar A = computeA_(T, pg);
+                Scalar m0_CO2 = molalityCO2inPureWater_(T, pg, A);
+                Scalar ATab;
+                Scalar m0_CO2Tab;
+                interpolateSolubilityTables_(T, pg, i, j, ATab, &m0_CO2Tab);
+                crossed =
+                    !(std::abs(ATab - A) <= 1e-3*std::abs(A))
+                    || !(std::abs(m0_CO2Tab - m0_CO2) <= 1e-3*std::abs(m0_CO2));
+            }
+
+            if (crossed)
+                correlationCells_[i + j*(nTemp_ - 1)] = 1;
+        }
+    }
+
+    /*!
+     * \brief Interpolates the parameter A and the molality of CO2 in pure water
+     *        bi-linearly in the (i, j) cell of the solubility tables.
+     *
+     * The molality is only interpolated if \a m0_CO2 is not a null pointer.
+     */
+    template <class Evaluation>
+    static void interpolateSolubilityTables_(const Evaluation& temperature,
+                                             const Evaluation& pg,
+                                             unsigned i,
+                                             unsigned j,
+                                             Evaluation& A,
+                                             Evaluation* m0_CO2)
+    {
+        Evaluation alpha = (temperature - tempMin_)*((nTemp_ - 1)/(tempMax_ - tempMin_));
+        Evaluation beta = (pg - pressMin_)*((nPress_ - 1)/(pressMax_ - pressMin_));
+        alpha -= i;
+        beta -= j;
+
+        const Scalar* v00 = solubilityTable_.data() + 2*(i + j*nTemp_);
+        const Scalar* v10 = v00 + 2;
+        const Scalar* v01 = v00 + 2*nTemp_;
+        const Scalar* v11 = v01 + 2;
+        const Evaluation& alphaBeta = alpha*beta;
+
+        const Evaluation& Ap =
+            v00[0]
+            + alpha*(v10[0] - v00[0])
+            + beta*(v01[0] - v00[0])
+            + alphaBeta*(v11[0] - v10[0] - v01[0] + v00[0]);
+        A = Ap/(pg/1e5);
+        if (!m0_CO2)
+            return;
+
+        *m0_CO2 =
+            v00[1]
+            + alpha*(v10[1] - v00[1])
+            + beta*(v01[1] - v00[1])
+            + alphaBeta*(v11[1] - v10[1] - v01[1] + v00[1]);
+    }
+
     /*!
      * \brief Returns the molality of NaCl (mol NaCl / kg water) for a given mole fraction
      *
@@ -247,11 +578,13 @@ private:
      *
      * \param temperature The temperature [K]
      * \param pg The gas phase pressure [Pa]
+     * \param A The parameter A of the mutual solubility, see computeA_()
      */
     template <class Evaluation>
-    static Evaluation molalityCO2inPureWater_(const Evaluation& temperature, const Evaluation& pg)
+    static Evaluation molalityCO2inPureWater_(const Evaluation& temperature,
+                                              const Evaluation& pg,
+                                              const Evaluation& A)
     {
-        const Evaluation& A = computeA_(temperature, pg); // according to Spycher, Pruess and Ennis-King (2003)
         const Evaluation& B = computeB_(temperature, pg); // according to Spycher, Pruess and Ennis-King (2003)
         const Evaluation& yH2OinGas = (1 - B) / (1. / A - B); // equilibrium mol fraction of H2O in the gas phase
         const Evaluation& xCO2inWater = B * (1 - yH2OinGas); // equilibrium mol fraction of CO2 in the water phase
@@ -403,8 +736,36 @@ private:
         return Toolbox::pow(10.0, logk0_H2O);
     }
 
+
+    static std::vector<Scalar> solubilityTable_;
+    // one entry per cell of the solubility tables which is non-zero if the
+    // correlations must be used within the cell
+    static std::vector<unsigned char> correlationCells_;
+    static Scalar tempMin_;
+    static Scalar tempMax_;
+    static unsigned nTemp_;
+    static Scalar pressMin_;
+    static Scalar pressMax_;
+    static unsigned nPress_;
 };
 
+template<class Scalar, class CO2Tables, bool verbose>
+std::vector<Scalar> Brine_CO2<Scalar, CO2Tables, verbose>::solubilityTable_;
+template<class Scalar, class CO2Tables, bool verbose>
+std::vector<unsigned char> Brine_CO2<Scalar, CO2Tables, verbose>::correlationCells_;
+template<class Scalar, class CO2Tables, bool verbose>
+Scalar Brine_CO2<Scalar, CO2Tables, verbose>::tempMin_;
+template<class Scalar, class CO2Tables, bool verbose>
+Scalar Brine_CO2<Scalar, CO2Tables, verbose>::tempMax_;
+template<class Scalar, class CO2Tables, bool verbose>
+unsigned Brine_CO2<Scalar, CO2Tables, verbose>::nTemp_;
+template<class Scalar, class CO2Tables, bool verbose>
+Scalar Brine_CO2<Scalar, CO2Tables, verbose>::pressMin_;
+template<class Scalar, class CO2Tables, bool verbose>
+Scalar Brine_CO2<Scalar, CO2Tables, verbose>::pressMax_;
+template<class Scalar, class CO2Tables, bool verbose>
+unsigned Brine_CO2<Scalar, CO2Tables, verbose>::nPress_;
+
 } // namespace BinaryCoeff
 } // namespace Opm
 
@@ -0,0 +1,330 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Fast approximations of the exponential function, the natural logarithm and
+ *        the power function.
+ *
+ * The functions are inlined and use small tables and short polynomials instead of the
+ * extra-precise argument reductions of the standard library. The relative error of
+ * fastExp() and fastLog() is below 1e-15. fastPow(b, e) is computed as exp(e*log(b)),
+ * so its relative error grows with |e*log(b)| and is bounded by about 1e-15 +
+ * 1.1e-16*|e*log(b)|. (i.e., it is below 1e-13 for all results which are normal
+ * floating point numbers.)
+ *
+ * Arguments for which the result is not a normal floating point number (e.g., zero,
+ * negative, infinite or NaN values) are passed on to the functions of the standard
+ * library.
+ */
+#ifndef OPM_MATERIAL_FAST_MATH_HPP
+#define OPM_MATERIAL_FAST_MATH_HPP
+
+#include "MathToolbox.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+namespace Opm {
+namespace FastMathDetail {
+// ln(2) split into a part which can be multiplied exactly with integers of up to 21
+// bits and the remainder
+static const double ln2Hi = 6.93147180369123816490e-01;
+static const double ln2Lo = 1.90821492927058770002e-10;
+
+// the tables are static members of a class template so that they can be defined in
+// a header
+template <class Dummy = void>
+struct Tables
+{
+    // 2^(j/64)
+    static const double exp2Frac[64];
+
+    // the center c of the j-th interval of [0.75, 1.5), 1/c and ln(c). The intervals
+    // are 1/128 wide below 1 and 1/64 wide above 1. The two intervals adjacent to 1 use
+    // c = 1 to avoid cancellation for arguments close to 1.
+    static const double center[64];
+    static const double invCenter[64];
+    static const double logCenter[64];
+};
+
+template <class Dummy>
+const double Tables<Dummy>::exp2Frac[64] = {
+    1, 1.0108892860517005, 1.0218971486541166,
+    1.0330248790212284, 1.0442737824274138, 1.0556451783605572,
+    1.0671404006768237, 1.0787607977571199, 1.0905077326652577,
+    1.1023825833078409, 1.1143867425958924, 1.1265216186082418,
+    1.1387886347566916, 1.1511892299529827, 1.1637248587775775,
+    1.1763969916502812, 1.189207115002721, 1.2021567314527031,
+    1.215247359980469, 1.22848053610687, 1.241857812073484,
+    1.2553807570246911, 1.2690509571917332, 1.2828700160787783,
+    1.2968395546510096, 1.3109612115247644, 1.3252366431597413,
+    1.3396675240533029, 1.3542555469368927, 1.3690024229745905,
+    1.383909881963832, 1.3989796725383112, 1.4142135623730951,
+    1.42961333839197, 1.4451808069770467, 1.460917794180647,
+    1.4768261459394993, 1.4929077282912648, 1.5091644275934228,
+    1.5255981507445384, 1.5422108254079407, 1.5590044002378369,
+    1.5759808451078865, 1.593142151342267, 1.6104903319492543,
+    1.6280274218573478, 1.6457554781539649, 1.6636765803267364,
+    1.681792830507429, 1.7001063537185235, 1.7186192981224779,
+    1.7373338352737062, 1.7562521603732995, 1.7753764925265212,
+    1.7947090750031072, 1.8142521755003989, 1.8340080864093424,
+    1.8539791250833855, 1.8741676341103, 1.8945759815869656,
+    1.9152065613971474, 1.9360617934922943, 1.9571441241754002,
+    1.9784560263879509
+};
+
+template <class Dummy>
+const double Tables<Dummy>::center[64] = {
+    0.75390625, 0.76171875, 0.76953125,
+    0.77734375, 0.78515625, 0.79296875,
+    0.80078125, 0.80859375, 0.81640625,
+    0.82421875, 0.83203125, 0.83984375,
+    0.84765625, 0.85546875, 0.86328125,
+    0.87109375, 0.87890625, 0.88671875,
+    0.89453125, 0.90234375, 0.91015625,
+    0.91796875, 0.92578125, 0.93359375,
+    0.94140625, 0.94921875, 0.95703125,
+    0.96484375, 0.97265625, 0.98046875,
+    0.98828125, 1, 1,
+    1.0234375, 1.0390625, 1.0546875,
+    1.0703125, 1.0859375, 1.1015625,
+    1.1171875, 1.1328125, 1.1484375,
+    1.1640625, 1.1796875, 1.1953125,
+    1.2109375, 1.2265625, 1.2421875,
+    1.2578125, 1.2734375, 1.2890625,
+    1.3046875, 1.3203125, 1.3359375,
+    1.3515625, 1.3671875, 1.3828125,
+    1.3984375, 1.4140625, 1.4296875,
+    1.4453125, 1.4609375, 1.4765625,
+    1.4921875
+};
+
+template <class Dummy>
+const double Tables<Dummy>::invCenter[64] = {
+    1.3264248704663213, 1.3128205128205128, 1.2994923857868019,
+    1.2864321608040201, 1.2736318407960199, 1.2610837438423645,
+    1.248780487804878, 1.2367149758454106, 1.2248803827751196,
+    1.2132701421800949, 1.2018779342723005, 1.1906976744186046,
+    1.1797235023041475, 1.1689497716894977, 1.158371040723982,
+    1.147982062780269, 1.1377777777777778, 1.1277533039647578,
+    1.1179039301310043, 1.1082251082251082, 1.0987124463519313,
+    1.0893617021276596, 1.0801687763713079, 1.0711297071129706,
+    1.0622406639004149, 1.0534979423868314, 1.0448979591836736,
+    1.0364372469635628, 1.0281124497991967, 1.0199203187250996,
+    1.0118577075098814, 1, 1,
+    0.97709923664122134, 0.96240601503759393, 0.94814814814814818,
+    0.93430656934306566, 0.92086330935251803, 0.90780141843971629,
+    0.8951048951048951, 0.88275862068965516, 0.87074829931972786,
+    0.85906040268456374, 0.84768211920529801, 0.83660130718954251,
+    0.82580645161290323, 0.8152866242038217, 0.80503144654088055,
+    0.79503105590062106, 0.78527607361963192, 0.77575757575757576,
+    0.76646706586826352, 0.75739644970414199, 0.74853801169590639,
+    0.73988439306358378, 0.73142857142857143, 0.7231638418079096,
+    0.71508379888268159, 0.70718232044198892, 0.69945355191256831,
+    0.69189189189189193, 0.68449197860962563, 0.67724867724867721,
+    0.67015706806282727
+};
+
+template <class Dummy>
+const double Tables<Dummy>::logCenter[64] = {
+    -0.28248725557467691, -0.27217788591581565, -0.26197371574157396,
+    -0.25187261975507008, -0.24187253642048673, -0.23197146543777514,
+    -0.22216746534115431, -0.21245865121419341, -0.20284319251475147,
+    -0.19331931100349597, -0.18388527877013736, -0.17453941635189968,
+    -0.16528009093910292, -0.15610571466306167, -0.14701474296180966,
+    -0.13800567301944372, -0.12907704227514236, -0.1202274269981598,
+    -0.11145544092532282, -0.10275973395776894, -0.094138990913861909,
+    -0.085591930335403507, -0.077117303344431287, -0.068713892548051811,
+    -0.060380510988907482, -0.052116001139014018, -0.043919233934835489,
+    -0.035789107851585282, -0.027724548014854862, -0.01972450534777859,
+    -0.01178795575204224, 0, 0,
+    0.023167059281534379, 0.038318864302136602, 0.053244514518812285,
+    0.067950661908507751, 0.082443669211074586, 0.096729626458551113,
+    0.11081436634029011, 0.12470347850095724, 0.13840232285911913,
+    0.15191604202584197, 0.16524957289530717, 0.17840765747281831,
+    0.19139485299962947, 0.20421554142869089, 0.21687393830061436,
+    0.22937410106484582, 0.24171993688714516, 0.25391520998096345,
+    0.26596354849713794, 0.27786845100345631, 0.28963329258304266,
+    0.30126133057816179, 0.3127557100038969, 0.32411946865421198,
+    0.33535554192113781, 0.34646676734620857, 0.3574558889218038,
+    0.36832556115870763, 0.37907835293496944, 0.38971675114002519,
+    0.40024316412701272
+};
+
+// returns 2^n for -1022 <= n <= 1023
+inline double exp2i_(int n)
+{
+    uint64_t bits = static_cast<uint64_t>(n + 1023) << 52;
+    double result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+// exp(x) for -708 < x < 709
+inline double expKernel_(double x)
+{
+    // split the argument such that exp(x) = 2^n * 2^(j/64) * exp(r) with integers n and
+    // 0 <= j < 64 and |r| <= ln(2)/128. Adding and subtracting 1.5*2^52 rounds to the
+    // nearest integer.
+    const double invLn2By64 = 92.332482616893656768;
+    const double shifter = 6755399441055744.0;
+    double kd = (x*invLn2By64 + shifter) - shifter;
+    double r = (x - kd*(ln2Hi/64)) - kd*(ln2Lo/64);
+    int k = static_cast<int>(kd);
+    int j = k & 63;
+    int n = (k - j)/64;
+
+    // exp(r) - 1. The Taylor polynomial of degree 5 is accurate to machine precision
+    // for |r| <= ln(2)/128. It is evaluated using Estrin's scheme to shorten the chain
+    // of dependent operations.
+    double r2 = r*r;
+    double p = (r + r2*(1.0/2 + r*(1.0/6))) + (r2*r2)*(1.0/24 + r*(1.0/120));
+
+    double t = Tables<>::exp2Frac[j];
+    return (t + t*p)*exp2i_(n);
+}
+
+// ln(x) for positive, normal and finite x
+inline double logKernel_(double x)
+{
+    // split the argument into x = 2^e * m with 0.75 <= m < 1.5. The six bits below the
+    // exponent of the difference to the bit pattern of 0.75 then identify the interval
+    // of m.
+    uint64_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    uint64_t tmp = bits - 0x3fe8000000000000ULL;
+    int e = static_cast<int>(static_cast<int64_t>(tmp) >> 52);
+    int j = static_cast<int>(tmp >> 46) & 63;
+    bits -= static_cast<uint64_t>(static_cast<int64_t>(e)) << 52;
+    double m;
+    std::memcpy(&m, &bits, sizeof(m));
+
+    // ln(m) = ln(c) + ln(1 + r) with r = m/c - 1 and |r| < 1/64. m - c is exact, so r
+    // only exhibits a relative rounding error.
+    double r = (m - Tables<>::center[j])*Tables<>::invCenter[j];
+    double r2 = r*r;
+    double r4 = r2*r2;
+    double p =
+        (r + r2*(-1.0/2 + r*(1.0/3)))
+        + r4*((-1.0/4 + r*(1.0/5)) + r2*(-1.0/6 + r*(1.0/7)) + r4*(-1.0/8));
+
+    return e*ln2Hi + ((Tables<>::logCenter[j] + e*ln2Lo) + p);
+}
+
+inline bool isPositiveNormal_(double x)
+{ return x >= std::numeric_limits<double>::min() && x <= std::numeric_limits<double>::max(); }
+} // namespace FastMathDetail
+
+/*!
+ * \brief A fast approximation of the exponential function.
+ */
+inline double fastExp(double x)
+{
+    // results which are not normal floating point numbers (and NaNs) are left to the
+    // standard library
+    if (!(-708.0 < x && x < 709.0))
+        return std::exp(x);
+
+    return FastMathDetail::expKernel_(x);
+}
+
+/*!
+ * \brief A fast approximation of the natural logarithm.
+ */
+inline double fastLog(double x)
+{
+    // zero, negative, subnormal, infinite and NaN arguments are left to the standard
+    // library
+    if (!FastMathDetail::isPositiveNormal_(x))
+        return std::log(x);
+
+    return FastMathDetail::logKernel_(x);
+}
+
+/*!
+ * \brief A fast approximation of the power function.
+ */
+inline double fastPow(double base, double exp)
+{
+    // the special cases are left to the standard library. Only calling it at a single
+    // place keeps the code which gets inlined small.
+    double y = 0.0;
+    if (FastMathDetail::isPositiveNormal_(base))
+        y = exp*FastMathDetail::logKernel_(base);
+    if (!(-708.0 < y && y < 709.0) || !FastMathDetail::isPositiveNormal_(base))
+        return std::pow(base, exp);
+
+    return FastMathDetail::expKernel_(y);
+}
+
+/*!
+ * \brief A fast approximation of the exponential function in single precision.
+ *
+ * This uses the double precision kernel, so the result is correctly rounded in almost
+ * all cases.
+ */
+inline float fastExp(float x)
+{ return static_cast<float>(fastExp(static_cast<double>(x))); }
+
+/*!
+ * \brief A fast approximation of the natural logarithm in single precision.
+ */
+inline float fastLog(float x)
+{ return static_cast<float>(fastLog(static_cast<double>(x))); }
+
+/*!
+ * \brief A fast approximation of the power function in single precision.
+ */
+inline float fastPow(float base, float exp)
+{ return static_cast<float>(fastPow(static_cast<double>(base), static_cast<double>(exp))); }
+
+/*!
+ * \brief A math toolbox which uses the fast approximations of exp(), log() and pow().
+ *
+ * All other functions are the same as the ones of MathToolbox. It can be passed to the
+ * material laws which accept a toolbox as a template parameter, e.g. VanGenuchten.
+ */
+template <class ScalarT>
+struct FastMathToolbox : public MathToolbox<ScalarT>
+{
+    typedef ScalarT Scalar;
+
+    //! The natural exponentiation of a value
+    static Scalar exp(Scalar arg)
+    { return fastExp(arg); }
+
+    //! The natural logarithm of a value
+    static Scalar log(Scalar arg)
+    { return fastLog(arg); }
+
+    //! Exponentiation to an arbitrary base
+    static Scalar pow(Scalar base, Scalar exp)
+    { return fastPow(base, exp); }
+};
+
+} // namespace Opm
+
+#endif
@@ -0,0 +1,126 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Solves small dense linear systems of equations whose size is known at
+ *        compile time.
+ */
+#ifndef OPM_FIXED_SIZE_LU_HPP
+#define OPM_FIXED_SIZE_LU_HPP
+
+#include <opm/material/common/MathToolbox.hpp>
+
+#include <opm/common/utility/platform_dependent/disable_warnings.h>
+
+#include <dune/common/fvector.hh>
+#include <dune/common/fmatrix.hh>
+
+#include <opm/common/utility/platform_dependent/reenable_warnings.h>
+
+#include <utility>
+
+namespace Opm {
+/*!
+ * \brief Solve the linear system of equations A*x = b in place using LU decomposition
+ *        with partial pivoting.
+ *
+ * This is intended for the small systems which arise from the Newton methods of the
+ * constraint solvers. Since the size of the system is a compile time constant, the
+ * compiler can unroll and vectorize all loops. In contrast to
+ * Dune::FieldMatrix::solve(), no copy of the matrix is made, the singularity
+ * threshold is not a global setting and singular matrices are reported by the return
+ * value instead of an exception.
+ *
+ * The entries of the matrix and of the right hand side may also be function
+ * evaluations for automatic differentiation, the pivots are selected using their
+ * values.
+ *
+ * \param x The solution of the system
+ * \param A The matrix of the system. It is used as scratch space, i.e., its entries
+ *          are unspecified afterwards. (Only the parts of the rows which are still
+ *          required are swapped and the permutation is not recorded, so it does not
+ *          contain a usable LU decomposition.)
+ * \param b The right hand side. It is used as scratch space as well.
+ * \param singularLimit A pivot whose magnitude is smaller than this value is
+ *                      considered to be zero.
+ *
+ * \return true if the system was solved, false if the matrix is singular. In the
+ *         latter case, x is not modified.
+ */
+template <class Evaluation, int n>
+bool solveFixedSizeLu(Dune::FieldVector<Evaluation, n> &x,
+                      Dune::FieldMatrix<Evaluation, n, n> &A,
+                      Dune::FieldVector<Evaluation, n> &b,
+                      typename MathToolbox<Evaluation>::Scalar singularLimit)
+{
+    typedef MathToolbox<Evaluation> Toolbox;
+    typedef typename Toolbox::Scalar Scalar;
+
+    // forward elimination
+    for (int k = 0; k < n; ++k) {
+        // find the pivot row
+        int pivotIdx = k;
+        Scalar pivotMag = std::abs(Toolbox::value(A[k][k]));
+        for (int i = k + 1; i < n; ++i) {
+            Scalar mag = std::abs(Toolbox::value(A[i][k]));
+            if (mag > pivotMag) {
+                pivotMag = mag;
+                pivotIdx = i;
+            }
+        }
+
+        if (!(pivotMag >= singularLimit))
+            return false; // singular matrix or NaN
+
+        // the columns left of the pivot are not used anymore
+        if (pivotIdx != k) {
+            for (int j = k; j < n; ++j)
+                std::swap(A[k][j], A[pivotIdx][j]);
+            std::swap(b[k], b[pivotIdx]);
+        }
+
+        // eliminate the entries below the pivot. they are not used anymore, so they
+        // are not updated.
+        const Evaluation& invPivot = 1.0/A[k][k];
+        for (int i = k + 1; i < n; ++i) {
+            const Evaluation& factor = A[i][k]*invPivot;
+            for (int j = k + 1; j < n; ++j)
+                A[i][j] -= factor*A[k][j];
+            b[i] -= factor*b[k];
+        }
+    }
+
+    // backward substitution
+    for (int i = n - 1; i >= 0; --i) {
+        Evaluation tmp = b[i];
+        for (int j = i + 1; j < n; ++j)
+            tmp -= A[i][j]*x[j];
+        x[i] = tmp/A[i][i];
+    }
+
+    return true;
+}
+} // namespace Opm
+
+#endif
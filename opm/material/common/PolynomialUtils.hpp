@@ -27,6 +27,7 @@
 #ifndef OPM_POLYNOMIAL_UTILS_HH
 #define OPM_POLYNOMIAL_UTILS_HH
 
+#include <cassert>
 #include <cmath>
 #include <algorithm>
 
@@ -316,6 +317,98 @@ int invertCubicPolynomial(SolContainer *sol,
 
     return 3;
 }
+
+/*!
+ * \ingroup Math
+ * \brief Determine the smallest and the largest real roots of many cubic
+ *        polynomials at once
+ *
+ * The polynomials are normalized to a leading coefficient of one, i.e., the i-th
+ * polynomial is defined as
+ * \f[ p_i(x) = x^3 + b_i\;x^2 + c_i\;x + d_i \f]
+ *
+ * In contrast to invertCubicPolynomial(), the polynomials are processed in a single
+ * loop over arrays without early returns. If the polynomial has three distinct real
+ * roots, the extreme ones are computed using the trigonometric form, else the real
+ * root is computed using Cardano's formula. In both cases, the roots are improved by
+ * a Newton iteration. Multiple roots are counted with their multiplicity, i.e., if the
+ * discriminant is zero, three roots are reported and the smallest and the largest
+ * ones are the double and the simple root.
+ *
+ * \param minRoot Array into which the smallest real roots are written
+ * \param maxRoot Array into which the largest real roots are written. This is the
+ *                same as the smallest root if there is only a single one.
+ * \param numRoots Array into which the number of real roots (1 or 3) is written
+ * \param b The coefficients for the quadratic terms
+ * \param c The coefficients for the linear terms
+ * \param d The coefficients for the constant terms
+ * \param n The number of polynomials
+ */
+template <class Scalar>
+void invertCubicPolynomials(Scalar *minRoot,
+                            Scalar *maxRoot,
+                            int *numRoots,
+                            const Scalar *b,
+                            const Scalar *c,
+                            const Scalar *d,
+                            unsigned n)
+{
+    const Scalar sqrt3 = std::sqrt(Scalar(3.0));
+
+    for (unsigned i = 0; i < n; ++i) {
+        // get rid of the quadratic term by subsituting x = t - b/3. this results in
+        // t^3 + p*t + q = 0
+        Scalar bThird = b[i]/3;
+        Scalar p = c[i] - b[i]*bThird;
+        Scalar q = d[i] + bThird*(2*bThird*bThird - c[i]);
+        Scalar disc = q*q/4 + p*p*p/27;
+
+        bool threeRoots = disc <= 0;
+        Scalar x0, x1;
+        if (disc == 0) {
+            // a double root at t = -3q/(2p) and a simple one at t = 3q/p. if p is zero,
+            // q is zero as well, i.e., t = 0 is a triple root.
+            Scalar tDouble = (p != 0)?(-3*q/(2*p)):Scalar(0.0);
+            Scalar tSimple = -2*tDouble;
+            x0 = std::min(tDouble, tSimple) - bThird;
+            x1 = std::max(tDouble, tSimple) - bThird;
+        }
+        else if (!threeRoots) {
+            // single real root (Cardano). the sign is chosen such that no
+            // cancellation happens in the cube root's argument.
+            Scalar sqrtDisc = std::sqrt(disc);
+            Scalar u = std::cbrt(-q/2 - ((q < 0)?-sqrtDisc:sqrtDisc));
+            Scalar t = (u != 0)?(u - p/(3*u)):Scalar(0.0);
+            x0 = x1 = t - bThird;
+        }
+        else {
+            // three real roots (trigonometric form)
+            Scalar r = std::sqrt(-p/3);
+            Scalar cosArg = -q/(2*r*r*r);
+            cosArg = std::min(Scalar(1.0), std::max(Scalar(-1.0), cosArg));
+            Scalar cosPhi = std::cos(std::acos(cosArg)/3);
+            Scalar sinPhi = std::sqrt(std::max(1 - cosPhi*cosPhi, Scalar(0.0)));
+            x1 = 2*r*cosPhi - bThird;
+            x0 = -r*(cosPhi + sqrt3*sinPhi) - bThird; // 2*r*cos(phi + 2/3*pi)
+        }
+
+        // polish the roots by a Newton iteration. only accept the result if it
+        // reduces the residual.
+        Scalar f0 = d[i] + x0*(c[i] + x0*(b[i] + x0));
+        Scalar df0 = c[i] + x0*(2*b[i] + 3*x0);
+        Scalar y0 = (df0 != 0)?(x0 - f0/df0):x0;
+        Scalar g0 = d[i] + y0*(c[i] + y0*(b[i] + y0));
+
+        Scalar f1 = d[i] + x1*(c[i] + x1*(b[i] + x1));
+        Scalar df1 = c[i] + x1*(2*b[i] + 3*x1);
+        Scalar y1 = (df1 != 0)?(x1 - f1/df1):x1;
+        Scalar g1 = d[i] + y1*(c[i] + y1*(b[i] + y1));
+
+        minRoot[i] = (std::abs(g0) < std::abs(f0))?y0:x0;
+        maxRoot[i] = (std::abs(g1) < std::abs(f1))?y1:x1;
+        numRoots[i] = threeRoots?3:1;
+    }
+}
 }
 
 #endif
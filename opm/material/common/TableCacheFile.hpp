@@ -0,0 +1,122 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Reads and writes the binary files which cache the tables of the tabulated
+ *        components.
+ *
+ * A cache file starts with the length of a key string (as a 64 bit integer) and the
+ * key itself. The key describes everything the tables depend on. It is followed by
+ * the raw contents of the tables in a fixed order. The files are thus only portable
+ * between machines with the same floating point representation and byte order, but
+ * a file which was written for a different scalar type, range or resolution is never
+ * used if the key includes these.
+ */
+#ifndef OPM_TABLE_CACHE_FILE_HPP
+#define OPM_TABLE_CACHE_FILE_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace Opm {
+/*!
+ * \brief Read the tables from a cache file.
+ *
+ * The tables must already have the size of the ones stored in the file.
+ *
+ * \return false if the file does not exist, if it was written for a different key or
+ *         if it is truncated. The contents of the tables are undefined in this case.
+ */
+template <class Scalar>
+bool readTableCacheFile(const std::string& fileName,
+                        const std::string& key,
+                        const std::vector<std::vector<Scalar>*>& tables)
+{
+    std::ifstream is(fileName.c_str(), std::ios::binary);
+    if (!is)
+        return false;
+
+    uint64_t keySize;
+    is.read(reinterpret_cast<char*>(&keySize), sizeof(keySize));
+    if (!is || keySize != key.size())
+        return false;
+
+    std::string fileKey(key.size(), '\0');
+    is.read(&fileKey[0], static_cast<std::streamsize>(keySize));
+    if (!is || fileKey != key)
+        return false;
+
+    for (std::vector<Scalar>* table : tables) {
+        is.read(reinterpret_cast<char*>(table->data()),
+                static_cast<std::streamsize>(table->size()*sizeof(Scalar)));
+        if (!is)
+            return false; // truncated file
+    }
+
+    return true;
+}
+
+/*!
+ * \brief Write the tables to a cache file.
+ *
+ * The data is written to a temporary file which is then renamed, so concurrent
+ * processes never read a partially written file. Failures are ignored.
+ */
+template <class Scalar>
+void writeTableCacheFile(const std::string& fileName,
+                         const std::string& key,
+                         const std::vector<std::vector<Scalar>*>& tables)
+{
+    std::ostringstream tmpName;
+    tmpName << fileName << ".tmp" << std::random_device()();
+
+    {
+        std::ofstream os(tmpName.str().c_str(), std::ios::binary);
+        if (!os)
+            return;
+
+        uint64_t keySize = key.size();
+        os.write(reinterpret_cast<const char*>(&keySize), sizeof(keySize));
+        os.write(key.data(), static_cast<std::streamsize>(keySize));
+        for (std::vector<Scalar>* table : tables)
+            os.write(reinterpret_cast<const char*>(table->data()),
+                     static_cast<std::streamsize>(table->size()*sizeof(Scalar)));
+        if (!os) {
+            os.close();
+            std::remove(tmpName.str().c_str());
+            return;
+        }
+    }
+
+    if (std::rename(tmpName.str().c_str(), fileName.c_str()) != 0)
+        std::remove(tmpName.str().c_str());
+}
+} // namespace Opm
+
+#endif
@@ -0,0 +1,412 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::GeneratedCO2Tables
+ */
+#ifndef OPM_GENERATED_CO2_TABLES_HPP
+#define OPM_GENERATED_CO2_TABLES_HPP
+
+#include <opm/common/Exceptions.hpp>
+#include <opm/common/ErrorMacros.hpp>
+#include <opm/material/common/MathToolbox.hpp>
+#include <opm/material/common/TableCacheFile.hpp>
+#include <opm/material/components/co2/SpanWagner.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <exception>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \ingroup Components
+ *
+ * \brief Tables of the enthalpy and the density of CO2 which are generated at run time.
+ *
+ * This class can be used as the \c CO2Tables parameter of the \c Opm::CO2 component
+ * and of the \c Opm::FluidSystems::BrineCO2 fluid system. In contrast to tables which
+ * are included as precomputed source files, the range and the resolution can be
+ * chosen by the user. The tables must be generated using init() before any property
+ * of CO2 is used. The values are computed using the equation of state by Span and
+ * Wagner (see SpanWagner), which is always evaluated in double precision.
+ *
+ * Since the properties of CO2 change very rapidly close to its critical point, the
+ * sampling points are not spaced uniformly: Their density is increased around the
+ * critical temperature and the critical pressure by up to a given factor. Below the
+ * critical temperature, the refinement around the critical pressure also resolves
+ * the jump of the properties at the vapor pressure better. Between the sampling
+ * points, the values are interpolated bilinearly.
+ *
+ * \tparam Scalar The type used for scalar values
+ */
+template <class Scalar>
+class GeneratedCO2Tables
+{
+    typedef Opm::SpanWagner<double> SpanWagner;
+
+    // one axis of the tables. the sampling points are uniformly spaced in terms of
+    // s(x) = x + refinement*width*atan((x - center)/width), i.e., their density is
+    // increased by a factor of up to 1 + refinement around the center. to find the
+    // interval which contains a value without a search, the axis is divided into
+    // uniform buckets which are not wider than the smallest interval. each bucket
+    // stores the index of the interval which contains its lower end.
+    struct Axis_
+    {
+        Scalar stretch(Scalar x) const
+        { return x + refinement*width*std::atan((x - center)/width); }
+
+        void init(Scalar xMin, Scalar xMax, unsigned n)
+        {
+            assert(xMin < xMax);
+            assert(n >= 2);
+
+            Scalar sMin = stretch(xMin);
+            Scalar sMax = stretch(xMax);
+
+            nodes.resize(n);
+            nodes[0] = xMin;
+            nodes[n - 1] = xMax;
+            for (unsigned i = 1; i < n - 1; ++i) {
+                // solve s(x) = s_i by bisection. s(x) is strictly monotonous, so the
+                // solution is between the previous node and the end of the axis.
+                Scalar s = sMin + (sMax - sMin)*i/(n - 1);
+                Scalar xLow = nodes[i - 1];
+                Scalar xHigh = xMax;
+                for (int iter = 0; iter < 200 && xHigh - xLow > 0; ++iter) {
+                    Scalar x = (xLow + xHigh)/2;
+                    if (x == xLow || x == xHigh)
+                        break;
+                    (stretch(x) < s ? xLow : xHigh) = x;
+                }
+                nodes[i] = (xLow + xHigh)/2;
+            }
+
+            Scalar minSpacing = xMax - xMin;
+            for (unsigned i = 0; i + 1 < n; ++i)
+                minSpacing = std::min(minSpacing, nodes[i + 1] - nodes[i]);
+            if (!(minSpacing > 0))
+                OPM_THROW(std::invalid_argument,
+                          "The resolution of the CO2 tables is too fine for the scalar type");
+            unsigned nBuckets = static_cast<unsigned>(std::ceil((xMax - xMin)/minSpacing));
+            bucketsPerUnit = nBuckets/(xMax - xMin);
+
+            buckets.resize(nBuckets + 1);
+            unsigned i = 0;
+            for (unsigned k = 0; k <= nBuckets; ++k) {
+                Scalar x = xMin + k/bucketsPerUnit;
+                while (i + 2 < n && x >= nodes[i + 1])
+                    ++ i;
+                buckets[k] = i;
+            }
+        }
+
+        // returns the index of the interval which contains a value. values outside of
+        // the axis are attributed to the first or the last interval.
+        unsigned intervalIdx(Scalar x) const
+        {
+            Scalar k = (x - nodes.front())*bucketsPerUnit;
+            unsigned i = buckets[static_cast<unsigned>(std::max<Scalar>(0, std::min<Scalar>(buckets.size() - 1, k)))];
+
+            // a bucket contains at most one sampling point, and the rounding errors
+            // of k may shift the bucket by one
+            while (i + 2 < nodes.size() && x >= nodes[i + 1])
+                ++ i;
+            if (i > 0 && x < nodes[i])
+                -- i;
+            return i;
+        }
+
+        Scalar center;
+        Scalar width;
+        Scalar refinement;
+
+        std::vector<Scalar> nodes;
+        Scalar bucketsPerUnit;
+        std::vector<unsigned> buckets;
+    };
+
+public:
+    /*!
+     * \brief A tabulated property of CO2 as a function of temperature and pressure.
+     */
+    class PropertyTable
+    {
+        friend class GeneratedCO2Tables;
+
+    public:
+        /*!
+         * \brief The minimum temperature of the table \f$\mathrm{[K]}\f$.
+         */
+        Scalar minTemp() const
+        { return tempAxis_.nodes.front(); }
+
+        /*!
+         * \brief The maximum temperature of the table \f$\mathrm{[K]}\f$.
+         */
+        Scalar maxTemp() const
+        { return tempAxis_.nodes.back(); }
+
+        /*!
+         * \brief The minimum pressure of the table \f$\mathrm{[Pa]}\f$.
+         */
+        Scalar minPress() const
+        { return pressAxis_.nodes.front(); }
+
+        /*!
+         * \brief The maximum pressure of the table \f$\mathrm{[Pa]}\f$.
+         */
+        Scalar maxPress() const
+        { return pressAxis_.nodes.back(); }
+
+        /*!
+         * \brief Returns true iff a temperature and a pressure are within the range of
+         *        the table.
+         */
+        template <class Evaluation>
+        bool applies(const Evaluation& temperature, const Evaluation& pressure) const
+        {
+            typedef MathToolbox<Evaluation> Toolbox;
+
+            Scalar T = Toolbox::value(temperature);
+            Scalar p = Toolbox::value(pressure);
+            return minTemp() <= T && T <= maxTemp() && minPress() <= p && p <= maxPress();
+        }
+
+        /*!
+         * \brief Evaluate the property at a given temperature and pressure.
+         *
+         * If this method is called for a value outside of the tabulated range, a \c
+         * Opm::NumericalProblem exception is thrown if the code is compiled in debug
+         * mode. Otherwise, the values are extrapolated linearly.
+         */
+        template <class Evaluation>
+        Evaluation eval(const Evaluation& temperature, const Evaluation& pressure) const
+        {
+            typedef MathToolbox<Evaluation> Toolbox;
+
+#ifndef NDEBUG
+            if (!applies(temperature, pressure))
+                OPM_THROW(NumericalProblem,
+                          "Attempt to get tabulated value for ("
+                          << Toolbox::value(temperature) << ", " << Toolbox::value(pressure)
+                          << ") on a table of extend "
+                          << minTemp() << " to " << maxTemp() << " times "
+                          << minPress() << " to " << maxPress());
+#endif
+
+            const std::vector<Scalar>& Ts = tempAxis_.nodes;
+            const std::vector<Scalar>& ps = pressAxis_.nodes;
+            unsigned i = tempAxis_.intervalIdx(Toolbox::value(temperature));
+            unsigned j = pressAxis_.intervalIdx(Toolbox::value(pressure));
+            const Evaluation& alpha = (temperature - Ts[i])/(Ts[i + 1] - Ts[i]);
+            const Evaluation& beta = (pressure - ps[j])/(ps[j + 1] - ps[j]);
+
+            unsigned m = static_cast<unsigned>(Ts.size());
+            const Scalar* v = values_.data() + i + j*m;
+            const Evaluation& s1 = v[0]*(1.0 - alpha) + v[1]*alpha;
+            const Evaluation& s2 = v[m]*(1.0 - alpha) + v[m + 1]*alpha;
+            return s1*(1.0 - beta) + s2*beta;
+        }
+
+    private:
+        // the value at the i-th temperature and the j-th pressure is stored at
+        // i + j*numTemperatures
+        std::vector<Scalar> values_;
+    };
+
+    /*!
+     * \brief Set how strongly the sampling points are concentrated around the
+     *        critical point.
+     *
+     * The density of the sampling points is increased by a factor of up to 1 + \a
+     * factor. The width of the refined region is about \a tempWidth around the
+     * critical temperature and \a pressWidth around the critical pressure. A factor of
+     * zero results in uniformly spaced sampling points. This method must be called
+     * before init(). The default is a factor of 8 within 5 K and 2 MPa.
+     */
+    static void setCriticalRefinement(Scalar factor, Scalar tempWidth, Scalar pressWidth)
+    {
+        assert(factor >= 0);
+        assert(tempWidth > 0 && pressWidth > 0);
+
+        tempAxis_.refinement = factor;
+        tempAxis_.width = tempWidth;
+        pressAxis_.refinement = factor;
+        pressAxis_.width = pressWidth;
+    }
+
+    /*!
+     * \brief Generate the tables.
+     *
+     * \param tempMin The minimum of the temperature range in \f$\mathrm{[K]}\f$
+     * \param tempMax The maximum of the temperature range in \f$\mathrm{[K]}\f$
+     * \param nTemp The number of sampling points within the temperature range
+     * \param pressMin The minimum of the pressure range in \f$\mathrm{[Pa]}\f$
+     * \param pressMax The maximum of the pressure range in \f$\mathrm{[Pa]}\f$
+     * \param nPress The number of sampling points within the pressure range
+     */
+    static void init(Scalar tempMin, Scalar tempMax, unsigned nTemp,
+                     Scalar pressMin, Scalar pressMax, unsigned nPress)
+    {
+        setAxes_(tempMin, tempMax, nTemp, pressMin, pressMax, nPress);
+        tabulate_();
+    }
+
+    /*!
+     * \brief Generate the tables using a cache file.
+     *
+     * If the cache file exists and was written for the same scalar type, ranges,
+     * resolution and refinement, the tables are read from it. Otherwise they are
+     * generated like by the other init() method and the cache file is (re-)written.
+     * Failures to write the file are ignored. The cache files have the same format as
+     * the ones of \c Opm::TabulatedComponent.
+     *
+     * \param tempMin The minimum of the temperature range in \f$\mathrm{[K]}\f$
+     * \param tempMax The maximum of the temperature range in \f$\mathrm{[K]}\f$
+     * \param nTemp The number of sampling points within the temperature range
+     * \param pressMin The minimum of the pressure range in \f$\mathrm{[Pa]}\f$
+     * \param pressMax The maximum of the pressure range in \f$\mathrm{[Pa]}\f$
+     * \param nPress The number of sampling points within the pressure range
+     * \param cacheFileName The name of the file which caches the tables
+     *
+     * \return true if the tables were read from the cache file
+     */
+    static bool init(Scalar tempMin, Scalar tempMax, unsigned nTemp,
+                     Scalar pressMin, Scalar pressMax, unsigned nPress,
+                     const std::string& cacheFileName)
+    {
+        setAxes_(tempMin, tempMax, nTemp, pressMin, pressMax, nPress);
+
+        const std::string& key = cacheKey_();
+        if (readTableCacheFile(cacheFileName, key, tables_()))
+            return true;
+
+        tabulate_();
+        writeTableCacheFile(cacheFileName, key, tables_());
+        return false;
+    }
+
+    //! The specific enthalpy of CO2 \f$\mathrm{[J/kg]}\f$
+    static PropertyTable tabulatedEnthalpy;
+
+    //! The density of CO2 \f$\mathrm{[kg/m^3]}\f$
+    static PropertyTable tabulatedDensity;
+
+    //! The salinity of the brine which is used by the BrineCO2 fluid system \f$\mathrm{[-]}\f$
+    static Scalar brineSalinity;
+
+private:
+    static void setAxes_(Scalar tempMin, Scalar tempMax, unsigned nTemp,
+                         Scalar pressMin, Scalar pressMax, unsigned nPress)
+    {
+        tempAxis_.center = SpanWagner::criticalTemperature();
+        pressAxis_.center = SpanWagner::criticalPressure();
+        tempAxis_.init(tempMin, tempMax, nTemp);
+        pressAxis_.init(pressMin, pressMax, nPress);
+
+        tabulatedEnthalpy.values_.resize(nTemp*nPress);
+        tabulatedDensity.values_.resize(nTemp*nPress);
+    }
+
+    // the pressures are independent of each other. exceptions must not leave the
+    // parallel region, so the first one is stored and re-thrown afterwards.
+    static void tabulate_()
+    {
+        std::exception_ptr error;
+        int nPress = static_cast<int>(pressAxis_.nodes.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+        for (int j = 0; j < nPress; ++ j) {
+            try {
+                tabulatePressure_(static_cast<unsigned>(j));
+            }
+            catch (...) {
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+                if (!error)
+                    error = std::current_exception();
+            }
+        }
+
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    static void tabulatePressure_(unsigned j)
+    {
+        unsigned m = static_cast<unsigned>(tempAxis_.nodes.size());
+        double p = pressAxis_.nodes[j];
+        for (unsigned i = 0; i < m; ++ i) {
+            double T = tempAxis_.nodes[i];
+            double rho = SpanWagner::density(T, p);
+            tabulatedDensity.values_[i + j*m] = static_cast<Scalar>(rho);
+            tabulatedEnthalpy.values_[i + j*m] = static_cast<Scalar>(SpanWagner::enthalpy(T, rho));
+        }
+    }
+
+    // all tables in the order in which they are stored in cache files
+    static std::vector<std::vector<Scalar>*> tables_()
+    { return { &tabulatedEnthalpy.values_, &tabulatedDensity.values_ }; }
+
+    // returns a string which identifies the tables
+    static std::string cacheKey_()
+    {
+        std::ostringstream oss;
+        oss.precision(std::numeric_limits<Scalar>::max_digits10);
+        oss << "OPM GeneratedCO2Tables 1\n"
+            << "sizeof(Scalar)=" << sizeof(Scalar) << "\n";
+        for (const Axis_* axis : { &tempAxis_, &pressAxis_ })
+            oss << "[" << axis->nodes.front() << ", " << axis->nodes.back() << "]"
+                << " n=" << axis->nodes.size()
+                << " refinement=" << axis->refinement
+                << " width=" << axis->width << "\n";
+        return oss.str();
+    }
+
+    static Axis_ tempAxis_;
+    static Axis_ pressAxis_;
+};
+
+template <class Scalar>
+typename GeneratedCO2Tables<Scalar>::PropertyTable GeneratedCO2Tables<Scalar>::tabulatedEnthalpy;
+template <class Scalar>
+typename GeneratedCO2Tables<Scalar>::PropertyTable GeneratedCO2Tables<Scalar>::tabulatedDensity;
+template <class Scalar>
+Scalar GeneratedCO2Tables<Scalar>::brineSalinity = 1e-1;
+template <class Scalar>
+typename GeneratedCO2Tables<Scalar>::Axis_ GeneratedCO2Tables<Scalar>::tempAxis_ = { 0.0, 5.0, 8.0, {}, 0.0, {} };
+template <class Scalar>
+typename GeneratedCO2Tables<Scalar>::Axis_ GeneratedCO2Tables<Scalar>::pressAxis_ = { 0.0, 2e6, 8.0, {}, 0.0, {} };
+
+} // namespace Opm
+
+#endif
@@ -31,12 +31,17 @@
 #include <cmath>
 #include <limits>
 #include <cassert>
+#include <exception>
 #include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
 
 #include <opm/common/Exceptions.hpp>
 #include <opm/common/ErrorMacros.hpp>
 
 #include <opm/material/common/MathToolbox.hpp>
+#include <opm/material/common/TableCacheFile.hpp>
 
 namespace Opm {
 /*!
@@ -53,8 +58,14 @@ namespace Opm {
  * \tparam useVaporPressure If true, tabulate all quantities along the
  *                          vapor pressure curve, if false use the
  *                          pressure range [p_min, p_max]
+ * \tparam useCubicInterpolation If true, the vapor pressure and the
+ *                               quantities which depend on temperature and
+ *                               pressure are interpolated using monotone
+ *                               cubic Hermite splines instead of linearly.
+ *                               This achieves a similar accuracy on much
+ *                               coarser tables.
  */
-template <class ScalarT, class RawComponent, bool useVaporPressure=true>
+template <class ScalarT, class RawComponent, bool useVaporPressure=true, bool useCubicInterpolation=false>
 class TabulatedComponent
 {
 public:
@@ -65,6 +76,9 @@ public:
     /*!
      * \brief Initialize the tables.
      *
+     * If the code is compiled with OpenMP support, the temperatures of the tables are
+     * filled in parallel, so the raw component must be thread safe.
+     *
      * \param tempMin The minimum of the temperature range in \f$\mathrm{[K]}\f$
      * \param tempMax The maximum of the temperature range in \f$\mathrm{[K]}\f$
      * \param nTemp The number of entries/steps within the temperature range
@@ -75,141 +89,49 @@ public:
     static void init(Scalar tempMin, Scalar tempMax, unsigned nTemp,
                      Scalar pressMin, Scalar pressMax, unsigned nPress)
     {
-        tempMin_ = tempMin;
-        tempMax_ = tempMax;
-        nTemp_ = nTemp;
-        pressMin_ = pressMin;
-        pressMax_ = pressMax;
-        nPress_ = nPress;
-        nDensity_ = nPress_;
-
-        // allocate the arrays
-        vaporPressure_ = new Scalar[nTemp_];
-        minGasDensity__ = new Scalar[nTemp_];
-        maxGasDensity__ = new Scalar[nTemp_];
-        minLiquidDensity__ = new Scalar[nTemp_];
-        maxLiquidDensity__ = new Scalar[nTemp_];
-
-        gasEnthalpy_ = new Scalar[nTemp_*nPress_];
-        liquidEnthalpy_ = new Scalar[nTemp_*nPress_];
-        gasHeatCapacity_ = new Scalar[nTemp_*nPress_];
-        liquidHeatCapacity_ = new Scalar[nTemp_*nPress_];
-        gasDensity_ = new Scalar[nTemp_*nPress_];
-        liquidDensity_ = new Scalar[nTemp_*nPress_];
-        gasViscosity_ = new Scalar[nTemp_*nPress_];
-        liquidViscosity_ = new Scalar[nTemp_*nPress_];
-        gasThermalConductivity_ = new Scalar[nTemp_*nPress_];
-        liquidThermalConductivity_ = new Scalar[nTemp_*nPress_];
-        gasPressure_ = new Scalar[nTemp_*nDensity_];
-        liquidPressure_ = new Scalar[nTemp_*nDensity_];
-
-        assert(std::numeric_limits<Scalar>::has_quiet_NaN);
-        Scalar NaN = std::numeric_limits<Scalar>::quiet_NaN();
-
-        // fill the temperature-pressure arrays
-        for (unsigned iT = 0; iT < nTemp_; ++ iT) {
-            Scalar temperature = iT * (tempMax_ - tempMin_)/(nTemp_ - 1) + tempMin_;
-
-            try { vaporPressure_[iT] = RawComponent::vaporPressure(temperature); }
-            catch (std::exception) { vaporPressure_[iT] = NaN; }
-
-            Scalar pgMax = maxGasPressure_(iT);
-            Scalar pgMin = minGasPressure_(iT);
-
-            // fill the temperature, pressure gas arrays
-            for (unsigned iP = 0; iP < nPress_; ++ iP) {
-                Scalar pressure = iP * (pgMax - pgMin)/(nPress_ - 1) + pgMin;
-
-                unsigned i = iT + iP*nTemp_;
-
-                try { gasEnthalpy_[i] = RawComponent::gasEnthalpy(temperature, pressure); }
-                catch (std::exception) { gasEnthalpy_[i] = NaN; }
-
-                try { gasHeatCapacity_[i] = RawComponent::gasHeatCapacity(temperature, pressure); }
-                catch (std::exception) { gasHeatCapacity_[i] = NaN; }
-
-                try { gasDensity_[i] = RawComponent::gasDensity(temperature, pressure); }
-                catch (std::exception) { gasDensity_[i] = NaN; }
-
-                try { gasViscosity_[i] = RawComponent::gasViscosity(temperature, pressure); }
-                catch (std::exception) { gasViscosity_[i] = NaN; }
-
-                try { gasThermalConductivity_[i] = RawComponent::gasThermalConductivity(temperature, pressure); }
-                catch (std::exception) { gasThermalConductivity_[i] = NaN; }
-            };
-
-            Scalar plMin = minLiquidPressure_(iT);
-            Scalar plMax = maxLiquidPressure_(iT);
-            for (unsigned iP = 0; iP < nPress_; ++ iP) {
-                Scalar pressure = iP * (plMax - plMin)/(nPress_ - 1) + plMin;
-
-                unsigned i = iT + iP*nTemp_;
-
-                try { liquidEnthalpy_[i] = RawComponent::liquidEnthalpy(temperature, pressure); }
-                catch (std::exception) { liquidEnthalpy_[i] = NaN; }
-
-                try { liquidHeatCapacity_[i] = RawComponent::liquidHeatCapacity(temperature, pressure); }
-                catch (std::exception) { liquidHeatCapacity_[i] = NaN; }
-
-                try { liquidDensity_[i] = RawComponent::liquidDensity(temperature, pressure); }
-                catch (std::exception) { liquidDensity_[i] = NaN; }
+        setRanges_(tempMin, tempMax, nTemp, pressMin, pressMax, nPress);
+        allocate_();
+        tabulate_();
+        computeSlopes_();
+    }
 
-                try { liquidViscosity_[i] = RawComponent::liquidViscosity(temperature, pressure); }
-                catch (std::exception) { liquidViscosity_[i] = NaN; }
+    /*!
+     * \brief Initialize the tables using a cache file.
+     *
+     * If the cache file exists and was written for the same raw component, scalar
+     * type, ranges and resolution, the tables are read from it. Otherwise they are
+     * calculated like by the other init() method and the cache file is (re-)written.
+     * Failures to write the file are ignored. To detect changed parameters of the raw
+     * component (e.g. the salinity of brine), a few of its values are stored in the
+     * file as well.
+     *
+     * \param tempMin The minimum of the temperature range in \f$\mathrm{[K]}\f$
+     * \param tempMax The maximum of the temperature range in \f$\mathrm{[K]}\f$
+     * \param nTemp The number of entries/steps within the temperature range
+     * \param pressMin The minimum of the pressure range in \f$\mathrm{[Pa]}\f$
+     * \param pressMax The maximum of the pressure range in \f$\mathrm{[Pa]}\f$
+     * \param nPress The number of entries/steps within the pressure range
+     * \param cacheFileName The name of the file which caches the tables
+     *
+     * \return true if the tables were read from the cache file
+     */
+    static bool init(Scalar tempMin, Scalar tempMax, unsigned nTemp,
+                     Scalar pressMin, Scalar pressMax, unsigned nPress,
+                     const std::string& cacheFileName)
+    {
+        setRanges_(tempMin, tempMax, nTemp, pressMin, pressMax, nPress);
 
-                try { liquidThermalConductivity_[i] = RawComponent::liquidThermalConductivity(temperature, pressure); }
-                catch (std::exception) { liquidThermalConductivity_[i] = NaN; }
-            }
+        const std::string& key = cacheKey_();
+        if (readCache_(cacheFileName, key)) {
+            computeSlopes_();
+            return true;
         }
 
-        // fill the temperature-density arrays
-        for (unsigned iT = 0; iT < nTemp_; ++ iT) {
-            Scalar temperature = iT * (tempMax_ - tempMin_)/(nTemp_ - 1) + tempMin_;
-
-            // calculate the minimum and maximum values for the gas
-            // densities
-            minGasDensity__[iT] = RawComponent::gasDensity(temperature, minGasPressure_(iT));
-            if (iT < nTemp_ - 1)
-                maxGasDensity__[iT] = RawComponent::gasDensity(temperature, maxGasPressure_(iT + 1));
-            else
-                maxGasDensity__[iT] = RawComponent::gasDensity(temperature, maxGasPressure_(iT));
-
-            // fill the temperature, density gas arrays
-            for (unsigned iRho = 0; iRho < nDensity_; ++ iRho) {
-                Scalar density =
-                    Scalar(iRho)/(nDensity_ - 1) *
-                    (maxGasDensity__[iT] - minGasDensity__[iT])
-                    +
-                    minGasDensity__[iT];
-
-                unsigned i = iT + iRho*nTemp_;
-
-                try { gasPressure_[i] = RawComponent::gasPressure(temperature, density); }
-                catch (std::exception) { gasPressure_[i] = NaN; };
-            };
-
-            // calculate the minimum and maximum values for the liquid
-            // densities
-            minLiquidDensity__[iT] = RawComponent::liquidDensity(temperature, minLiquidPressure_(iT));
-            if (iT < nTemp_ - 1)
-                maxLiquidDensity__[iT] = RawComponent::liquidDensity(temperature, maxLiquidPressure_(iT + 1));
-            else
-                maxLiquidDensity__[iT] = RawComponent::liquidDensity(temperature, maxLiquidPressure_(iT));
-
-            // fill the temperature, density liquid arrays
-            for (unsigned iRho = 0; iRho < nDensity_; ++ iRho) {
-                Scalar density =
-                    Scalar(iRho)/(nDensity_ - 1) *
-                    (maxLiquidDensity__[iT] - minLiquidDensity__[iT])
-                    +
-                    minLiquidDensity__[iT];
-
-                unsigned i = iT + iRho*nTemp_;
-
-                try { liquidPressure_[i] = RawComponent::liquidPressure(temperature, density); }
-                catch (std::exception) { liquidPressure_[i] = NaN; };
-            };
-        }
+        allocate_();
+        tabulate_();
+        computeSlopes_();
+        writeCache_(cacheFileName, key);
+        return false;
     }
 
     /*!
@@ -259,7 +181,7 @@ public:
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
-        const Evaluation& result = interpolateT_(vaporPressure_, temperature);
+        const Evaluation& result = interpolateT_(vaporPressure_, vaporPressureSlopes_, temperature);
         if (std::isnan(Toolbox::value(result)))
             return RawComponent::vaporPressure(temperature);
         return result;
@@ -277,6 +199,7 @@ public:
         typedef MathToolbox<Evaluation> Toolbox;
 
         const Evaluation& result = interpolateGasTP_(gasEnthalpy_,
+                                                     gasEnthalpySlopes_,
                                                      temperature,
                                                      pressure);
         if (std::isnan(Toolbox::value(result)))
@@ -296,6 +219,7 @@ public:
         typedef MathToolbox<Evaluation> Toolbox;
 
         const Evaluation& result = interpolateLiquidTP_(liquidEnthalpy_,
+                                                        liquidEnthalpySlopes_,
                                                         temperature,
                                                         pressure);
         if (std::isnan(Toolbox::value(result)))
@@ -315,6 +239,7 @@ public:
         typedef MathToolbox<Evaluation> Toolbox;
 
         const Evaluation& result = interpolateGasTP_(gasHeatCapacity_,
+                                                     gasHeatCapacitySlopes_,
                                                      temperature,
                                                      pressure);
         if (std::isnan(Toolbox::value(result)))
@@ -334,6 +259,7 @@ public:
         typedef MathToolbox<Evaluation> Toolbox;
 
         const Evaluation& result = interpolateLiquidTP_(liquidHeatCapacity_,
+                                                        liquidHeatCapacitySlopes_,
                                                         temperature,
                                                         pressure);
         if (std::isnan(Toolbox::value(result)))
@@ -433,6 +359,7 @@ public:
         typedef MathToolbox<Evaluation> Toolbox;
 
         const Evaluation& result = interpolateGasTP_(gasDensity_,
+                                                     gasDensitySlopes_,
                                                      temperature,
                                                      pressure);
         if (std::isnan(Toolbox::value(result)))
@@ -453,6 +380,7 @@ public:
         typedef MathToolbox<Evaluation> Toolbox;
 
         const Evaluation& result = interpolateLiquidTP_(liquidDensity_,
+                                                        liquidDensitySlopes_,
                                                         temperature,
                                                         pressure);
         if (std::isnan(Toolbox::value(result)))
@@ -472,6 +400,7 @@ public:
         typedef MathToolbox<Evaluation> Toolbox;
 
         const Evaluation& result = interpolateGasTP_(gasViscosity_,
+                                                     gasViscositySlopes_,
                                                      temperature,
                                                      pressure);
         if (std::isnan(Toolbox::value(result)))
@@ -491,6 +420,7 @@ public:
         typedef MathToolbox<Evaluation> Toolbox;
 
         const Evaluation& result = interpolateLiquidTP_(liquidViscosity_,
+                                                        liquidViscositySlopes_,
                                                         temperature,
                                                         pressure);
         if (std::isnan(Toolbox::value(result)))
@@ -510,6 +440,7 @@ public:
         typedef MathToolbox<Evaluation> Toolbox;
 
         const Evaluation& result = interpolateGasTP_(gasThermalConductivity_,
+                                                     gasThermalConductivitySlopes_,
                                                      temperature,
                                                      pressure);
         if (std::isnan(Toolbox::value(result)))
@@ -529,6 +460,7 @@ public:
         typedef MathToolbox<Evaluation> Toolbox;
 
         const Evaluation& result = interpolateLiquidTP_(liquidThermalConductivity_,
+                                                        liquidThermalConductivitySlopes_,
                                                         temperature,
                                                         pressure);
         if (std::isnan(Toolbox::value(result)))
@@ -536,10 +468,745 @@ public:
         return result;
     }
 
+    /*!
+     * \brief The temperature \f$\mathrm{[K]}\f$ of the liquid given its pressure and
+     *        specific enthalpy.
+     *
+     * The temperature is tabulated as a function of pressure and enthalpy. Outside of
+     * the table, it is determined using Newton's method on liquidEnthalpy().
+     *
+     * \param pressure pressure of component in \f$\mathrm{[Pa]}\f$
+     * \param enthalpy specific enthalpy of the liquid in \f$\mathrm{[J/kg]}\f$
+     */
+    template <class Evaluation>
+    static Evaluation liquidTemperatureFromEnthalpy(const Evaluation& pressure, const Evaluation& enthalpy)
+    { return inverseLookup_(liquidEnthalpyQuantity_, pressure, enthalpy); }
+
+    /*!
+     * \brief The temperature \f$\mathrm{[K]}\f$ of the gas given its pressure and
+     *        specific enthalpy.
+     *
+     * The temperature is tabulated as a function of pressure and enthalpy. Outside of
+     * the table, it is determined using Newton's method on gasEnthalpy().
+     *
+     * \param pressure pressure of component in \f$\mathrm{[Pa]}\f$
+     * \param enthalpy specific enthalpy of the gas in \f$\mathrm{[J/kg]}\f$
+     */
+    template <class Evaluation>
+    static Evaluation gasTemperatureFromEnthalpy(const Evaluation& pressure, const Evaluation& enthalpy)
+    { return inverseLookup_(gasEnthalpyQuantity_, pressure, enthalpy); }
+
+    /*!
+     * \brief The temperature \f$\mathrm{[K]}\f$ of the liquid given its pressure and
+     *        density.
+     *
+     * The temperature is tabulated as a function of pressure and density. If the
+     * density of the liquid is not monotonous in temperature (e.g. for water close to
+     * its freezing point), only the largest monotonous temperature range is
+     * tabulated. Outside of the table, the temperature is determined using Newton's
+     * method on liquidDensity().
+     *
+     * \param pressure pressure of component in \f$\mathrm{[Pa]}\f$
+     * \param density density of the liquid in \f$\mathrm{[kg/m^3]}\f$
+     */
+    template <class Evaluation>
+    static Evaluation liquidTemperatureFromDensity(const Evaluation& pressure, const Evaluation& density)
+    { return inverseLookup_(liquidDensityQuantity_, pressure, density); }
+
+    /*!
+     * \brief The temperature \f$\mathrm{[K]}\f$ of the gas given its pressure and
+     *        density.
+     *
+     * The temperature is tabulated as a function of pressure and density. Outside of
+     * the table, it is determined using Newton's method on gasDensity().
+     *
+     * \param pressure pressure of component in \f$\mathrm{[Pa]}\f$
+     * \param density density of the gas in \f$\mathrm{[kg/m^3]}\f$
+     */
+    template <class Evaluation>
+    static Evaluation gasTemperatureFromDensity(const Evaluation& pressure, const Evaluation& density)
+    { return inverseLookup_(gasDensityQuantity_, pressure, density); }
+
 private:
+    // the quantities for which the temperature is tabulated as a function of
+    // pressure and the quantity
+    enum InverseQuantity_ {
+        liquidEnthalpyQuantity_,
+        gasEnthalpyQuantity_,
+        liquidDensityQuantity_,
+        gasDensityQuantity_,
+        numInverseQuantities_
+    };
+
+    // the temperature as a function of pressure and another quantity. the entry
+    // iP + k*nPress_ is the temperature at the pressure index iP where the quantity
+    // is firstValue[iP] + k/(nTemp_ - 1)*(lastValue[iP] - firstValue[iP]).
+    struct InverseTable_
+    {
+        std::vector<Scalar> temperatures;
+        std::vector<Scalar> firstValue;
+        std::vector<Scalar> lastValue;
+    };
+
+    // returns the temperature given the pressure and the value of a quantity
+    template <class Evaluation>
+    static Evaluation inverseLookup_(unsigned quantity, const Evaluation& p, const Evaluation& value)
+    {
+        typedef MathToolbox<Evaluation> Toolbox;
+
+        // the density of the gas phase is roughly proportional to the pressure. the
+        // table of its inverse thus uses density/pressure, which makes the
+        // interpolation between pressures much more accurate.
+        const Evaluation& tableValue = (quantity == gasDensityQuantity_)?(value/p):value;
+        const Evaluation& result = interpolateInverse_(inverseTables_[quantity], p, tableValue);
+        if (!std::isnan(Toolbox::value(result)))
+            return result;
+
+        return solveTemperature_(quantity, p, value);
+    }
+
+    // returns the temperature interpolated from an inverse table. this works like the
+    // interpolation of the temperature-density tables with the roles of temperature
+    // and pressure exchanged. since the ranges of the quantity differ between the
+    // pressures, the value only needs to be within the range of one of the two
+    // pressures. for the other one, the temperature is extrapolated linearly.
+    template <class Evaluation>
+    static Evaluation interpolateInverse_(const InverseTable_& table, const Evaluation& p, const Evaluation& value)
+    {
+        typedef MathToolbox<Evaluation> Toolbox;
+
+        Evaluation alphaP = (nPress_ - 1)*(p - pressMin_)/(pressMax_ - pressMin_);
+        Scalar alphaPValue = Toolbox::value(alphaP);
+        if (!(0 <= alphaPValue && alphaPValue <= nPress_ - 1))
+            return Toolbox::createConstant(NaN_());
+
+        unsigned iP = std::min<unsigned>(nPress_ - 2, static_cast<unsigned>(alphaPValue));
+        alphaP -= iP;
+
+        Evaluation alphaV[2];
+        unsigned iV[2];
+        bool inRange = false;
+        for (unsigned k = 0; k < 2; ++k) {
+            Scalar first = table.firstValue[iP + k];
+            Scalar last = table.lastValue[iP + k];
+            if (std::isnan(first))
+                return Toolbox::createConstant(NaN_()); // no temperatures at this pressure
+
+            alphaV[k] = (nTemp_ - 1)*(value - first)/(last - first);
+
+            Scalar alphaVValue = Toolbox::value(alphaV[k]);
+            if (0 <= alphaVValue && alphaVValue <= nTemp_ - 1)
+                inRange = true;
+            else if (!(alphaVValue > -1 && alphaVValue < nTemp_))
+                return Toolbox::createConstant(NaN_()); // too far out for extrapolation
+
+            iV[k] = std::min<unsigned>(nTemp_ - 2, static_cast<unsigned>(std::max<Scalar>(0, alphaVValue)));
+            alphaV[k] -= iV[k];
+        }
+
+        if (!inRange)
+            return Toolbox::createConstant(NaN_());
+
+        const Scalar* T = table.temperatures.data();
+        return
+            T[(iP    ) + (iV[0]    )*nPress_]*(1 - alphaP)*(1 - alphaV[0]) +
+            T[(iP    ) + (iV[0] + 1)*nPress_]*(1 - alphaP)*(    alphaV[0]) +
+            T[(iP + 1) + (iV[1]    )*nPress_]*(    alphaP)*(1 - alphaV[1]) +
+            T[(iP + 1) + (iV[1] + 1)*nPress_]*(    alphaP)*(    alphaV[1]);
+    }
+
+    // determine the temperature at which a quantity exhibits a given value using
+    // Newton's method. the iterations are kept within a bracket of the solution which
+    // is narrowed by bisection if a step would leave it. temperatures at which the
+    // tabulated quantity is undefined or, if the vapor pressure is used, at which the
+    // phase is not stable are above the solution for liquids and below it for gases.
+    // (the quantities of the metastable states are not necessarily monotonous.) the
+    // derivatives of the result are those of the implicit function defined by f(T, p)
+    // = value.
+    template <class Evaluation>
+    static Evaluation solveTemperature_(unsigned quantity, const Evaluation& p, const Evaluation& value)
+    {
+        typedef MathToolbox<Evaluation> Toolbox;
+
+        Scalar pValue = Toolbox::value(p);
+        Scalar targetValue = Toolbox::value(value);
+        bool isLiquid = isLiquid_(quantity);
+
+        Scalar tolerance = 10*std::numeric_limits<Scalar>::epsilon();
+        Scalar TLow = tempMin_;
+        Scalar THigh = tempMax_;
+        Scalar T = (TLow + THigh)/2;
+        Scalar df_dT = NaN_();
+        for (int i = 0;; ++i) {
+            if (i == 100)
+                OPM_THROW(NumericalProblem,
+                          "Newton method did not converge while determining the temperature of "
+                          << name() << " at p=" << pValue << " for a value of " << targetValue);
+
+            Scalar f = tabulatedQuantity_(quantity, T, pValue) - targetValue;
+            Scalar pv = useVaporPressure?vaporPressure(T):NaN_();
+            if (std::isnan(f) || (isLiquid?(pValue < pv):(pValue > pv))) {
+                (isLiquid?THigh:TLow) = T;
+                T = (TLow + THigh)/2;
+                continue;
+            }
+
+            Scalar eps = std::sqrt(std::numeric_limits<Scalar>::epsilon())*T;
+            df_dT = (tabulatedQuantity_(quantity, T + eps, pValue) - targetValue - f)/eps;
+            if (std::isnan(df_dT))
+                df_dT = (f - (tabulatedQuantity_(quantity, T - eps, pValue) - targetValue))/eps;
+            if (f == 0)
+                break;
+
+            ((f > 0) == (df_dT > 0)?THigh:TLow) = T;
+            Scalar newT = T - f/df_dT;
+            if (std::abs(newT - T) < tolerance*T) {
+                T = newT;
+                break;
+            }
+            else if (TLow < newT && newT < THigh)
+                T = newT;
+            else if (THigh - TLow < tolerance*T) {
+                // the bracket has collapsed. if the Newton step is tiny, the steps are
+                // only dominated by the round-off errors of the quantity. otherwise,
+                // the quantity is discontinuous at the bracket.
+                if (!(std::abs(newT - T) < std::sqrt(std::numeric_limits<Scalar>::epsilon())*T))
+                    OPM_THROW(NumericalProblem,
+                              "Could not determine the temperature of " << name()
+                              << " at p=" << pValue << " for a value of " << targetValue);
+                break;
+            }
+            else
+                T = (TLow + THigh)/2;
+        }
+
+        // T(p, value) is given by f(T(p, value), p) = value, thus dT = (dvalue -
+        // df/dp*dp)/(df/dT). the value part of the following expressions is zero.
+        const Evaluation& fp = tabulatedQuantity_(quantity, Toolbox::createConstant(T), p);
+        return T + ((value - targetValue) - (fp - Toolbox::value(fp)))/df_dT;
+    }
+
+    static void setRanges_(Scalar tempMin, Scalar tempMax, unsigned nTemp,
+                           Scalar pressMin, Scalar pressMax, unsigned nPress)
+    {
+        tempMin_ = tempMin;
+        tempMax_ = tempMax;
+        nTemp_ = nTemp;
+        pressMin_ = pressMin;
+        pressMax_ = pressMax;
+        nPress_ = nPress;
+        nDensity_ = nPress_;
+    }
+
+    static void allocate_()
+    {
+        vaporPressure_.resize(nTemp_);
+        minGasDensity__.resize(nTemp_);
+        maxGasDensity__.resize(nTemp_);
+        minLiquidDensity__.resize(nTemp_);
+        maxLiquidDensity__.resize(nTemp_);
+
+        gasEnthalpy_.resize(nTemp_*nPress_);
+        liquidEnthalpy_.resize(nTemp_*nPress_);
+        gasHeatCapacity_.resize(nTemp_*nPress_);
+        liquidHeatCapacity_.resize(nTemp_*nPress_);
+        gasDensity_.resize(nTemp_*nPress_);
+        liquidDensity_.resize(nTemp_*nPress_);
+        gasViscosity_.resize(nTemp_*nPress_);
+        liquidViscosity_.resize(nTemp_*nPress_);
+        gasThermalConductivity_.resize(nTemp_*nPress_);
+        liquidThermalConductivity_.resize(nTemp_*nPress_);
+        gasPressure_.resize(nTemp_*nDensity_);
+        liquidPressure_.resize(nTemp_*nDensity_);
+
+        for (unsigned quantity = 0; quantity < numInverseQuantities_; ++quantity) {
+            InverseTable_& table = inverseTables_[quantity];
+            table.temperatures.resize(nPress_*nTemp_);
+            table.firstValue.resize(nPress_);
+            table.lastValue.resize(nPress_);
+        }
+    }
+
+    // all tables in the order in which they are stored in cache files
+    static std::vector<std::vector<Scalar>*> tables_()
+    {
+        std::vector<std::vector<Scalar>*> tables = {
+            &vaporPressure_,
+            &minGasDensity__, &maxGasDensity__,
+            &minLiquidDensity__, &maxLiquidDensity__,
+            &gasEnthalpy_, &liquidEnthalpy_,
+            &gasHeatCapacity_, &liquidHeatCapacity_,
+            &gasDensity_, &liquidDensity_,
+            &gasViscosity_, &liquidViscosity_,
+            &gasThermalConductivity_, &liquidThermalConductivity_,
+            &gasPressure_, &liquidPressure_
+        };
+        for (unsigned quantity = 0; quantity < numInverseQuantities_; ++quantity) {
+            InverseTable_& table = inverseTables_[quantity];
+            tables.push_back(&table.temperatures);
+            tables.push_back(&table.firstValue);
+            tables.push_back(&table.lastValue);
+        }
+        return tables;
+    }
+
+    static Scalar temperatureAt_(unsigned iT)
+    { return iT * (tempMax_ - tempMin_)/(nTemp_ - 1) + tempMin_; }
+
+    static void tabulate_()
+    {
+        assert(std::numeric_limits<Scalar>::has_quiet_NaN);
+        Scalar NaN = std::numeric_limits<Scalar>::quiet_NaN();
+
+        // the vapor pressure determines the pressure range at each temperature. since
+        // the density range of a temperature also depends on the pressure range of the
+        // next one, the vapor pressures are computed up front.
+        for (unsigned iT = 0; iT < nTemp_; ++ iT) {
+            try { vaporPressure_[iT] = RawComponent::vaporPressure(temperatureAt_(iT)); }
+            catch (const std::exception&) { vaporPressure_[iT] = NaN; }
+        }
+
+        // the temperatures are independent of each other, and so are the pressures
+        // of the inverse tables
+        parallelFor_(nTemp_, &tabulateTemperature_);
+        parallelFor_(nPress_, &tabulateInversePressure_);
+    }
+
+    // call fn(i) for all 0 <= i < n, in parallel if OpenMP is available. exceptions
+    // must not leave the parallel region, so the first one is stored and re-thrown
+    // afterwards.
+    static void parallelFor_(unsigned n, void (*fn)(unsigned))
+    {
+        std::exception_ptr error;
+        int nInt = static_cast<int>(n);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+        for (int i = 0; i < nInt; ++ i) {
+            try {
+                fn(static_cast<unsigned>(i));
+            }
+            catch (...) {
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+                {
+                    if (!error)
+                        error = std::current_exception();
+                }
+            }
+        }
+
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    // fill all entries of the tables for a given temperature index
+    static void tabulateTemperature_(unsigned iT)
+    {
+        Scalar NaN = std::numeric_limits<Scalar>::quiet_NaN();
+        Scalar temperature = temperatureAt_(iT);
+
+        Scalar pgMax = maxGasPressure_(iT);
+        Scalar pgMin = minGasPressure_(iT);
+
+        // fill the temperature, pressure gas arrays
+        for (unsigned iP = 0; iP < nPress_; ++ iP) {
+            Scalar pressure = iP * (pgMax - pgMin)/(nPress_ - 1) + pgMin;
+
+            unsigned i = iT + iP*nTemp_;
+
+            try { gasEnthalpy_[i] = RawComponent::gasEnthalpy(temperature, pressure); }
+            catch (const std::exception&) { gasEnthalpy_[i] = NaN; }
+
+            try { gasHeatCapacity_[i] = RawComponent::gasHeatCapacity(temperature, pressure); }
+            catch (const std::exception&) { gasHeatCapacity_[i] = NaN; }
+
+            try { gasDensity_[i] = RawComponent::gasDensity(temperature, pressure); }
+            catch (const std::exception&) { gasDensity_[i] = NaN; }
+
+            try { gasViscosity_[i] = RawComponent::gasViscosity(temperature, pressure); }
+            catch (const std::exception&) { gasViscosity_[i] = NaN; }
+
+            try { gasThermalConductivity_[i] = RawComponent::gasThermalConductivity(temperature, pressure); }
+            catch (const std::exception&) { gasThermalConductivity_[i] = NaN; }
+        };
+
+        Scalar plMin = minLiquidPressure_(iT);
+        Scalar plMax = maxLiquidPressure_(iT);
+        for (unsigned iP = 0; iP < nPress_; ++ iP) {
+            Scalar pressure = iP * (plMax - plMin)/(nPress_ - 1) + plMin;
+
+            unsigned i = iT + iP*nTemp_;
+
+            try { liquidEnthalpy_[i] = RawComponent::liquidEnthalpy(temperature, pressure); }
+            catch (const std::exception&) { liquidEnthalpy_[i] = NaN; }
+
+            try { liquidHeatCapacity_[i] = RawComponent::liquidHeatCapacity(temperature, pressure); }
+            catch (const std::exception&) { liquidHeatCapacity_[i] = NaN; }
+
+            try { liquidDensity_[i] = RawComponent::liquidDensity(temperature, pressure); }
+            catch (const std::exception&) { liquidDensity_[i] = NaN; }
+
+            try { liquidViscosity_[i] = RawComponent::liquidViscosity(temperature, pressure); }
+            catch (const std::exception&) { liquidViscosity_[i] = NaN; }
+
+            try { liquidThermalConductivity_[i] = RawComponent::liquidThermalConductivity(temperature, pressure); }
+            catch (const std::exception&) { liquidThermalConductivity_[i] = NaN; }
+        }
+
+        // calculate the minimum and maximum values for the gas
+        // densities
+        minGasDensity__[iT] = RawComponent::gasDensity(temperature, minGasPressure_(iT));
+        if (iT < nTemp_ - 1)
+            maxGasDensity__[iT] = RawComponent::gasDensity(temperature, maxGasPressure_(iT + 1));
+        else
+            maxGasDensity__[iT] = RawComponent::gasDensity(temperature, maxGasPressure_(iT));
+
+        // fill the temperature, density gas arrays
+        for (unsigned iRho = 0; iRho < nDensity_; ++ iRho) {
+            Scalar density =
+                Scalar(iRho)/(nDensity_ - 1) *
+                (maxGasDensity__[iT] - minGasDensity__[iT])
+                +
+                minGasDensity__[iT];
+
+            unsigned i = iT + iRho*nTemp_;
+
+            try { gasPressure_[i] = RawComponent::gasPressure(temperature, density); }
+            catch (const std::exception&) { gasPressure_[i] = NaN; };
+        };
+
+        // calculate the minimum and maximum values for the liquid
+        // densities
+        minLiquidDensity__[iT] = RawComponent::liquidDensity(temperature, minLiquidPressure_(iT));
+        if (iT < nTemp_ - 1)
+            maxLiquidDensity__[iT] = RawComponent::liquidDensity(temperature, maxLiquidPressure_(iT + 1));
+        else
+            maxLiquidDensity__[iT] = RawComponent::liquidDensity(temperature, maxLiquidPressure_(iT));
+
+        // fill the temperature, density liquid arrays
+        for (unsigned iRho = 0; iRho < nDensity_; ++ iRho) {
+            Scalar density =
+                Scalar(iRho)/(nDensity_ - 1) *
+                (maxLiquidDensity__[iT] - minLiquidDensity__[iT])
+                +
+                minLiquidDensity__[iT];
+
+            unsigned i = iT + iRho*nTemp_;
+
+            try { liquidPressure_[i] = RawComponent::liquidPressure(temperature, density); }
+            catch (const std::exception&) { liquidPressure_[i] = NaN; };
+        };
+    }
+
+    static bool isLiquid_(unsigned quantity)
+    { return quantity == liquidEnthalpyQuantity_ || quantity == liquidDensityQuantity_; }
+
+    // returns the quantity which is tabulated by an inverse table. for the gas
+    // density, this is density/pressure (see inverseLookup_()).
+    static Scalar rawQuantity_(unsigned quantity, Scalar T, Scalar p)
+    {
+        switch (quantity) {
+        case liquidEnthalpyQuantity_: return RawComponent::liquidEnthalpy(T, p);
+        case gasEnthalpyQuantity_: return RawComponent::gasEnthalpy(T, p);
+        case liquidDensityQuantity_: return RawComponent::liquidDensity(T, p);
+        default: return RawComponent::gasDensity(T, p)/p;
+        }
+    }
+
+    template <class Evaluation>
+    static Evaluation tabulatedQuantity_(unsigned quantity, const Evaluation& T, const Evaluation& p)
+    {
+        switch (quantity) {
+        case liquidEnthalpyQuantity_: return liquidEnthalpy(T, p);
+        case gasEnthalpyQuantity_: return gasEnthalpy(T, p);
+        case liquidDensityQuantity_: return liquidDensity(T, p);
+        default: return gasDensity(T, p);
+        }
+    }
+
+    static Scalar inversePressureAt_(unsigned iP)
+    { return iP * (pressMax_ - pressMin_)/(nPress_ - 1) + pressMin_; }
+
+    // fill the entries of all inverse tables for a given pressure index
+    static void tabulateInversePressure_(unsigned iP)
+    {
+        for (unsigned quantity = 0; quantity < numInverseQuantities_; ++quantity)
+            tabulateInverse_(quantity, iP);
+    }
+
+    // fill the temperatures of an inverse table for a given pressure index. the
+    // quantity is sampled at the temperatures of the other tables and the largest
+    // range of temperatures in which it is strictly monotonous is inverted. like for
+    // the other tables, only temperatures at which the phase is not too far from
+    // being stable are considered if the vapor pressure is used.
+    static void tabulateInverse_(unsigned quantity, unsigned iP)
+    {
+        Scalar NaN = NaN_();
+        Scalar pressure = inversePressureAt_(iP);
+        bool isLiquid = isLiquid_(quantity);
+
+        std::vector<Scalar> samples(nTemp_);
+        for (unsigned iT = 0; iT < nTemp_; ++ iT) {
+            Scalar pv = vaporPressure_[iT];
+            if (useVaporPressure && !std::isnan(pv)
+                && (isLiquid?(pressure < pv/1.1):(pressure > pv*1.1)))
+            {
+                samples[iT] = NaN;
+                continue;
+            }
+
+            try { samples[iT] = rawQuantity_(quantity, temperatureAt_(iT), pressure); }
+            catch (const std::exception&) { samples[iT] = NaN; }
+        }
+
+        // find the longest range [beginIdx, endIdx) of valid samples in which the
+        // quantity is strictly monotonous
+        unsigned beginIdx = 0, endIdx = 0;
+        unsigned curBeginIdx = 0;
+        for (unsigned iT = 0; iT < nTemp_; ++ iT) {
+            if (std::isnan(samples[iT])) {
+                curBeginIdx = iT + 1;
+                continue;
+            }
+
+            if (iT > curBeginIdx + 1) {
+                Scalar dPrev = samples[iT - 1] - samples[iT - 2];
+                Scalar d = samples[iT] - samples[iT - 1];
+                if (!(d*dPrev > 0))
+                    curBeginIdx = iT - 1;
+            }
+            if (iT > curBeginIdx && samples[iT] == samples[iT - 1])
+                curBeginIdx = iT;
+
+            if (iT + 1 - curBeginIdx > endIdx - beginIdx) {
+                beginIdx = curBeginIdx;
+                endIdx = iT + 1;
+            }
+        }
+
+        InverseTable_& table = inverseTables_[quantity];
+        if (endIdx - beginIdx < 2) {
+            table.firstValue[iP] = NaN;
+            table.lastValue[iP] = NaN;
+            for (unsigned k = 0; k < nTemp_; ++ k)
+                table.temperatures[iP + k*nPress_] = NaN;
+            return;
+        }
+
+        Scalar firstValue = samples[beginIdx];
+        Scalar lastValue = samples[endIdx - 1];
+        table.firstValue[iP] = firstValue;
+        table.lastValue[iP] = lastValue;
+
+        unsigned iT = beginIdx;
+        for (unsigned k = 0; k < nTemp_; ++ k) {
+            Scalar value = firstValue + (lastValue - firstValue)*k/(nTemp_ - 1);
+
+            // find the sampled interval which contains the value. since the values are
+            // monotonous, it can only move to higher temperatures.
+            while (iT + 2 < endIdx
+                   && (samples[iT + 1] - value)*(lastValue - firstValue) < 0)
+                ++ iT;
+
+            // interpolate the temperature linearly and improve it using the secant
+            // method on the raw component
+            Scalar T0 = temperatureAt_(iT);
+            Scalar T1 = temperatureAt_(iT + 1);
+            Scalar f0 = samples[iT] - value;
+            Scalar f1 = samples[iT + 1] - value;
+            Scalar T = T0 - f0*(T1 - T0)/(f1 - f0);
+            for (int i = 0; i < 2 && T0 != T1; ++i) {
+                Scalar f;
+                try { f = rawQuantity_(quantity, T, pressure) - value; }
+                catch (const std::exception&) { break; }
+
+                if (f == 0 || !(std::abs(f - f1) > 0))
+                    break;
+
+                T0 = T1;
+                T1 = T;
+                f0 = f1;
+                f1 = f;
+                T = T1 - f1*(T1 - T0)/(f1 - f0);
+            }
+
+            table.temperatures[iP + k*nPress_] = T;
+        }
+    }
+
+    // compute the slopes of the cubic Hermite splines. the slopes are stored in units
+    // of the table entries per index, i.e., the spacing of the sampling points is one.
+    static void computeSlopes_()
+    {
+        if (!useCubicInterpolation)
+            return;
+
+        vaporPressureSlopes_.resize(nTemp_);
+        for (unsigned iT = 0; iT < nTemp_; ++ iT)
+            vaporPressureSlopes_[iT] = sampleSlope_(vaporPressure_, iT, 1, nTemp_);
+
+        computePressureSlopes_(gasEnthalpySlopes_, gasEnthalpy_);
+        computePressureSlopes_(liquidEnthalpySlopes_, liquidEnthalpy_);
+        computePressureSlopes_(gasHeatCapacitySlopes_, gasHeatCapacity_);
+        computePressureSlopes_(liquidHeatCapacitySlopes_, liquidHeatCapacity_);
+        computePressureSlopes_(gasDensitySlopes_, gasDensity_);
+        computePressureSlopes_(liquidDensitySlopes_, liquidDensity_);
+        computePressureSlopes_(gasViscositySlopes_, gasViscosity_);
+        computePressureSlopes_(liquidViscositySlopes_, liquidViscosity_);
+        computePressureSlopes_(gasThermalConductivitySlopes_, gasThermalConductivity_);
+        computePressureSlopes_(liquidThermalConductivitySlopes_, liquidThermalConductivity_);
+    }
+
+    // compute the slopes of a temperature-pressure table along the pressure axis
+    static void computePressureSlopes_(std::vector<Scalar>& slopes, const std::vector<Scalar>& values)
+    {
+        slopes.resize(values.size());
+        for (unsigned iT = 0; iT < nTemp_; ++ iT)
+            for (unsigned iP = 0; iP < nPress_; ++ iP)
+                slopes[iT + iP*nTemp_] = sampleSlope_(values, iT + iP*nTemp_, nTemp_, nPress_);
+    }
+
+    // returns the slope at the sampling point with index i of a table, given the
+    // stride between the entries of the axis and the number of sampling points on the
+    // axis
+    static Scalar sampleSlope_(const std::vector<Scalar>& values, unsigned i, unsigned stride, unsigned n)
+    {
+        unsigned k = (i/stride) % n; // position on the axis
+        Scalar d[4] = { NaN_(), NaN_(), NaN_(), NaN_() };
+        if (k > 1)
+            d[0] = values[i - stride] - values[i - 2*stride];
+        if (k > 0)
+            d[1] = values[i] - values[i - stride];
+        if (k + 1 < n)
+            d[2] = values[i + stride] - values[i];
+        if (k + 2 < n)
+            d[3] = values[i + 2*stride] - values[i + stride];
+
+        return monotoneSlope_(d[0], d[1], d[2], d[3]);
+    }
+
+    static Scalar NaN_()
+    { return std::numeric_limits<Scalar>::quiet_NaN(); }
+
+    // returns the slope at a sampling point given the differences between the values
+    // of its neighbors. dLeft and dRight are the differences to the adjacent points,
+    // dLeft2 and dRight2 the ones between the adjacent points and the next ones. NaN
+    // indicates a missing point. in the interior, the harmonic mean of Fritsch and
+    // Butland is used, which is zero at local extrema and thus does not cause
+    // overshoots. at the boundaries, the three-point formula is limited like by
+    // Fritsch and Carlson.
+    template <class Evaluation>
+    static Evaluation monotoneSlope_(const Evaluation& dLeft2,
+                                     const Evaluation& dLeft,
+                                     const Evaluation& dRight,
+                                     const Evaluation& dRight2)
+    {
+        typedef MathToolbox<Evaluation> Toolbox;
+
+        Scalar l = Toolbox::value(dLeft);
+        Scalar r = Toolbox::value(dRight);
+        if (std::isnan(l) && std::isnan(r))
+            return Toolbox::createConstant(0.0);
+        else if (std::isnan(l))
+            return boundarySlope_(dRight, dRight2);
+        else if (std::isnan(r))
+            return boundarySlope_(dLeft, dLeft2);
+        else if (l*r <= 0)
+            return Toolbox::createConstant(0.0);
+
+        return 2*dLeft*dRight/(dLeft + dRight);
+    }
+
+    // returns the slope at the boundary given the difference d to the adjacent
+    // point and the difference dNext between that point and the next one
+    template <class Evaluation>
+    static Evaluation boundarySlope_(const Evaluation& d, const Evaluation& dNext)
+    {
+        typedef MathToolbox<Evaluation> Toolbox;
+
+        Scalar a = Toolbox::value(d);
+        Scalar b = Toolbox::value(dNext);
+        if (std::isnan(b))
+            return d;
+
+        const Evaluation& m = (3*d - dNext)/2;
+        Scalar mValue = Toolbox::value(m);
+        if (mValue*a <= 0)
+            return Toolbox::createConstant(0.0);
+        else if (a*b <= 0 && std::abs(mValue) > 3*std::abs(a))
+            return 3*d;
+        return m;
+    }
+
+    // evaluates the cubic Hermite polynomial for the values y0 and y1 and the slopes
+    // m0 and m1 at the positions 0 and 1
+    template <class Evaluation, class ValueType>
+    static Evaluation hermite_(const Evaluation& alpha,
+                               const ValueType& y0,
+                               const ValueType& y1,
+                               const ValueType& m0,
+                               const ValueType& m1)
+    {
+        const Evaluation& alpha2 = alpha*alpha;
+        const Evaluation& alpha3 = alpha2*alpha;
+
+        return
+            (2*alpha3 - 3*alpha2 + 1)*y0
+            + (alpha3 - 2*alpha2 + alpha)*m0
+            + (3*alpha2 - 2*alpha3)*y1
+            + (alpha3 - alpha2)*m1;
+    }
+
+    // returns the string which identifies the tables in a cache file. besides the
+    // ranges, it contains a few values of the raw component to detect changes of its
+    // parameters.
+    static std::string cacheKey_()
+    {
+        Scalar T = (tempMin_ + tempMax_)/2;
+        Scalar p = (pressMin_ + pressMax_)/2;
+        Scalar fingerprint[5];
+        try { fingerprint[0] = RawComponent::vaporPressure(T); }
+        catch (const std::exception&) { fingerprint[0] = 0.0; }
+        try { fingerprint[1] = RawComponent::gasDensity(T, p); }
+        catch (const std::exception&) { fingerprint[1] = 0.0; }
+        try { fingerprint[2] = RawComponent::gasEnthalpy(T, p); }
+        catch (const std::exception&) { fingerprint[2] = 0.0; }
+        try { fingerprint[3] = RawComponent::liquidDensity(T, p); }
+        catch (const std::exception&) { fingerprint[3] = 0.0; }
+        try { fingerprint[4] = RawComponent::liquidEnthalpy(T, p); }
+        catch (const std::exception&) { fingerprint[4] = 0.0; }
+
+        std::ostringstream oss;
+        oss.precision(std::numeric_limits<Scalar>::max_digits10);
+        oss << "OPM TabulatedComponent 2\n"
+            << RawComponent::name() << "\n"
+            << "sizeof(Scalar)=" << sizeof(Scalar)
+            << " useVaporPressure=" << useVaporPressure << "\n"
+            << "T=[" << tempMin_ << ", " << tempMax_ << "] nTemp=" << nTemp_ << "\n"
+            << "p=[" << pressMin_ << ", " << pressMax_ << "] nPress=" << nPress_ << "\n";
+        for (unsigned i = 0; i < 5; ++i)
+            oss << fingerprint[i] << "\n";
+        return oss.str();
+    }
+
+    // read the tables from a cache file. returns false if the file does not exist or
+    // if it was written for a different key.
+    static bool readCache_(const std::string& fileName, const std::string& key)
+    {
+        allocate_();
+        return readTableCacheFile(fileName, key, tables_());
+    }
+
+    static void writeCache_(const std::string& fileName, const std::string& key)
+    { writeTableCacheFile(fileName, key, tables_()); }
+
     // returns an interpolated value depending on temperature
     template <class Evaluation>
-    static Evaluation interpolateT_(const Scalar *values, const Evaluation& T)
+    static Evaluation interpolateT_(const std::vector<Scalar>& values,
+                                    const std::vector<Scalar>& slopes,
+                                    const Evaluation& T)
     {
         typedef Opm::MathToolbox<Evaluation> Toolbox;
 
@@ -550,6 +1217,9 @@ private:
         unsigned iT = (unsigned) Toolbox::value(alphaT);
         alphaT -= iT;
 
+        if (useCubicInterpolation)
+            return hermite_(alphaT, values[iT], values[iT + 1], slopes[iT], slopes[iT + 1]);
+
         return
             values[iT    ]*(1 - alphaT) +
             values[iT + 1]*(    alphaT);
@@ -558,10 +1228,16 @@ private:
     // returns an interpolated value for liquid depending on
     // temperature and pressure
     template <class Evaluation>
-    static Evaluation interpolateLiquidTP_(const Scalar *values, const Evaluation& T, const Evaluation& p)
+    static Evaluation interpolateLiquidTP_(const std::vector<Scalar>& values,
+                                           const std::vector<Scalar>& slopes,
+                                           const Evaluation& T,
+                                           const Evaluation& p)
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
+        if (useCubicInterpolation)
+            return interpolateCubicTP_(values, slopes, T, p, /*isLiquid=*/true);
+
         Evaluation alphaT = tempIdx_(T);
         if (alphaT < 0 || alphaT >= nTemp_ - 1) {
             return Toolbox::createConstant(std::numeric_limits<Scalar>::quiet_NaN());
@@ -609,10 +1285,16 @@ private:
     // returns an interpolated value for gas depending on
     // temperature and pressure
     template <class Evaluation>
-    static Evaluation interpolateGasTP_(const Scalar *values, const Evaluation& T, const Evaluation& p)
+    static Evaluation interpolateGasTP_(const std::vector<Scalar>& values,
+                                           const std::vector<Scalar>& slopes,
+                                           const Evaluation& T,
+                                           const Evaluation& p)
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
+        if (useCubicInterpolation)
+            return interpolateCubicTP_(values, slopes, T, p, /*isLiquid=*/false);
+
         Evaluation alphaT = tempIdx_(T);
         if (alphaT < 0 || alphaT >= nTemp_ - 1) {
             return Toolbox::createConstant(std::numeric_limits<Scalar>::quiet_NaN());
@@ -655,10 +1337,93 @@ private:
             values[(iT + 1) + (iP2 + 1)*nTemp_]*(    alphaT)*(    alphaP2);
     }
 
+    // returns a value depending on temperature and pressure which is interpolated
+    // using cubic Hermite splines. for each of the four temperatures around T, the
+    // table is interpolated along the pressure axis and the resulting values are
+    // then interpolated along the temperature axis.
+    template <class Evaluation>
+    static Evaluation interpolateCubicTP_(const std::vector<Scalar>& values,
+                                          const std::vector<Scalar>& slopes,
+                                          const Evaluation& T,
+                                          const Evaluation& p,
+                                          bool isLiquid)
+    {
+        typedef MathToolbox<Evaluation> Toolbox;
+
+        Evaluation alphaT = tempIdx_(T);
+        if (alphaT < 0 || alphaT >= nTemp_ - 1)
+            return Toolbox::createConstant(NaN_());
+
+        unsigned iT = std::min<unsigned>(nTemp_ - 2, static_cast<unsigned>(Toolbox::value(alphaT)));
+        alphaT -= iT;
+
+        // the values at the temperatures iT - 1, iT, iT + 1 and iT + 2. the outer ones
+        // are only used to determine the slopes along the temperature axis and only if
+        // the pressure is within their tabulated range.
+        Evaluation y[4];
+        bool valid[4];
+        for (int k = 0; k < 4; ++k) {
+            int jT = static_cast<int>(iT) + k - 1;
+            valid[k] = false;
+            if (jT < 0 || jT >= static_cast<int>(nTemp_))
+                continue;
+
+            const Evaluation& alphaP =
+                isLiquid
+                ? pressLiquidIdx_(p, static_cast<unsigned>(jT))
+                : pressGasIdx_(p, static_cast<unsigned>(jT));
+            bool isInner = (k == 1 || k == 2);
+            Scalar alphaPValue = Toolbox::value(alphaP);
+            if (!isInner && !(0 <= alphaPValue && alphaPValue <= nPress_ - 1))
+                continue;
+
+            y[k] = interpolateCubicP_(values, slopes, static_cast<unsigned>(jT), alphaP);
+            valid[k] = !std::isnan(Toolbox::value(y[k]));
+        }
+
+        if (!valid[1] || !valid[2])
+            return Toolbox::createConstant(NaN_());
+
+        const Evaluation& NaN = Toolbox::createConstant(NaN_());
+        const Evaluation& dLeft = valid[0]?Evaluation(y[1] - y[0]):NaN;
+        const Evaluation& d = y[2] - y[1];
+        const Evaluation& dRight = valid[3]?Evaluation(y[3] - y[2]):NaN;
+
+        return hermite_(alphaT,
+                        y[1],
+                        y[2],
+                        monotoneSlope_(NaN, dLeft, d, dRight),
+                        monotoneSlope_(dLeft, d, dRight, NaN));
+    }
+
+    // returns the value at a given temperature index which is interpolated along the
+    // pressure axis. outside of the tabulated range, the value is extrapolated linearly.
+    template <class Evaluation>
+    static Evaluation interpolateCubicP_(const std::vector<Scalar>& values,
+                                         const std::vector<Scalar>& slopes,
+                                         unsigned iT,
+                                         Evaluation alphaP)
+    {
+        typedef MathToolbox<Evaluation> Toolbox;
+
+        Scalar alphaPValue = Toolbox::value(alphaP);
+        unsigned iP = 0;
+        if (alphaPValue > 0)
+            iP = std::min<unsigned>(nPress_ - 2, static_cast<unsigned>(alphaPValue));
+        alphaP -= iP;
+
+        unsigned i0 = iT + iP*nTemp_;
+        unsigned i1 = i0 + nTemp_;
+        if (alphaPValue < iP || alphaPValue > iP + 1)
+            return values[i0] + (values[i1] - values[i0])*alphaP;
+
+        return hermite_(alphaP, values[i0], values[i1], slopes[i0], slopes[i1]);
+    }
+
     // returns an interpolated value for gas depending on
     // temperature and density
     template <class Evaluation>
-    static Evaluation interpolateGasTRho_(const Scalar *values, const Evaluation& T, const Evaluation& rho)
+    static Evaluation interpolateGasTRho_(const std::vector<Scalar>& values, const Evaluation& T, const Evaluation& rho)
     {
         Evaluation alphaT = tempIdx_(T);
         unsigned iT = std::max<int>(0, std::min<int>(nTemp_ - 2, (int) alphaT));
@@ -681,7 +1446,7 @@ private:
     // returns an interpolated value for liquid depending on
     // temperature and density
     template <class Evaluation>
-    static Evaluation interpolateLiquidTRho_(const Scalar *values, const Evaluation& T, const Evaluation& rho)
+    static Evaluation interpolateLiquidTRho_(const std::vector<Scalar>& values, const Evaluation& T, const Evaluation& rho)
     {
         Evaluation alphaT = tempIdx_(T);
         unsigned iT = std::max<int>(0, std::min<int>(nTemp_ - 2, (int) alphaT));
@@ -809,35 +1574,51 @@ private:
     { return maxGasDensity__[tempIdx]; }
 
     // 1D fields with the temperature as degree of freedom
-    static Scalar *vaporPressure_;
+    static std::vector<Scalar> vaporPressure_;
+    static std::vector<Scalar> vaporPressureSlopes_;
 
-    static Scalar *minLiquidDensity__;
-    static Scalar *maxLiquidDensity__;
+    static std::vector<Scalar> minLiquidDensity__;
+    static std::vector<Scalar> maxLiquidDensity__;
 
-    static Scalar *minGasDensity__;
-    static Scalar *maxGasDensity__;
+    static std::vector<Scalar> minGasDensity__;
+    static std::vector<Scalar> maxGasDensity__;
 
     // 2D fields with the temperature and pressure as degrees of
     // freedom
-    static Scalar *gasEnthalpy_;
-    static Scalar *liquidEnthalpy_;
-
-    static Scalar *gasHeatCapacity_;
-    static Scalar *liquidHeatCapacity_;
-
-    static Scalar *gasDensity_;
-    static Scalar *liquidDensity_;
-
-    static Scalar *gasViscosity_;
-    static Scalar *liquidViscosity_;
-
-    static Scalar *gasThermalConductivity_;
-    static Scalar *liquidThermalConductivity_;
+    static std::vector<Scalar> gasEnthalpy_;
+    static std::vector<Scalar> liquidEnthalpy_;
+
+    static std::vector<Scalar> gasHeatCapacity_;
+    static std::vector<Scalar> liquidHeatCapacity_;
+
+    static std::vector<Scalar> gasDensity_;
+    static std::vector<Scalar> liquidDensity_;
+
+    static std::vector<Scalar> gasViscosity_;
+    static std::vector<Scalar> liquidViscosity_;
+
+    static std::vector<Scalar> gasThermalConductivity_;
+    static std::vector<Scalar> liquidThermalConductivity_;
+
+    // slopes of the 2D fields along the pressure axis for cubic
+    // interpolation
+    static std::vector<Scalar> gasEnthalpySlopes_;
+    static std::vector<Scalar> liquidEnthalpySlopes_;
+    static std::vector<Scalar> gasHeatCapacitySlopes_;
+    static std::vector<Scalar> liquidHeatCapacitySlopes_;
+    static std::vector<Scalar> gasDensitySlopes_;
+    static std::vector<Scalar> liquidDensitySlopes_;
+    static std::vector<Scalar> gasViscositySlopes_;
+    static std::vector<Scalar> liquidViscositySlopes_;
+    static std::vector<Scalar> gasThermalConductivitySlopes_;
+    static std::vector<Scalar> liquidThermalConductivitySlopes_;
 
     // 2D fields with the temperature and density as degrees of
     // freedom
-    static Scalar *gasPressure_;
-    static Scalar *liquidPressure_;
+    static std::vector<Scalar> gasPressure_;
+    static std::vector<Scalar> liquidPressure_;
+
+    static InverseTable_ inverseTables_[numInverseQuantities_];
 
     // temperature, pressure and density ranges
     static Scalar tempMin_;
@@ -853,58 +1634,83 @@ private:
     static unsigned nDensity_;
 };
 
-template <class Scalar, class RawComponent, bool useVaporPressure>
-Scalar* TabulatedComponent<Scalar, RawComponent, useVaporPressure>::vaporPressure_;
-template <class Scalar, class RawComponent, bool useVaporPressure>
-Scalar* TabulatedComponent<Scalar, RawComponent, useVaporPressure>::minLiquidDensity__;
-template <class Scalar, class RawComponent, bool useVaporPressure>
-Scalar* TabulatedComponent<Scalar, RawComponent, useVaporPressure>::maxLiquidDensity__;
-template <class Scalar, class RawComponent, bool useVaporPressure>
-Scalar* TabulatedComponent<Scalar, RawComponent, useVaporPressure>::minGasDensity__;
-template <class Scalar, class RawComponent, bool useVaporPressure>
-Scalar* TabulatedComponent<Scalar, RawComponent, useVaporPressure>::maxGasDensity__;
-template <class Scalar, class RawComponent, bool useVaporPressure>
-Scalar* TabulatedComponent<Scalar, RawComponent, useVaporPressure>::gasEnthalpy_;
-template <class Scalar, class RawComponent, bool useVaporPressure>
-Scalar* TabulatedComponent<Scalar, RawComponent, useVaporPressure>::liquidEnthalpy_;
-template <class Scalar, class RawComponent, bool useVaporPressure>
-Scalar* TabulatedComponent<Scalar, RawComponent, useVaporPressure>::gasHeatCapacity_;
-template <class Scalar, class RawComponent, bool useVaporPressure>
-Scalar* TabulatedComponent<Scalar, RawComponent, useVaporPressure>::liquidHeatCapacity_;
-template <class Scalar, class RawComponent, bool useVaporPressure>
-Scalar* TabulatedComponent<Scalar, RawComponent, useVaporPressure>::gasDensity_;
-template <class Scalar, class RawComponent, bool useVaporPressure>
-Scalar* TabulatedComponent<Scalar, RawComponent, useVaporPressure>::liquidDensity_;
-template <class Scalar, class RawComponent, bool useVaporPressure>
-Scalar* TabulatedComponent<Scalar, RawComponent, useVaporPressure>::gasViscosity_;
-template <class Scalar, class RawComponent, bool useVaporPressure>
-Scalar* TabulatedComponent<Scalar, RawComponent, useVaporPressure>::liquidViscosity_;
-template <class Scalar, class RawComponent, bool useVaporPressure>
-Scalar* TabulatedComponent<Scalar, RawComponent, useVaporPressure>::gasThermalConductivity_;
-template <class Scalar, class RawComponent, bool useVaporPressure>
-Scalar* TabulatedComponent<Scalar, RawComponent, useVaporPressure>::liquidThermalConductivity_;
-template <class Scalar, class RawComponent, bool useVaporPressure>
-Scalar* TabulatedComponent<Scalar, RawComponent, useVaporPressure>::gasPressure_;
-template <class Scalar, class RawComponent, bool useVaporPressure>
-Scalar* TabulatedComponent<Scalar, RawComponent, useVaporPressure>::liquidPressure_;
-template <class Scalar, class RawComponent, bool useVaporPressure>
-Scalar TabulatedComponent<Scalar, RawComponent, useVaporPressure>::tempMin_;
-template <class Scalar, class RawComponent, bool useVaporPressure>
-Scalar TabulatedComponent<Scalar, RawComponent, useVaporPressure>::tempMax_;
-template <class Scalar, class RawComponent, bool useVaporPressure>
-unsigned TabulatedComponent<Scalar, RawComponent, useVaporPressure>::nTemp_;
-template <class Scalar, class RawComponent, bool useVaporPressure>
-Scalar TabulatedComponent<Scalar, RawComponent, useVaporPressure>::pressMin_;
-template <class Scalar, class RawComponent, bool useVaporPressure>
-Scalar TabulatedComponent<Scalar, RawComponent, useVaporPressure>::pressMax_;
-template <class Scalar, class RawComponent, bool useVaporPressure>
-unsigned TabulatedComponent<Scalar, RawComponent, useVaporPressure>::nPress_;
-template <class Scalar, class RawComponent, bool useVaporPressure>
-Scalar TabulatedComponent<Scalar, RawComponent, useVaporPressure>::densityMin_;
-template <class Scalar, class RawComponent, bool useVaporPressure>
-Scalar TabulatedComponent<Scalar, RawComponent, useVaporPressure>::densityMax_;
-template <class Scalar, class RawComponent, bool useVaporPressure>
-unsigned TabulatedComponent<Scalar, RawComponent, useVaporPressure>::nDensity_;
+template <class Scalar, class RawComponent, bool useVaporPressure, bool useCubicInterpolation>
+std::vector<Scalar> TabulatedComponent<Scalar, RawComponent, useVaporPressure, useCubicInterpolation>::vaporPressure_;
+template <class Scalar, class RawComponent, bool useVaporPressure, bool useCubicInterpolation>
+std::vector<Scalar> TabulatedComponent<Scalar, RawComponent, useVaporPressure, useCubicInterpolation>::minLiquidDensity__;
+template <class Scalar, class RawComponent, bool useVaporPressure, bool useCubicInterpolation>
+std::vector<Scalar> TabulatedComponent<Scalar, RawComponent, useVaporPressure, useCubicInterpolation>::maxLiquidDensity__;
+template <class Scalar, class RawComponent, bool useVaporPressure, bool useCubicInterpolation>
+std::vector<Scalar> TabulatedComponent<Scalar, RawComponent, useVaporPressure, useCubicInterpolation>::minGasDensity__;
+template <class Scalar, class RawComponent, bool useVaporPressure, bool useCubicInterpolation>
+std::vector<Scalar> TabulatedComponent<Scalar, RawComponent, useVaporPressure, useCubicInterpolation>::maxGasDensity__;
+template <class Scalar, class RawComponent, bool useVaporPressure, bool useCubicInterpolation>
+std::vector<Scalar> TabulatedComponent<Scalar, RawComponent, useVaporPressure, useCubicInterpolation>::gasEnthalpy_;
+template <class Scalar, class RawComponent, bool useVaporPressure, bool useCubicInterpolation>
+std::vector<Scalar> TabulatedComponent<Scalar, RawComponent, useVaporPressure, useCubicInterpolation>::liquidEnthalpy_;
+template <class Scalar, class RawComponent, bool useVaporPressure, bool useCubicInterpolation>
+std::vector<Scalar> TabulatedComponent<Scalar, RawComponent, useVaporPressure, useCubicInterpolation>::gasHeatCapacity_;
+template <class Scalar, class RawComponent, bool useVaporPressure, bool useCubicInterpolation>
+std::vector<Scalar> TabulatedComponent<Scalar, RawComponent, useVaporPressure, useCubicInterpolation>::liquidHeatCapacity_;
+template <class Scalar, class RawComponent, bool useVaporPressure, bool useCubicInterpolation>
+std::vector<Scalar> TabulatedComponent<Scalar, RawComponent, useVaporPressure, useCubicInterpolation>::gasDensity_;
+template <class Scalar, class RawComponent, bool useVaporPressure, bool useCubicInterpolation>
+std::vector<Scalar> TabulatedComponent<Scalar, RawComponent, useVaporPressure, useCubicInterpolation>::liquidDensity_;
+template <class Scalar, class RawComponent, bool useVaporPressure, bool useCubicInterpolation>
+std::vector<Scalar> TabulatedComponent<Scalar, RawComponent, useVaporPressure, useCubicInterpolation>::gasViscosity_;
+template <class Scalar, class RawComponent, bool useVaporPressure, bool useCubicInterpolation>
+std::vector<Scalar> TabulatedComponent<Scalar, RawComponent, useVaporPressure, useCubicInterpolation>::liquidViscosity_;
+template <class Scalar, class RawComponent, bool useVaporPressure, bool useCubicInterpolation>
+std::vector<Scalar> TabulatedComponent<Scalar, RawComponent, useVaporPressure, useCubicInterpolation>::gasThermalConductivity_;
+template <class Scalar, class RawComponent, bool useVaporPressure, bool useCubicInterpolation>
+std::vector<Scalar> TabulatedComponent<Scalar, RawComponent, useVaporPressure, useCubicInterpolation>::liquidThermalConductivity_;
+template <class Scalar, class RawComponent, bool useVaporPressure, bool useCubicInterpolation>
+std::vector<Scalar> TabulatedComponent<Scalar, RawComponent, useVaporPressure, useCubicInterpolation>::gasPressure_;
+template <class Scalar, class RawComponent, bool useVaporPressure, bool useCubicInterpolation>
+std::vector<Scalar> TabulatedComponent<Scalar, RawComponent, useVaporPressure, useCubicInterpolation>::liquidPressure_;
+template <class Scalar, class RawComponent, bool useVaporPressure, bool useCubicInterpolation>
+std::vector<Scalar> TabulatedComponent<Scalar, RawComponent, useVaporPressure, useCubicInterpolation>::vaporPressureSlopes_;
+template <class Scalar, class RawComponent, bool useVaporPressure, bool useCubicInterpolation>
+std::vector<Scalar> TabulatedComponent<Scalar, RawComponent, useVaporPressure, useCubicInterpolation>::gasEnthalpySlopes_;
+template <class Scalar, class RawComponent, bool useVaporPressure, bool useCubicInterpolation>
+std::vector<Scalar> TabulatedComponent<Scalar, RawComponent, useVaporPressure, useCubicInterpolation>::liquidEnthalpySlopes_;
+template <class Scalar, class RawComponent, bool useVaporPressure, bool useCubicInterpolation>
+std::vector<Scalar> TabulatedComponent<Scalar, RawComponent, useVaporPressure, useCubicInterpolation>::gasHeatCapacitySlopes_;
+template <class Scalar, class RawComponent, bool useVaporPressure, bool useCubicInterpolation>
+std::vector<Scalar> TabulatedComponent<Scalar, RawComponent, useVaporPressure, useCubicInterpolation>::liquidHeatCapacitySlopes_;
+template <class Scalar, class RawComponent, bool useVaporPressure, bool useCubicInterpolation>
+std::vector<Scalar> TabulatedComponent<Scalar, RawComponent, useVaporPressure, useCubicInterpolation>::gasDensitySlopes_;
+template <class Scalar, class RawComponent, bool useVaporPressure, bool useCubicInterpolation>
+std::vector<Scalar> TabulatedComponent<Scalar, RawComponent, useVaporPressure, useCubicInterpolation>::liquidDensitySlopes_;
+template <class Scalar, class RawComponent, bool useVaporPressure, bool useCubicInterpolation>
+std::vector<Scalar> TabulatedComponent<Scalar, RawComponent, useVaporPressure, useCubicInterpolation>::gasViscositySlopes_;
+template <class Scalar, class RawComponent, bool useVaporPressure, bool useCubicInterpolation>
+std::vector<Scalar> TabulatedComponent<Scalar, RawComponent, useVaporPressure, useCubicInterpolation>::liquidViscositySlopes_;
+template <class Scalar, class RawComponent, bool useVaporPressure, bool useCubicInterpolation>
+std::vector<Scalar> TabulatedComponent<Scalar, RawComponent, useVaporPressure, useCubicInterpolation>::gasThermalConductivitySlopes_;
+template <class Scalar, class RawComponent, bool useVaporPressure, bool useCubicInterpolation>
+std::vector<Scalar> TabulatedComponent<Scalar, RawComponent, useVaporPressure, useCubicInterpolation>::liquidThermalConductivitySlopes_;
+template <class Scalar, class RawComponent, bool useVaporPressure, bool useCubicInterpolation>
+typename TabulatedComponent<Scalar, RawComponent, useVaporPressure, useCubicInterpolation>::InverseTable_
+TabulatedComponent<Scalar, RawComponent, useVaporPressure, useCubicInterpolation>::inverseTables_[TabulatedComponent<Scalar, RawComponent, useVaporPressure, useCubicInterpolation>::numInverseQuantities_];
+template <class Scalar, class RawComponent, bool useVaporPressure, bool useCubicInterpolation>
+Scalar TabulatedComponent<Scalar, RawComponent, useVaporPressure, useCubicInterpolation>::tempMin_;
+template <class Scalar, class RawComponent, bool useVaporPressure, bool useCubicInterpolation>
+Scalar TabulatedComponent<Scalar, RawComponent, useVaporPressure, useCubicInterpolation>::tempMax_;
+template <class Scalar, class RawComponent, bool useVaporPressure, bool useCubicInterpolation>
+unsigned TabulatedComponent<Scalar, RawComponent, useVaporPressure, useCubicInterpolation>::nTemp_;
+template <class Scalar, class RawComponent, bool useVaporPressure, bool useCubicInterpolation>
+Scalar TabulatedComponent<Scalar, RawComponent, useVaporPressure, useCubicInterpolation>::pressMin_;
+template <class Scalar, class RawComponent, bool useVaporPressure, bool useCubicInterpolation>
+Scalar TabulatedComponent<Scalar, RawComponent, useVaporPressure, useCubicInterpolation>::pressMax_;
+template <class Scalar, class RawComponent, bool useVaporPressure, bool useCubicInterpolation>
+unsigned TabulatedComponent<Scalar, RawComponent, useVaporPressure, useCubicInterpolation>::nPress_;
+template <class Scalar, class RawComponent, bool useVaporPressure, bool useCubicInterpolation>
+Scalar TabulatedComponent<Scalar, RawComponent, useVaporPressure, useCubicInterpolation>::densityMin_;
+template <class Scalar, class RawComponent, bool useVaporPressure, bool useCubicInterpolation>
+Scalar TabulatedComponent<Scalar, RawComponent, useVaporPressure, useCubicInterpolation>::densityMax_;
+template <class Scalar, class RawComponent, bool useVaporPressure, bool useCubicInterpolation>
+unsigned TabulatedComponent<Scalar, RawComponent, useVaporPressure, useCubicInterpolation>::nDensity_;
 
 
 } // namespace Opm
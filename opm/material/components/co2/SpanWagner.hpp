@@ -0,0 +1,370 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::SpanWagner
+ */
+#ifndef OPM_SPAN_WAGNER_HPP
+#define OPM_SPAN_WAGNER_HPP
+
+#include <opm/common/Exceptions.hpp>
+#include <opm/common/ErrorMacros.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Opm {
+
+/*!
+ * \brief The reference equation of state for carbon dioxide by Span and Wagner.
+ *
+ * The equation is formulated in terms of the Helmholtz energy as a function of
+ * temperature and density. It is valid from the triple point temperature up to
+ * 1100 K and for pressures up to 800 MPa. Since it is much too expensive to be
+ * evaluated during a simulation, it is only used to generate the tables of the CO2
+ * component (see GeneratedCO2Tables).
+ *
+ * The enthalpy is zero for the ideal gas at 298.15 K and 101.325 kPa.
+ *
+ * See:
+ *
+ * R. Span and W. Wagner: A New Equation of State for Carbon Dioxide Covering the
+ * Fluid Region from the Triple-Point Temperature to 1100 K at Pressures up to
+ * 800 MPa. Journal of Physical and Chemical Reference Data, 25 (6),
+ * pp. 1509-1596, 1996
+ *
+ * \tparam Scalar The type used for scalar values
+ */
+template <class Scalar>
+class SpanWagner
+{
+public:
+    /*!
+     * \brief The critical temperature of CO2 \f$\mathrm{[K]}\f$.
+     */
+    static Scalar criticalTemperature()
+    { return 304.1282; }
+
+    /*!
+     * \brief The critical pressure of CO2 \f$\mathrm{[Pa]}\f$.
+     */
+    static Scalar criticalPressure()
+    { return 7.3773e6; }
+
+    /*!
+     * \brief The critical density of CO2 \f$\mathrm{[kg/m^3]}\f$.
+     */
+    static Scalar criticalDensity()
+    { return 467.6; }
+
+    /*!
+     * \brief The specific gas constant of CO2 \f$\mathrm{[J/(kg K)]}\f$.
+     */
+    static Scalar specificGasConstant()
+    { return 188.9241; }
+
+    /*!
+     * \brief The vapor pressure of CO2 \f$\mathrm{[Pa]}\f$ according to the
+     *        auxiliary equation of Span and Wagner.
+     *
+     * \param T The temperature \f$\mathrm{[K]}\f$. It must be below the critical
+     *          temperature.
+     */
+    static Scalar vaporPressure(Scalar T)
+    {
+        static const Scalar a[4] = { -7.0602087, 1.9391218, -1.6463597, -3.2995634 };
+        static const Scalar t[4] = { 1.0, 1.5, 2.0, 4.0 };
+
+        Scalar theta = 1 - T/criticalTemperature();
+        Scalar sum = 0;
+        for (int i = 0; i < 4; ++i)
+            sum += a[i]*std::pow(theta, t[i]);
+        return criticalPressure()*std::exp(criticalTemperature()/T*sum);
+    }
+
+    /*!
+     * \brief The density of the saturated liquid \f$\mathrm{[kg/m^3]}\f$ according to
+     *        the auxiliary equation of Span and Wagner.
+     *
+     * \param T The temperature \f$\mathrm{[K]}\f$. It must be below the critical
+     *          temperature.
+     */
+    static Scalar saturatedLiquidDensity(Scalar T)
+    {
+        static const Scalar a[4] = { 1.9245108, -0.62385555, -0.32731127, 0.39245142 };
+        static const Scalar t[4] = { 0.34, 1.0/2, 10.0/6, 11.0/6 };
+
+        Scalar theta = 1 - T/criticalTemperature();
+        Scalar sum = 0;
+        for (int i = 0; i < 4; ++i)
+            sum += a[i]*std::pow(theta, t[i]);
+        return criticalDensity()*std::exp(sum);
+    }
+
+    /*!
+     * \brief The density of the saturated vapor \f$\mathrm{[kg/m^3]}\f$ according to
+     *        the auxiliary equation of Span and Wagner.
+     *
+     * \param T The temperature \f$\mathrm{[K]}\f$. It must be below the critical
+     *          temperature.
+     */
+    static Scalar saturatedVaporDensity(Scalar T)
+    {
+        static const Scalar a[5] = { -1.7074879, -0.82274670, -4.6008549, -10.111178, -29.742252 };
+        static const Scalar t[5] = { 0.340, 1.0/2, 1.0, 7.0/3, 14.0/3 };
+
+        Scalar theta = 1 - T/criticalTemperature();
+        Scalar sum = 0;
+        for (int i = 0; i < 5; ++i)
+            sum += a[i]*std::pow(theta, t[i]);
+        return criticalDensity()*std::exp(sum);
+    }
+
+    /*!
+     * \brief The pressure \f$\mathrm{[Pa]}\f$ given temperature and density.
+     *
+     * \param T The temperature \f$\mathrm{[K]}\f$
+     * \param rho The density \f$\mathrm{[kg/m^3]}\f$
+     */
+    static Scalar pressure(Scalar T, Scalar rho)
+    {
+        Scalar phirDelta, phirTau;
+        residualDerivatives_(phirDelta, phirTau, criticalTemperature()/T, rho/criticalDensity());
+        return rho*specificGasConstant()*T*(1 + rho/criticalDensity()*phirDelta);
+    }
+
+    /*!
+     * \brief The specific enthalpy \f$\mathrm{[J/kg]}\f$ given temperature and density.
+     *
+     * \param T The temperature \f$\mathrm{[K]}\f$
+     * \param rho The density \f$\mathrm{[kg/m^3]}\f$
+     */
+    static Scalar enthalpy(Scalar T, Scalar rho)
+    {
+        Scalar tau = criticalTemperature()/T;
+        Scalar delta = rho/criticalDensity();
+
+        Scalar phirDelta, phirTau;
+        residualDerivatives_(phirDelta, phirTau, tau, delta);
+        return specificGasConstant()*T*(1 + tau*(idealTauDerivative_(tau) + phirTau) + delta*phirDelta);
+    }
+
+    /*!
+     * \brief The density \f$\mathrm{[kg/m^3]}\f$ of the stable phase given
+     *        temperature and pressure.
+     *
+     * Below the critical temperature, the phase is liquid if the pressure is above the
+     * vapor pressure and vapor otherwise.
+     *
+     * \param T The temperature \f$\mathrm{[K]}\f$
+     * \param p The pressure \f$\mathrm{[Pa]}\f$
+     */
+    static Scalar density(Scalar T, Scalar p)
+    {
+        // bracket the density. below the critical temperature, the bracket excludes
+        // the densities of the other phase: the stable vapor is less dense than the
+        // saturated vapor, the stable liquid is denser than the saturated liquid. the
+        // auxiliary equations are only approximately consistent with the equation of
+        // state, so the brackets are widened a little.
+        Scalar rhoLow = 0;
+        Scalar rhoHigh = 2000;
+        if (T < criticalTemperature()) {
+            if (p < vaporPressure(T))
+                rhoHigh = saturatedVaporDensity(T)*1.02;
+            else
+                rhoLow = saturatedLiquidDensity(T)*0.98;
+        }
+
+        Scalar fLow = -p;
+        if (rhoLow > 0)
+            fLow = pressure(T, rhoLow) - p;
+        Scalar fHigh = pressure(T, rhoHigh) - p;
+        if (!(fLow <= 0 && fHigh >= 0))
+            OPM_THROW(NumericalProblem,
+                      "Could not bracket the density of CO2 at T=" << T << ", p=" << p);
+
+        // regula falsi with the Illinois modification. the first guess is the ideal
+        // gas for vapors and the saturated liquid for liquids.
+        Scalar tolerance = 10*std::numeric_limits<Scalar>::epsilon();
+        Scalar rho = std::min(p/(specificGasConstant()*T), rhoHigh);
+        if (rhoLow > 0)
+            rho = rhoLow;
+        int side = 0;
+        for (int i = 0; i < 200; ++i) {
+            Scalar f = pressure(T, rho) - p;
+            if (f == 0 || rhoHigh - rhoLow < tolerance*rho)
+                return rho;
+
+            if (f < 0) {
+                rhoLow = rho;
+                fLow = f;
+                if (side == -1)
+                    fHigh /= 2;
+                side = -1;
+            }
+            else {
+                rhoHigh = rho;
+                fHigh = f;
+                if (side == 1)
+                    fLow /= 2;
+                side = 1;
+            }
+
+            Scalar newRho = rhoLow - fLow*(rhoHigh - rhoLow)/(fHigh - fLow);
+            if (std::abs(newRho - rho) < tolerance*rho)
+                return newRho;
+            rho = newRho;
+        }
+
+        OPM_THROW(NumericalProblem,
+                  "Could not determine the density of CO2 at T=" << T << ", p=" << p);
+    }
+
+private:
+    // the derivative of the ideal gas part of the reduced Helmholtz energy with
+    // regard to the inverse reduced temperature
+    static Scalar idealTauDerivative_(Scalar tau)
+    {
+        static const Scalar a[8] =
+            { 8.37304456, -3.70454304, 2.5,
+              1.99427042, 0.62105248, 0.41195293, 1.04028922, 0.08327678 };
+        static const Scalar theta[8] =
+            { 0.0, 0.0, 0.0,
+              3.15163, 6.11190, 6.77708, 11.32384, 27.08792 };
+
+        Scalar result = a[1] + a[2]/tau;
+        for (int i = 3; i < 8; ++i)
+            result += a[i]*theta[i]*(1/(1 - std::exp(-theta[i]*tau)) - 1);
+        return result;
+    }
+
+    // the derivatives of the residual part of the reduced Helmholtz energy with regard
+    // to the reduced density and the inverse reduced temperature
+    static void residualDerivatives_(Scalar& phirDelta, Scalar& phirTau, Scalar tau, Scalar delta)
+    {
+        // polynomial and exponential terms: n*delta^d*tau^t*exp(-delta^c)
+        static const Scalar n[34] = {
+            0.38856823203161, 2.9385475942740, -5.5867188534934, -0.76753199592477,
+            0.31729005580416, 0.54803315897767, 0.12279411220335,
+
+            2.1658961543220, 1.5841735109724, -0.23132705405503, 0.058116916431436,
+            -0.55369137205382, 0.48946615909422, -0.024275739843501, 0.062494790501678,
+            -0.12175860225246, -0.37055685270086, -0.016775879700426, -0.11960736637987,
+            -0.045619362508778, 0.035612789270346, -0.0074427727132052, -0.0017395704902432,
+            -0.021810121289527, 0.024332166559236, -0.037440133423463, 0.14338715756878,
+            -0.13491969083286, -0.023151225053480, 0.012363125492901, 0.0021058321972940,
+            -0.00033958519026368, 0.0055993651771592, -0.00030335118055646
+        };
+        static const int d[34] = {
+            1, 1, 1, 1, 2, 2, 3,
+            1, 2, 4, 5, 5, 5, 6, 6, 6, 1, 1, 4, 4, 4, 7, 8, 2, 3, 3, 5, 5, 6, 7, 8, 10, 4, 8
+        };
+        static const Scalar t[34] = {
+            0.00, 0.75, 1.00, 2.00, 0.75, 2.00, 0.75,
+            1.50, 1.50, 2.50, 0.00, 1.50, 2.00, 0.00, 1.00, 2.00, 3.00, 6.00, 3.00, 6.00,
+            8.00, 6.00, 0.00, 7.00, 12.00, 16.00, 22.00, 24.00, 16.00, 24.00, 8.00, 2.00,
+            28.00, 14.00
+        };
+        static const int c[34] = {
+            0, 0, 0, 0, 0, 0, 0,
+            1, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 4, 4, 4, 4, 4, 4, 5, 6
+        };
+
+        // gaussian bell-shaped terms: n*delta^d*tau^t*exp(-alpha*(delta - eps)^2 -
+        // beta*(tau - gamma)^2)
+        static const Scalar nGauss[5] = {
+            -213.65488688320, 26641.569149272, -24027.212204557, -283.41603423999, 212.47284400179
+        };
+        static const int dGauss[5] = { 2, 2, 2, 3, 3 };
+        static const Scalar tGauss[5] = { 1.0, 0.0, 1.0, 3.0, 3.0 };
+        static const Scalar alphaGauss[5] = { 25, 25, 25, 15, 20 };
+        static const Scalar betaGauss[5] = { 325, 300, 300, 275, 275 };
+        static const Scalar gammaGauss[5] = { 1.16, 1.19, 1.19, 1.25, 1.22 };
+
+        // non-analytic terms for the critical region: n*Delta^b*delta*psi
+        static const Scalar nNa[3] = { -0.66642276540751, 0.72608632349897, 0.055068668612842 };
+        static const Scalar aNa[3] = { 3.5, 3.5, 3.0 };
+        static const Scalar bNa[3] = { 0.875, 0.925, 0.875 };
+        static const Scalar betaNa[3] = { 0.3, 0.3, 0.3 };
+        static const Scalar ANa[3] = { 0.7, 0.7, 0.7 };
+        static const Scalar BNa[3] = { 0.3, 0.3, 1.0 };
+        static const Scalar CNa[3] = { 10.0, 10.0, 12.5 };
+        static const Scalar DNa[3] = { 275, 275, 275 };
+
+        phirDelta = 0;
+        phirTau = 0;
+
+        for (int i = 0; i < 34; ++i) {
+            Scalar term = n[i]*std::pow(delta, d[i])*std::pow(tau, t[i]);
+            Scalar deltaC = 0;
+            if (c[i] > 0) {
+                deltaC = std::pow(delta, c[i]);
+                term *= std::exp(-deltaC);
+            }
+
+            phirDelta += term*(d[i] - c[i]*deltaC)/delta;
+            phirTau += term*t[i]/tau;
+        }
+
+        for (int i = 0; i < 5; ++i) {
+            Scalar dDelta = delta - 1;
+            Scalar dTau = tau - gammaGauss[i];
+            Scalar term =
+                nGauss[i]*std::pow(delta, dGauss[i])*std::pow(tau, tGauss[i])
+                *std::exp(-alphaGauss[i]*dDelta*dDelta - betaGauss[i]*dTau*dTau);
+
+            phirDelta += term*(dGauss[i]/delta - 2*alphaGauss[i]*dDelta);
+            phirTau += term*(tGauss[i]/tau - 2*betaGauss[i]*dTau);
+        }
+
+        for (int i = 0; i < 3; ++i) {
+            Scalar dDelta = delta - 1;
+            Scalar dDelta2 = dDelta*dDelta;
+            Scalar dTau = tau - 1;
+
+            Scalar theta = (1 - tau) + ANa[i]*std::pow(dDelta2, 1/(2*betaNa[i]));
+            Scalar Delta = theta*theta + BNa[i]*std::pow(dDelta2, aNa[i]);
+            Scalar psi = std::exp(-CNa[i]*dDelta2 - DNa[i]*dTau*dTau);
+            if (Delta <= 0) {
+                // delta = tau = 1, i.e., at the critical point the term and its first
+                // derivatives vanish
+                continue;
+            }
+
+            Scalar DeltaB = std::pow(Delta, bNa[i]);
+            Scalar DeltaDelta =
+                dDelta*(ANa[i]*theta*2/betaNa[i]*std::pow(dDelta2, 1/(2*betaNa[i]) - 1)
+                        + 2*BNa[i]*aNa[i]*std::pow(dDelta2, aNa[i] - 1));
+            Scalar DeltaBDelta = bNa[i]*DeltaB/Delta*DeltaDelta;
+            Scalar DeltaBTau = -2*theta*bNa[i]*DeltaB/Delta;
+
+            phirDelta += nNa[i]*(DeltaB*(psi - 2*CNa[i]*dDelta*delta*psi) + DeltaBDelta*delta*psi);
+            phirTau += nNa[i]*delta*(DeltaBTau*psi - 2*DNa[i]*dTau*DeltaB*psi);
+        }
+    }
+};
+
+} // namespace Opm
+
+#endif
@@ -30,6 +30,7 @@
 #include <opm/material/Constants.hpp>
 #include <opm/material/common/MathToolbox.hpp>
 
+#include <cassert>
 #include <cmath>
 
 namespace Opm {
@@ -81,6 +82,35 @@ public:
     //! Triple pressure of water \f$\mathrm{[Pa]}\f$
     static const Scalar triplePressure;
 
+    /*!
+     * \brief Computes a range of integer powers of a quantity.
+     *
+     * The powers \f$x^k\f$ for \f$k_{min} \leq k \leq k_{max}\f$ are stored in
+     * result[k - kMin]. They are obtained by successive multiplication, which is much
+     * cheaper than calling pow() for each term of the polynomials of the IAPWS
+     * formulation.
+     *
+     * \param result Array of size kMax - kMin + 1 into which the powers are written
+     * \param x The quantity of interest
+     * \param kMin The smallest exponent. It must not be positive.
+     * \param kMax The largest exponent. It must not be negative.
+     */
+    static void integerPowers(Scalar *result, Scalar x, int kMin, int kMax)
+    {
+        assert(kMin <= 0 && 0 <= kMax);
+
+        Scalar *pow0 = result - kMin;
+        pow0[0] = 1.0;
+        for (int k = 1; k <= kMax; ++k)
+            pow0[k] = pow0[k - 1]*x;
+
+        if (kMin < 0) {
+            Scalar xInv = 1/x;
+            for (int k = -1; k >= kMin; --k)
+                pow0[k] = pow0[k + 1]*xInv;
+        }
+    }
+
     /*!
      * \brief The dynamic viscosity \f$\mathrm{[(N/m^2)*s]}\f$of pure water.
      *
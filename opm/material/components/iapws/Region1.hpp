@@ -27,9 +27,12 @@
 #ifndef OPM_IAPWS_REGION1_HPP
 #define OPM_IAPWS_REGION1_HPP
 
+#include "Common.hpp"
+
 #include <opm/material/common/MathToolbox.hpp>
 
 #include <cmath>
+#include <type_traits>
 
 namespace Opm {
 namespace IAPWS {
@@ -137,20 +140,9 @@ public:
     template <class Evaluation>
     static Evaluation gamma(const Evaluation& temperature, const Evaluation& pressure)
     {
-        typedef MathToolbox<Evaluation> Toolbox;
-
-        const Evaluation tau_ = tau(temperature);   /* reduced temperature */
-        const Evaluation pi_ = pi(pressure);    /* reduced pressure */
-
-        Evaluation result = 0;
-        for (int i = 0; i < 34; ++i) {
-            result += n(i)*Toolbox::pow(7.1 - pi_, I(i))*Toolbox::pow(tau_ - 1.222, J(i));
-        }
-
-        return result;
+        return series_(temperature, pressure, /*piOrder=*/0, /*tauOrder=*/0);
     }
 
-
     /*!
      * \brief The partial derivative of the Gibbs free energy to the
      *        normalized temperature for IAPWS region 1 (i.e. liquid) (dimensionless).
@@ -165,21 +157,7 @@ public:
     template <class Evaluation>
     static Evaluation dgamma_dtau(const Evaluation& temperature, const Evaluation& pressure)
     {
-        typedef MathToolbox<Evaluation> Toolbox;
-
-        const Evaluation tau_ = tau(temperature);   /* reduced temperature */
-        const Evaluation pi_ = pi(pressure);    /* reduced pressure */
-
-        Evaluation result = Toolbox::createConstant(0.0);
-        for (int i = 0; i < 34; i++) {
-            result +=
-                n(i) *
-                Toolbox::pow(7.1 - pi_, static_cast<Scalar>(I(i))) *
-                Toolbox::pow(tau_ - 1.222,  static_cast<Scalar>(J(i)-1)) *
-                J(i);
-        }
-
-        return result;
+        return series_(temperature, pressure, /*piOrder=*/0, /*tauOrder=*/1);
     }
 
     /*!
@@ -196,21 +174,7 @@ public:
     template <class Evaluation>
     static Evaluation dgamma_dpi(const Evaluation& temperature, const Evaluation& pressure)
     {
-        typedef MathToolbox<Evaluation> Toolbox;
-
-        const Evaluation tau_ = tau(temperature);   /* reduced temperature */
-        const Evaluation pi_ = pi(pressure);    /* reduced pressure */
-
-        Evaluation result = Toolbox::createConstant(0.0);
-        for (int i = 0; i < 34; i++) {
-            result +=
-                -n(i) *
-                I(i) *
-                Toolbox::pow(7.1 - pi_, static_cast<Scalar>(I(i) - 1)) *
-                Toolbox::pow(tau_ - 1.222, static_cast<Scalar>(J(i)));
-        }
-
-        return result;
+        return series_(temperature, pressure, /*piOrder=*/1, /*tauOrder=*/0);
     }
 
     /*!
@@ -228,22 +192,7 @@ public:
     template <class Evaluation>
     static Evaluation ddgamma_dtaudpi(const Evaluation& temperature, const Evaluation& pressure)
     {
-        typedef MathToolbox<Evaluation> Toolbox;
-
-        const Evaluation tau_ = tau(temperature);   /* reduced temperature */
-        const Evaluation pi_ = pi(pressure);    /* reduced pressure */
-
-        Evaluation result = Toolbox::createConstant(0.0);
-        for (int i = 0; i < 34; i++) {
-            result +=
-                -n(i) *
-                I(i) *
-                J(i) *
-                Toolbox::pow(7.1 - pi_, static_cast<Scalar>(I(i) - 1)) *
-                Toolbox::pow(tau_ - 1.222, static_cast<Scalar>(J(i) - 1));
-        }
-
-        return result;
+        return series_(temperature, pressure, /*piOrder=*/1, /*tauOrder=*/1);
     }
 
     /*!
@@ -261,22 +210,7 @@ public:
     template <class Evaluation>
     static Evaluation ddgamma_ddpi(const Evaluation& temperature, const Evaluation& pressure)
     {
-        typedef MathToolbox<Evaluation> Toolbox;
-
-        const Evaluation tau_ = tau(temperature);   /* reduced temperature */
-        const Evaluation pi_ = pi(pressure);    /* reduced pressure */
-
-        Evaluation result = Toolbox::createConstant(0.0);
-        for (int i = 0; i < 34; i++) {
-            result +=
-                n(i) *
-                I(i) *
-                (I(i) - 1) *
-                Toolbox::pow(7.1 - pi_, I(i) - 2) *
-                Toolbox::pow(tau_ - 1.222, J(i));
-        }
-
-        return result;
+        return series_(temperature, pressure, /*piOrder=*/2, /*tauOrder=*/0);
     }
 
     /*!
@@ -292,26 +226,95 @@ public:
      */
     template <class Evaluation>
     static Evaluation ddgamma_ddtau(const Evaluation& temperature, const Evaluation& pressure)
+    {
+        return series_(temperature, pressure, /*piOrder=*/0, /*tauOrder=*/2);
+    }
+
+private:
+    // the range of exponents of the polynomial terms in (7.1 - pi) and (tau - 1.222),
+    // including the ones of the second derivatives and of their first derivatives
+    enum { minPiExp = -3, maxPiExp = 32 };
+    enum { minTauExp = -44, maxTauExp = 17 };
+
+    // evaluate the derivative of the polynomial for the Gibbs free energy of the
+    // given orders with regard to the reduced pressure and temperature. the
+    // polynomial is evaluated for scalars and the derivatives of the result are then
+    // obtained using the chain rule, so no arithmetic on function evaluations is
+    // required for the individual terms.
+    template <class Evaluation>
+    static Evaluation series_(const Evaluation& temperature,
+                              const Evaluation& pressure,
+                              int piOrder,
+                              int tauOrder)
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
-        const Evaluation tau_ = tau(temperature);   /* reduced temperature */
-        const Evaluation pi_ = pi(pressure);    /* reduced pressure */
-
-        Evaluation result = Toolbox::createConstant(0.0);
-        for (int i = 0; i < 34; i++) {
-            result +=
-                n(i) *
-                Toolbox::pow(7.1 - pi_, I(i)) *
-                J(i) *
-                (J(i) - 1) *
-                Toolbox::pow(tau_ - 1.222,  J(i) - 2);
+        if (std::is_same<Evaluation, Scalar>::value)
+            return scalarSeries_(Toolbox::value(tau(temperature)),
+                                 Toolbox::value(pi(pressure)),
+                                 piOrder,
+                                 tauOrder);
+
+        const Evaluation& tau_ = tau(temperature);
+        const Evaluation& pi_ = pi(pressure);
+        Scalar tauValue = Toolbox::value(tau_);
+        Scalar piValue = Toolbox::value(pi_);
+
+        Scalar dS_dpi;
+        Scalar dS_dtau;
+        Scalar S = scalarSeries_(tauValue, piValue, piOrder, tauOrder, &dS_dpi, &dS_dtau);
+
+        return S + dS_dpi*(pi_ - piValue) + dS_dtau*(tau_ - tauValue);
+    }
+
+    // evaluate the derivative of the polynomial for scalars. if requested, the
+    // derivatives of the result with regard to pi and tau are computed as well.
+    // instead of calling pow() for each term, the powers of the bases are computed
+    // once.
+    static Scalar scalarSeries_(Scalar tau_,
+                                Scalar pi_,
+                                int piOrder,
+                                int tauOrder,
+                                Scalar* dS_dpi = 0,
+                                Scalar* dS_dtau = 0)
+    {
+        Scalar piPow[maxPiExp - minPiExp + 1];
+        Scalar tauPow[maxTauExp - minTauExp + 1];
+        Common<Scalar>::integerPowers(piPow, 7.1 - pi_, minPiExp, maxPiExp);
+        Common<Scalar>::integerPowers(tauPow, tau_ - 1.222, minTauExp, maxTauExp);
+
+        Scalar result = 0.0;
+        Scalar resultPi = 0.0;
+        Scalar resultTau = 0.0;
+        for (int i = 0; i < 34; ++i) {
+            // the derivatives of the powers. note that the derivative of (7.1 - pi)
+            // with regard to pi is -1.
+            Scalar factor = n(i);
+            for (int k = 0; k < piOrder; ++k)
+                factor *= -(I(i) - k);
+            for (int k = 0; k < tauOrder; ++k)
+                factor *= J(i) - k;
+            if (factor == 0.0)
+                continue;
+
+            int piIdx = static_cast<int>(I(i)) - piOrder - minPiExp;
+            int tauIdx = static_cast<int>(J(i)) - tauOrder - minTauExp;
+            result += factor*piPow[piIdx]*tauPow[tauIdx];
+
+            if (dS_dpi) {
+                resultPi -= factor*(I(i) - piOrder)*piPow[piIdx - 1]*tauPow[tauIdx];
+                resultTau += factor*(J(i) - tauOrder)*piPow[piIdx]*tauPow[tauIdx - 1];
+            }
+        }
+
+        if (dS_dpi) {
+            *dS_dpi = resultPi;
+            *dS_dtau = resultTau;
         }
 
         return result;
     }
 
-private:
     static Scalar n(int i)
     {
         static const Scalar n[34] = {
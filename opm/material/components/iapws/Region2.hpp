@@ -27,9 +27,12 @@
 #ifndef OPM_IAPWS_REGION2_HPP
 #define OPM_IAPWS_REGION2_HPP
 
+#include "Common.hpp"
+
 #include <opm/material/common/MathToolbox.hpp>
 
 #include <cmath>
+#include <type_traits>
 
 namespace Opm {
 namespace IAPWS {
@@ -137,23 +140,11 @@ public:
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
-        const Evaluation& tau_ = tau(temperature); /* reduced temperature */
-        const Evaluation& pi_ = pi(pressure);      /* reduced pressure */
-
-        Evaluation result;
-
-        // ideal gas part
-        result = Toolbox::ln(pi_);
-        for (int i = 0; i < 9; ++i)
-            result += n_g(i)*Toolbox::pow(tau_, J_g(i));
-
-        // residual part
-        for (int i = 0; i < 43; ++i)
-            result +=
-                n_r(i)*
-                Toolbox::pow(pi_, I_r(i))*
-                Toolbox::pow(tau_ - 0.5, J_r(i));
-        return result;
+        // ideal gas part and residual part
+        return
+            Toolbox::log(pi(pressure))
+            + idealGasSeries_(temperature, /*tauOrder=*/0)
+            + residualSeries_(temperature, pressure, /*piOrder=*/0, /*tauOrder=*/0);
     }
 
     /*!
@@ -171,30 +162,10 @@ public:
     template <class Evaluation>
     static Evaluation dgamma_dtau(const Evaluation& temperature, const Evaluation& pressure)
     {
-        typedef MathToolbox<Evaluation> Toolbox;
-
-        const Evaluation& tau_ = tau(temperature);   /* reduced temperature */
-        const Evaluation& pi_ = pi(pressure);    /* reduced pressure */
-
-        // ideal gas part
-        Evaluation result = Toolbox::createConstant(0.0);
-        for (int i = 0; i < 9; i++) {
-            result +=
-                n_g(i) *
-                J_g(i) *
-                Toolbox::pow(tau_, static_cast<Scalar>(J_g(i) - 1));
-        }
-
-        // residual part
-        for (int i = 0; i < 43; i++) {
-            result +=
-                n_r(i) *
-                Toolbox::pow(pi_,  static_cast<Scalar>(I_r(i))) *
-                J_r(i) *
-                Toolbox::pow(tau_ - 0.5, static_cast<Scalar>(J_r(i) - 1));
-        }
-
-        return result;
+        // ideal gas part and residual part
+        return
+            idealGasSeries_(temperature, /*tauOrder=*/1)
+            + residualSeries_(temperature, pressure, /*piOrder=*/0, /*tauOrder=*/1);
     }
 
     /*!
@@ -212,24 +183,10 @@ public:
     template <class Evaluation>
     static Evaluation dgamma_dpi(const Evaluation& temperature, const Evaluation& pressure)
     {
-        typedef MathToolbox<Evaluation> Toolbox;
-
-        const Evaluation& tau_ = tau(temperature);   /* reduced temperature */
-        const Evaluation& pi_ = pi(pressure);    /* reduced pressure */
-
-        // ideal gas part
-        Evaluation result = 1/pi_;
-
-        // residual part
-        for (int i = 0; i < 43; i++) {
-            result +=
-                n_r(i) *
-                I_r(i) *
-                Toolbox::pow(pi_, static_cast<Scalar>(I_r(i) - 1)) *
-                Toolbox::pow(tau_ - 0.5, static_cast<Scalar>(J_r(i)));
-        }
-
-        return result;
+        // ideal gas part and residual part
+        return
+            1/pi(pressure)
+            + residualSeries_(temperature, pressure, /*piOrder=*/1, /*tauOrder=*/0);
     }
 
     /*!
@@ -247,25 +204,8 @@ public:
     template <class Evaluation>
     static Evaluation ddgamma_dtaudpi(const Evaluation& temperature, const Evaluation& pressure)
     {
-        typedef MathToolbox<Evaluation> Toolbox;
-
-        const Evaluation& tau_ = tau(temperature);   /* reduced temperature */
-        const Evaluation& pi_ = pi(pressure);    /* reduced pressure */
-
-        // ideal gas part
-        Evaluation result = Toolbox::createConstant(0.0);
-
-        // residual part
-        for (int i = 0; i < 43; i++) {
-            result +=
-                n_r(i) *
-                I_r(i) *
-                J_r(i) *
-                Toolbox::pow(pi_, static_cast<Scalar>(I_r(i) - 1)) *
-                Toolbox::pow(tau_ - 0.5, static_cast<Scalar>(J_r(i) - 1));
-        }
-
-        return result;
+        // the ideal gas part is zero
+        return residualSeries_(temperature, pressure, /*piOrder=*/1, /*tauOrder=*/1);
     }
 
     /*!
@@ -283,25 +223,12 @@ public:
     template <class Evaluation>
     static Evaluation ddgamma_ddpi(const Evaluation& temperature, const Evaluation& pressure)
     {
-        typedef MathToolbox<Evaluation> Toolbox;
-
-        const Evaluation& tau_ = tau(temperature);   /* reduced temperature */
-        const Evaluation& pi_ = pi(pressure);    /* reduced pressure */
-
-        // ideal gas part
-        Evaluation result = -1/(pi_*pi_);
-
-        // residual part
-        for (int i = 0; i < 43; i++) {
-            result +=
-                n_r(i) *
-                I_r(i) *
-                (I_r(i) - 1) *
-                Toolbox::pow(pi_, static_cast<Scalar>(I_r(i) - 2)) *
-                Toolbox::pow(tau_ - 0.5, static_cast<Scalar>(J_r(i)));
-        }
+        const Evaluation& pi_ = pi(pressure);
 
-        return result;
+        // ideal gas part and residual part
+        return
+            -1/(pi_*pi_)
+            + residualSeries_(temperature, pressure, /*piOrder=*/2, /*tauOrder=*/0);
     }
 
     /*!
@@ -318,37 +245,143 @@ public:
      */
     template <class Evaluation>
     static Evaluation ddgamma_ddtau(const Evaluation& temperature, const Evaluation& pressure)
+    {
+        // ideal gas part and residual part
+        return
+            idealGasSeries_(temperature, /*tauOrder=*/2)
+            + residualSeries_(temperature, pressure, /*piOrder=*/0, /*tauOrder=*/2);
+    }
+
+
+private:
+    // the range of exponents of the polynomial terms in tau, pi and (tau - 0.5),
+    // including the ones of the second derivatives and of their first derivatives
+    enum { minIdealTauExp = -8, maxIdealTauExp = 3 };
+    enum { minPiExp = -2, maxPiExp = 24 };
+    enum { minTauExp = -3, maxTauExp = 58 };
+
+    // evaluate the derivative of the given order of the polynomial of the ideal gas
+    // part of the Gibbs free energy with regard to the reduced temperature. the
+    // polynomial is evaluated for scalars and the derivatives of the result are then
+    // obtained using the chain rule.
+    template <class Evaluation>
+    static Evaluation idealGasSeries_(const Evaluation& temperature, int tauOrder)
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
-        const Evaluation& tau_ = tau(temperature);   /* reduced temperature */
-        const Evaluation& pi_ = pi(pressure);    /* reduced pressure */
-
-        // ideal gas part
-        Evaluation result = Toolbox::createConstant(0.0);
-        for (int i = 0; i < 9; i++) {
-            result +=
-                n_g(i) *
-                J_g(i) *
-                (J_g(i) - 1) *
-                Toolbox::pow(tau_, static_cast<Scalar>(J_g(i) - 2));
-        }
+        if (std::is_same<Evaluation, Scalar>::value)
+            return scalarIdealGasSeries_(Toolbox::value(tau(temperature)), tauOrder);
+
+        const Evaluation& tau_ = tau(temperature);
+        Scalar tauValue = Toolbox::value(tau_);
+
+        Scalar dS_dtau;
+        Scalar S = scalarIdealGasSeries_(tauValue, tauOrder, &dS_dtau);
 
-        // residual part
-        for (int i = 0; i < 43; i++) {
-            result +=
-                n_r(i) *
-                Toolbox::pow(pi_,  I_r(i)) *
-                J_r(i) *
-                (J_r(i) - 1.) *
-                Toolbox::pow(tau_ - 0.5, static_cast<Scalar>(J_r(i) - 2));
+        return S + dS_dtau*(tau_ - tauValue);
+    }
+
+    static Scalar scalarIdealGasSeries_(Scalar tau_, int tauOrder, Scalar* dS_dtau = 0)
+    {
+        Scalar tauPow[maxIdealTauExp - minIdealTauExp + 1];
+        Common<Scalar>::integerPowers(tauPow, tau_, minIdealTauExp, maxIdealTauExp);
+
+        Scalar result = 0.0;
+        Scalar resultTau = 0.0;
+        for (int i = 0; i < 9; ++i) {
+            Scalar factor = n_g(i);
+            for (int k = 0; k < tauOrder; ++k)
+                factor *= J_g(i) - k;
+            if (factor == 0.0)
+                continue;
+
+            int tauIdx = static_cast<int>(J_g(i)) - tauOrder - minIdealTauExp;
+            result += factor*tauPow[tauIdx];
+            if (dS_dtau)
+                resultTau += factor*(J_g(i) - tauOrder)*tauPow[tauIdx - 1];
         }
 
+        if (dS_dtau)
+            *dS_dtau = resultTau;
+
         return result;
     }
 
+    // evaluate the derivative of the polynomial of the residual part of the Gibbs
+    // free energy of the given orders with regard to the reduced pressure and
+    // temperature. like for the ideal gas part, the polynomial is evaluated for
+    // scalars.
+    template <class Evaluation>
+    static Evaluation residualSeries_(const Evaluation& temperature,
+                                      const Evaluation& pressure,
+                                      int piOrder,
+                                      int tauOrder)
+    {
+        typedef MathToolbox<Evaluation> Toolbox;
+
+        if (std::is_same<Evaluation, Scalar>::value)
+            return scalarResidualSeries_(Toolbox::value(tau(temperature)),
+                                         Toolbox::value(pi(pressure)),
+                                         piOrder,
+                                         tauOrder);
+
+        const Evaluation& tau_ = tau(temperature);
+        const Evaluation& pi_ = pi(pressure);
+        Scalar tauValue = Toolbox::value(tau_);
+        Scalar piValue = Toolbox::value(pi_);
+
+        Scalar dS_dpi;
+        Scalar dS_dtau;
+        Scalar S = scalarResidualSeries_(tauValue, piValue, piOrder, tauOrder, &dS_dpi, &dS_dtau);
+
+        return S + dS_dpi*(pi_ - piValue) + dS_dtau*(tau_ - tauValue);
+    }
+
+    // instead of calling pow() for each term, the powers of the bases are computed
+    // once. if requested, the derivatives of the result with regard to pi and tau are
+    // computed as well.
+    static Scalar scalarResidualSeries_(Scalar tau_,
+                                        Scalar pi_,
+                                        int piOrder,
+                                        int tauOrder,
+                                        Scalar* dS_dpi = 0,
+                                        Scalar* dS_dtau = 0)
+    {
+        Scalar piPow[maxPiExp - minPiExp + 1];
+        Scalar tauPow[maxTauExp - minTauExp + 1];
+        Common<Scalar>::integerPowers(piPow, pi_, minPiExp, maxPiExp);
+        Common<Scalar>::integerPowers(tauPow, tau_ - 0.5, minTauExp, maxTauExp);
+
+        Scalar result = 0.0;
+        Scalar resultPi = 0.0;
+        Scalar resultTau = 0.0;
+        for (int i = 0; i < 43; ++i) {
+            Scalar factor = n_r(i);
+            for (int k = 0; k < piOrder; ++k)
+                factor *= I_r(i) - k;
+            for (int k = 0; k < tauOrder; ++k)
+                factor *= J_r(i) - k;
+            if (factor == 0.0)
+                continue;
+
+            int piIdx = static_cast<int>(I_r(i)) - piOrder - minPiExp;
+            int tauIdx = static_cast<int>(J_r(i)) - tauOrder - minTauExp;
+            result += factor*piPow[piIdx]*tauPow[tauIdx];
+
+            if (dS_dpi) {
+                resultPi += factor*(I_r(i) - piOrder)*piPow[piIdx - 1]*tauPow[tauIdx];
+                resultTau += factor*(J_r(i) - tauOrder)*piPow[piIdx]*tauPow[tauIdx - 1];
+            }
+        }
+
+        if (dS_dpi) {
+            *dS_dpi = resultPi;
+            *dS_dtau = resultTau;
+        }
+
+        return result;
+    }
 
-private:
     static Scalar n_g(int i)
     {
         static const Scalar n[9] = {
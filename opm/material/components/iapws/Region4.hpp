@@ -103,15 +103,16 @@ public:
             -0.48232657361591e4, 0.40511340542057e6, -0.23855557567849,
             0.65017534844798e3
         };
-        const Evaluation& beta = pow((pressure/1e6 /*from Pa to MPa*/), (1./4.));
-        const Evaluation& beta2 = pow(beta, 2.);
+        // the fourth root and the squares are computed without pow()
+        const Evaluation& beta2 = Toolbox::sqrt(pressure/1e6 /*from Pa to MPa*/);
+        const Evaluation& beta = Toolbox::sqrt(beta2);
         const Evaluation& E = beta2 + n[2] * beta + n[5];
         const Evaluation& F = n[0]*beta2 + n[3]*beta + n[6];
         const Evaluation& G = n[1]*beta2 + n[4]*beta + n[7];
 
-        const Evaluation& D = ( 2.*G)/(-F -Toolbox::sqrt(pow(F,2.) - 4.*E*G));
+        const Evaluation& D = ( 2.*G)/(-F -Toolbox::sqrt(F*F - 4.*E*G));
 
-        const Evaluation& temperature = (n[9] + D - Toolbox::sqrt(pow(n[9]+D , 2.) - 4.* (n[8] + n[9]*D)) ) * 0.5;
+        const Evaluation& temperature = (n[9] + D - Toolbox::sqrt((n[9] + D)*(n[9] + D) - 4.* (n[8] + n[9]*D)) ) * 0.5;
 
         return temperature;
     }
@@ -28,6 +28,10 @@
 #define OPM_COMPOSITION_FROM_FUGACITIES_HPP
 
 #include <opm/material/common/MathToolbox.hpp>
+#include <opm/material/common/FixedSizeLu.hpp>
+#include <opm/material/localad/Evaluation.hpp>
+#include <opm/material/localad/Math.hpp>
+#include <opm/material/fluidstates/CompositionalFluidState.hpp>
 
 
 #include <opm/common/utility/platform_dependent/disable_warnings.h>
@@ -43,6 +47,7 @@
 #include <opm/material/common/Valgrind.hpp>
 
 #include <limits>
+#include <type_traits>
 
 namespace Opm {
 
@@ -86,8 +91,22 @@ public:
      *        fugacities in a phase.
      *
      * The phase's fugacities must already be set.
+     *
+     * By default, the Jacobian matrix of the Newton method is approximated using
+     * forward differences, which requires numComponents + 1 evaluations of all
+     * fugacity coefficients per iteration. If \a useAdJacobian is true, the mole
+     * fractions are seeded as the variables of a local automatic differentiation
+     * evaluation instead, so the exact Jacobian is obtained by evaluating the
+     * fugacity coefficients only once. This requires the fluid system to support
+     * LocalAd::Evaluation objects as the Evaluation type of fugacityCoefficient() and
+     * its parameter cache to accept fluid states of this type. If the fluid system
+     * provides a parameter cache which stores its quantities as function evaluations
+     * (i.e., if it defines FluidSystem::EvaluationParameterCache<Evaluation>::type),
+     * this cache is used to compute the Jacobian. Otherwise, the Jacobian is only
+     * exact if the regular parameter cache does not store any quantities which depend
+     * on the composition.
      */
-    template <class FluidState>
+    template <bool useAdJacobian = false, class FluidState>
     static void solve(FluidState &fluidState,
                       ParameterCache &paramCache,
                       unsigned phaseIdx,
@@ -127,7 +146,8 @@ public:
         const int nMax = 25;
         for (int nIdx = 0; nIdx < nMax; ++nIdx) {
             // calculate Jacobian matrix and right hand side
-            linearize_(J, b, fluidState, paramCache, phaseIdx, targetFug);
+            linearize_(J, b, fluidState, paramCache, phaseIdx, targetFug,
+                       std::integral_constant<bool, useAdJacobian>());
             Valgrind::CheckDefined(J);
             Valgrind::CheckDefined(b);
 
@@ -142,11 +162,10 @@ public:
             std::cout << "\n";
             */
 
-            // Solve J*x = b
+            // Solve J*x = b. (this overwrites J and b.)
             x = Toolbox::createConstant(0.0);
-            try { J.solve(x, b); }
-            catch (Dune::FMatrixError e)
-            { throw Opm::NumericalProblem(e.what()); }
+            if (!solveFixedSizeLu(x, J, b, /*singularLimit=*/1e-20))
+                OPM_THROW(Opm::NumericalProblem, "Singular Jacobian matrix in composition calculation");
 
             //std::cout << "original delta: " << x << "\n";
 
@@ -225,7 +244,8 @@ protected:
                              FluidState &fluidState,
                              ParameterCache &paramCache,
                              unsigned phaseIdx,
-                             const ComponentVector &targetFug)
+                             const ComponentVector &targetFug,
+                             std::false_type /*useAdJacobian*/)
     {
         typedef MathToolbox<Evaluation> Toolbox;
 
@@ -293,6 +313,68 @@ protected:
         return absError;
     }
 
+    // the type of the parameter cache which is used to compute the Jacobian by means
+    // of automatic differentiation. (these methods are only used to select the type.)
+    template <class FS, class Eval>
+    static typename FS::template EvaluationParameterCache<Eval>::type adParameterCache_(int);
+
+    template <class FS, class Eval>
+    static typename FS::ParameterCache adParameterCache_(long);
+
+    // calculate the defect and its exact derivatives with regard to the mole fractions
+    // of all components by means of automatic differentiation
+    template <class FluidState>
+    static Scalar linearize_(Dune::FieldMatrix<Evaluation, numComponents, numComponents> &J,
+                             Dune::FieldVector<Evaluation, numComponents> &defect,
+                             FluidState &fluidState,
+                             const ParameterCache &/*paramCache*/,
+                             unsigned phaseIdx,
+                             const ComponentVector &targetFug,
+                             std::true_type /*useAdJacobian*/)
+    {
+        static_assert(std::is_same<Evaluation, Scalar>::value,
+                      "Jacobians obtained by automatic differentiation are only "
+                      "supported for scalar compositions");
+
+        typedef Opm::LocalAd::Evaluation<Scalar, CompositionFromFugacities, numComponents> AdEval;
+        typedef MathToolbox<AdEval> AdToolbox;
+        typedef Opm::CompositionalFluidState<AdEval, FluidSystem, /*storeEnthalpy=*/false> AdFluidState;
+
+        AdFluidState adFluidState;
+        adFluidState.setTemperature(fluidState.temperature(phaseIdx));
+        adFluidState.setPressure(phaseIdx, fluidState.pressure(phaseIdx));
+        for (unsigned i = 0; i < numComponents; ++ i)
+            adFluidState.setMoleFraction(phaseIdx, i,
+                                         AdToolbox::createVariable(fluidState.moleFraction(phaseIdx, i), i));
+
+        // the quantities of the parameter cache must carry the derivatives with regard
+        // to the mole fractions as well. the cache of the scalar fluid state is not
+        // modified.
+        typedef decltype(adParameterCache_<FluidSystem, AdEval>(0)) AdParameterCache;
+        AdParameterCache adParamCache;
+        adParamCache.updatePhase(adFluidState, phaseIdx);
+
+        Scalar absError = 0;
+        for (unsigned j = 0; j < numComponents; ++ j) {
+            const AdEval& phi =
+                FluidSystem::template fugacityCoefficient<AdFluidState, AdEval>(adFluidState,
+                                                                                adParamCache,
+                                                                                phaseIdx,
+                                                                                j);
+            const AdEval& f = phi*adFluidState.pressure(phaseIdx)*adFluidState.moleFraction(phaseIdx, j);
+            fluidState.setFugacityCoefficient(phaseIdx, j, phi.value);
+
+            defect[j] = targetFug[j] - f.value;
+            absError = std::max(absError, std::abs(defect[j]));
+
+            // the derivatives of the defect are the negative derivatives of the fugacity
+            for (unsigned i = 0; i < numComponents; ++ i)
+                J[j][i] = - f.derivatives[i];
+        }
+
+        return absError;
+    }
+
     template <class FluidState>
     static Scalar update_(FluidState &fluidState,
                           ParameterCache &paramCache,
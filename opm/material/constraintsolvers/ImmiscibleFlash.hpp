@@ -30,12 +30,16 @@
 #include <opm/common/ErrorMacros.hpp>
 #include <opm/common/Exceptions.hpp>
 #include <opm/material/common/Valgrind.hpp>
+#include <opm/material/common/FixedSizeLu.hpp>
 
 #include <dune/common/fvector.hh>
 #include <dune/common/fmatrix.hh>
 
+#include <algorithm>
+#include <exception>
 #include <limits>
 #include <iostream>
+#include <vector>
 
 namespace Opm {
 
@@ -106,11 +110,27 @@ public:
         }
     }
 
+    /*!
+     * \brief The outcome of a flash calculation which does not throw on failure.
+     */
+    struct SolveStatus
+    {
+        //! The number of iterations which were carried out
+        unsigned numIterations;
+
+        //! True iff the flash calculation converged
+        bool converged;
+    };
+
     /*!
      * \brief Calculates the chemical equilibrium from the component
      *        fugacities in a phase.
      *
      * The phase's fugacities must already be set.
+     *
+     * For two fluid phases, the problem is reduced to a single equation for the
+     * pressure of the first phase which is solved by a bracketing method. The Newton
+     * method for all phases is only used if this fails.
      */
     template <class MaterialLaw, class FluidState>
     static void solve(FluidState &fluidState,
@@ -118,7 +138,122 @@ public:
                       const typename MaterialLaw::Params &matParams,
                       const ComponentVector &globalMolarities)
     {
-        Dune::FMatrixPrecision<Scalar>::set_singular_limit(1e-25);
+        unsigned numIterations;
+        solve_<MaterialLaw>(fluidState, paramCache, matParams, globalMolarities, numIterations);
+    }
+
+    /*!
+     * \brief Calculates the chemical equilibrium from the component
+     *        fugacities in a phase without throwing if it fails.
+     *
+     * This is the same as solve(), but numerical problems are reported by the returned
+     * status object instead of an exception. If the calculation failed, the fluid
+     * state is undefined. Exceptions other than Opm::NumericalProblem are passed on.
+     */
+    template <class MaterialLaw, class FluidState>
+    static SolveStatus trySolve(FluidState &fluidState,
+                                ParameterCache &paramCache,
+                                const typename MaterialLaw::Params &matParams,
+                                const ComponentVector &globalMolarities)
+    {
+        SolveStatus status;
+        status.numIterations = 0;
+        status.converged = false;
+        try {
+            solve_<MaterialLaw>(fluidState,
+                                paramCache,
+                                matParams,
+                                globalMolarities,
+                                status.numIterations);
+            status.converged = true;
+        }
+        catch (const NumericalProblem&) {
+            // the Newton method did not converge or the linear solver failed. other
+            // exceptions indicate programming errors and are thus passed on
+        }
+
+        return status;
+    }
+
+    /*!
+     * \brief Calculates the pressures and saturations for a batch of cells.
+     *
+     * The fluid state of each cell is used as the initial solution, i.e., it should
+     * contain the result of the previous flash calculation of the cell or it must have
+     * been initialized using guessInitial(). The temperature of each fluid state is set
+     * to the one given for the cell.
+     *
+     * The material law parameters are specified by a function object which returns
+     * the parameters of a cell given its index. If OpenMP is enabled, the cells are
+     * processed in parallel. The cells are independent of each other, so a cell which
+     * converges early does not hold back the remaining ones.
+     *
+     * Instead of throwing on the first failure, the number of iterations and whether
+     * the calculation converged is reported for each cell in \a status. The fluid
+     * states of the failed cells are undefined. Exceptions other than
+     * Opm::NumericalProblem are re-thrown after all cells have been processed.
+     *
+     * \return The number of cells for which the flash calculation failed
+     */
+    template <class MaterialLaw, class FluidState, class MaterialParamsFn>
+    static unsigned solveBatch(std::vector<FluidState>& fluidStates,
+                               std::vector<SolveStatus>& status,
+                               const MaterialParamsFn& matParams,
+                               const std::vector<ComponentVector>& globalMolarities,
+                               const std::vector<Scalar>& temperatures)
+    {
+        assert(globalMolarities.size() == fluidStates.size());
+        assert(temperatures.size() == fluidStates.size());
+
+        int numCells = static_cast<int>(fluidStates.size());
+        status.resize(fluidStates.size());
+
+        // exceptions must not leave the parallel region, so the first one is stored
+        // and re-thrown afterwards
+        std::exception_ptr error;
+        unsigned numFailed = 0;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 16) reduction(+:numFailed)
+#endif
+        for (int cellIdx = 0; cellIdx < numCells; ++cellIdx) {
+            try {
+                FluidState& fluidState = fluidStates[cellIdx];
+                ParameterCache paramCache;
+
+                fluidState.setTemperature(temperatures[cellIdx]);
+                status[cellIdx] = trySolve<MaterialLaw>(fluidState,
+                                                        paramCache,
+                                                        matParams(static_cast<unsigned>(cellIdx)),
+                                                        globalMolarities[cellIdx]);
+                if (!status[cellIdx].converged)
+                    ++ numFailed;
+            }
+            catch (...) {
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+                {
+                    if (!error)
+                        error = std::current_exception();
+                }
+            }
+        }
+
+        if (error)
+            std::rethrow_exception(error);
+
+        return numFailed;
+    }
+
+protected:
+    template <class MaterialLaw, class FluidState>
+    static void solve_(FluidState &fluidState,
+                       ParameterCache &paramCache,
+                       const typename MaterialLaw::Params &matParams,
+                       const ComponentVector &globalMolarities,
+                       unsigned &numIterations)
+    {
+        numIterations = 0;
 
         /////////////////////////
         // Check if all fluid phases are incompressible
@@ -144,6 +279,26 @@ public:
             }
         };
 
+        /////////////////////////
+        // Two phases: one-dimensional root finding
+        /////////////////////////
+        if (numPhases == 2 && !allIncompressible) {
+            // the root finding modifies the fluid state and the parameter cache. if it
+            // fails, the Newton method must start from the state which was passed to
+            // the solver.
+            const FluidState inputFluidState(fluidState);
+            const ParameterCache inputParamCache(paramCache);
+            if (solveTwoPhase_<MaterialLaw>(fluidState,
+                                            paramCache,
+                                            matParams,
+                                            globalMolarities,
+                                            numIterations))
+                return;
+
+            fluidState = inputFluidState;
+            paramCache = inputParamCache;
+        }
+
         /////////////////////////
         // Newton method
         /////////////////////////
@@ -163,23 +318,22 @@ public:
 
         const int nMax = 50; // <- maximum number of newton iterations
         for (int nIdx = 0; nIdx < nMax; ++nIdx) {
+            ++ numIterations;
+
             // calculate Jacobian matrix and right hand side
             linearize_<MaterialLaw>(J, b, fluidState, paramCache, matParams, globalMolarities);
             Valgrind::CheckDefined(J);
             Valgrind::CheckDefined(b);
 
-            // Solve J*x = b
+            // Solve J*x = b. (this overwrites J and b.)
             deltaX = 0;
 
-            try { J.solve(deltaX, b); }
-            catch (Dune::FMatrixError e)
-            {
+            if (!solveFixedSizeLu(deltaX, J, b, /*singularLimit=*/1e-25)) {
                 /*
-                std::cout << "error: " << e << "\n";
                 std::cout << "b: " << b << "\n";
                 */
 
-                throw Opm::NumericalProblem(e.what());
+                OPM_THROW(NumericalProblem, "Singular Jacobian matrix in flash calculation");
             }
             Valgrind::CheckDefined(deltaX);
 
@@ -225,8 +379,154 @@ public:
                   << fluidState.temperature(/*phaseIdx=*/0));
     }
 
+    // for two phases, the saturation of the first phase is an explicit function of
+    // its pressure: S_0 = c^0/rhoMolar_0(p_0). together with the capillary pressure,
+    // this also determines the pressure and thus the saturation of the second phase.
+    // the remaining equation S_0 + S_1 = 1 is monotonically decreasing in p_0 because
+    // the densities increase with pressure, so its root can be bracketed.
+    template <class MaterialLaw, class FluidState>
+    static bool solveTwoPhase_(FluidState &fluidState,
+                               ParameterCache &paramCache,
+                               const typename MaterialLaw::Params &matParams,
+                               const ComponentVector &globalMolarities,
+                               unsigned &numIterations)
+    {
+        const unsigned maxIterations = 100;
+
+        // the tolerance is relative for the pressure and absolute for the sum of the
+        // saturations. it must be attainable in the precision of the Scalar type.
+        const Scalar tolerance = std::max<Scalar>(1e-12, 10*std::numeric_limits<Scalar>::epsilon());
+
+        // if the cell does not contain the component of a phase, the saturation of
+        // this phase is zero for any pressure. in this case, only the density of the
+        // other phase needs to be evaluated to find its pressure.
+        int presentPhaseIdx = -1;
+        if (globalMolarities[/*compIdx=*/1] == 0.0 && globalMolarities[/*compIdx=*/0] > 0.0)
+            presentPhaseIdx = 0;
+        else if (globalMolarities[/*compIdx=*/0] == 0.0 && globalMolarities[/*compIdx=*/1] > 0.0)
+            presentPhaseIdx = 1;
+
+        Scalar p = fluidState.pressure(/*phaseIdx=*/0);
+        if (!std::isfinite(p) || p <= 0)
+            p = 2e5;
+
+        // find an interval which contains the root by expanding it geometrically. the
+        // root may also be hit directly, e.g., if the initial pressure is already the
+        // solution.
+        Scalar defect = twoPhaseDefect_<MaterialLaw>(fluidState, paramCache, matParams, globalMolarities, p, presentPhaseIdx);
+        ++ numIterations;
+        Scalar pLow = p;
+        Scalar pHigh = p;
+        Scalar defectLow = defect;
+        Scalar defectHigh = defect;
+        while (!(std::abs(defect) <= tolerance) && !(defectLow > 0 && defectHigh < 0)) {
+            if (numIterations >= maxIterations || !std::isfinite(defect))
+                return false;
+
+            if (defectLow <= 0) {
+                pHigh = pLow;
+                defectHigh = defectLow;
+                p = pLow = pLow/2;
+                defect = defectLow = twoPhaseDefect_<MaterialLaw>(fluidState, paramCache, matParams, globalMolarities, p, presentPhaseIdx);
+            }
+            else {
+                pLow = pHigh;
+                defectLow = defectHigh;
+                p = pHigh = pHigh*2;
+                defect = defectHigh = twoPhaseDefect_<MaterialLaw>(fluidState, paramCache, matParams, globalMolarities, p, presentPhaseIdx);
+            }
+            ++ numIterations;
+        }
+
+        // shrink the interval using the Illinois variant of the regula falsi until
+        // either the defect or the interval becomes smaller than the tolerance
+        int lastSide = 0;
+        while (!(std::abs(defect) <= tolerance) && pHigh - pLow > tolerance*pHigh) {
+            if (numIterations >= maxIterations)
+                return false;
+
+            p = pLow + (pHigh - pLow)*defectLow/(defectLow - defectHigh);
+            if (!(pLow < p && p < pHigh))
+                p = (pLow + pHigh)/2;
+
+            defect = twoPhaseDefect_<MaterialLaw>(fluidState, paramCache, matParams, globalMolarities, p, presentPhaseIdx);
+            ++ numIterations;
+            if (!std::isfinite(defect))
+                return false;
+
+            if (defect > 0) {
+                pLow = p;
+                defectLow = defect;
+                if (lastSide == -1)
+                    defectHigh /= 2;
+                lastSide = -1;
+            }
+            else {
+                pHigh = p;
+                defectHigh = defect;
+                if (lastSide == 1)
+                    defectLow /= 2;
+                lastSide = 1;
+            }
+        }
+
+        // set the final solution. if the defect is small enough, the fluid state
+        // already corresponds to the last pressure which has been evaluated.
+        if (!(std::abs(defect) <= tolerance)) {
+            p = (pLow + pHigh)/2;
+            twoPhaseDefect_<MaterialLaw>(fluidState, paramCache, matParams, globalMolarities, p, presentPhaseIdx);
+        }
+        fluidState.setPressure(/*phaseIdx=*/0, p);
+        completeFluidState_<MaterialLaw>(fluidState, paramCache, matParams);
+
+        return true;
+    }
+
+    // returns S_0 + S_1 - 1 for a given pressure of the first phase. the saturations
+    // are set in the fluid state. if only one phase is present, the saturation of the
+    // other one is zero and its density is not evaluated.
+    template <class MaterialLaw, class FluidState>
+    static Scalar twoPhaseDefect_(FluidState &fluidState,
+                                  ParameterCache &paramCache,
+                                  const typename MaterialLaw::Params &matParams,
+                                  const ComponentVector &globalMolarities,
+                                  Scalar p0,
+                                  int presentPhaseIdx)
+    {
+        fluidState.setPressure(/*phaseIdx=*/0, p0);
+        fluidState.setPressure(/*phaseIdx=*/1, p0);
+
+        Scalar S0 = 0.0;
+        if (presentPhaseIdx != 1) {
+            paramCache.updateAllPressures(fluidState);
+            fluidState.setDensity(/*phaseIdx=*/0, FluidSystem::density(fluidState, paramCache, /*phaseIdx=*/0));
+            S0 = globalMolarities[/*compIdx=*/0]/fluidState.molarity(/*phaseIdx=*/0, /*compIdx=*/0);
+        }
+
+        // the capillary pressure is evaluated for physically meaningful saturations
+        Scalar S0Clamped = std::max<Scalar>(0.0, std::min<Scalar>(1.0, S0));
+        if (presentPhaseIdx == 0)
+            S0Clamped = 1.0;
+        fluidState.setSaturation(/*phaseIdx=*/0, S0Clamped);
+        fluidState.setSaturation(/*phaseIdx=*/1, 1.0 - S0Clamped);
+
+        ComponentVector pC;
+        MaterialLaw::capillaryPressures(pC, matParams, fluidState);
+        fluidState.setPressure(/*phaseIdx=*/1, p0 + (pC[1] - pC[0]));
+
+        Scalar S1 = 0.0;
+        if (presentPhaseIdx != 0) {
+            paramCache.updateAllPressures(fluidState);
+            fluidState.setDensity(/*phaseIdx=*/1, FluidSystem::density(fluidState, paramCache, /*phaseIdx=*/1));
+            S1 = globalMolarities[/*compIdx=*/1]/fluidState.molarity(/*phaseIdx=*/1, /*compIdx=*/1);
+        }
+
+        fluidState.setSaturation(/*phaseIdx=*/0, S0);
+        fluidState.setSaturation(/*phaseIdx=*/1, S1);
+
+        return S0 + S1 - 1;
+    }
 
-protected:
     template <class FluidState>
     static void printFluidState_(const FluidState &fs)
     {
@@ -286,7 +586,10 @@ protected:
 
             // deviate the mole fraction of the i-th component
             Scalar xI = getQuantity_(fluidState, pvIdx);
-            const Scalar eps = 1e-10/quantityWeight_(fluidState, pvIdx);
+            // the perturbation must not vanish in the precision of the Scalar type
+            const Scalar eps =
+                std::max<Scalar>(1e-10, std::numeric_limits<Scalar>::epsilon()*1e3)
+                /quantityWeight_(fluidState, pvIdx);
             setQuantity_<MaterialLaw>(fluidState, paramCache, matParams, pvIdx, xI + eps);
             assert(std::abs(getQuantity_(fluidState, pvIdx) - (xI + eps))
                    <= std::max<Scalar>(1.0, std::abs(xI))*std::numeric_limits<Scalar>::epsilon()*100);
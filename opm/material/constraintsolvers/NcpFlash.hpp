@@ -32,7 +32,9 @@
 
 #include <opm/material/fluidmatrixinteractions/NullMaterial.hpp>
 #include <opm/material/fluidmatrixinteractions/MaterialTraits.hpp>
+#include <opm/material/fluidstates/CompositionalFluidState.hpp>
 #include <opm/material/common/MathToolbox.hpp>
+#include <opm/material/common/FixedSizeLu.hpp>
 #include <opm/common/ErrorMacros.hpp>
 #include <opm/common/Exceptions.hpp>
 #include <opm/material/common/Means.hpp>
@@ -40,6 +42,12 @@
 
 #include <limits>
 #include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <type_traits>
+#include <vector>
+#include <cassert>
 
 namespace Opm {
 
@@ -92,6 +100,8 @@ class NcpFlash
 
     static const int numEq = numPhases*(numComponents + 1);
 
+    typedef Dune::FieldVector<Scalar, numComponents> CompositionVector;
+
 public:
     /*!
      * \brief Guess initial values for all quantities.
@@ -123,14 +133,252 @@ public:
         // set the fugacity coefficients of all components in all phases
         paramCache.updateAll(fluidState);
         for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++ phaseIdx) {
-            for (unsigned compIdx = 0; compIdx < numComponents; ++ compIdx) {
-                const typename FluidState::Scalar phi =
-                    FluidSystem::fugacityCoefficient(fluidState, paramCache, phaseIdx, compIdx);
-                fluidState.setFugacityCoefficient(phaseIdx, compIdx, phi);
+            typename FluidState::Scalar phi[numComponents];
+            FluidSystem::fugacityCoefficients(phi, fluidState, paramCache, phaseIdx);
+            for (unsigned compIdx = 0; compIdx < numComponents; ++ compIdx)
+                fluidState.setFugacityCoefficient(phaseIdx, compIdx, phi[compIdx]);
+        }
+    }
+
+    /*!
+     * \brief Guess initial values for all quantities using a phase stability analysis.
+     *
+     * The temperature and the pressure of the first phase must already be set for the
+     * fluid state, e.g. from the result of a previous flash calculation or from an
+     * estimate of the pressure. Capillary pressures are neglected.
+     *
+     * First, the phase which exhibits the lowest Gibbs energy for the overall
+     * composition of the fluid is determined. Then, Michelsen's tangent plane
+     * criterion is evaluated for all other phases, i.e., the stationary points of the
+     * tangent plane distance are located using successive substitution, which is
+     * accelerated by the dominant eigenvalue method. If the mixture is stable, the
+     * fluid is completely assigned to the lowest-energy phase and the compositions of
+     * the other phases are set to the ones of the stationary points. Otherwise, the
+     * K-values of the most unstable phase are refined by a few accelerated successive
+     * substitution steps of a two-phase flash at the given pressure. For stable
+     * mixtures, the pressure is adapted to the total molarity of the fluid and the
+     * analysis is repeated until the pressure does not change anymore. The result is
+     * then the solution of the flash problem, so the subsequent Newton method only
+     * needs to verify it.
+     *
+     * The fugacity coefficients are obtained from the fluid system, i.e., for fluid
+     * systems based on the Peng-Robinson equation of state, from
+     * PengRobinsonMixture::computeFugacityCoefficient().
+     *
+     * \return true iff the fluid was found to be stable as a single phase
+     */
+    template <class FluidState>
+    static bool guessFromStabilityAnalysis(FluidState &fluidState,
+                                           ParameterCache &paramCache,
+                                           const CompositionVector& globalMolarities)
+    {
+        static_assert(std::is_same<typename FluidState::Scalar, Scalar>::value,
+                      "The stability analysis is only implemented for scalar fluid states");
+
+        // the overall composition of the fluid
+        Scalar sumMoles = 0;
+        for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+            sumMoles += globalMolarities[compIdx];
+        CompositionVector z;
+        for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+            z[compIdx] = std::max<Scalar>(0.0, globalMolarities[compIdx]/sumMoles);
+
+        // if the fluid is stable, the pressure must be consistent with the total
+        // molarity. since this may change the outcome of the stability test, it is
+        // repeated for the adapted pressure. (doing the same for the two-phase split
+        // makes things worse because the cubic equation of state may flip between its
+        // roots.)
+        Scalar p = fluidState.pressure(/*phaseIdx=*/0);
+        Scalar phaseFraction[numPhases];
+        bool isStable = true;
+        unsigned refPhaseIdx = 0;
+        for (int outerIdx = 0; outerIdx < 8; ++outerIdx) {
+            CompositionVector W[numPhases];
+            unsigned trialPhaseIdx = analyzeStability_(W, refPhaseIdx, fluidState, paramCache, z, p);
+            if (trialPhaseIdx == numPhases) {
+                // no phase exhibits a finite Gibbs energy, i.e., the analysis is
+                // inconclusive
+                for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++ phaseIdx)
+                    fluidState.setPressure(phaseIdx, p);
+                return false;
+            }
+
+            std::fill(phaseFraction, phaseFraction + numPhases, 0.0);
+            for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++ phaseIdx) {
+                if (phaseIdx == refPhaseIdx || phaseIdx == trialPhaseIdx)
+                    continue;
+
+                // the compositions of absent phases do not sum up to more than one
+                Scalar sumW = 0.0;
+                for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+                    sumW += W[phaseIdx][compIdx];
+                for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+                    fluidState.setMoleFraction(phaseIdx, compIdx, W[phaseIdx][compIdx]/std::max<Scalar>(1.0, sumW));
+            }
+
+            isStable = (trialPhaseIdx == refPhaseIdx);
+            if (isStable) {
+                for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+                    fluidState.setMoleFraction(refPhaseIdx, compIdx, z[compIdx]);
+                phaseFraction[refPhaseIdx] = 1.0;
+            }
+            else {
+                CompositionVector x, y;
+                Scalar nu = splitTwoPhases_(x, y, fluidState, paramCache, refPhaseIdx, trialPhaseIdx, z, W[trialPhaseIdx]);
+                for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx) {
+                    fluidState.setMoleFraction(refPhaseIdx, compIdx, x[compIdx]);
+                    fluidState.setMoleFraction(trialPhaseIdx, compIdx, y[compIdx]);
+                }
+                phaseFraction[refPhaseIdx] = 1.0 - nu;
+                phaseFraction[trialPhaseIdx] = nu;
+                break;
             }
+
+            Scalar pOld = p;
+            p = consistentPressure_(fluidState, paramCache, phaseFraction, sumMoles, p);
+            if (std::abs(p - pOld) < 1e-3*pOld)
+                break;
         }
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++ phaseIdx)
+            fluidState.setPressure(phaseIdx, p);
+
+        // the stationary points were determined for the pressure before its last
+        // adaptation. also, the flash problem evaluates the fugacity coefficients of the
+        // absent phases at their unnormalized compositions.
+        if (isStable)
+            updateAbsentPhases_(fluidState, paramCache, refPhaseIdx, z);
+
+        // convert the molar phase fractions to saturations and set the fugacity
+        // coefficients of all components in all phases
+        paramCache.updateAll(fluidState);
+        Scalar phaseVolume[numPhases];
+        Scalar totalVolume = 0.0;
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++ phaseIdx) {
+            phaseVolume[phaseIdx] = 0.0;
+            if (phaseFraction[phaseIdx] > 0) {
+                Scalar rho = FluidSystem::density(fluidState, paramCache, phaseIdx);
+                phaseVolume[phaseIdx] = phaseFraction[phaseIdx]*fluidState.averageMolarMass(phaseIdx)/rho;
+            }
+            totalVolume += phaseVolume[phaseIdx];
+
+            Scalar phi[numComponents];
+            FluidSystem::fugacityCoefficients(phi, fluidState, paramCache, phaseIdx);
+            for (unsigned compIdx = 0; compIdx < numComponents; ++ compIdx)
+                fluidState.setFugacityCoefficient(phaseIdx, compIdx, phi[compIdx]);
+        }
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++ phaseIdx)
+            fluidState.setSaturation(phaseIdx, phaseVolume[phaseIdx]/totalVolume);
+
+        return isStable;
     }
 
+    /*!
+     * \brief The outcome of a flash calculation which does not throw on failure.
+     */
+    struct SolveStatus
+    {
+        //! The number of Newton iterations which were carried out
+        unsigned numIterations;
+
+        //! True iff the flash calculation converged
+        bool converged;
+    };
+
+    /*!
+     * \brief Specifies how the Newton method of the flash calculation is globalized.
+     *
+     * By default, the full Newton step is applied, i.e., the update is only limited
+     * by fixed bounds on the change of each quantity (50% of the pressure, 0.25 for
+     * saturations and 0.2 for mole fractions). If the line search is enabled, the step
+     * is cut back until the scaled residual of the NCP system decreases by a
+     * sufficient fraction of the reduction which is predicted by the linearization
+     * (Armijo condition). If a positive trust region radius is specified, the bounds
+     * are multiplied by the radius, which is adapted from iteration to iteration
+     * depending on how well the linearization predicts the reduction of the residual.
+     *
+     * Optionally, the initial solution of the Newton method can be determined by
+     * guessFromStabilityAnalysis() instead of using the fluid state passed to the
+     * solver.
+     */
+    struct SolverParameters
+    {
+        SolverParameters(Scalar tol = -1.0)
+            : tolerance(tol)
+            , maxIterations(50)
+            , lineSearch(false)
+            , maxBacktrackingSteps(8)
+            , armijoParameter(1e-4)
+            , trustRegionRadius(0.0)
+            , stabilityAnalysis(false)
+        {}
+
+        //! The tolerance of the Newton method. If it is not positive, a default
+        //! which depends on the precision of the Scalar type is used.
+        Scalar tolerance;
+
+        //! The maximum number of Newton iterations
+        unsigned maxIterations;
+
+        //! Use a backtracking line search on the residual of the NCP system
+        bool lineSearch;
+
+        //! The maximum number of times a step may be cut back in a single iteration
+        unsigned maxBacktrackingSteps;
+
+        //! The fraction of the predicted residual reduction which must be achieved for
+        //! a step to be accepted
+        Scalar armijoParameter;
+
+        //! The initial and maximum trust region radius relative to the default bounds
+        //! of the update. It must be smaller than 2. If it is not positive, the trust
+        //! region is disabled.
+        Scalar trustRegionRadius;
+
+        //! Get the initial solution from guessFromStabilityAnalysis(). The temperature
+        //! and the pressure of the first phase of the fluid state are used as the
+        //! starting point of the analysis. If the fluid is stable as a single phase,
+        //! the Newton method is skipped. (This is only supported for scalar fluid
+        //! states.)
+        bool stabilityAnalysis;
+    };
+
+    /*!
+     * \brief Records the convergence behavior of a single flash calculation.
+     */
+    struct ConvergenceStatistics
+    {
+        ConvergenceStatistics()
+        { reset(); }
+
+        void reset()
+        {
+            numIterations = 0;
+            numBacktrackingSteps = 0;
+            converged = false;
+            residualHistory.clear();
+            updateHistory.clear();
+        }
+
+        //! The number of Newton iterations which were carried out
+        unsigned numIterations;
+
+        //! The total number of step reductions of the line search and of the trust
+        //! region
+        unsigned numBacktrackingSteps;
+
+        //! True iff the flash calculation converged
+        bool converged;
+
+        //! The scaled Euclidean norm of the residual at the beginning of each Newton
+        //! iteration. If the calculation converged, the norm of the residual of the
+        //! final solution is appended.
+        std::vector<Scalar> residualHistory;
+
+        //! The weighted maximum norm of the full Newton step of each iteration. This
+        //! is the quantity which is compared to the tolerance.
+        std::vector<Scalar> updateHistory;
+    };
+
     /*!
      * \brief Calculates the chemical equilibrium from the component
      *        fugacities in a phase.
@@ -143,17 +391,251 @@ public:
                       const typename MaterialLaw::Params &matParams,
                       const Dune::FieldVector<typename FluidState::Scalar, numComponents>& globalMolarities,
                       Scalar tolerance = -1.0)
+    {
+        unsigned numIterations;
+        solveNewton_<MaterialLaw>(fluidState,
+                                  paramCache,
+                                  matParams,
+                                  globalMolarities,
+                                  SolverParameters(tolerance),
+                                  numIterations,
+                                  /*stats=*/0);
+    }
+
+    /*!
+     * \brief Calculates the chemical equilibrium using a user-specified strategy
+     *        for the Newton method.
+     *
+     * If \a stats is not a null pointer, the convergence behavior of the calculation
+     * is recorded in the object it points to. This is also done if the calculation
+     * fails, i.e., if a NumericalProblem exception is thrown.
+     */
+    template <class MaterialLaw, class FluidState>
+    static void solve(FluidState &fluidState,
+                      ParameterCache &paramCache,
+                      const typename MaterialLaw::Params &matParams,
+                      const Dune::FieldVector<typename FluidState::Scalar, numComponents>& globalMolarities,
+                      const SolverParameters &params,
+                      ConvergenceStatistics *stats = 0)
+    {
+        unsigned numIterations;
+        solveNewton_<MaterialLaw>(fluidState,
+                                  paramCache,
+                                  matParams,
+                                  globalMolarities,
+                                  params,
+                                  numIterations,
+                                  stats);
+    }
+
+    /*!
+     * \brief Calculates the chemical equilibrium from the component
+     *        fugacities in a phase without throwing if it fails.
+     *
+     * This is the same as solve(), but numerical problems are reported by the returned
+     * status object instead of an exception. If the calculation failed, the fluid
+     * state is undefined. Exceptions other than Opm::NumericalProblem are passed on.
+     */
+    template <class MaterialLaw, class FluidState>
+    static SolveStatus trySolve(FluidState &fluidState,
+                                ParameterCache &paramCache,
+                                const typename MaterialLaw::Params &matParams,
+                                const Dune::FieldVector<typename FluidState::Scalar, numComponents>& globalMolarities,
+                                Scalar tolerance = -1.0)
+    {
+        return trySolveNewton_<MaterialLaw>(fluidState,
+                                            paramCache,
+                                            matParams,
+                                            globalMolarities,
+                                            SolverParameters(tolerance),
+                                            /*stats=*/0);
+    }
+
+    /*!
+     * \brief Calculates the chemical equilibrium using a user-specified strategy
+     *        for the Newton method without throwing if it fails.
+     */
+    template <class MaterialLaw, class FluidState>
+    static SolveStatus trySolve(FluidState &fluidState,
+                                ParameterCache &paramCache,
+                                const typename MaterialLaw::Params &matParams,
+                                const Dune::FieldVector<typename FluidState::Scalar, numComponents>& globalMolarities,
+                                const SolverParameters &params,
+                                ConvergenceStatistics *stats = 0)
+    {
+        return trySolveNewton_<MaterialLaw>(fluidState,
+                                            paramCache,
+                                            matParams,
+                                            globalMolarities,
+                                            params,
+                                            stats);
+    }
+
+    /*!
+     * \brief Calculates the chemical equilibrium for a batch of cells.
+     *
+     * The fluid state of each cell is used as the initial solution of its Newton
+     * method, i.e., it should contain the result of the previous flash calculation of
+     * the cell. For cells which have not been flashed before, guessInitial() must be
+     * called first. The temperature of each fluid state is set to the one given for
+     * the cell. If the warm-started Newton method does not converge, the calculation
+     * is retried once starting from guessInitial() without the stability analysis.
+     *
+     * The material law parameters are specified by a function object which returns
+     * the parameters of a cell given its index. If OpenMP is enabled, the cells are
+     * processed in parallel. All scratch data (Jacobian matrix, residual and parameter
+     * cache) lives on the stack of the thread which processes a cell, so no
+     * synchronization is required.
+     *
+     * Instead of throwing on the first failure, the number of iterations and whether
+     * the calculation converged is reported for each cell in \a status. The fluid
+     * states of the failed cells are undefined. Exceptions other than
+     * Opm::NumericalProblem are re-thrown after all cells have been processed.
+     *
+     * \return The number of cells for which the flash calculation failed
+     */
+    template <class MaterialLaw, class FluidState, class MaterialParamsFn>
+    static unsigned solveBatch(std::vector<FluidState>& fluidStates,
+                               std::vector<SolveStatus>& status,
+                               const MaterialParamsFn& matParams,
+                               const std::vector<Dune::FieldVector<typename FluidState::Scalar, numComponents> >& globalMolarities,
+                               const std::vector<Scalar>& temperatures,
+                               Scalar tolerance = -1.0)
+    {
+        return solveBatch<MaterialLaw>(fluidStates,
+                                       status,
+                                       matParams,
+                                       globalMolarities,
+                                       temperatures,
+                                       SolverParameters(tolerance));
+    }
+
+    /*!
+     * \brief Calculates the chemical equilibrium for a batch of cells using a
+     *        user-specified strategy for the Newton method.
+     */
+    template <class MaterialLaw, class FluidState, class MaterialParamsFn>
+    static unsigned solveBatch(std::vector<FluidState>& fluidStates,
+                               std::vector<SolveStatus>& status,
+                               const MaterialParamsFn& matParams,
+                               const std::vector<Dune::FieldVector<typename FluidState::Scalar, numComponents> >& globalMolarities,
+                               const std::vector<Scalar>& temperatures,
+                               const SolverParameters &params)
+    {
+        assert(globalMolarities.size() == fluidStates.size());
+        assert(temperatures.size() == fluidStates.size());
+
+        int numCells = static_cast<int>(fluidStates.size());
+        status.resize(fluidStates.size());
+
+        // exceptions must not leave the parallel region, so the first one is stored
+        // and re-thrown afterwards
+        std::exception_ptr error;
+        unsigned numFailed = 0;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 16) reduction(+:numFailed)
+#endif
+        for (int cellIdx = 0; cellIdx < numCells; ++cellIdx) {
+            try {
+                FluidState& fluidState = fluidStates[cellIdx];
+                const auto& cellMolarities = globalMolarities[cellIdx];
+                const typename MaterialLaw::Params& cellMatParams = matParams(static_cast<unsigned>(cellIdx));
+                ParameterCache paramCache;
+
+                fluidState.setTemperature(temperatures[cellIdx]);
+
+                SolveStatus& cellStatus = status[cellIdx];
+                cellStatus = trySolveNewton_<MaterialLaw>(fluidState,
+                                                          paramCache,
+                                                          cellMatParams,
+                                                          cellMolarities,
+                                                          params,
+                                                          /*stats=*/0);
+                if (!cellStatus.converged) {
+                    // the warm start did not work. try again using the default initial
+                    // solution
+                    unsigned warmIterations = cellStatus.numIterations;
+                    SolverParameters coldParams(params);
+                    coldParams.stabilityAnalysis = false;
+                    guessInitial(fluidState, paramCache, cellMolarities);
+                    cellStatus = trySolveNewton_<MaterialLaw>(fluidState,
+                                                              paramCache,
+                                                              cellMatParams,
+                                                              cellMolarities,
+                                                              coldParams,
+                                                              /*stats=*/0);
+                    cellStatus.numIterations += warmIterations;
+                }
+
+                if (!cellStatus.converged)
+                    ++ numFailed;
+            }
+            catch (...) {
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+                {
+                    if (!error)
+                        error = std::current_exception();
+                }
+            }
+        }
+
+        if (error)
+            std::rethrow_exception(error);
+
+        return numFailed;
+    }
+
+    /*!
+     * \brief Calculates the chemical equilibrium from the component
+     *        fugacities in a phase.
+     *
+     * This is a convenience method which assumes that the capillary pressure is
+     * zero...
+     */
+    template <class FluidState, class ComponentVector>
+    static void solve(FluidState &fluidState,
+                      const ComponentVector &globalMolarities,
+                      Scalar tolerance = 0.0)
+    {
+        ParameterCache paramCache;
+        paramCache.updateAll(fluidState);
+
+        typedef NullMaterialTraits<Scalar, numPhases> MaterialTraits;
+        typedef NullMaterial<MaterialTraits> MaterialLaw;
+        typedef typename MaterialLaw::Params MaterialLawParams;
+
+        MaterialLawParams matParams;
+        solve<MaterialLaw>(fluidState, paramCache, matParams, globalMolarities, tolerance);
+    }
+
+protected:
+    template <class MaterialLaw, class FluidState>
+    static void solveNewton_(FluidState &fluidState,
+                             ParameterCache &paramCache,
+                             const typename MaterialLaw::Params &matParams,
+                             const Dune::FieldVector<typename FluidState::Scalar, numComponents>& globalMolarities,
+                             const SolverParameters &params,
+                             unsigned& numIterations,
+                             ConvergenceStatistics *stats)
     {
         typedef typename FluidState::Scalar Evaluation;
         typedef Dune::FieldMatrix<Evaluation, numEq, numEq> Matrix;
         typedef Dune::FieldVector<Evaluation, numEq> Vector;
 
-        Dune::FMatrixPrecision<Scalar>::set_singular_limit(1e-35);
-
+        Scalar tolerance = params.tolerance;
         if (tolerance <= 0)
             tolerance = std::min<Scalar>(1e-5,
                                          1e8*std::numeric_limits<Scalar>::epsilon());
 
+        const bool globalize = params.lineSearch || params.trustRegionRadius > 0;
+        Scalar trustRegionRadius = params.trustRegionRadius;
+
+        if (stats)
+            stats->reset();
+        numIterations = 0;
+
         /////////////////////////
         // Newton method
         /////////////////////////
@@ -164,16 +646,49 @@ public:
         Vector deltaX;
         // right hand side
         Vector b;
+        // linearization before solving the linear system
+        Matrix origJ;
+        Vector origB;
 
         Valgrind::SetUndefined(J);
         Valgrind::SetUndefined(deltaX);
         Valgrind::SetUndefined(b);
 
+        bool isSinglePhase = false;
+        if (params.stabilityAnalysis)
+            isSinglePhase =
+                guessFromStabilityAnalysis_<MaterialLaw>(fluidState,
+                                                         paramCache,
+                                                         matParams,
+                                                         globalMolarities,
+                                                         std::is_same<Evaluation, Scalar>());
+
         // make the fluid state consistent with the fluid system.
         completeFluidState_<MaterialLaw>(fluidState,
                                          paramCache,
                                          matParams);
 
+        // the scaling factor of the mass balance defects of the residual
+        Scalar molarityScale = 0.0;
+        for (unsigned compIdx = 0; compIdx < numComponents; ++ compIdx)
+            molarityScale += std::abs(Opm::MathToolbox<Evaluation>::value(globalMolarities[compIdx]));
+        molarityScale = std::max<Scalar>(molarityScale, 1e-10);
+
+        if (isSinglePhase) {
+            // the stability analysis may already have determined the solution. this is
+            // only accepted if it satisfies the equations of the flash problem, else
+            // it is used as the initial solution of the Newton method.
+            calculateDefect_(b, fluidState, fluidState, globalMolarities);
+            Scalar residual = std::sqrt(2*meritFunction_(b, pressureScale_(fluidState), molarityScale));
+            if (residual < tolerance) {
+                if (stats) {
+                    stats->residualHistory.push_back(residual);
+                    stats->converged = true;
+                }
+                return;
+            }
+        }
+
         /*
         std::cout << "--------------------\n";
         std::cout << "globalMolarities: ";
@@ -181,8 +696,11 @@ public:
             std::cout << globalMolarities[compIdx] << " ";
         std::cout << "\n";
         */
-        const int nMax = 50; // <- maximum number of newton iterations
-        for (int nIdx = 0; nIdx < nMax; ++nIdx) {
+        for (unsigned nIdx = 0; nIdx < params.maxIterations; ++nIdx) {
+            numIterations = nIdx + 1;
+            if (stats)
+                stats->numIterations = numIterations;
+
             // calculate Jacobian matrix and right hand side
             linearize_<MaterialLaw>(J,
                                     b,
@@ -193,20 +711,29 @@ public:
             Valgrind::CheckDefined(J);
             Valgrind::CheckDefined(b);
 
-            // Solve J*x = b
+            if (stats) {
+                Scalar merit = meritFunction_(b, pressureScale_(fluidState), molarityScale);
+                stats->residualHistory.push_back(std::sqrt(2*merit));
+            }
+
+            // the globalization needs the linearization to predict the reduction of
+            // the residual
+            if (globalize) {
+                origJ = J;
+                origB = b;
+            }
+
+            // Solve J*x = b. (this overwrites J and b.)
             deltaX = 0;
 
-            try { J.solve(deltaX, b); }
-            catch (const Dune::FMatrixError& e)
-            {
+            if (!solveFixedSizeLu(deltaX, J, b, /*singularLimit=*/1e-35)) {
                 /*
                 printFluidState_(fluidState);
-                std::cout << "error: " << e << "\n";
                 std::cout << "b: " << b << "\n";
                 std::cout << "J: " << J << "\n";
                 */
 
-                throw Opm::NumericalProblem(e.what());
+                OPM_THROW(NumericalProblem, "Singular Jacobian matrix in flash calculation");
             }
             Valgrind::CheckDefined(deltaX);
 
@@ -232,11 +759,34 @@ public:
             */
 
             // update the fluid quantities.
-            //update_<MaterialLaw>(fluidState, paramCache, matParams, deltaX);
-            Scalar relError = update_<MaterialLaw>(fluidState, paramCache, matParams, deltaX);
-
-            if (relError < tolerance)
+            Scalar relError;
+            if (globalize)
+                relError = updateGlobalized_<MaterialLaw>(fluidState,
+                                                          paramCache,
+                                                          matParams,
+                                                          deltaX,
+                                                          origJ,
+                                                          origB,
+                                                          globalMolarities,
+                                                          molarityScale,
+                                                          params,
+                                                          trustRegionRadius,
+                                                          stats);
+            else
+                relError = update_<MaterialLaw>(fluidState, paramCache, matParams, deltaX);
+
+            if (stats)
+                stats->updateHistory.push_back(relError);
+
+            if (relError < tolerance) {
+                if (stats) {
+                    calculateDefect_(b, fluidState, fluidState, globalMolarities);
+                    Scalar merit = meritFunction_(b, pressureScale_(fluidState), molarityScale);
+                    stats->residualHistory.push_back(std::sqrt(2*merit));
+                    stats->converged = true;
+                }
                 return;
+            }
         }
 
         /*
@@ -253,31 +803,611 @@ public:
                   << fluidState.temperature(/*phaseIdx=*/0));
     }
 
-    /*!
-     * \brief Calculates the chemical equilibrium from the component
-     *        fugacities in a phase.
-     *
-     * This is a convenience method which assumes that the capillary pressure is
-     * zero...
-     */
-    template <class FluidState, class ComponentVector>
-    static void solve(FluidState &fluidState,
-                      const ComponentVector &globalMolarities,
-                      Scalar tolerance = 0.0)
+    // determine the initial solution of the Newton method using the stability
+    // analysis. returns true iff the fluid is stable as a single phase. in this case,
+    // the fluid state is the solution of the flash problem except that the compositions
+    // of the absent phases are the ones of the stationary points of the tangent plane
+    // distance.
+    template <class MaterialLaw, class FluidState>
+    static bool guessFromStabilityAnalysis_(FluidState &fluidState,
+                                            ParameterCache &paramCache,
+                                            const typename MaterialLaw::Params &matParams,
+                                            const CompositionVector &globalMolarities,
+                                            std::true_type /*isScalar*/)
     {
-        ParameterCache paramCache;
+        if (!guessFromStabilityAnalysis(fluidState, paramCache, globalMolarities))
+            return false;
+
+        // the stability analysis neglects capillary pressures, i.e., the pressure it
+        // determined is the one of the present phase. the primary variable is the
+        // pressure of the first phase, though.
+        unsigned presentPhaseIdx = 0;
+        for (unsigned phaseIdx = 1; phaseIdx < numPhases; ++ phaseIdx)
+            if (fluidState.saturation(phaseIdx) > fluidState.saturation(presentPhaseIdx))
+                presentPhaseIdx = phaseIdx;
+
+        Dune::FieldVector<Scalar, numPhases> pC;
+        MaterialLaw::capillaryPressures(pC, matParams, fluidState);
+        fluidState.setPressure(/*phaseIdx=*/0,
+                               fluidState.pressure(presentPhaseIdx)
+                               - (pC[presentPhaseIdx] - pC[0]));
+        return true;
+    }
+
+    // for function evaluations, the stability analysis is done for the values of the
+    // quantities. since it does not provide any derivatives, the Newton method must
+    // not be skipped, i.e., false is always returned.
+    template <class MaterialLaw, class FluidState, class ComponentVector>
+    static bool guessFromStabilityAnalysis_(FluidState &fluidState,
+                                            ParameterCache &paramCache,
+                                            const typename MaterialLaw::Params &matParams,
+                                            const ComponentVector &globalMolarities,
+                                            std::false_type /*isScalar*/)
+    {
+        typedef Opm::MathToolbox<typename FluidState::Scalar> Toolbox;
+
+        CompositionalFluidState<Scalar, FluidSystem> scalarFluidState;
+        scalarFluidState.assign(fluidState);
+        CompositionVector scalarMolarities;
+        for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+            scalarMolarities[compIdx] = Toolbox::value(globalMolarities[compIdx]);
+
+        guessFromStabilityAnalysis_<MaterialLaw>(scalarFluidState,
+                                                 paramCache,
+                                                 matParams,
+                                                 scalarMolarities,
+                                                 std::true_type());
+
+        fluidState.setPressure(/*phaseIdx=*/0, scalarFluidState.pressure(/*phaseIdx=*/0));
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++ phaseIdx) {
+            fluidState.setSaturation(phaseIdx, scalarFluidState.saturation(phaseIdx));
+            for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+                fluidState.setMoleFraction(phaseIdx, compIdx, scalarFluidState.moleFraction(phaseIdx, compIdx));
+        }
+        return false;
+    }
+
+    template <class MaterialLaw, class FluidState>
+    static SolveStatus trySolveNewton_(FluidState &fluidState,
+                                       ParameterCache &paramCache,
+                                       const typename MaterialLaw::Params &matParams,
+                                       const Dune::FieldVector<typename FluidState::Scalar, numComponents>& globalMolarities,
+                                       const SolverParameters &params,
+                                       ConvergenceStatistics *stats)
+    {
+        SolveStatus status;
+        status.numIterations = 0;
+        status.converged = false;
+        try {
+            solveNewton_<MaterialLaw>(fluidState,
+                                      paramCache,
+                                      matParams,
+                                      globalMolarities,
+                                      params,
+                                      status.numIterations,
+                                      stats);
+            status.converged = true;
+        }
+        catch (const NumericalProblem&) {
+            // the Newton method did not converge or the linear solver failed. other
+            // exceptions indicate programming errors and are thus passed on
+        }
+
+        return status;
+    }
+
+    // half of the squared Euclidean norm of the scaled residual of the NCP system
+    template <class Vector>
+    static Scalar meritFunction_(const Vector &b, Scalar pressureScale, Scalar molarityScale)
+    {
+        typedef Opm::MathToolbox<typename Vector::value_type> Toolbox;
+
+        Scalar result = 0.0;
+        for (unsigned eqIdx = 0; eqIdx < numEq; ++ eqIdx) {
+            Scalar tmp = Toolbox::value(b[eqIdx]);
+            if (eqIdx < numComponents*(numPhases - 1))
+                tmp /= pressureScale; // fugacities
+            else if (eqIdx < numComponents*numPhases)
+                tmp /= molarityScale; // total molarities
+            // the NCP constraints are already dimensionless
+
+            result += tmp*tmp;
+        }
+
+        return result/2;
+    }
+
+    // the scaling factor for the fugacity defects. this is the current pressure
+    // instead of a fixed value because the fugacities of all components vanish with
+    // the pressure, i.e., a fixed scale would make the line search drive the pressure
+    // towards zero.
+    template <class FluidState>
+    static Scalar pressureScale_(const FluidState &fluidState)
+    {
+        typedef Opm::MathToolbox<typename FluidState::Scalar> Toolbox;
+        return std::max<Scalar>(1.0, std::abs(Toolbox::value(fluidState.pressure(/*phaseIdx=*/0))));
+    }
+
+    // apply a Newton step which is limited by the line search and the trust region.
+    // the trust region scales the bounds which update_() imposes on the change of each
+    // quantity. a trial step is accepted if it achieves a sufficient fraction of the
+    // residual reduction predicted by the linearization for the step which was
+    // actually applied. returns the weighted maximum norm of the full Newton step.
+    template <class MaterialLaw, class FluidState, class Vector, class Matrix, class ComponentVector>
+    static Scalar updateGlobalized_(FluidState &fluidState,
+                                    ParameterCache &paramCache,
+                                    const typename MaterialLaw::Params &matParams,
+                                    const Vector &deltaX,
+                                    const Matrix &J,
+                                    const Vector &b,
+                                    const ComponentVector &globalMolarities,
+                                    Scalar molarityScale,
+                                    const SolverParameters &params,
+                                    Scalar &trustRegionRadius,
+                                    ConvergenceStatistics *stats)
+    {
+        typedef Opm::MathToolbox<typename Vector::value_type> Toolbox;
+
+        Scalar relError = 0;
+        for (unsigned pvIdx = 0; pvIdx < numEq; ++ pvIdx)
+            relError = std::max<Scalar>(relError,
+                                        std::abs(Toolbox::value(deltaX[pvIdx]))
+                                        * quantityWeight_(fluidState, pvIdx));
+
+        const FluidState origFluidState(fluidState);
+        const ParameterCache origParamCache(paramCache);
+        const Scalar initialBoundScale = (trustRegionRadius > 0)?trustRegionRadius:1.0;
+        Scalar boundScale = initialBoundScale;
+
+        Vector step;
+        Vector newB;
+        Vector predictedB;
+        Scalar lambda = 1.0;
+        for (unsigned btIdx = 0; ; ++btIdx) {
+            step = deltaX;
+            step *= lambda;
+
+            Scalar merit = 0.0;
+            Scalar newMerit = std::numeric_limits<Scalar>::infinity();
+            Scalar predictedMerit = 0.0;
+            bool isBounded = false;
+            try {
+                update_<MaterialLaw>(fluidState, paramCache, matParams, step, boundScale, &isBounded);
+
+                // the residual predicted by the linearization for the applied step
+                predictedB = b;
+                for (unsigned pvIdx = 0; pvIdx < numEq; ++ pvIdx) {
+                    const auto& dx =
+                        getQuantity_(origFluidState, pvIdx) - getQuantity_(fluidState, pvIdx);
+                    for (unsigned eqIdx = 0; eqIdx < numEq; ++ eqIdx)
+                        predictedB[eqIdx] -= J[eqIdx][pvIdx]*dx;
+                }
+
+                calculateDefect_(newB, fluidState, fluidState, globalMolarities);
+
+                Scalar pressureScale = pressureScale_(fluidState);
+                merit = meritFunction_(b, pressureScale, molarityScale);
+                newMerit = meritFunction_(newB, pressureScale, molarityScale);
+                predictedMerit = meritFunction_(predictedB, pressureScale, molarityScale);
+            }
+            catch (const NumericalProblem&) {
+                // the fluid system cannot cope with the trial solution. treat it like
+                // a step which increases the residual
+            }
+            if (!std::isfinite(newMerit))
+                newMerit = std::numeric_limits<Scalar>::infinity();
+
+            Scalar predictedReduction = merit - predictedMerit;
+            Scalar actualReduction = merit - newMerit;
+            bool sufficientDecrease =
+                predictedReduction > 0
+                && actualReduction >= params.armijoParameter*predictedReduction;
+
+            if (sufficientDecrease) {
+                if (trustRegionRadius > 0) {
+                    Scalar ratio = actualReduction/predictedReduction;
+                    if (ratio < 0.25)
+                        trustRegionRadius /= 2;
+                    else if (ratio > 0.75 && isBounded && lambda == 1.0)
+                        trustRegionRadius = std::min(2*trustRegionRadius, params.trustRegionRadius);
+                }
+                break;
+            }
+
+            if (btIdx >= params.maxBacktrackingSteps) {
+                // no acceptable step was found. this happens if the Newton direction
+                // is not a descent direction of the residual, e.g. when the active
+                // set of the NCP constraints changes. fall back to the bounded Newton
+                // step and let the next iteration deal with it.
+                fluidState = origFluidState;
+                paramCache = origParamCache;
+                update_<MaterialLaw>(fluidState, paramCache, matParams, deltaX, initialBoundScale);
+                if (trustRegionRadius > 0)
+                    trustRegionRadius = params.trustRegionRadius;
+                break;
+            }
+
+            // reject the step
+            fluidState = origFluidState;
+            paramCache = origParamCache;
+            if (stats)
+                ++ stats->numBacktrackingSteps;
+
+            if (params.lineSearch)
+                lambda /= 2;
+            else {
+                // trust region only: shrink the bounds and evaluate the resulting step
+                // like the ones of the line search
+                trustRegionRadius = std::max<Scalar>(trustRegionRadius/4, 1e-10);
+                boundScale = trustRegionRadius;
+            }
+        }
+
+        return relError;
+    }
+
+    // run the tangent plane analysis of a fluid of the overall composition z at a given
+    // pressure. returns the index of the most unstable phase, or the index of the phase
+    // of lowest Gibbs energy if the fluid is stable. if the Gibbs energy is not finite
+    // for any phase, numPhases is returned.
+    template <class FluidState>
+    static unsigned analyzeStability_(CompositionVector *W,
+                                      unsigned &refPhaseIdx,
+                                      FluidState &fluidState,
+                                      ParameterCache &paramCache,
+                                      const CompositionVector &z,
+                                      Scalar p)
+    {
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++ phaseIdx) {
+            fluidState.setPressure(phaseIdx, p);
+            for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+                fluidState.setMoleFraction(phaseIdx, compIdx, z[compIdx]);
+        }
         paramCache.updateAll(fluidState);
 
-        typedef NullMaterialTraits<Scalar, numPhases> MaterialTraits;
-        typedef NullMaterial<MaterialTraits> MaterialLaw;
-        typedef typename MaterialLaw::Params MaterialLawParams;
+        // find the phase with the lowest Gibbs energy for the overall composition. The
+        // logarithms of its fugacities (divided by the pressure) define the tangent
+        // plane.
+        refPhaseIdx = 0;
+        Scalar minGibbsEnergy = std::numeric_limits<Scalar>::infinity();
+        CompositionVector lnPhi, d(0.0);
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++ phaseIdx) {
+            computeLnFugacityCoefficients_(lnPhi, fluidState, paramCache, phaseIdx, z);
 
-        MaterialLawParams matParams;
-        solve<MaterialLaw>(fluidState, paramCache, matParams, globalMolarities, tolerance);
+            Scalar g = 0.0;
+            for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+                if (z[compIdx] > 0)
+                    g += z[compIdx]*(std::log(z[compIdx]) + lnPhi[compIdx]);
+
+            if (std::isfinite(g) && g < minGibbsEnergy) {
+                minGibbsEnergy = g;
+                refPhaseIdx = phaseIdx;
+                for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+                    d[compIdx] = (z[compIdx] > 0)?(std::log(z[compIdx]) + lnPhi[compIdx]):0.0;
+            }
+        }
+
+        if (!std::isfinite(minGibbsEnergy))
+            return numPhases;
+
+        // tangent plane analysis of all other phases. W are the mole numbers at the
+        // stationary points, the mixture is unstable if their sum exceeds 1.
+        unsigned trialPhaseIdx = refPhaseIdx;
+        Scalar maxSumW = 1.0 + 1e-8;
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++ phaseIdx) {
+            if (phaseIdx == refPhaseIdx)
+                continue;
+
+            Scalar sumW = findStationaryPoint_(W[phaseIdx], fluidState, paramCache, phaseIdx, z, d);
+            if (sumW > maxSumW) {
+                maxSumW = sumW;
+                trialPhaseIdx = phaseIdx;
+            }
+        }
+
+        return trialPhaseIdx;
     }
 
+    // determine the compositions of the absent phases of a single-phase fluid for
+    // which the fugacities of all components are the same as in the present phase,
+    // i.e., x_i*phi_i(x) = z_i*phi_i^ref(z). the fugacity coefficients are evaluated
+    // at the unnormalized compositions, like in the equations of the flash problem.
+    // the compositions of the fluid state are used as the initial guess.
+    template <class FluidState>
+    static void updateAbsentPhases_(FluidState &fluidState,
+                                    ParameterCache &paramCache,
+                                    unsigned refPhaseIdx,
+                                    const CompositionVector &z)
+    {
+        CompositionVector lnPhi, d;
+        computeLnFugacityCoefficients_(lnPhi, fluidState, paramCache, refPhaseIdx, z);
+        for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+            d[compIdx] = (z[compIdx] > 0)?(std::log(z[compIdx]) + lnPhi[compIdx]):0.0;
+
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++ phaseIdx) {
+            if (phaseIdx == refPhaseIdx)
+                continue;
+
+            CompositionVector x, lnX, lnXNew, lastDelta(0.0);
+            for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+                lnX[compIdx] = std::log(std::max<Scalar>(fluidState.moleFraction(phaseIdx, compIdx), 1e-100));
+
+            const int nMax = 100;
+            for (int nIdx = 0; nIdx < nMax; ++nIdx) {
+                for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+                    x[compIdx] = (z[compIdx] > 0)?std::exp(lnX[compIdx]):0.0;
+
+                computeLnFugacityCoefficients_(lnPhi, fluidState, paramCache, phaseIdx, x);
+                // the steps are damped because the cubic equation of state may
+                // otherwise flip between its roots from one step to the next
+                for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+                    lnXNew[compIdx] =
+                        (z[compIdx] > 0)?((lnX[compIdx] + d[compIdx] - lnPhi[compIdx])/2):0.0;
+
+                if (!(acceleratedSubstitution_(lnX, lnXNew, lastDelta, nIdx) >= 1e-12))
+                    break;
+            }
+
+            for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx) {
+                Scalar xi = (z[compIdx] > 0)?std::exp(lnX[compIdx]):0.0;
+                fluidState.setMoleFraction(phaseIdx, compIdx, std::isfinite(xi)?xi:0.0);
+            }
+            paramCache.updatePhase(fluidState, phaseIdx);
+        }
+
+        for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+            fluidState.setMoleFraction(refPhaseIdx, compIdx, z[compIdx]);
+        paramCache.updatePhase(fluidState, refPhaseIdx);
+    }
+
+    // calculate the pressure for which the phases of the fluid state occupy the volume
+    // given by the total molarity if their compositions and molar fractions are
+    // fixed. this uses Newton's method for the logarithms of the pressure and of the
+    // volume with derivatives approximated by finite differences.
+    template <class FluidState>
+    static Scalar consistentPressure_(FluidState &fluidState,
+                                      ParameterCache &paramCache,
+                                      const Scalar *phaseFraction,
+                                      Scalar sumMoles,
+                                      Scalar p)
+    {
+        const Scalar eps = 1e-6;
+        Scalar lnP = std::log(p);
+        for (int nIdx = 0; nIdx < 20; ++nIdx) {
+            Scalar f = std::log(sumMoles*molarVolume_(fluidState, paramCache, phaseFraction, std::exp(lnP)));
+            Scalar fEps = std::log(sumMoles*molarVolume_(fluidState, paramCache, phaseFraction, std::exp(lnP + eps)));
+            Scalar df = (fEps - f)/eps;
+            if (!std::isfinite(f) || !(df < 0))
+                break;
+
+            // limit the change of the pressure to a factor of e per iteration
+            Scalar delta = std::max<Scalar>(-1.0, std::min<Scalar>(1.0, f/df));
+            lnP -= delta;
+            if (std::abs(delta) < 1e-8)
+                break;
+        }
+
+        return std::exp(lnP);
+    }
+
+    // the volume occupied by one mole of the fluid at a given pressure
+    template <class FluidState>
+    static Scalar molarVolume_(FluidState &fluidState,
+                               ParameterCache &paramCache,
+                               const Scalar *phaseFraction,
+                               Scalar p)
+    {
+        Scalar volume = 0.0;
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++ phaseIdx) {
+            if (phaseFraction[phaseIdx] <= 0)
+                continue;
+
+            fluidState.setPressure(phaseIdx, p);
+            paramCache.updatePhase(fluidState, phaseIdx);
+            Scalar rho = FluidSystem::density(fluidState, paramCache, phaseIdx);
+            volume += phaseFraction[phaseIdx]*fluidState.averageMolarMass(phaseIdx)/rho;
+        }
+
+        return volume;
+    }
+
+    // calculate the logarithms of the fugacity coefficients of all components in a
+    // phase of a given composition
+    template <class FluidState>
+    static void computeLnFugacityCoefficients_(CompositionVector &lnPhi,
+                                               FluidState &fluidState,
+                                               ParameterCache &paramCache,
+                                               unsigned phaseIdx,
+                                               const CompositionVector &x)
+    {
+        for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+            fluidState.setMoleFraction(phaseIdx, compIdx, x[compIdx]);
+        paramCache.updatePhase(fluidState, phaseIdx);
+
+        Scalar phi[numComponents];
+        FluidSystem::fugacityCoefficients(phi, fluidState, paramCache, phaseIdx);
+        for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+            lnPhi[compIdx] = std::log(phi[compIdx]);
+    }
+
+    // do a successive substitution step for the logarithms of the quantities u. every
+    // few steps, the step is extrapolated using the dominant eigenvalue of the
+    // iteration (Crowe and Nishio, 1975). the return value is the maximum change.
+    static Scalar acceleratedSubstitution_(CompositionVector &u,
+                                           const CompositionVector &uNew,
+                                           CompositionVector &lastDelta,
+                                           unsigned iterIdx)
+    {
+        CompositionVector delta(uNew);
+        delta -= u;
+
+        Scalar maxDelta = 0.0;
+        for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+            maxDelta = std::max(maxDelta, std::abs(delta[compIdx]));
+
+        u = uNew;
+        if (iterIdx % 5 == 4) {
+            Scalar lambda = (delta*delta)/(lastDelta*delta);
+            if (std::isfinite(lambda) && 0.0 < lambda && lambda < 0.95)
+                u.axpy(lambda/(1.0 - lambda), delta);
+        }
+        lastDelta = delta;
+
+        return maxDelta;
+    }
+
+    // find the stationary point of the tangent plane distance function of a trial
+    // phase. returns the sum of the mole numbers at the stationary point.
+    template <class FluidState>
+    static Scalar findStationaryPoint_(CompositionVector &W,
+                                       FluidState &fluidState,
+                                       ParameterCache &paramCache,
+                                       unsigned phaseIdx,
+                                       const CompositionVector &z,
+                                       const CompositionVector &d)
+    {
+        // start with the ideal solution estimate, i.e., the fugacity coefficients of
+        // the trial phase at the overall composition
+        CompositionVector lnPhi, lnW, lnWNew, lastDelta(0.0);
+        computeLnFugacityCoefficients_(lnPhi, fluidState, paramCache, phaseIdx, z);
+        for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+            lnW[compIdx] = d[compIdx] - lnPhi[compIdx];
+
+        Scalar sumW = 0.0;
+        const int nMax = 100;
+        for (int nIdx = 0; nIdx < nMax; ++nIdx) {
+            sumW = 0.0;
+            for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx) {
+                W[compIdx] = (z[compIdx] > 0)?std::exp(lnW[compIdx]):0.0;
+                sumW += W[compIdx];
+            }
+
+            CompositionVector x(W);
+            x /= sumW;
+            computeLnFugacityCoefficients_(lnPhi, fluidState, paramCache, phaseIdx, x);
+            for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+                lnWNew[compIdx] = (z[compIdx] > 0)?(d[compIdx] - lnPhi[compIdx]):0.0;
+
+            if (acceleratedSubstitution_(lnW, lnWNew, lastDelta, nIdx) < 1e-10)
+                break;
+        }
+
+        sumW = 0.0;
+        Scalar distToFeed = 0.0;
+        for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx) {
+            W[compIdx] = (z[compIdx] > 0)?std::exp(lnW[compIdx]):0.0;
+            sumW += W[compIdx];
+        }
+        for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+            distToFeed += std::pow(W[compIdx]/sumW - z[compIdx], 2);
+
+        // the trivial solution does not indicate an instability
+        if (distToFeed < 1e-10)
+            return std::min<Scalar>(1.0, sumW);
+
+        return sumW;
+    }
+
+    // two-phase flash at constant pressure using accelerated successive substitution
+    // of the K-values. returns the molar fraction of the second phase.
+    template <class FluidState>
+    static Scalar splitTwoPhases_(CompositionVector &x,
+                                  CompositionVector &y,
+                                  FluidState &fluidState,
+                                  ParameterCache &paramCache,
+                                  unsigned xPhaseIdx,
+                                  unsigned yPhaseIdx,
+                                  const CompositionVector &z,
+                                  const CompositionVector &W)
+    {
+        Scalar sumW = 0.0;
+        for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+            sumW += W[compIdx];
+
+        // the initial K-values are given by the stationary point of the trial phase
+        CompositionVector lnK, lnKNew, lnPhiX, lnPhiY, lastDelta(0.0);
+        for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+            lnK[compIdx] = (z[compIdx] > 0)?std::log(W[compIdx]/sumW/z[compIdx]):0.0;
+
+        Scalar nu = 0.5;
+        const int nMax = 20;
+        for (int nIdx = 0; nIdx < nMax; ++nIdx) {
+            CompositionVector K;
+            for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+                K[compIdx] = std::exp(lnK[compIdx]);
+
+            nu = solveRachfordRice_(K, z, nu);
+            for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx) {
+                x[compIdx] = z[compIdx]/(1.0 + nu*(K[compIdx] - 1.0));
+                y[compIdx] = K[compIdx]*x[compIdx];
+            }
+
+            if (nu <= 0.0 || nu >= 1.0)
+                // one of the phases vanishes for these K-values. leave it to the
+                // Newton method to sort things out.
+                break;
+
+            computeLnFugacityCoefficients_(lnPhiX, fluidState, paramCache, xPhaseIdx, x);
+            computeLnFugacityCoefficients_(lnPhiY, fluidState, paramCache, yPhaseIdx, y);
+            for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+                lnKNew[compIdx] = (z[compIdx] > 0)?(lnPhiX[compIdx] - lnPhiY[compIdx]):0.0;
+
+            if (acceleratedSubstitution_(lnK, lnKNew, lastDelta, nIdx) < 1e-8)
+                break;
+        }
+
+        return nu;
+    }
+
+    // solve the Rachford-Rice equation for the molar fraction of the second phase
+    // using Newton's method safeguarded by bisection. the result is limited to [0, 1].
+    static Scalar solveRachfordRice_(const CompositionVector &K,
+                                     const CompositionVector &z,
+                                     Scalar nu)
+    {
+        Scalar nuMin = 0.0;
+        Scalar nuMax = 1.0;
+        if (rachfordRice_(K, z, nuMin) <= 0.0)
+            return nuMin;
+        if (rachfordRice_(K, z, nuMax) >= 0.0)
+            return nuMax;
+
+        for (int nIdx = 0; nIdx < 50; ++nIdx) {
+            // the Rachford-Rice function is monotonically decreasing
+            Scalar f = 0.0, df = 0.0;
+            for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx) {
+                Scalar tmp = (K[compIdx] - 1.0)/(1.0 + nu*(K[compIdx] - 1.0));
+                f += z[compIdx]*tmp;
+                df -= z[compIdx]*tmp*tmp;
+            }
+
+            if (f > 0.0)
+                nuMin = nu;
+            else
+                nuMax = nu;
+
+            Scalar nuNew = nu - f/df;
+            if (!(nuMin < nuNew && nuNew < nuMax))
+                nuNew = (nuMin + nuMax)/2;
+
+            if (std::abs(nuNew - nu) < 1e-12)
+                return nuNew;
+            nu = nuNew;
+        }
+
+        return nu;
+    }
+
+    static Scalar rachfordRice_(const CompositionVector &K,
+                                const CompositionVector &z,
+                                Scalar nu)
+    {
+        Scalar f = 0.0;
+        for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+            f += z[compIdx]*(K[compIdx] - 1.0)/(1.0 + nu*(K[compIdx] - 1.0));
+        return f;
+    }
 
-protected:
     template <class FluidState>
     static void printFluidState_(const FluidState &fluidState)
     {
@@ -446,11 +1576,16 @@ protected:
     static Scalar update_(FluidState &fluidState,
                           ParameterCache &paramCache,
                           const typename MaterialLaw::Params &matParams,
-                          const Vector &deltaX)
+                          const Vector &deltaX,
+                          Scalar boundScale = 1.0,
+                          bool *isBounded = 0)
     {
         typedef typename FluidState::Scalar Evaluation;
         typedef Opm::MathToolbox<Evaluation> Toolbox;
 
+        if (isBounded)
+            *isBounded = false;
+
         // make sure we don't swallow non-finite update vectors
 #ifndef NDEBUG
         assert(deltaX.dimension == numEq);
@@ -467,20 +1602,26 @@ protected:
                                         std::abs(Toolbox::value(delta))
                                         * quantityWeight_(fluidState, pvIdx));
 
+            // the bounds are scaled by the trust region (if any)
+            Evaluation maxDelta;
             if (isSaturationIdx_(pvIdx)) {
                 // dampen to at most 25% change in saturation per iteration
-                delta = Toolbox::min(0.25, Toolbox::max(-0.25, delta));
+                maxDelta = 0.25*boundScale;
             }
             else if (isMoleFracIdx_(pvIdx)) {
                 // dampen to at most 20% change in mole fraction per iteration
-                delta = Toolbox::min(0.20, Toolbox::max(-0.20, delta));
+                maxDelta = 0.20*boundScale;
             }
-            else if (isPressureIdx_(pvIdx)) {
+            else {
+                assert(isPressureIdx_(pvIdx));
                 // dampen to at most 50% change in pressure per iteration
-                delta = Toolbox::min(0.5*fluidState.pressure(0),
-                                     Toolbox::max(-0.5*fluidState.pressure(0), delta));
+                maxDelta = 0.5*boundScale*fluidState.pressure(0);
             }
 
+            if (isBounded && std::abs(Toolbox::value(delta)) > Toolbox::value(maxDelta))
+                *isBounded = true;
+            delta = Toolbox::min(maxDelta, Toolbox::max(-maxDelta, delta));
+
             setQuantityRaw_(fluidState, pvIdx, tmp - delta);
         }
 
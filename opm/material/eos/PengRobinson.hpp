@@ -30,12 +30,16 @@
 
 #include <opm/material/fluidstates/TemperatureOverlayFluidState.hpp>
 #include <opm/material/IdealGas.hpp>
-#include <opm/material/common/UniformTabulated2DFunction.hpp>
 
 #include <opm/material/common/Unused.hpp>
 #include <opm/material/common/PolynomialUtils.hpp>
+#include <opm/material/common/MathToolbox.hpp>
 
+#include <algorithm>
+#include <cmath>
 #include <csignal>
+#include <limits>
+#include <type_traits>
 
 namespace Opm {
 
@@ -62,32 +66,49 @@ class PengRobinson
     { }
 
 public:
-    static void  init(Scalar /*aMin*/, Scalar /*aMax*/, unsigned /*na*/,
-                      Scalar /*bMin*/, Scalar /*bMax*/, unsigned /*nb*/)
-    {
-/*
-        // resize the tabulation for the critical points
-        criticalTemperature_.resize(aMin, aMax, na, bMin, bMax, nb);
-        criticalPressure_.resize(aMin, aMax, na, bMin, bMax, nb);
-        criticalMolarVolume_.resize(aMin, aMax, na, bMin, bMax, nb);
-
-        Scalar VmCrit, pCrit, TCrit;
-        for (unsigned i = 0; i < na; ++i) {
-            Scalar a = criticalTemperature_.iToX(i);
-            assert(std::abs(criticalTemperature_.xToI(criticalTemperature_.iToX(i)) - i) < 1e-10);
-
-            for (unsigned j = 0; j < nb; ++j) {
-                Scalar b = criticalTemperature_.jToY(j);
-                assert(std::abs(criticalTemperature_.yToJ(criticalTemperature_.jToY(j)) - j) < 1e-10);
+    /*!
+     * \brief Initialize the Peng-Robinson EOS.
+     *
+     * The critical point of the EOS is available in closed form (see
+     * computeCriticalPoint()), so nothing needs to be tabulated. The arguments specify
+     * the range of the attractive and repulsive parameters which was used for the
+     * tabulation in the past; they are ignored.
+     */
+    static void init(Scalar /*aMin*/, Scalar /*aMax*/, unsigned /*na*/,
+                     Scalar /*bMin*/, Scalar /*bMax*/, unsigned /*nb*/)
+    { }
 
-                findCriticalPoint_(TCrit, pCrit, VmCrit,  a, b);
+    /*!
+     * \brief Computes the critical point of the EOS for given attractive and repulsive
+     *        parameters.
+     *
+     * At the critical point, the first and the second derivatives of the pressure with
+     * regard to the molar volume are zero. For constant parameters, this yields
+     *
+     * \f[ V_{crit} = b\,(1 + \sqrt[3]{4 - \sqrt{8}} + \sqrt[3]{4 + \sqrt{8}}) \f]
+     *
+     * and the critical temperature and pressure follow from the two conditions. The
+     * result is the same as that of the iterative search for the isotherm where the
+     * extrema of the EOS coincide, but it is exact and much cheaper.
+     *
+     * \param Tcrit The critical temperature [K]
+     * \param pcrit The critical pressure [Pa]
+     * \param Vcrit The critical molar volume [m^3/mol]
+     * \param a The attractive parameter
+     * \param b The co-volume [m^3/mol]
+     */
+    static void computeCriticalPoint(Scalar &Tcrit,
+                                     Scalar &pcrit,
+                                     Scalar &Vcrit,
+                                     Scalar a,
+                                     Scalar b)
+    {
+        Vcrit = criticalVolumeFactor_()*b;
 
-                criticalTemperature_.setSamplePoint(i, j, TCrit);
-                criticalPressure_.setSamplePoint(i, j, pCrit);
-                criticalMolarVolume_.setSamplePoint(i, j, VmCrit);
-            }
-        }
-        */
+        // dp/dV = 0 yields the temperature, the EOS the pressure
+        Scalar denom = Vcrit*(Vcrit + 2*b) - b*b;
+        Tcrit = 2*a*(Vcrit + b)*(Vcrit - b)*(Vcrit - b)/(R*denom*denom);
+        pcrit = R*Tcrit/(Vcrit - b) - a/denom;
     }
 
     /*!
@@ -139,92 +160,138 @@ public:
     /*!
      * \brief Computes molar volumes where the Peng-Robinson EOS is
      *        true.
+     *
+     * The temperature and pressure of the fluid state as well as the attractive and
+     * repulsive parameters may be function evaluations for automatic
+     * differentiation. In this case, the EOS is solved for the values and the
+     * derivatives of the molar volume are obtained by implicit differentiation of
+     * the relation which determines it, i.e., of the cubic polynomial for the
+     * compressibility factor if the molar volume is one of its roots.
      */
-    template <class FluidState, class Params>
-    static Scalar computeMolarVolume(const FluidState &fs,
-                                     Params &params,
-                                     unsigned phaseIdx,
-                                     bool isGasPhase)
+    template <class FluidState, class Params, class Evaluation = typename FluidState::Scalar>
+    static Evaluation computeMolarVolume(const FluidState &fs,
+                                         Params &params,
+                                         unsigned phaseIdx,
+                                         bool isGasPhase)
     {
+        typedef Opm::MathToolbox<Evaluation> Toolbox;
+
         Valgrind::CheckDefined(fs.temperature(phaseIdx));
         Valgrind::CheckDefined(fs.pressure(phaseIdx));
 
-        Scalar Vm = 0;
-        Valgrind::SetUndefined(Vm);
+        const Evaluation& T = toLhs_<Evaluation>(fs.temperature(phaseIdx));
+        const Evaluation& p = toLhs_<Evaluation>(fs.pressure(phaseIdx));
 
-        Scalar T = fs.temperature(phaseIdx);
-        Scalar p = fs.pressure(phaseIdx);
+        const Evaluation& a = toLhs_<Evaluation>(params.a(phaseIdx)); // "attractive factor"
+        const Evaluation& b = toLhs_<Evaluation>(params.b(phaseIdx)); // "co-volume"
 
-        Scalar a = params.a(phaseIdx); // "attractive factor"
-        Scalar b = params.b(phaseIdx); // "co-volume"
+        Scalar TValue = Toolbox::value(T);
+        Scalar pValue = Toolbox::value(p);
+        Scalar aValue = Toolbox::value(a);
+        Scalar bValue = Toolbox::value(b);
 
-        if (!std::isfinite(a) || std::abs(a) < 1e-30)
+        if (!std::isfinite(aValue) || std::abs(aValue) < 1e-30)
             return std::numeric_limits<Scalar>::quiet_NaN();
-        if (!std::isfinite(b) || b <= 0)
+        if (!std::isfinite(bValue) || bValue <= 0)
             return std::numeric_limits<Scalar>::quiet_NaN();
 
-        Scalar RT= R*T;
-        Scalar Astar = a*p/(RT*RT);
-        Scalar Bstar = b*p/RT;
+        Scalar RT = R*TValue;
+        Scalar Astar = aValue*pValue/(RT*RT);
+        Scalar Bstar = bValue*pValue/RT;
 
-        Scalar a1 = 1.0;
         Scalar a2 = - (1 - Bstar);
         Scalar a3 = Astar - Bstar*(3*Bstar + 2);
         Scalar a4 = Bstar*(- Astar + Bstar*(1 + Bstar));
 
-        // ignore the first two results if the smallest
-        // compressibility factor is <= 0.0. (this means that if we
-        // would get negative molar volumes for the liquid phase, we
-        // consider the liquid phase non-existant.)
-        Scalar Z[3] = {0.0,0.0,0.0};
-        Valgrind::CheckDefined(a1);
+        // use the same root solver as computeMolarVolumes() so that the scalar and
+        // the batched code paths yield identical results
+        Scalar ZMin, ZMax;
+        int numSol;
         Valgrind::CheckDefined(a2);
         Valgrind::CheckDefined(a3);
         Valgrind::CheckDefined(a4);
-        int numSol = invertCubicPolynomial(Z, a1, a2, a3, a4);
-        if (numSol == 3) {
-            // the EOS has three intersections with the pressure,
-            // i.e. the molar volume of gas is the largest one and the
-            // molar volume of liquid is the smallest one
-            if (isGasPhase)
-                Vm = Z[2]*RT/p;
-            else
-                Vm = Z[0]*RT/p;
-        }
-        else if (numSol == 1) {
-            // the EOS only has one intersection with the pressure,
-            // for the other phase, we take the extremum of the EOS
-            // with the largest distance from the intersection.
-            Scalar VmCubic = Z[0]*RT/p;
-            Vm = VmCubic;
-
-            // find the extrema (if they are present)
-            Scalar Vmin, Vmax, pmin, pmax;
-            if (findExtrema_(Vmin, Vmax,
-                             pmin, pmax,
-                             a, b, T))
-            {
-                if (isGasPhase)
-                    Vm = std::max(Vmax, VmCubic);
-                else {
-                    if (Vmin > 0)
-                        Vm = std::min(Vmin, VmCubic);
-                    else
-                        Vm = VmCubic;
-                }
-            }
-            else {
-                // the EOS does not exhibit any physically meaningful
-                // extrema, and the fluid is critical...
-                Vm = VmCubic;
-                handleCriticalFluid_(Vm, fs, params, phaseIdx, isGasPhase);
-            }
-        }
+        invertCubicPolynomials(&ZMin, &ZMax, &numSol, &a2, &a3, &a4, /*n=*/1);
+        MolarVolumeSource source;
+        Scalar Vm = selectMolarVolume_(ZMin, ZMax, numSol,
+                                       aValue, bValue, TValue, pValue,
+                                       isGasPhase, source);
 
         Valgrind::CheckDefined(Vm);
         assert(std::isfinite(Vm));
         assert(Vm > 0);
-        return Vm;
+        return molarVolumeDerivatives_(Vm, source, T, p, a, b);
+    }
+
+    /*!
+     * \brief Computes the molar volumes of many fluid phases at once.
+     *
+     * The phases are specified by arrays of their temperatures, pressures and
+     * Peng-Robinson parameters. The compressibility factors of all phases are
+     * computed by invertCubicPolynomials() and the root is selected the same way as in
+     * computeMolarVolume(): If the EOS has three real roots, the largest one is used
+     * for gas phases and the smallest one for liquid phases. For the remaining
+     * phases, the extrema of the EOS are considered, which is done one phase at a
+     * time. For invalid parameters, the molar volume is NaN.
+     *
+     * \param Vm Array into which the molar volumes are written [m^3/mol]
+     * \param T The temperatures of the phases [K]
+     * \param p The pressures of the phases [Pa]
+     * \param a The attractive parameters of the phases
+     * \param b The co-volumes of the phases
+     * \param isGasPhase Specifies for each phase whether it is a gas or a liquid
+     * \param n The number of phases
+     */
+    static void computeMolarVolumes(Scalar *Vm,
+                                    const Scalar *T,
+                                    const Scalar *p,
+                                    const Scalar *a,
+                                    const Scalar *b,
+                                    const bool *isGasPhase,
+                                    unsigned n)
+    {
+        // process the phases in chunks which fit on the stack
+        const unsigned chunkSize = 64;
+        Scalar a2[chunkSize], a3[chunkSize], a4[chunkSize];
+        Scalar ZMin[chunkSize], ZMax[chunkSize];
+        int numSol[chunkSize];
+        MolarVolumeSource source;
+
+        for (unsigned offset = 0; offset < n; offset += chunkSize) {
+            unsigned m = std::min(chunkSize, n - offset);
+
+            // the coefficients of the cubic for the compressibility factor
+            for (unsigned i = 0; i < m; ++i) {
+                Scalar RT = R*T[offset + i];
+                Scalar Astar = a[offset + i]*p[offset + i]/(RT*RT);
+                Scalar Bstar = b[offset + i]*p[offset + i]/RT;
+
+                a2[i] = - (1 - Bstar);
+                a3[i] = Astar - Bstar*(3*Bstar + 2);
+                a4[i] = Bstar*(- Astar + Bstar*(1 + Bstar));
+            }
+
+            invertCubicPolynomials(ZMin, ZMax, numSol, a2, a3, a4, m);
+
+            for (unsigned i = 0; i < m; ++i) {
+                unsigned phaseIdx = offset + i;
+                Scalar RT = R*T[phaseIdx];
+                if (!std::isfinite(a[phaseIdx]) || std::abs(a[phaseIdx]) < 1e-30
+                    || !std::isfinite(b[phaseIdx]) || b[phaseIdx] <= 0)
+                    Vm[phaseIdx] = std::numeric_limits<Scalar>::quiet_NaN();
+                else if (numSol[i] == 3)
+                    Vm[phaseIdx] = (isGasPhase[phaseIdx]?ZMax[i]:ZMin[i])*RT/p[phaseIdx];
+                else
+                    Vm[phaseIdx] = selectMolarVolume_(ZMin[i],
+                                                      ZMax[i],
+                                                      numSol[i],
+                                                      a[phaseIdx],
+                                                      b[phaseIdx],
+                                                      T[phaseIdx],
+                                                      p[phaseIdx],
+                                                      isGasPhase[phaseIdx],
+                                                      source);
+            }
+        }
     }
 
     /*!
@@ -274,22 +341,168 @@ public:
     { return params.pressure()*computeFugacityCoeff(params); }
 
 protected:
-    template <class FluidState, class Params>
-    static void handleCriticalFluid_(Scalar &Vm,
-                                     const FluidState &/*fs*/,
-                                     const Params &params,
-                                     unsigned phaseIdx,
-                                     bool isGasPhase)
+    // the relation which determines the molar volume of a phase
+    enum MolarVolumeSource {
+        cubicRoot, // a root of the cubic for the compressibility factor
+        eosExtremum, // an extremum of the isotherm
+        criticalVolume // the critical molar volume
+    };
+
+    // select the molar volume of a phase from the smallest and the largest
+    // compressibility factors of the EOS
+    static Scalar selectMolarVolume_(Scalar ZMin,
+                                     Scalar ZMax,
+                                     int numSol,
+                                     Scalar a,
+                                     Scalar b,
+                                     Scalar T,
+                                     Scalar p,
+                                     bool isGasPhase,
+                                     MolarVolumeSource &source)
+    {
+        Scalar RT = R*T;
+        Scalar Vm = 0;
+        source = cubicRoot;
+        if (numSol == 3) {
+            // the EOS has three intersections with the pressure,
+            // i.e. the molar volume of gas is the largest one and the
+            // molar volume of liquid is the smallest one
+            if (isGasPhase)
+                Vm = ZMax*RT/p;
+            else
+                Vm = ZMin*RT/p;
+        }
+        else if (numSol == 1) {
+            // the EOS only has one intersection with the pressure,
+            // for the other phase, we take the extremum of the EOS
+            // with the largest distance from the intersection.
+            Scalar VmCubic = ZMin*RT/p;
+            Vm = VmCubic;
+
+            // find the extrema (if they are present)
+            Scalar Vmin, Vmax, pmin, pmax;
+            if (findExtrema_(Vmin, Vmax,
+                             pmin, pmax,
+                             a, b, T))
+            {
+                if (isGasPhase)
+                    Vm = std::max(Vmax, VmCubic);
+                else {
+                    if (Vmin > 0)
+                        Vm = std::min(Vmin, VmCubic);
+                    else
+                        Vm = VmCubic;
+                }
+
+                if (Vm != VmCubic)
+                    source = eosExtremum;
+            }
+            else {
+                // the EOS does not exhibit any physically meaningful
+                // extrema, and the fluid is critical...
+                Vm = VmCubic;
+                handleCriticalFluid_(Vm, a, b, isGasPhase);
+
+                if (Vm != VmCubic)
+                    source = criticalVolume;
+            }
+        }
+
+        return Vm;
+    }
+
+    // attach the derivatives to a molar volume which was determined from the values
+    // of the temperature, the pressure and the Peng-Robinson parameters. the
+    // derivatives are obtained by implicit differentiation of the relation which
+    // determines the molar volume.
+    template <class Evaluation>
+    static Evaluation molarVolumeDerivatives_(Scalar Vm,
+                                             MolarVolumeSource source,
+                                             const Evaluation& T,
+                                             const Evaluation& p,
+                                             const Evaluation& a,
+                                             const Evaluation& b)
     {
-        Scalar Tcrit, pcrit, Vcrit;
-        findCriticalPoint_(Tcrit,
-                           pcrit,
-                           Vcrit,
-                           params.a(phaseIdx),
-                           params.b(phaseIdx));
+        typedef Opm::MathToolbox<Evaluation> Toolbox;
+
+        // without derivatives, the molar volume must be returned unmodified. (e.g.,
+        // converting it to a compressibility factor and back is not exact.)
+        if (std::is_same<Evaluation, Scalar>::value)
+            return Vm;
+
+        const Evaluation& RT = R*T;
+        if (source == cubicRoot) {
+            // F(Z; A*, B*) = 0 for the compressibility factor Z. with F evaluated at the
+            // fixed value of Z, the derivatives of Z are -(dF/dx)/(dF/dZ).
+            const Evaluation& Astar = a*p/(RT*RT);
+            const Evaluation& Bstar = b*p/RT;
+
+            const Evaluation& a2 = - (1 - Bstar);
+            const Evaluation& a3 = Astar - Bstar*(3*Bstar + 2);
+            const Evaluation& a4 = Bstar*(- Astar + Bstar*(1 + Bstar));
+
+            Scalar Z = Vm*Toolbox::value(p)/Toolbox::value(RT);
+            const Evaluation& F = a4 + Z*(a3 + Z*(a2 + Z));
+            Scalar dF_dZ = Toolbox::value(a3) + Z*(2*Toolbox::value(a2) + 3*Z);
+            if (std::abs(dF_dZ) < 1e-30)
+                return Vm; // double root
+
+            const Evaluation& ZEval = Z + (Toolbox::value(F) - F)/dF_dZ;
+            return ZEval*RT/p;
+        }
+        else if (source == eosExtremum) {
+            // dp/dV = 0 at the extrema of the isotherm. this is equivalent to a root
+            // of a quartic polynomial in the molar volume.
+            Evaluation coeffs[5];
+            extremaPolynomial_(coeffs, a, b, RT);
+
+            const Evaluation& G =
+                coeffs[4] + Vm*(coeffs[3] + Vm*(coeffs[2] + Vm*(coeffs[1] + Vm*coeffs[0])));
+            Scalar dG_dV =
+                Toolbox::value(coeffs[3])
+                + Vm*(2*Toolbox::value(coeffs[2])
+                      + Vm*(3*Toolbox::value(coeffs[1]) + Vm*4*Toolbox::value(coeffs[0])));
+            if (std::abs(dG_dV) < 1e-30)
+                return Vm;
+
+            return Vm + (Toolbox::value(G) - G)/dG_dV;
+        }
+
+        // the critical molar volume of the Peng-Robinson EOS is proportional to the
+        // co-volume
+        assert(source == criticalVolume);
+        return Vm*b/Toolbox::value(b);
+    }
+
+    // the coefficients of the quartic polynomial in the molar volume whose roots
+    // are the extrema of an isotherm of the EOS, highest order first
+    template <class Evaluation>
+    static void extremaPolynomial_(Evaluation *coeffs,
+                                   const Evaluation& a,
+                                   const Evaluation& b,
+                                   const Evaluation& RT)
+    {
+        Scalar u = 2;
+        Scalar w = -1;
 
+        coeffs[0] = RT;
+        coeffs[1] = 2*RT*u*b - 2*a;
+        coeffs[2] = 2*RT*w*b*b + RT*u*u*b*b  + 4*a*b - u*a*b;
+        coeffs[3] = 2*RT*u*w*b*b*b + 2*u*a*b*b - 2*a*b*b;
+        coeffs[4] = RT*w*w*b*b*b*b - u*a*b*b*b;
+    }
 
-        //Scalar Vcrit = criticalMolarVolume_.eval(params.a(phaseIdx), params.b(phaseIdx));
+    // convert a function evaluation or a scalar to the requested type
+    template <class LhsEval, class Eval>
+    static LhsEval toLhs_(const Eval& value)
+    { return Opm::MathToolbox<Eval>::template toLhs<LhsEval>(value); }
+
+    static void handleCriticalFluid_(Scalar &Vm,
+                                     Scalar /*a*/,
+                                     Scalar b,
+                                     bool isGasPhase)
+    {
+        Scalar Vcrit = criticalVolumeFactor_()*b;
 
         if (isGasPhase)
             Vm = std::max(Vm, Vcrit);
@@ -297,98 +510,12 @@ protected:
             Vm = std::min(Vm, Vcrit);
     }
 
-    static void findCriticalPoint_(Scalar &Tcrit,
-                                   Scalar &pcrit,
-                                   Scalar &Vcrit,
-                                   Scalar a,
-                                   Scalar b)
+    // the ratio of the critical molar volume and the co-volume
+    static Scalar criticalVolumeFactor_()
     {
-        Scalar minVm(0);
-        Scalar maxVm(1e100);
-
-        Scalar minP(0);
-        Scalar maxP(1e100);
-
-        // first, we need to find an isotherm where the EOS exhibits
-        // a maximum and a minimum
-        Scalar Tmin = 250; // [K]
-        for (unsigned i = 0; i < 30; ++i) {
-            bool hasExtrema = findExtrema_(minVm, maxVm, minP, maxP, a, b, Tmin);
-            if (hasExtrema)
-                break;
-            Tmin /= 2;
-        };
-
-        Scalar T = Tmin;
-
-        // Newton's method: Start at minimum temperature and minimize
-        // the "gap" between the extrema of the EOS
-        unsigned iMax = 100;
-        for (unsigned i = 0; i < iMax; ++i) {
-            // calculate function we would like to minimize
-            Scalar f = maxVm - minVm;
-
-            // check if we're converged
-            if (f < 1e-10 || (i == iMax - 1 && f < 1e-8)) {
-                Tcrit = T;
-                pcrit = (minP + maxP)/2;
-                Vcrit = (maxVm + minVm)/2;
-                return;
-            }
-
-            // backward differences. Forward differences are not
-            // robust, since the isotherm could be critical if an
-            // epsilon was added to the temperature. (this is case
-            // rarely happens, though)
-            const Scalar eps = - 1e-11;
-            bool OPM_OPTIM_UNUSED hasExtrema = findExtrema_(minVm, maxVm, minP, maxP, a, b, T + eps);
-            assert(hasExtrema);
-            assert(std::isfinite(maxVm));
-            Scalar fStar = maxVm - minVm;
-
-            // derivative of the difference between the maximum's
-            // molar volume and the minimum's molar volume regarding
-            // temperature
-            Scalar fPrime = (fStar - f)/eps;
-            if (std::abs(fPrime) < 1e-40) {
-                Tcrit = T;
-                pcrit = (minP + maxP)/2;
-                Vcrit = (maxVm + minVm)/2;
-                return;
-            }
-
-            // update value for the current iteration
-            Scalar delta = f/fPrime;
-            assert(std::isfinite(delta));
-            if (delta > 0)
-                delta = -10;
-
-            // line search (we have to make sure that both extrema
-            // still exist after the update)
-            for (unsigned j = 0; ; ++j) {
-                if (j >= 20) {
-                    if (f < 1e-8) {
-                        Tcrit = T;
-                        pcrit = (minP + maxP)/2;
-                        Vcrit = (maxVm + minVm)/2;
-                        return;
-                    }
-                    OPM_THROW(NumericalProblem,
-                               "Could not determine the critical point for a=" << a << ", b=" << b);
-                }
-
-                if (findExtrema_(minVm, maxVm, minP, maxP, a, b, T - delta)) {
-                    // if the isotherm for T - delta exhibits two
-                    // extrema the update is finished
-                    T -= delta;
-                    break;
-                }
-                else
-                    delta /= 2;
-            };
-        }
-
-        assert(false);
+        static const Scalar factor =
+            1 + std::cbrt(4 - std::sqrt(8.0)) + std::cbrt(4 + std::sqrt(8.0));
+        return factor;
     }
 
     // find the two molar volumes where the EOS exhibits extrema and
@@ -401,18 +528,17 @@ protected:
                              Scalar b,
                              Scalar T)
     {
-        Scalar u = 2;
-        Scalar w = -1;
-
         Scalar RT = R*T;
 
         // calculate coefficients of the 4th order polynominal in
         // monomial basis
-        Scalar a1 = RT;
-        Scalar a2 = 2*RT*u*b - 2*a;
-        Scalar a3 = 2*RT*w*b*b + RT*u*u*b*b  + 4*a*b - u*a*b;
-        Scalar a4 = 2*RT*u*w*b*b*b + 2*u*a*b*b - 2*a*b*b;
-        Scalar a5 = RT*w*w*b*b*b*b - u*a*b*b*b;
+        Scalar coeffs[5];
+        extremaPolynomial_(coeffs, a, b, RT);
+        Scalar a1 = coeffs[0];
+        Scalar a2 = coeffs[1];
+        Scalar a3 = coeffs[2];
+        Scalar a4 = coeffs[3];
+        Scalar a5 = coeffs[4];
 
         assert(std::isfinite(a1));
         assert(std::isfinite(a2));
@@ -520,28 +646,11 @@ protected:
                                       Scalar VmLiquid,
                                       Scalar VmGas)
     { return fugacity(params, T, p, VmLiquid) - fugacity(params, T, p, VmGas); }
-
-/*
-    static UniformTabulated2DFunction<Scalar> criticalTemperature_;
-    static UniformTabulated2DFunction<Scalar> criticalPressure_;
-    static UniformTabulated2DFunction<Scalar> criticalMolarVolume_;
-*/
 };
 
 template <class Scalar>
 const Scalar PengRobinson<Scalar>::R = Opm::Constants<Scalar>::R;
 
-/*
-template <class Scalar>
-UniformTabulated2DFunction<Scalar> PengRobinson<Scalar>::criticalTemperature_;
-
-template <class Scalar>
-UniformTabulated2DFunction<Scalar> PengRobinson<Scalar>::criticalPressure_;
-
-template <class Scalar>
-UniformTabulated2DFunction<Scalar> PengRobinson<Scalar>::criticalMolarVolume_;
-*/
-
 } // namespace Opm
 
 #endif
@@ -30,7 +30,9 @@
 #include "PengRobinson.hpp"
 
 #include <opm/material/Constants.hpp>
+#include <opm/material/common/MathToolbox.hpp>
 
+#include <algorithm>
 #include <iostream>
 
 namespace Opm {
@@ -56,18 +58,49 @@ class PengRobinsonMixture
 
 public:
     /*!
-     * \brief Computes molar volumes where the Peng-Robinson EOS is
-     *        true.
+     * \brief Computes the molar volumes of a fluid phase for many fluid states at
+     *        once.
      *
-     * \return Number of solutions.
+     * The Peng-Robinson parameters of each fluid state are taken from a parameter
+     * cache which must already be updated for the phase, i.e., its a(phaseIdx) and
+     * b(phaseIdx) methods must return the mixture parameters. The roots of
+     * the EOS are determined for all states by a single call to
+     * PengRobinson::computeMolarVolumes(), which selects the largest root for gas
+     * phases and the smallest one for liquid phases.
+     *
+     * \param Vm Array into which the molar volumes are written [m^3/mol]
+     * \param fluidStates The fluid states which specify the temperature and pressure
+     * \param paramCaches The parameter caches which belong to each fluid state
+     * \param phaseIdx The index of the phase
+     * \param isGasPhase Specifies whether the phase is gaseous
+     * \param numStates The number of fluid states
      */
-    template <class MutableParams, class FluidState>
-    static int computeMolarVolumes(Scalar *Vm,
-                                   const MutableParams &params,
-                                   unsigned phaseIdx,
-                                   const FluidState &fs)
+    template <class FluidState, class ParameterCache>
+    static void computeMolarVolumes(Scalar *Vm,
+                                    const FluidState *fluidStates,
+                                    const ParameterCache *paramCaches,
+                                    unsigned phaseIdx,
+                                    bool isGasPhase,
+                                    unsigned numStates)
     {
-        return PengRobinson::computeMolarVolumes(Vm, params, phaseIdx, fs);
+        // gather the arguments in chunks which fit on the stack
+        const unsigned chunkSize = 64;
+        Scalar T[chunkSize], p[chunkSize], a[chunkSize], b[chunkSize];
+        bool isGas[chunkSize];
+
+        for (unsigned offset = 0; offset < numStates; offset += chunkSize) {
+            unsigned m = std::min(chunkSize, numStates - offset);
+            for (unsigned i = 0; i < m; ++i) {
+                const FluidState& fs = fluidStates[offset + i];
+                T[i] = toLhs_<Scalar>(fs.temperature(phaseIdx));
+                p[i] = toLhs_<Scalar>(fs.pressure(phaseIdx));
+                a[i] = toLhs_<Scalar>(paramCaches[offset + i].a(phaseIdx));
+                b[i] = toLhs_<Scalar>(paramCaches[offset + i].b(phaseIdx));
+                isGas[i] = isGasPhase;
+            }
+
+            PengRobinson::computeMolarVolumes(Vm + offset, T, p, a, b, isGas, m);
+        }
     }
 
     /*!
@@ -87,52 +120,58 @@ public:
       * R. Reid, et al.: The Properties of Gases and Liquids,
       * 4th edition, McGraw-Hill, 1987, pp. 42-44, 143-145
       */
-    template <class FluidState, class Params>
-    static Scalar computeFugacityCoefficient(const FluidState &fs,
-                                             const Params &params,
-                                             unsigned phaseIdx,
-                                             unsigned compIdx)
+    template <class FluidState, class Params, class LhsEval = typename FluidState::Scalar>
+    static LhsEval computeFugacityCoefficient(const FluidState &fs,
+                                              const Params &params,
+                                              unsigned phaseIdx,
+                                              unsigned compIdx)
     {
+        typedef Opm::MathToolbox<LhsEval> Toolbox;
+
         // note that we normalize the component mole fractions, so
         // that their sum is 100%. This increases numerical stability
         // considerably if the fluid state is not physical.
-        Scalar Vm = params.molarVolume(phaseIdx);
+        const LhsEval& Vm = toLhs_<LhsEval>(params.molarVolume(phaseIdx));
 
         // Calculate b_i / b
-        Scalar bi_b = params.bPure(phaseIdx, compIdx) / params.b(phaseIdx);
+        const LhsEval& bi_b =
+            toLhs_<LhsEval>(params.bPure(phaseIdx, compIdx))
+            / toLhs_<LhsEval>(params.b(phaseIdx));
 
         // Calculate the compressibility factor
-        Scalar RT = R*fs.temperature(phaseIdx);
-        Scalar p = fs.pressure(phaseIdx); // molar volume in [bar]
-        Scalar Z = p*Vm/RT; // compressibility factor
+        const LhsEval& RT = R*toLhs_<LhsEval>(fs.temperature(phaseIdx));
+        const LhsEval& p = toLhs_<LhsEval>(fs.pressure(phaseIdx)); // molar volume in [bar]
+        const LhsEval& Z = p*Vm/RT; // compressibility factor
 
         // Calculate A^* and B^* (see: Reid, p. 42)
-        Scalar Astar = params.a(phaseIdx)*p/(RT*RT);
-        Scalar Bstar = params.b(phaseIdx)*p/(RT);
+        const LhsEval& Astar = toLhs_<LhsEval>(params.a(phaseIdx))*p/(RT*RT);
+        const LhsEval& Bstar = toLhs_<LhsEval>(params.b(phaseIdx))*p/(RT);
 
         // calculate delta_i (see: Reid, p. 145)
-        Scalar sumMoleFractions = 0.0;
+        LhsEval sumMoleFractions = 0.0;
         for (unsigned compJIdx = 0; compJIdx < numComponents; ++compJIdx)
-            sumMoleFractions += fs.moleFraction(phaseIdx, compJIdx);
-        Scalar deltai = 2*std::sqrt(params.aPure(phaseIdx, compIdx))/params.a(phaseIdx);
-        Scalar tmp = 0;
+            sumMoleFractions += toLhs_<LhsEval>(fs.moleFraction(phaseIdx, compJIdx));
+        LhsEval deltai =
+            2*Toolbox::sqrt(toLhs_<LhsEval>(params.aPure(phaseIdx, compIdx)))
+            / toLhs_<LhsEval>(params.a(phaseIdx));
+        LhsEval tmp = 0;
         for (unsigned compJIdx = 0; compJIdx < numComponents; ++compJIdx) {
             tmp +=
-                fs.moleFraction(phaseIdx, compJIdx)
+                toLhs_<LhsEval>(fs.moleFraction(phaseIdx, compJIdx))
                 / sumMoleFractions
-                * std::sqrt(params.aPure(phaseIdx, compJIdx))
+                * Toolbox::sqrt(toLhs_<LhsEval>(params.aPure(phaseIdx, compJIdx)))
                 * (1.0 - StaticParameters::interactionCoefficient(compIdx, compJIdx));
         };
         deltai *= tmp;
 
-        Scalar base =
+        const LhsEval& base =
             (2*Z + Bstar*(u + std::sqrt(u*u - 4*w))) /
             (2*Z + Bstar*(u - std::sqrt(u*u - 4*w)));
-        Scalar expo =  Astar/(Bstar*std::sqrt(u*u - 4*w))*(bi_b - deltai);
+        const LhsEval& expo =  Astar/(Bstar*std::sqrt(u*u - 4*w))*(bi_b - deltai);
 
-        Scalar fugCoeff =
-            std::exp(bi_b*(Z - 1))/std::max(Scalar(1e-9), Z - Bstar) *
-            std::pow(base, expo);
+        LhsEval fugCoeff =
+            Toolbox::exp(bi_b*(Z - 1))/Toolbox::max(1e-9, Z - Bstar) *
+            Toolbox::pow(base, expo);
 
         ////////
         // limit the fugacity coefficient to a reasonable range:
@@ -140,17 +179,95 @@ public:
         // on one side, we want the mole fraction to be at
         // least 10^-3 if the fugacity is at the current pressure
         //
-        fugCoeff = std::min(Scalar(1e10), fugCoeff);
+        fugCoeff = Toolbox::min(1e10, fugCoeff);
         //
         // on the other hand, if the mole fraction of the component is 100%, we want the
         // fugacity to be at least 10^-3 Pa
         //
-        fugCoeff = std::max(Scalar(1e-10), fugCoeff);
+        fugCoeff = Toolbox::max(1e-10, fugCoeff);
         ///////////
 
         return fugCoeff;
     }
 
+    /*!
+     * \brief Computes the fugacity coefficients of all components in a phase.
+     *
+     * This yields the same results as calling computeFugacityCoefficient() for
+     * each component, but the quantities which do not depend on the component
+     * (compressibility factor, \f$A^*\f$, \f$B^*\f$, the normalized mole fractions
+     * and the logarithmic term of the EOS) are only evaluated once. Also, the
+     * square roots of the pure component attractive parameters are not recomputed:
+     * The parameter object must provide the cross attractive parameters
+     * \f$\sqrt{a_i a_j}(1 - k_{ij})\f$ of the mixing rule via an
+     * aCache(phaseIdx, compIIdx, compJIdx) method.
+     *
+     * \param fugCoeffs Array into which the fugacity coefficients of all components
+     *                  are written
+     * \param fs The fluid state of interest
+     * \param params The parameter object which is up to date for the phase
+     * \param phaseIdx The index of the phase
+     */
+    template <class FluidState, class Params, class LhsEval>
+    static void computeFugacityCoefficients(LhsEval *fugCoeffs,
+                                            const FluidState &fs,
+                                            const Params &params,
+                                            unsigned phaseIdx)
+    {
+        typedef Opm::MathToolbox<LhsEval> Toolbox;
+
+        const LhsEval& Vm = toLhs_<LhsEval>(params.molarVolume(phaseIdx));
+        const LhsEval& a = toLhs_<LhsEval>(params.a(phaseIdx));
+        const LhsEval& b = toLhs_<LhsEval>(params.b(phaseIdx));
+
+        // Calculate the compressibility factor
+        const LhsEval& RT = R*toLhs_<LhsEval>(fs.temperature(phaseIdx));
+        const LhsEval& p = toLhs_<LhsEval>(fs.pressure(phaseIdx));
+        const LhsEval& Z = p*Vm/RT;
+
+        // Calculate A^* and B^* (see: Reid, p. 42)
+        const LhsEval& Astar = a*p/(RT*RT);
+        const LhsEval& Bstar = b*p/(RT);
+
+        // the terms which are the same for all components
+        Scalar sqrtUW = std::sqrt(u*u - 4*w);
+        const LhsEval& logBase =
+            Toolbox::log((2*Z + Bstar*(u + sqrtUW)) / (2*Z + Bstar*(u - sqrtUW)));
+        const LhsEval& expoFactor = Astar/(Bstar*sqrtUW)*logBase;
+        const LhsEval& logZMinusB = Toolbox::log(Toolbox::max(1e-9, Z - Bstar));
+
+        // normalize the mole fractions, see computeFugacityCoefficient()
+        LhsEval x[numComponents];
+        LhsEval sumMoleFractions = 0.0;
+        for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx) {
+            x[compIdx] = toLhs_<LhsEval>(fs.moleFraction(phaseIdx, compIdx));
+            sumMoleFractions += x[compIdx];
+        }
+        for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+            x[compIdx] /= sumMoleFractions;
+
+        for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx) {
+            // calculate b_i / b and delta_i (see: Reid, p. 145)
+            const LhsEval& bi_b = toLhs_<LhsEval>(params.bPure(phaseIdx, compIdx)) / b;
+            LhsEval tmp = 0;
+            for (unsigned compJIdx = 0; compJIdx < numComponents; ++compJIdx)
+                tmp += x[compJIdx]*toLhs_<LhsEval>(params.aCache(phaseIdx, compIdx, compJIdx));
+            const LhsEval& deltai = 2*tmp/a;
+
+            const LhsEval& fugCoeff =
+                Toolbox::exp(bi_b*(Z - 1) - logZMinusB + expoFactor*(bi_b - deltai));
+
+            // limit the fugacity coefficient to a reasonable range (see
+            // computeFugacityCoefficient())
+            fugCoeffs[compIdx] = Toolbox::max(1e-10, Toolbox::min(1e10, fugCoeff));
+        }
+    }
+
+private:
+    // convert a function evaluation or a scalar to the requested type
+    template <class LhsEval, class Eval>
+    static LhsEval toLhs_(const Eval& value)
+    { return Opm::MathToolbox<Eval>::template toLhs<LhsEval>(value); }
 };
 
 template <class Scalar, class StaticParameters>
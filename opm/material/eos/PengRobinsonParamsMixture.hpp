@@ -28,7 +28,10 @@
 #define OPM_PENG_ROBINSON_PARAMS_MIXTURE_HPP
 
 #include <algorithm>
+#include <cassert>
+#include <cmath>
 #include <opm/material/Constants.hpp>
+#include <opm/material/common/MathToolbox.hpp>
 
 #include "PengRobinsonParams.hpp"
 
@@ -51,28 +54,40 @@ namespace Opm
  * J.E. Killough, et al.: Fifth Comparative Solution Project:
  * Evaluation of Miscible Flood Simulators, Ninth SPE Symposium on
  * Reservoir Simulation, 1987
+ *
+ * If EvaluationT is a function evaluation for automatic differentiation, the
+ * parameters carry the derivatives of the temperature, pressure and composition of
+ * the fluid states which they are updated with.
  */
-template <class Scalar, class FluidSystem, unsigned phaseIdx, bool useSpe5Relations=false>
+template <class Scalar, class FluidSystem, unsigned phaseIdx, bool useSpe5Relations=false, class EvaluationT = Scalar>
 class PengRobinsonParamsMixture
-    : public PengRobinsonParams<Scalar>
+    : public PengRobinsonParams<EvaluationT>
 {
     enum { numComponents = FluidSystem::numComponents };
 
+    typedef Opm::MathToolbox<EvaluationT> Toolbox;
+
     // Peng-Robinson parameters for pure substances
-    typedef Opm::PengRobinsonParams<Scalar> PureParams;
+    typedef Opm::PengRobinsonParams<EvaluationT> PureParams;
 
     // the ideal gas constant
     static const Scalar R;
 
 public:
+    //! The type of the parameters. This may be a function evaluation for automatic
+    //! differentiation.
+    typedef EvaluationT Evaluation;
+
     /*!
      * \brief Update Peng-Robinson parameters for the pure components.
      */
     template <class FluidState>
     void updatePure(const FluidState &fluidState)
     {
-        updatePure(fluidState.temperature(phaseIdx),
-                   fluidState.pressure(phaseIdx));
+        typedef Opm::MathToolbox<typename FluidState::Scalar> FsToolbox;
+
+        updatePure(FsToolbox::template toLhs<Evaluation>(fluidState.temperature(phaseIdx)),
+                   FsToolbox::template toLhs<Evaluation>(fluidState.pressure(phaseIdx)));
     }
 
     /*!
@@ -80,7 +95,7 @@ public:
      *
      * This method is given by the SPE5 paper.
      */
-    void updatePure(Scalar temperature, Scalar pressure)
+    void updatePure(const Evaluation& temperature, const Evaluation& pressure)
     {
         Valgrind::CheckDefined(temperature);
         Valgrind::CheckDefined(pressure);
@@ -93,7 +108,7 @@ public:
         for (unsigned i = 0; i < numComponents; ++i) {
             Scalar pc = FluidSystem::criticalPressure(i);
             Scalar omega = FluidSystem::acentricFactor(i);
-            Scalar Tr = temperature/FluidSystem::criticalTemperature(i);
+            const Evaluation& Tr = temperature/FluidSystem::criticalTemperature(i);
             Scalar RTc = R*FluidSystem::criticalTemperature(i);
 
             Scalar f_omega;
@@ -107,12 +122,12 @@ public:
 
             Valgrind::CheckDefined(f_omega);
 
-            Scalar tmp = 1 + f_omega*(1 - std::sqrt(Tr));
+            Evaluation tmp = 1 + f_omega*(1 - Toolbox::sqrt(Tr));
             tmp = tmp*tmp;
 
-            Scalar newA = 0.4572355*RTc*RTc/pc * tmp;
+            const Evaluation& newA = 0.4572355*RTc*RTc/pc * tmp;
             Scalar newB = 0.0777961 * RTc / pc;
-            assert(std::isfinite(newA));
+            assert(std::isfinite(Toolbox::value(newA)));
             assert(std::isfinite(newB));
 
             this->pureParams_[i].setA(newA);
@@ -134,45 +149,24 @@ public:
     template <class FluidState>
     void updateMix(const FluidState &fs)
     {
-        Scalar sumx = 0.0;
-        for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
-            sumx += fs.moleFraction(phaseIdx, compIdx);
-        sumx = std::max(Scalar(1e-10), sumx);
-
         // Calculate the Peng-Robinson parameters of the mixture
         //
         // See: R. Reid, et al.: The Properties of Gases and Liquids,
         // 4th edition, McGraw-Hill, 1987, p. 82
-        Scalar newA = 0;
-        Scalar newB = 0;
-        for (unsigned compIIdx = 0; compIIdx < numComponents; ++compIIdx) {
-            const Scalar moleFracI = fs.moleFraction(phaseIdx, compIIdx);
-            Scalar xi = std::max(Scalar(0), std::min(Scalar(1.0), moleFracI));
-            Valgrind::CheckDefined(xi);
-
-            for (unsigned compJIdx = 0; compJIdx < numComponents; ++compJIdx) {
-                const Scalar moleFracJ = fs.moleFraction(phaseIdx, compJIdx );
-                Scalar xj = std::max(Scalar(0), std::min(Scalar(1), moleFracJ));
-                Valgrind::CheckDefined(xj);
-
-                // mixing rule from Reid, page 82
-                newA +=  xi * xj * aCache_[compIIdx][compJIdx];
-
-                assert(std::isfinite(newA));
-            }
-
-            // mixing rule from Reid, page 82
-            newB += std::max(Scalar(0), xi) * this->pureParams_[compIIdx].b();
-            assert(std::isfinite(newB));
-        }
-
-        // assert(newB > 0);
-        this->setA(newA);
-        this->setB(newB);
-
-        Valgrind::CheckDefined(this->a());
-        Valgrind::CheckDefined(this->b());
-
+        for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+            x_[compIdx] = moleFraction_(fs, compIdx);
+
+        // the attractive parameter is the quadratic form x^T*A*x. the products of A
+        // and the mole fractions are kept, so that they can be updated incrementally
+        // if the mole fractions of only few components change. (the columns of A are
+        // accumulated in the outer loop, so that the additions are independent.)
+        for (unsigned compIIdx = 0; compIIdx < numComponents; ++compIIdx)
+            sumAx_[compIIdx] = aCache_[compIIdx][0] * x_[0];
+        for (unsigned compJIdx = 1; compJIdx < numComponents; ++compJIdx)
+            for (unsigned compIIdx = 0; compIIdx < numComponents; ++compIIdx)
+                sumAx_[compIIdx] += aCache_[compIIdx][compJIdx] * x_[compJIdx];
+
+        updateAB_();
     }
 
     /*!
@@ -180,14 +174,50 @@ public:
      *        the mixture provided that only a single mole fraction
      *        was changed.
      *
-     * The updatePure() method needs to be called _before_ calling
-     * this method!
+     * This only requires O(N) operations for N components instead of the O(N^2) of
+     * updateMix(). The updatePure() and updateMix() methods need to be called
+     * _before_ calling this method!
      */
     template <class FluidState>
     void updateSingleMoleFraction(const FluidState &fs,
-                                  unsigned /*compIdx*/)
+                                  unsigned compIdx)
     {
-        updateMix(fs);
+        assert(compIdx < numComponents);
+
+        updateMoleFraction_(compIdx, moleFraction_(fs, compIdx));
+        updateAB_();
+    }
+
+    /*!
+     * \brief Calculates the "a" and "b" Peng-Robinson parameters for
+     *        the mixture provided that only the mole fractions of some
+     *        components were changed.
+     *
+     * This requires O(N*M) operations for N components of which M are changed. If
+     * more than half of the mole fractions are modified, the parameters are
+     * recomputed from scratch. The updatePure() and updateMix() methods need to be
+     * called _before_ calling this method!
+     *
+     * \param fs The fluid state which contains the new composition
+     * \param compIndices The indices of the components whose mole fractions were
+     *                    modified
+     * \param numModified The number of modified mole fractions
+     */
+    template <class FluidState>
+    void updateMoleFractions(const FluidState &fs,
+                             const unsigned *compIndices,
+                             unsigned numModified)
+    {
+        if (2*numModified > numComponents) {
+            updateMix(fs);
+            return;
+        }
+
+        for (unsigned i = 0; i < numModified; ++i) {
+            assert(compIndices[i] < numComponents);
+            updateMoleFraction_(compIndices[i], moleFraction_(fs, compIndices[i]));
+        }
+        updateAB_();
     }
 
     /*!
@@ -205,6 +235,20 @@ public:
         return pureParams_[compIdx];
     }
 
+    /*!
+     * \brief Returns the attractive parameter of the mixing rule for a pair of
+     *        components.
+     *
+     * This is \f$\sqrt{a_i a_j}(1 - \Psi_{ij})\f$, where \f$\Psi_{ij}\f$ is the binary
+     * interaction coefficient. The values are updated by updatePure().
+     */
+    const Evaluation& aCache(unsigned compIIdx, unsigned compJIdx) const
+    {
+        assert(compIIdx < numComponents);
+        assert(compJIdx < numComponents);
+        return aCache_[compIIdx][compJIdx];
+    }
+
     /*!
      * \brief If run under valgrind, this method produces an warning
      *        if the parameters where not determined correctly.
@@ -232,18 +276,63 @@ private:
                 Scalar Psi = FluidSystem::interactionCoefficient(compIIdx, compJIdx);
 
                 aCache_[compIIdx][compJIdx] =
-                    std::sqrt(this->pureParams_[compIIdx].a()
-                              * this->pureParams_[compJIdx].a())
+                    Toolbox::sqrt(this->pureParams_[compIIdx].a()
+                                  * this->pureParams_[compJIdx].a())
                     * (1 - Psi);
             }
         }
     }
 
-    Scalar aCache_[numComponents][numComponents];
+    // the clamped mole fraction of a component in the phase
+    template <class FluidState>
+    static Evaluation moleFraction_(const FluidState &fs, unsigned compIdx)
+    {
+        typedef Opm::MathToolbox<typename FluidState::Scalar> FsToolbox;
+
+        const Evaluation& moleFrac =
+            FsToolbox::template toLhs<Evaluation>(fs.moleFraction(phaseIdx, compIdx));
+        Valgrind::CheckDefined(moleFrac);
+        return Toolbox::max(0.0, Toolbox::min(1.0, moleFrac));
+    }
+
+    // change the mole fraction of a single component and update the products of A
+    // and the mole fractions accordingly
+    void updateMoleFraction_(unsigned compIdx, const Evaluation& newMoleFrac)
+    {
+        const Evaluation& delta = newMoleFrac - x_[compIdx];
+        for (unsigned compIIdx = 0; compIIdx < numComponents; ++compIIdx)
+            sumAx_[compIIdx] += aCache_[compIIdx][compIdx] * delta;
+        x_[compIdx] = newMoleFrac;
+    }
+
+    // calculate the mixture parameters from the mole fractions and the products of A
+    // and the mole fractions
+    void updateAB_()
+    {
+        Evaluation newA = 0;
+        Evaluation newB = 0;
+        for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx) {
+            // mixing rules from Reid, page 82
+            newA += x_[compIdx] * sumAx_[compIdx];
+            newB += x_[compIdx] * this->pureParams_[compIdx].b();
+        }
+        assert(std::isfinite(Toolbox::value(newA)));
+        assert(std::isfinite(Toolbox::value(newB)));
+
+        this->setA(newA);
+        this->setB(newB);
+
+        Valgrind::CheckDefined(this->a());
+        Valgrind::CheckDefined(this->b());
+    }
+
+    Evaluation aCache_[numComponents][numComponents];
+    Evaluation x_[numComponents];
+    Evaluation sumAx_[numComponents];
 };
 
-template <class Scalar, class FluidSystem, unsigned phaseIdx, bool useSpe5Relations>
-const Scalar PengRobinsonParamsMixture<Scalar, FluidSystem, phaseIdx, useSpe5Relations>::R = Opm::Constants<Scalar>::R;
+template <class Scalar, class FluidSystem, unsigned phaseIdx, bool useSpe5Relations, class EvaluationT>
+const Scalar PengRobinsonParamsMixture<Scalar, FluidSystem, phaseIdx, useSpe5Relations, EvaluationT>::R = Opm::Constants<Scalar>::R;
 
 } // namespace Opm
 
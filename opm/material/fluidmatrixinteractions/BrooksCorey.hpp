@@ -48,9 +48,14 @@ namespace Opm {
  * concern itself converting absolute to effective saturations and
  * vice versa.
  *
+ * The powers are computed using the toolbox specified by the
+ * MathToolboxT template parameter, e.g., Opm::FastMathToolbox.
+ *
  *\see BrooksCoreyParams
  */
-template <class TraitsT, class ParamsT = BrooksCoreyParams<TraitsT> >
+template <class TraitsT,
+          class ParamsT = BrooksCoreyParams<TraitsT>,
+          template <class> class MathToolboxT = MathToolbox>
 class BrooksCorey : public TraitsT
 {
 public:
@@ -165,7 +170,7 @@ public:
     template <class Evaluation>
     static Evaluation twoPhaseSatPcnw(const Params &params, const Evaluation& Sw)
     {
-        typedef MathToolbox<Evaluation> Toolbox;
+        typedef MathToolboxT<Evaluation> Toolbox;
 
         assert(0 <= Sw && Sw <= 1);
 
@@ -175,7 +180,7 @@ public:
     template <class Evaluation>
     static Evaluation twoPhaseSatPcnwInv(const Params &params, const Evaluation& pcnw)
     {
-        typedef MathToolbox<Evaluation> Toolbox;
+        typedef MathToolboxT<Evaluation> Toolbox;
 
         assert(pcnw > 0.0);
 
@@ -208,7 +213,7 @@ public:
     template <class Evaluation>
     static Evaluation twoPhaseSatSw(const Params &params, const Evaluation& pc)
     {
-        typedef MathToolbox<Evaluation> Toolbox;
+        typedef MathToolboxT<Evaluation> Toolbox;
 
         assert(pc > 0); // if we don't assume that, std::pow will screw up!
 
@@ -248,7 +253,7 @@ public:
     template <class Evaluation>
     static Evaluation twoPhaseSatKrw(const Params &params, const Evaluation& Sw)
     {
-        typedef MathToolbox<Evaluation> Toolbox;
+        typedef MathToolboxT<Evaluation> Toolbox;
 
         assert(0 <= Sw && Sw <= 1);
 
@@ -258,7 +263,7 @@ public:
     template <class Evaluation>
     static Evaluation twoPhaseSatKrwInv(const Params &params, const Evaluation& krw)
     {
-        typedef MathToolbox<Evaluation> Toolbox;
+        typedef MathToolboxT<Evaluation> Toolbox;
 
         return Toolbox::pow(krw, 1.0/(2.0/params.lambda() + 3));
     }
@@ -285,7 +290,7 @@ public:
     template <class Evaluation>
     static Evaluation twoPhaseSatKrn(const Params &params, const Evaluation& Sw)
     {
-        typedef MathToolbox<Evaluation> Toolbox;
+        typedef MathToolboxT<Evaluation> Toolbox;
 
         assert(0 <= Sw && Sw <= 1);
 
@@ -297,7 +302,7 @@ public:
     template <class Evaluation>
     static Evaluation twoPhaseSatKrnInv(const Params &params, const Evaluation& krn)
     {
-        typedef MathToolbox<Evaluation> Toolbox;
+        typedef MathToolboxT<Evaluation> Toolbox;
 
         // since inverting the formula for krn is hard to do analytically, we use the
         // Newton-Raphson method
@@ -28,6 +28,7 @@
 #define OPM_ECL_DEFAULT_MATERIAL_HPP
 
 #include "EclDefaultMaterialParams.hpp"
+#include "TwoPhaseSatPcnwKrwKrn.hpp"
 
 #include <opm/material/common/Valgrind.hpp>
 #include <opm/material/common/MathToolbox.hpp>
@@ -248,10 +249,74 @@ public:
                                        const FluidState &fluidState)
     {
         typedef typename std::remove_reference<decltype(values[0])>::type Evaluation;
+        typedef MathToolbox<Evaluation> Toolbox;
+        typedef MathToolbox<typename FluidState::Scalar> FsToolbox;
+
+        Scalar Swco = params.Swl();
+
+        const Evaluation& Sw = FsToolbox::template toLhs<Evaluation>(fluidState.saturation(waterPhaseIdx));
+        const Evaluation& Sg = FsToolbox::template toLhs<Evaluation>(fluidState.saturation(gasPhaseIdx));
+
+        const Evaluation& SwKro = Toolbox::max(Evaluation(Swco), Sw);
+        const Evaluation& Sw_ow = Sg + SwKro;
+        const Evaluation& So_go = 1 - Sw_ow;
+
+        // evaluate each two-phase relperm only once. the capillary pressures are not
+        // needed here, use capillaryPressuresAndRelativePermeabilities() if they are.
+        const Evaluation& krw = OilWaterMaterialLaw::twoPhaseSatKrw(params.oilWaterParams(), Sw);
+        const Evaluation& kro_ow = OilWaterMaterialLaw::twoPhaseSatKrn(params.oilWaterParams(), Sw_ow);
+        const Evaluation& kro_go = GasOilMaterialLaw::twoPhaseSatKrw(params.gasOilParams(), So_go);
+        const Evaluation& krg = GasOilMaterialLaw::twoPhaseSatKrn(params.gasOilParams(), 1 - Sg);
 
-        values[waterPhaseIdx] = krw<FluidState, Evaluation>(params, fluidState);
-        values[oilPhaseIdx] = krn<FluidState, Evaluation>(params, fluidState);
-        values[gasPhaseIdx] = krg<FluidState, Evaluation>(params, fluidState);
+        values[waterPhaseIdx] = krw;
+        values[oilPhaseIdx] = krnFromTwoPhase_(params, SwKro, Sg, Sw_ow, kro_ow, kro_go);
+        values[gasPhaseIdx] = krg;
+    }
+
+    /*!
+     * \brief The capillary pressures and the relative permeabilities of all phases.
+     *
+     * This computes the same quantities as capillaryPressures() and
+     * relativePermeabilities(), but each nested two-phase law is only evaluated
+     * once for all of them.
+     */
+    template <class PcContainerT, class KrContainerT, class FluidState>
+    static void capillaryPressuresAndRelativePermeabilities(PcContainerT &pcValues,
+                                                            KrContainerT &krValues,
+                                                            const Params &params,
+                                                            const FluidState &fluidState)
+    {
+        typedef typename std::remove_reference<decltype(krValues[0])>::type Evaluation;
+        typedef MathToolbox<Evaluation> Toolbox;
+        typedef MathToolbox<typename FluidState::Scalar> FsToolbox;
+
+        Scalar Swco = params.Swl();
+
+        const Evaluation& Sw = FsToolbox::template toLhs<Evaluation>(fluidState.saturation(waterPhaseIdx));
+        const Evaluation& Sg = FsToolbox::template toLhs<Evaluation>(fluidState.saturation(gasPhaseIdx));
+        const Evaluation& SwGo = 1 - Sg;
+
+        const Evaluation& SwKro = Toolbox::max(Evaluation(Swco), Sw);
+        const Evaluation& Sw_ow = Sg + SwKro;
+        const Evaluation& So_go = 1 - Sw_ow;
+
+        Evaluation pcow, krw, kro_ow;
+        twoPhaseSatPcnwKrwKrn<OilWaterMaterialLaw>(pcow, krw, kro_ow,
+                                                   params.oilWaterParams(),
+                                                   Sw, Sw, Sw_ow);
+
+        Evaluation pcgo, kro_go, krg;
+        twoPhaseSatPcnwKrwKrn<GasOilMaterialLaw>(pcgo, kro_go, krg,
+                                                 params.gasOilParams(),
+                                                 SwGo, So_go, SwGo);
+
+        pcValues[gasPhaseIdx] = pcgo;
+        pcValues[oilPhaseIdx] = 0;
+        pcValues[waterPhaseIdx] = - pcow;
+
+        krValues[waterPhaseIdx] = krw;
+        krValues[oilPhaseIdx] = krnFromTwoPhase_(params, SwKro, Sg, Sw_ow, kro_ow, kro_go);
+        krValues[gasPhaseIdx] = krg;
     }
 
     /*!
@@ -297,27 +362,12 @@ public:
                          FsToolbox::template toLhs<Evaluation>(fluidState.saturation(waterPhaseIdx)));
         Evaluation Sg = FsToolbox::template toLhs<Evaluation>(fluidState.saturation(gasPhaseIdx));
 
-        Evaluation Sw_ow = Sg + Sw;
-        Evaluation So_go = 1.0 - Sw_ow;
+        const Evaluation& Sw_ow = Sg + Sw;
+        const Evaluation& So_go = 1.0 - Sw_ow;
         const Evaluation& kro_ow = OilWaterMaterialLaw::twoPhaseSatKrn(params.oilWaterParams(), Sw_ow);
         const Evaluation& kro_go = GasOilMaterialLaw::twoPhaseSatKrw(params.gasOilParams(), So_go);
 
-        // avoid the division by zero: chose a regularized kro which is used if Sw - Swco
-        // < epsilon/2 and interpolate between the oridinary and the regularized kro between
-        // epsilon and epsilon/2
-        const Scalar epsilon = 1e-5;
-        if (Toolbox::value(Sw_ow) - Swco < epsilon) {
-            Evaluation kro2 = (kro_ow + kro_go)/2;;
-            if (Toolbox::value(Sw_ow) - Swco > epsilon/2) {
-                Evaluation kro1 = (Sg*kro_go + (Sw - Swco)*kro_ow)/(Sw_ow - Swco);
-                Evaluation alpha = (epsilon - (Sw_ow - Swco))/(epsilon/2);
-                return kro2*alpha + kro1*(1 - alpha);
-            }
-
-            return kro2;
-        }
-        else
-            return (Sg*kro_go + (Sw - Swco)*kro_ow)/(Sw_ow - Swco);
+        return krnFromTwoPhase_(params, Sw, Sg, Sw_ow, kro_ow, kro_go);
     }
 
     /*!
@@ -362,6 +412,39 @@ public:
             params.gasOilParams().update(/*pcSw=*/1 - Sg, /*krwSw=*/So_go, /*krnSw=*/1 - Sg);
         }
     }
+
+private:
+    // combine the oil relperms of the two two-phase systems. 'Sw' is the water
+    // saturation which has already been limited to the connate one
+    template <class Evaluation>
+    static Evaluation krnFromTwoPhase_(const Params &params,
+                                       const Evaluation& Sw,
+                                       const Evaluation& Sg,
+                                       const Evaluation& Sw_ow,
+                                       const Evaluation& kro_ow,
+                                       const Evaluation& kro_go)
+    {
+        typedef MathToolbox<Evaluation> Toolbox;
+
+        Scalar Swco = params.Swl();
+
+        // avoid the division by zero: chose a regularized kro which is used if Sw - Swco
+        // < epsilon/2 and interpolate between the oridinary and the regularized kro between
+        // epsilon and epsilon/2
+        const Scalar epsilon = 1e-5;
+        if (Toolbox::value(Sw_ow) - Swco < epsilon) {
+            Evaluation kro2 = (kro_ow + kro_go)/2;;
+            if (Toolbox::value(Sw_ow) - Swco > epsilon/2) {
+                Evaluation kro1 = (Sg*kro_go + (Sw - Swco)*kro_ow)/(Sw_ow - Swco);
+                Evaluation alpha = (epsilon - (Sw_ow - Swco))/(epsilon/2);
+                return kro2*alpha + kro1*(1 - alpha);
+            }
+
+            return kro2;
+        }
+        else
+            return (Sg*kro_go + (Sw - Swco)*kro_ow)/(Sw_ow - Swco);
+    }
 };
 } // namespace Opm
 
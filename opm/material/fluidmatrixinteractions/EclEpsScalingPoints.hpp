@@ -44,6 +44,7 @@
 #endif
 
 #include <array>
+#include <vector>
 #include <string>
 #include <iostream>
 #include <cassert>
@@ -54,7 +55,9 @@ namespace Opm {
  * \brief Collects all grid properties which are relevant for end point scaling.
  *
  * This class is used for both, the drainage and the imbibition variants of the ECL
- * keywords.
+ * keywords. Note that the data of the grid properties is not copied: only the keywords
+ * which are explicitly specified by the deck are referenced and all other pointers are
+ * null. All data is indexed by the cartesian index of the cell.
  */
 class EclEpsGridProperties
 {
@@ -159,6 +162,40 @@ struct EclEpsScalingPointsInfo
     Scalar maxKrog; // maximum relative permability of oil in the gas-oil system
     Scalar maxKrg; // maximum relative permability of gas
 
+    /*!
+     * \brief Copy the values of an info object which may use a different floating point
+     *        type.
+     *
+     * This is used to store the per-element scaling information using a more compact
+     * representation than the one used for the computations.
+     */
+    template <class OtherScalar>
+    void assign(const EclEpsScalingPointsInfo<OtherScalar>& other)
+    {
+        Swl = static_cast<Scalar>(other.Swl);
+        Sgl = static_cast<Scalar>(other.Sgl);
+        Sowl = static_cast<Scalar>(other.Sowl);
+        Sogl = static_cast<Scalar>(other.Sogl);
+
+        Swcr = static_cast<Scalar>(other.Swcr);
+        Sgcr = static_cast<Scalar>(other.Sgcr);
+        Sowcr = static_cast<Scalar>(other.Sowcr);
+        Sogcr = static_cast<Scalar>(other.Sogcr);
+
+        Swu = static_cast<Scalar>(other.Swu);
+        Sgu = static_cast<Scalar>(other.Sgu);
+        Sowu = static_cast<Scalar>(other.Sowu);
+        Sogu = static_cast<Scalar>(other.Sogu);
+
+        maxPcow = static_cast<Scalar>(other.maxPcow);
+        maxPcgo = static_cast<Scalar>(other.maxPcgo);
+
+        maxKrw = static_cast<Scalar>(other.maxKrw);
+        maxKrow = static_cast<Scalar>(other.maxKrow);
+        maxKrog = static_cast<Scalar>(other.maxKrog);
+        maxKrg = static_cast<Scalar>(other.maxKrg);
+    }
+
     void print() const
     {
         std::cout << "    Swl: " << Swl << "\n"
@@ -504,7 +541,8 @@ public:
     /*!
      * \brief Assigns the scaling points which actually ought to be used.
      */
-    void init(const EclEpsScalingPointsInfo<Scalar>& epsInfo,
+    template <class InfoScalar>
+    void init(const EclEpsScalingPointsInfo<InfoScalar>& epsInfo,
               const EclEpsConfig& config,
               EclTwoPhaseSystemType epsSystemType)
     {
@@ -580,6 +618,25 @@ public:
         }
     }
 
+    /*!
+     * \brief Copy the scaling points of an object which may use a different floating
+     *        point type.
+     */
+    template <class OtherScalar>
+    void assign(const EclEpsScalingPoints<OtherScalar>& other)
+    {
+        for (unsigned i = 0; i < saturationPcPoints_.size(); ++i)
+            saturationPcPoints_[i] = static_cast<Scalar>(other.saturationPcPoints()[i]);
+        for (unsigned i = 0; i < saturationKrwPoints_.size(); ++i)
+            saturationKrwPoints_[i] = static_cast<Scalar>(other.saturationKrwPoints()[i]);
+        for (unsigned i = 0; i < saturationKrnPoints_.size(); ++i)
+            saturationKrnPoints_[i] = static_cast<Scalar>(other.saturationKrnPoints()[i]);
+
+        maxPcnw_ = static_cast<Scalar>(other.maxPcnw());
+        maxKrw_ = static_cast<Scalar>(other.maxKrw());
+        maxKrn_ = static_cast<Scalar>(other.maxKrn());
+    }
+
     /*!
      * \brief Sets an saturation value for capillary pressure saturation scaling
      */
@@ -28,6 +28,7 @@
 #define OPM_ECL_EPS_TWO_PHASE_LAW_HPP
 
 #include "EclEpsTwoPhaseLawParams.hpp"
+#include "TwoPhaseSatPcnwKrwKrn.hpp"
 
 #include <opm/material/fluidstates/SaturationOverlayFluidState.hpp>
 #include <opm/common/ErrorMacros.hpp>
@@ -152,17 +153,19 @@ public:
     template <class Evaluation>
     static Evaluation twoPhaseSatPcnw(const Params &params, const Evaluation& SwScaled)
     {
-        const Evaluation& SwUnscaled = scaledToUnscaledSatPc(params, SwScaled);
-        const Evaluation& pcUnscaled = EffLaw::twoPhaseSatPcnw(params.effectiveLawParams(), SwUnscaled);
-        return unscaledToScaledPcnw_(params, pcUnscaled);
+        // scale -> evaluate -> unscale. all coefficients of the transformations have
+        // been precomputed by the parameter object, so this only adds a few
+        // multiply-adds to the evaluation of the nested law
+        const Evaluation& SwUnscaled = params.scaledToUnscaledSatPc().eval(SwScaled);
+        return EffLaw::twoPhaseSatPcnw(params.effectiveLawParams(), SwUnscaled)*params.pcnwScalingFactor();
     }
 
     template <class Evaluation>
     static Evaluation twoPhaseSatPcnwInv(const Params &params, const Evaluation& pcnwScaled)
     {
-        Evaluation pcnwUnscaled = scaledToUnscaledPcnw_(params, pcnwScaled);
-        Evaluation SwUnscaled = EffLaw::twoPhaseSatPcnwInv(params.effectiveLawParams(), pcnwUnscaled);
-        return unscaledToScaledSatPc(params, SwUnscaled);
+        const Evaluation& pcnwUnscaled = pcnwScaled/params.pcnwScalingFactor();
+        const Evaluation& SwUnscaled = EffLaw::twoPhaseSatPcnwInv(params.effectiveLawParams(), pcnwUnscaled);
+        return params.unscaledToScaledSatPc().eval(SwUnscaled);
     }
 
     /*!
@@ -230,17 +233,16 @@ public:
     template <class Evaluation>
     static Evaluation twoPhaseSatKrw(const Params &params, const Evaluation& SwScaled)
     {
-        const Evaluation& SwUnscaled = scaledToUnscaledSatKrw(params, SwScaled);
-        const Evaluation& krwUnscaled = EffLaw::twoPhaseSatKrw(params.effectiveLawParams(), SwUnscaled);
-        return unscaledToScaledKrw_(params, krwUnscaled);
+        const Evaluation& SwUnscaled = params.scaledToUnscaledSatKrw().eval(SwScaled);
+        return EffLaw::twoPhaseSatKrw(params.effectiveLawParams(), SwUnscaled)*params.krwScalingFactor();
     }
 
     template <class Evaluation>
     static Evaluation twoPhaseSatKrwInv(const Params &params, const Evaluation& krwScaled)
     {
-        Evaluation krwUnscaled = scaledToUnscaledKrw_(params, krwScaled);
-        Evaluation SwUnscaled = EffLaw::twoPhaseSatKrwInv(params.effectiveLawParams(), krwUnscaled);
-        return unscaledToScaledSatKrw(params, SwUnscaled);
+        const Evaluation& krwUnscaled = krwScaled/params.krwScalingFactor();
+        const Evaluation& SwUnscaled = EffLaw::twoPhaseSatKrwInv(params.effectiveLawParams(), krwUnscaled);
+        return params.unscaledToScaledSatKrw().eval(SwUnscaled);
     }
 
     /*!
@@ -256,17 +258,44 @@ public:
     template <class Evaluation>
     static Evaluation twoPhaseSatKrn(const Params &params, const Evaluation& SwScaled)
     {
-        const Evaluation& SwUnscaled = scaledToUnscaledSatKrn(params, SwScaled);
-        const Evaluation& krnUnscaled = EffLaw::twoPhaseSatKrn(params.effectiveLawParams(), SwUnscaled);
-        return unscaledToScaledKrn_(params, krnUnscaled);
+        const Evaluation& SwUnscaled = params.scaledToUnscaledSatKrn().eval(SwScaled);
+        return EffLaw::twoPhaseSatKrn(params.effectiveLawParams(), SwUnscaled)*params.krnScalingFactor();
     }
 
     template <class Evaluation>
     static Evaluation twoPhaseSatKrnInv(const Params &params, const Evaluation& krnScaled)
     {
-        Evaluation krnUnscaled = scaledToUnscaledKrn_(params, krnScaled);
-        Evaluation SwUnscaled = EffLaw::twoPhaseSatKrnInv(params.effectiveLawParams(), krnUnscaled);
-        return unscaledToScaledSatKrn(params, SwUnscaled);
+        const Evaluation& krnUnscaled = krnScaled/params.krnScalingFactor();
+        const Evaluation& SwUnscaled = EffLaw::twoPhaseSatKrnInv(params.effectiveLawParams(), krnUnscaled);
+        return params.unscaledToScaledSatKrn().eval(SwUnscaled);
+    }
+
+    /*!
+     * \brief Evaluate the capillary pressure and both relative permeabilities at once.
+     *
+     * The saturations are transformed to the unscaled space and then passed to the
+     * fused kernel of the nested law (if it has one).
+     */
+    template <class Evaluation>
+    static void twoPhaseSatPcnwKrwKrn(Evaluation& pcnw,
+                                      Evaluation& krw,
+                                      Evaluation& krn,
+                                      const Params& params,
+                                      const Evaluation& pcSwScaled,
+                                      const Evaluation& krwSwScaled,
+                                      const Evaluation& krnSwScaled)
+    {
+        const Evaluation& pcSwUnscaled = params.scaledToUnscaledSatPc().eval(pcSwScaled);
+        const Evaluation& krwSwUnscaled = params.scaledToUnscaledSatKrw().eval(krwSwScaled);
+        const Evaluation& krnSwUnscaled = params.scaledToUnscaledSatKrn().eval(krnSwScaled);
+
+        Opm::twoPhaseSatPcnwKrwKrn<EffLaw>(pcnw, krw, krn,
+                                           params.effectiveLawParams(),
+                                           pcSwUnscaled, krwSwUnscaled, krnSwUnscaled);
+
+        pcnw *= params.pcnwScalingFactor();
+        krw *= params.krwScalingFactor();
+        krn *= params.krnScalingFactor();
     }
 
     /*!
@@ -276,29 +305,11 @@ public:
      */
     template <class Evaluation>
     static Evaluation scaledToUnscaledSatPc(const Params &params, const Evaluation& SwScaled)
-    {
-        if (!params.config().enableSatScaling())
-            return SwScaled;
-
-        // the saturations of capillary pressure are always scaled using two-point
-        // scaling
-        return scaledToUnscaledSatTwoPoint_(SwScaled,
-                                            params.unscaledPoints().saturationPcPoints(),
-                                            params.scaledPoints().saturationPcPoints());
-    }
+    { return params.scaledToUnscaledSatPc().eval(SwScaled); }
 
     template <class Evaluation>
     static Evaluation unscaledToScaledSatPc(const Params &params, const Evaluation& SwUnscaled)
-    {
-        if (!params.config().enableSatScaling())
-            return SwUnscaled;
-
-        // the saturations of capillary pressure are always scaled using two-point
-        // scaling
-        return unscaledToScaledSatTwoPoint_(SwUnscaled,
-                                            params.unscaledPoints().saturationPcPoints(),
-                                            params.scaledPoints().saturationPcPoints());
-    }
+    { return params.unscaledToScaledSatPc().eval(SwUnscaled); }
 
     /*!
      * \brief Convert an absolute saturation to an effective one for the scaling of the
@@ -306,39 +317,11 @@ public:
      */
     template <class Evaluation>
     static Evaluation scaledToUnscaledSatKrw(const Params &params, const Evaluation& SwScaled)
-    {
-        if (!params.config().enableSatScaling())
-            return SwScaled;
-
-        if (params.config().enableThreePointKrSatScaling()) {
-            return scaledToUnscaledSatThreePoint_(SwScaled,
-                                                  params.unscaledPoints().saturationKrwPoints(),
-                                                  params.scaledPoints().saturationKrwPoints());
-        }
-        else { // two-point relperm saturation scaling
-            return scaledToUnscaledSatTwoPoint_(SwScaled,
-                                                params.unscaledPoints().saturationKrwPoints(),
-                                                params.scaledPoints().saturationKrwPoints());
-        }
-    }
+    { return params.scaledToUnscaledSatKrw().eval(SwScaled); }
 
     template <class Evaluation>
     static Evaluation unscaledToScaledSatKrw(const Params &params, const Evaluation& SwUnscaled)
-    {
-        if (!params.config().enableSatScaling())
-            return SwUnscaled;
-
-        if (params.config().enableThreePointKrSatScaling()) {
-            return unscaledToScaledSatThreePoint_(SwUnscaled,
-                                                  params.unscaledPoints().saturationKrwPoints(),
-                                                  params.scaledPoints().saturationKrwPoints());
-        }
-        else { // two-point relperm saturation scaling
-            return unscaledToScaledSatTwoPoint_(SwUnscaled,
-                                                params.unscaledPoints().saturationKrwPoints(),
-                                                params.scaledPoints().saturationKrwPoints());
-        }
-    }
+    { return params.unscaledToScaledSatKrw().eval(SwUnscaled); }
 
     /*!
      * \brief Convert an absolute saturation to an effective one for the scaling of the
@@ -346,192 +329,11 @@ public:
      */
     template <class Evaluation>
     static Evaluation scaledToUnscaledSatKrn(const Params &params, const Evaluation& SwScaled)
-    {
-        if (!params.config().enableSatScaling())
-            return SwScaled;
-
-        if (params.config().enableThreePointKrSatScaling())
-            return scaledToUnscaledSatThreePoint_(SwScaled,
-                                                  params.unscaledPoints().saturationKrnPoints(),
-                                                  params.scaledPoints().saturationKrnPoints());
-        else // two-point relperm saturation scaling
-            return scaledToUnscaledSatTwoPoint_(SwScaled,
-                                                params.unscaledPoints().saturationKrnPoints(),
-                                                params.scaledPoints().saturationKrnPoints());
-    }
-
+    { return params.scaledToUnscaledSatKrn().eval(SwScaled); }
 
     template <class Evaluation>
     static Evaluation unscaledToScaledSatKrn(const Params &params, const Evaluation& SwUnscaled)
-    {
-        if (!params.config().enableSatScaling())
-            return SwUnscaled;
-
-        if (params.config().enableThreePointKrSatScaling()) {
-            return unscaledToScaledSatThreePoint_(SwUnscaled,
-                                                  params.unscaledPoints().saturationKrnPoints(),
-                                                  params.scaledPoints().saturationKrnPoints());
-        }
-        else { // two-point relperm saturation scaling
-            return unscaledToScaledSatTwoPoint_(SwUnscaled,
-                                                params.unscaledPoints().saturationKrnPoints(),
-                                                params.scaledPoints().saturationKrnPoints());
-        }
-    }
-
-private:
-    template <class Evaluation, class PointsContainer>
-    static Evaluation scaledToUnscaledSatTwoPoint_(const Evaluation& scaledSat,
-                                                   const PointsContainer& unscaledSats,
-                                                   const PointsContainer& scaledSats)
-    {
-        return
-            unscaledSats[0]
-            +
-            (scaledSat - scaledSats[0])*((unscaledSats[1] - unscaledSats[0])/(scaledSats[1] - scaledSats[0]));
-    }
-
-    template <class Evaluation, class PointsContainer>
-    static Evaluation unscaledToScaledSatTwoPoint_(const Evaluation& unscaledSat,
-                                                   const PointsContainer& unscaledSats,
-                                                   const PointsContainer& scaledSats)
-    {
-        return
-            scaledSats[0]
-            +
-            (unscaledSat - unscaledSats[0])*((scaledSats[1] - scaledSats[0])/(unscaledSats[1] - unscaledSats[0]));
-    }
-
-    template <class Evaluation, class PointsContainer>
-    static Evaluation scaledToUnscaledSatThreePoint_(const Evaluation& scaledSat,
-                                                     const PointsContainer& unscaledSats,
-                                                     const PointsContainer& scaledSats)
-    {
-        if (unscaledSats[1] >= unscaledSats[2])
-            return scaledToUnscaledSatTwoPoint_(scaledSat, unscaledSats, scaledSats);
-
-        if (scaledSat < scaledSats[1]) {
-            Scalar delta = scaledSats[1] - scaledSats[0];
-            if (delta <= 1e-20)
-                delta = 1.0; // prevent division by zero for (possibly) incorrect input data
-
-            return
-                unscaledSats[0]
-                +
-                (scaledSat - scaledSats[0])*((unscaledSats[1] - unscaledSats[0])/delta);
-        }
-        else {
-            Scalar delta = scaledSats[2] - scaledSats[1];
-            if (delta <= 1e-20)
-                delta = 1.0; // prevent division by zero for (possibly) incorrect input data
-
-            return
-                unscaledSats[1]
-                +
-                (scaledSat - scaledSats[1])*((unscaledSats[2] - unscaledSats[1])/delta);
-        }
-    }
-
-    template <class Evaluation, class PointsContainer>
-    static Evaluation unscaledToScaledSatThreePoint_(const Evaluation& unscaledSat,
-                                                     const PointsContainer& unscaledSats,
-                                                     const PointsContainer& scaledSats)
-    {
-        if (unscaledSats[1] >= unscaledSats[2])
-            return unscaledToScaledSatTwoPoint_(unscaledSat, unscaledSats, scaledSats);
-
-        if (unscaledSat < unscaledSats[1]) {
-            Scalar delta = unscaledSats[1] - unscaledSats[0];
-            if (delta <= 1e-20)
-                delta = 1.0; // prevent division by zero for (possibly) incorrect input data
-
-            return
-                scaledSats[0]
-                +
-                (unscaledSat - unscaledSats[0])*((scaledSats[1] - scaledSats[0])/delta);
-        }
-        else {
-            Scalar delta = unscaledSats[2] - unscaledSats[1];
-            if (delta <= 1e-20)
-                delta = 1.0; // prevent division by zero for (possibly) incorrect input data
-
-            return
-                scaledSats[1]
-                +
-                (unscaledSat - unscaledSats[1])*((scaledSats[2] - scaledSats[1])/delta);
-        }
-    }
-
-    /*!
-     * \brief Scale the capillary pressure according to the given parameters
-     */
-    template <class Evaluation>
-    static Evaluation unscaledToScaledPcnw_(const Params &params, const Evaluation& unscaledPcnw)
-    {
-        if (!params.config().enablePcScaling())
-            return unscaledPcnw;
-
-        Scalar alpha = params.scaledPoints().maxPcnw()/params.unscaledPoints().maxPcnw();
-        return unscaledPcnw*alpha;
-    }
-
-    template <class Evaluation>
-    static Evaluation scaledToUnscaledPcnw_(const Params &params, const Evaluation& scaledPcnw)
-    {
-        if (!params.config().enablePcScaling())
-            return scaledPcnw;
-
-        Scalar alpha = params.unscaledPoints().maxPcnw()/params.scaledPoints().maxPcnw();
-        return scaledPcnw/alpha;
-    }
-
-    /*!
-     * \brief Scale the wetting phase relative permeability of a phase according to the given parameters
-     */
-    template <class Evaluation>
-    static Evaluation unscaledToScaledKrw_(const Params &params, const Evaluation& unscaledKrw)
-    {
-        if (!params.config().enableKrwScaling())
-            return unscaledKrw;
-
-        // TODO: three point krw y-scaling
-        Scalar alpha = params.scaledPoints().maxKrw()/params.unscaledPoints().maxKrw();
-        return unscaledKrw*alpha;
-    }
-
-    template <class Evaluation>
-    static Evaluation scaledToUnscaledKrw_(const Params &params, const Evaluation& scaledKrw)
-    {
-        if (!params.config().enableKrwScaling())
-            return scaledKrw;
-
-        Scalar alpha = params.unscaledPoints().maxKrw()/params.scaledPoints().maxKrw();
-        return scaledKrw*alpha;
-    }
-
-    /*!
-     * \brief Scale the non-wetting phase relative permeability of a phase according to the given parameters
-     */
-    template <class Evaluation>
-    static Evaluation unscaledToScaledKrn_(const Params &params, const Evaluation& unscaledKrn)
-    {
-        if (!params.config().enableKrnScaling())
-            return unscaledKrn;
-
-        //TODO: three point krn y-scaling
-        Scalar alpha = params.scaledPoints().maxKrn()/params.unscaledPoints().maxKrn();
-        return unscaledKrn*alpha;
-    }
-
-    template <class Evaluation>
-    static Evaluation scaledToUnscaledKrn_(const Params &params, const Evaluation& scaledKrn)
-    {
-        if (!params.config().enableKrnScaling())
-            return scaledKrn;
-
-        Scalar alpha = params.unscaledPoints().maxKrn()/params.scaledPoints().maxKrn();
-        return scaledKrn*alpha;
-    }
+    { return params.unscaledToScaledSatKrn().eval(SwUnscaled); }
 };
 } // namespace Opm
 
@@ -41,13 +41,100 @@
 #include <algorithm>
 
 namespace Opm {
+/*!
+ * \ingroup FluidMatrixInteractions
+ *
+ * \brief A piecewise linear function which consists of at most two affine segments.
+ *
+ * This is used to map saturations between the scaled and the unscaled spaces of the
+ * endpoint scaling code. Since the coefficients are precomputed, evaluating the
+ * transformation only requires a comparison and a fused multiply-add.
+ *
+ * The coefficients are always computed using the 'Scalar' type, but they are stored
+ * using 'StorageScalar'. This allows to use a more compact representation (e.g., float)
+ * for the per-element data while the computations are performed in full precision.
+ */
+template <class Scalar, class StorageScalar = Scalar>
+class EclEpsSaturationTransform
+{
+public:
+    EclEpsSaturationTransform()
+    { setIdentity(); }
+
+    /*!
+     * \brief Make the transformation the identity function.
+     */
+    void setIdentity()
+    {
+        xSwitch_ = 0.0;
+        offset_[0] = offset_[1] = 0.0;
+        slope_[0] = slope_[1] = 1.0;
+    }
+
+    /*!
+     * \brief Linearly map the interval [x0, x1] to [y0, y1].
+     */
+    template <class XPointsContainer, class YPointsContainer>
+    void setTwoPoint(const XPointsContainer& xPoints, const YPointsContainer& yPoints)
+    {
+        setSegment_(/*segmentIdx=*/0, xPoints[0], xPoints[1], yPoints[0], yPoints[1]);
+        setSegment_(/*segmentIdx=*/1, xPoints[0], xPoints[1], yPoints[0], yPoints[1]);
+        xSwitch_ = static_cast<StorageScalar>(xPoints[0]);
+    }
+
+    /*!
+     * \brief Map [x0, x1] to [y0, y1] and [x1, x2] to [y1, y2].
+     */
+    template <class XPointsContainer, class YPointsContainer>
+    void setThreePoint(const XPointsContainer& xPoints, const YPointsContainer& yPoints)
+    {
+        setSegment_(/*segmentIdx=*/0, xPoints[0], xPoints[1], yPoints[0], yPoints[1]);
+        setSegment_(/*segmentIdx=*/1, xPoints[1], xPoints[2], yPoints[1], yPoints[2]);
+        xSwitch_ = static_cast<StorageScalar>(xPoints[1]);
+    }
+
+    /*!
+     * \brief Evaluate the transformation.
+     */
+    template <class Evaluation>
+    Evaluation eval(const Evaluation& x) const
+    {
+        unsigned segmentIdx = (x < Scalar(xSwitch_))?0:1;
+        return Scalar(offset_[segmentIdx]) + x*Scalar(slope_[segmentIdx]);
+    }
+
+private:
+    void setSegment_(unsigned segmentIdx, Scalar x0, Scalar x1, Scalar y0, Scalar y1)
+    {
+        Scalar delta = x1 - x0;
+        if (delta <= 1e-20)
+            delta = 1.0; // prevent division by zero for (possibly) incorrect input data
+
+        Scalar slope = (y1 - y0)/delta;
+        slope_[segmentIdx] = static_cast<StorageScalar>(slope);
+        offset_[segmentIdx] = static_cast<StorageScalar>(y0 - x0*slope);
+    }
+
+    StorageScalar xSwitch_;
+    StorageScalar offset_[2];
+    StorageScalar slope_[2];
+};
+
 /*!
  * \ingroup FluidMatrixInteractions
  *
  * \brief A default implementation of the parameters for the material law adapter class
  *        which implements ECL endpoint scaleing .
+ *
+ * The 'StorageScalar' template parameter specifies the floating point type which is
+ * used to store the per-element quantities, i.e., the scaled points and the
+ * precomputed scaling transformations. Setting it to 'float' roughly halves the memory
+ * required by these objects at the price of a relative error of about 1e-7 for the
+ * scaling points. All computations are still done using the 'Scalar' type of the
+ * nested material law.
  */
-template <class EffLawT>
+template <class EffLawT,
+          class StorageScalarT = typename EffLawT::Params::Traits::Scalar>
 class EclEpsTwoPhaseLawParams
 {
     typedef typename EffLawT::Params EffLawParams;
@@ -55,7 +142,10 @@ class EclEpsTwoPhaseLawParams
 
 public:
     typedef typename EffLawParams::Traits Traits;
+    typedef StorageScalarT StorageScalar;
     typedef Opm::EclEpsScalingPoints<Scalar> ScalingPoints;
+    typedef Opm::EclEpsScalingPoints<StorageScalar> StoredScalingPoints;
+    typedef Opm::EclEpsSaturationTransform<Scalar, StorageScalar> SaturationTransform;
 
     EclEpsTwoPhaseLawParams()
     {
@@ -79,6 +169,8 @@ public:
 
         finalized_ = true;
 #endif
+
+        updateTransforms_();
     }
 
     /*!
@@ -109,19 +201,27 @@ public:
      * \brief Set the scaling points which are seen by the physical model
      */
     void setScaledPoints(std::shared_ptr<ScalingPoints> value)
-    { scaledPoints_ = *value; }
+    { scaledPoints_.assign(*value); }
 
     /*!
      * \brief Returns the scaling points which are seen by the physical model
      */
-    const ScalingPoints& scaledPoints() const
+    const StoredScalingPoints& scaledPoints() const
     { return scaledPoints_; }
 
     /*!
      * \brief Returns the scaling points which are seen by the physical model
+     *
+     * If the scaling points are modified, finalize() must be called again. (In debug
+     * mode, the material law asserts this.)
      */
-    ScalingPoints& scaledPoints()
-    { return scaledPoints_; }
+    StoredScalingPoints& scaledPoints()
+    {
+#ifndef NDEBUG
+        finalized_ = false;
+#endif
+        return scaledPoints_;
+    }
 
     /*!
      * \brief Sets the parameter object for the effective/nested material law.
@@ -135,7 +235,150 @@ public:
     const EffLawParams& effectiveLawParams() const
     { return *effectiveLawParams_; }
 
+    /*!
+     * \brief Returns the transformation of scaled to unscaled saturations for the
+     *        capillary pressure.
+     */
+    const SaturationTransform& scaledToUnscaledSatPc() const
+    { assertFinalized_(); return scaledToUnscaledSatPc_; }
+
+    /*!
+     * \brief Returns the transformation of unscaled to scaled saturations for the
+     *        capillary pressure.
+     */
+    const SaturationTransform& unscaledToScaledSatPc() const
+    { assertFinalized_(); return unscaledToScaledSatPc_; }
+
+    /*!
+     * \brief Returns the transformation of scaled to unscaled saturations for the
+     *        relative permeability of the wetting phase.
+     */
+    const SaturationTransform& scaledToUnscaledSatKrw() const
+    { assertFinalized_(); return scaledToUnscaledSatKrw_; }
+
+    /*!
+     * \brief Returns the transformation of unscaled to scaled saturations for the
+     *        relative permeability of the wetting phase.
+     */
+    const SaturationTransform& unscaledToScaledSatKrw() const
+    { assertFinalized_(); return unscaledToScaledSatKrw_; }
+
+    /*!
+     * \brief Returns the transformation of scaled to unscaled saturations for the
+     *        relative permeability of the non-wetting phase.
+     */
+    const SaturationTransform& scaledToUnscaledSatKrn() const
+    { assertFinalized_(); return scaledToUnscaledSatKrn_; }
+
+    /*!
+     * \brief Returns the transformation of unscaled to scaled saturations for the
+     *        relative permeability of the non-wetting phase.
+     */
+    const SaturationTransform& unscaledToScaledSatKrn() const
+    { assertFinalized_(); return unscaledToScaledSatKrn_; }
+
+    /*!
+     * \brief The factor by which the unscaled capillary pressure is multiplied to get
+     *        the scaled one.
+     */
+    Scalar pcnwScalingFactor() const
+    { assertFinalized_(); return pcnwFactor_; }
+
+    /*!
+     * \brief The factor by which the unscaled relperm of the wetting phase is multiplied
+     *        to get the scaled one.
+     */
+    Scalar krwScalingFactor() const
+    { assertFinalized_(); return krwFactor_; }
+
+    /*!
+     * \brief The factor by which the unscaled relperm of the non-wetting phase is
+     *        multiplied to get the scaled one.
+     */
+    Scalar krnScalingFactor() const
+    { assertFinalized_(); return krnFactor_; }
+
 private:
+    // precompute the coefficients of the transformations between the scaled and the
+    // unscaled spaces. this avoids evaluating the divisions by the differences of the
+    // scaling points for each call of the material law.
+    void updateTransforms_()
+    {
+        const EclEpsConfig& cfg = config();
+
+        if (!cfg.enableSatScaling()) {
+            scaledToUnscaledSatPc_.setIdentity();
+            unscaledToScaledSatPc_.setIdentity();
+            scaledToUnscaledSatKrw_.setIdentity();
+            unscaledToScaledSatKrw_.setIdentity();
+            scaledToUnscaledSatKrn_.setIdentity();
+            unscaledToScaledSatKrn_.setIdentity();
+        }
+        else {
+            const ScalingPoints& unscaled = *unscaledPoints_;
+            const StoredScalingPoints& scaled = scaledPoints_;
+
+            // the saturations of capillary pressure are always scaled using two-point
+            // scaling
+            scaledToUnscaledSatPc_.setTwoPoint(scaled.saturationPcPoints(),
+                                               unscaled.saturationPcPoints());
+            unscaledToScaledSatPc_.setTwoPoint(unscaled.saturationPcPoints(),
+                                               scaled.saturationPcPoints());
+
+            if (cfg.enableThreePointKrSatScaling()) {
+                // the choice between two- and three-point scaling depends on the
+                // unscaled points for both directions
+                if (unscaled.saturationKrwPoints()[1] >= unscaled.saturationKrwPoints()[2]) {
+                    scaledToUnscaledSatKrw_.setTwoPoint(scaled.saturationKrwPoints(),
+                                                        unscaled.saturationKrwPoints());
+                    unscaledToScaledSatKrw_.setTwoPoint(unscaled.saturationKrwPoints(),
+                                                        scaled.saturationKrwPoints());
+                }
+                else {
+                    scaledToUnscaledSatKrw_.setThreePoint(scaled.saturationKrwPoints(),
+                                                          unscaled.saturationKrwPoints());
+                    unscaledToScaledSatKrw_.setThreePoint(unscaled.saturationKrwPoints(),
+                                                          scaled.saturationKrwPoints());
+                }
+
+                if (unscaled.saturationKrnPoints()[1] >= unscaled.saturationKrnPoints()[2]) {
+                    scaledToUnscaledSatKrn_.setTwoPoint(scaled.saturationKrnPoints(),
+                                                        unscaled.saturationKrnPoints());
+                    unscaledToScaledSatKrn_.setTwoPoint(unscaled.saturationKrnPoints(),
+                                                        scaled.saturationKrnPoints());
+                }
+                else {
+                    scaledToUnscaledSatKrn_.setThreePoint(scaled.saturationKrnPoints(),
+                                                          unscaled.saturationKrnPoints());
+                    unscaledToScaledSatKrn_.setThreePoint(unscaled.saturationKrnPoints(),
+                                                          scaled.saturationKrnPoints());
+                }
+            }
+            else {
+                scaledToUnscaledSatKrw_.setTwoPoint(scaled.saturationKrwPoints(),
+                                                    unscaled.saturationKrwPoints());
+                unscaledToScaledSatKrw_.setTwoPoint(unscaled.saturationKrwPoints(),
+                                                    scaled.saturationKrwPoints());
+                scaledToUnscaledSatKrn_.setTwoPoint(scaled.saturationKrnPoints(),
+                                                    unscaled.saturationKrnPoints());
+                unscaledToScaledSatKrn_.setTwoPoint(unscaled.saturationKrnPoints(),
+                                                    scaled.saturationKrnPoints());
+            }
+        }
+
+        pcnwFactor_ = 1.0;
+        if (cfg.enablePcScaling())
+            pcnwFactor_ = static_cast<StorageScalar>(Scalar(scaledPoints_.maxPcnw())/unscaledPoints_->maxPcnw());
+
+        // TODO: three point y-scaling of the relative permeabilities
+        krwFactor_ = 1.0;
+        if (cfg.enableKrwScaling())
+            krwFactor_ = static_cast<StorageScalar>(Scalar(scaledPoints_.maxKrw())/unscaledPoints_->maxKrw());
+
+        krnFactor_ = 1.0;
+        if (cfg.enableKrnScaling())
+            krnFactor_ = static_cast<StorageScalar>(Scalar(scaledPoints_.maxKrn())/unscaledPoints_->maxKrn());
+    }
 
 #ifndef NDEBUG
     void assertFinalized_() const
@@ -151,7 +394,18 @@ private:
 
     std::shared_ptr<EclEpsConfig> config_;
     std::shared_ptr<ScalingPoints> unscaledPoints_;
-    ScalingPoints scaledPoints_;
+    StoredScalingPoints scaledPoints_;
+
+    SaturationTransform scaledToUnscaledSatPc_;
+    SaturationTransform unscaledToScaledSatPc_;
+    SaturationTransform scaledToUnscaledSatKrw_;
+    SaturationTransform unscaledToScaledSatKrw_;
+    SaturationTransform scaledToUnscaledSatKrn_;
+    SaturationTransform unscaledToScaledSatKrn_;
+
+    StorageScalar pcnwFactor_;
+    StorageScalar krwFactor_;
+    StorageScalar krnFactor_;
 };
 
 } // namespace Opm
@@ -28,6 +28,7 @@
 #define OPM_ECL_HYSTERESIS_TWO_PHASE_LAW_HPP
 
 #include "EclHysteresisTwoPhaseLawParams.hpp"
+#include "TwoPhaseSatPcnwKrwKrn.hpp"
 
 namespace Opm {
 /*!
@@ -276,6 +277,36 @@ public:
         return EffectiveLaw::twoPhaseSatKrn(params.imbibitionParams(),
                                             Sw + params.deltaSwImbKrn());
     }
+
+    /*!
+     * \brief Evaluate the capillary pressure and both relative permeabilities at once.
+     *
+     * If all quantities are taken from the drainage curves, the fused kernel of the
+     * nested law is used for them.
+     */
+    template <class Evaluation>
+    static void twoPhaseSatPcnwKrwKrn(Evaluation& pcnw,
+                                      Evaluation& krw,
+                                      Evaluation& krn,
+                                      const Params& params,
+                                      const Evaluation& pcSw,
+                                      const Evaluation& krwSw,
+                                      const Evaluation& krnSw)
+    {
+        if (!params.config().enableHysteresis()
+            || params.config().krHysteresisModel() < 0
+            || (krwSw <= params.krwSwMdc() && krnSw <= params.krnSwMdc()))
+        {
+            Opm::twoPhaseSatPcnwKrwKrn<EffectiveLaw>(pcnw, krw, krn,
+                                                     params.drainageParams(),
+                                                     pcSw, krwSw, krnSw);
+            return;
+        }
+
+        pcnw = twoPhaseSatPcnw(params, pcSw);
+        krw = twoPhaseSatKrw(params, krwSw);
+        krn = twoPhaseSatKrn(params, krnSw);
+    }
 };
 } // namespace Opm
 
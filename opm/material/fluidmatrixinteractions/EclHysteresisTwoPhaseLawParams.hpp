@@ -46,8 +46,13 @@ namespace Opm {
  *
  * \brief A default implementation of the parameters for the material law which
  *        implements the ECL relative permeability and capillary pressure hysteresis
+ *
+ * The 'StorageScalar' template parameter specifies the floating point type which is
+ * used to store the per-element state of the hysteresis model, i.e., the saturations
+ * of the last drainage to imbibition switches and the resulting saturation shifts.
  */
-template <class EffLawT>
+template <class EffLawT,
+          class StorageScalarT = typename EffLawT::Params::Traits::Scalar>
 class EclHysteresisTwoPhaseLawParams
 {
     typedef typename EffLawT::Params EffLawParams;
@@ -55,6 +60,7 @@ class EclHysteresisTwoPhaseLawParams
 
 public:
     typedef typename EffLawParams::Traits Traits;
+    typedef StorageScalarT StorageScalar;
 
     EclHysteresisTwoPhaseLawParams()
     {
@@ -102,8 +108,9 @@ public:
     /*!
      * \brief Sets the parameters used for the drainage curve
      */
+    template <class InfoScalar>
     void setDrainageParams(std::shared_ptr<EffLawParams> value,
-                           const EclEpsScalingPointsInfo<Scalar>& /* info */,
+                           const EclEpsScalingPointsInfo<InfoScalar>& /* info */,
                            EclTwoPhaseSystemType /* twoPhaseSystem */)
 
     {
@@ -122,8 +129,9 @@ public:
     /*!
      * \brief Sets the parameters used for the imbibition curve
      */
+    template <class InfoScalar>
     void setImbibitionParams(std::shared_ptr<EffLawParams> value,
-                             const EclEpsScalingPointsInfo<Scalar>& /* info */,
+                             const EclEpsScalingPointsInfo<InfoScalar>& /* info */,
                              EclTwoPhaseSystemType /* twoPhaseSystem */)
     {
         imbibitionParams_ = *value;
@@ -153,7 +161,7 @@ public:
      *        drainage curve (MDC) to imbibition happend on the capillary pressure curve.
      */
     void setPcSwMdc(Scalar value)
-    { pcSwMdc_ = value; }
+    { pcSwMdc_ = static_cast<StorageScalar>(value); }
 
     /*!
      * \brief Set the saturation of the wetting phase where the last switch from the main
@@ -186,7 +194,7 @@ public:
      *        non-wetting phase.
      */
     void setKrnSwMdc(Scalar value)
-    { krnSwMdc_ = value; }
+    { krnSwMdc_ = static_cast<StorageScalar>(value); }
 
     /*!
      * \brief Set the saturation of the wetting phase where the last switch from the main
@@ -226,7 +234,7 @@ public:
      * krn(Sw) = krn_imbibition(Sw + Sw_shift,krn) else
      */
     void setDeltaSwImbKrn(Scalar value)
-    { deltaSwImbKrn_ = value; }
+    { deltaSwImbKrn_ = static_cast<StorageScalar>(value); }
 
     /*!
      * \brief Returns the saturation value which must be added if krn is calculated using
@@ -246,9 +254,14 @@ public:
      */
     void update(Scalar pcSw, Scalar /* krwSw */, Scalar krnSw)
     {
+        // compare the saturations using the storage precision. this avoids updating the
+        // parameters over and over again if the stored value has been rounded up.
+        StorageScalar storedPcSw = static_cast<StorageScalar>(pcSw);
+        StorageScalar storedKrnSw = static_cast<StorageScalar>(krnSw);
+
         bool updateParams = false;
-        if (pcSw < pcSwMdc_) {
-            pcSwMdc_ = pcSw;
+        if (storedPcSw < pcSwMdc_) {
+            pcSwMdc_ = storedPcSw;
             updateParams = true;
         }
 
@@ -265,8 +278,8 @@ public:
         }
 */
 
-        if (krnSw < krnSwMdc_) {
-            krnSwMdc_ = krnSw;
+        if (storedKrnSw < krnSwMdc_) {
+            krnSwMdc_ = storedKrnSw;
             updateParams = true;
         }
 
@@ -297,18 +310,21 @@ private:
         deltaSwImbKrw_ = SwKrwMdcImbibition - krwSwMdc_;
 */
 
-        Scalar krnMdcDrainage = EffLawT::twoPhaseSatKrn(drainageParams(), krnSwMdc_);
+        Scalar krnSwMdc = krnSwMdc_;
+        Scalar krnMdcDrainage = EffLawT::twoPhaseSatKrn(drainageParams(), krnSwMdc);
         Scalar SwKrnMdcImbibition = EffLawT::twoPhaseSatKrnInv(imbibitionParams(), krnMdcDrainage);
-        deltaSwImbKrn_ = SwKrnMdcImbibition - krnSwMdc_;
+        Scalar deltaSwImbKrn = SwKrnMdcImbibition - krnSwMdc;
+        deltaSwImbKrn_ = static_cast<StorageScalar>(deltaSwImbKrn);
 
-        Scalar pcMdcDrainage = EffLawT::twoPhaseSatPcnw(drainageParams(), pcSwMdc_);
+        Scalar pcSwMdc = pcSwMdc_;
+        Scalar pcMdcDrainage = EffLawT::twoPhaseSatPcnw(drainageParams(), pcSwMdc);
         Scalar SwPcMdcImbibition = EffLawT::twoPhaseSatPcnwInv(imbibitionParams(), pcMdcDrainage);
-        deltaSwImbPc_ = SwPcMdcImbibition - pcSwMdc_;
+        deltaSwImbPc_ = static_cast<StorageScalar>(SwPcMdcImbibition - pcSwMdc);
 
 //        assert(std::abs(EffLawT::twoPhaseSatPcnw(imbibitionParams(), pcSwMdc_ + deltaSwImbPc_)
 //                        - EffLawT::twoPhaseSatPcnw(drainageParams(), pcSwMdc_)) < 1e-8);
-        assert(std::abs(EffLawT::twoPhaseSatKrn(imbibitionParams(), krnSwMdc_ + deltaSwImbKrn_)
-                        - EffLawT::twoPhaseSatKrn(drainageParams(), krnSwMdc_)) < 1e-8);
+        assert(std::abs(EffLawT::twoPhaseSatKrn(imbibitionParams(), krnSwMdc + deltaSwImbKrn)
+                        - EffLawT::twoPhaseSatKrn(drainageParams(), krnSwMdc)) < 1e-8);
 //        assert(std::abs(EffLawT::twoPhaseSatKrw(imbibitionParams(), krwSwMdc_ + deltaSwImbKrw_)
 //                        - EffLawT::twoPhaseSatKrw(drainageParams(), krwSwMdc_)) < 1e-8);
 
@@ -327,15 +343,15 @@ private:
     // three different values because the sourounding code can choose to use different
     // definitions for the saturations for different quantities
 //    Scalar krwSwMdc_;
-    Scalar krnSwMdc_;
-    Scalar pcSwMdc_;
+    StorageScalar krnSwMdc_;
+    StorageScalar pcSwMdc_;
 
     // offsets added to wetting phase saturation uf using the imbibition curves need to
     // be used to calculate the wetting phase relperm, the non-wetting phase relperm and
     // the capillary pressure
 //    Scalar deltaSwImbKrw_;
-    Scalar deltaSwImbKrn_;
-    Scalar deltaSwImbPc_;
+    StorageScalar deltaSwImbKrn_;
+    StorageScalar deltaSwImbPc_;
 
     // trapped non-wetting phase saturation
     //Scalar Sncrt_;
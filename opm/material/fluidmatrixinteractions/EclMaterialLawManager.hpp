@@ -58,13 +58,24 @@ namespace Opm {
  *
  * \brief Provides an simple way to create and manage the material law objects
  *        for a complete ECL deck.
+ *
+ * The 'StorageScalar' template parameter specifies the floating point type which is
+ * used to store the per-element end point scaling and hysteresis data. Using 'float'
+ * significantly reduces the memory footprint of the material laws for large grids
+ * while the material laws are still evaluated using the 'Scalar' type of the traits.
+ * (On x86_64, the objects which are allocated for each element take 2048 bytes of
+ * heap memory with 'double' and 1232 bytes with 'float'. Each element stores four end
+ * point scaling parameter objects, and the precomputed saturation transformations and
+ * scaling factors account for 264 bytes of each of them with 'double' and for 132
+ * bytes with 'float'.)
  */
-template <class TraitsT>
+template <class TraitsT, class StorageScalarT = typename TraitsT::Scalar>
 class EclMaterialLawManager
 {
 private:
     typedef TraitsT Traits;
     typedef typename Traits::Scalar Scalar;
+    typedef StorageScalarT StorageScalar;
     enum { waterPhaseIdx = Traits::wettingPhaseIdx };
     enum { oilPhaseIdx = Traits::nonWettingPhaseIdx };
     enum { gasPhaseIdx = Traits::gasPhaseIdx };
@@ -80,16 +91,16 @@ private:
     typedef typename OilWaterEffectiveTwoPhaseLaw::Params OilWaterEffectiveTwoPhaseParams;
 
     // the two-phase material law which is defined on absolute (scaled) saturations
-    typedef EclEpsTwoPhaseLaw<GasOilEffectiveTwoPhaseLaw> GasOilEpsTwoPhaseLaw;
-    typedef EclEpsTwoPhaseLaw<OilWaterEffectiveTwoPhaseLaw> OilWaterEpsTwoPhaseLaw;
-    typedef typename GasOilEpsTwoPhaseLaw::Params GasOilEpsTwoPhaseParams;
-    typedef typename OilWaterEpsTwoPhaseLaw::Params OilWaterEpsTwoPhaseParams;
+    typedef EclEpsTwoPhaseLawParams<GasOilEffectiveTwoPhaseLaw, StorageScalar> GasOilEpsTwoPhaseParams;
+    typedef EclEpsTwoPhaseLawParams<OilWaterEffectiveTwoPhaseLaw, StorageScalar> OilWaterEpsTwoPhaseParams;
+    typedef EclEpsTwoPhaseLaw<GasOilEffectiveTwoPhaseLaw, GasOilEpsTwoPhaseParams> GasOilEpsTwoPhaseLaw;
+    typedef EclEpsTwoPhaseLaw<OilWaterEffectiveTwoPhaseLaw, OilWaterEpsTwoPhaseParams> OilWaterEpsTwoPhaseLaw;
 
     // the scaled two-phase material laws with hystersis
-    typedef EclHysteresisTwoPhaseLaw<GasOilEpsTwoPhaseLaw> GasOilTwoPhaseLaw;
-    typedef EclHysteresisTwoPhaseLaw<OilWaterEpsTwoPhaseLaw> OilWaterTwoPhaseLaw;
-    typedef typename GasOilTwoPhaseLaw::Params GasOilTwoPhaseHystParams;
-    typedef typename OilWaterTwoPhaseLaw::Params OilWaterTwoPhaseHystParams;
+    typedef EclHysteresisTwoPhaseLawParams<GasOilEpsTwoPhaseLaw, StorageScalar> GasOilTwoPhaseHystParams;
+    typedef EclHysteresisTwoPhaseLawParams<OilWaterEpsTwoPhaseLaw, StorageScalar> OilWaterTwoPhaseHystParams;
+    typedef EclHysteresisTwoPhaseLaw<GasOilEpsTwoPhaseLaw, GasOilTwoPhaseHystParams> GasOilTwoPhaseLaw;
+    typedef EclHysteresisTwoPhaseLaw<OilWaterEpsTwoPhaseLaw, OilWaterTwoPhaseHystParams> OilWaterTwoPhaseLaw;
 
 public:
     // the three-phase material law used by the simulation
@@ -102,15 +113,25 @@ private:
     typedef std::vector<std::shared_ptr<OilWaterEffectiveTwoPhaseParams> > OilWaterEffectiveParamVector;
     typedef std::vector<std::shared_ptr<EclEpsScalingPoints<Scalar> > > GasOilScalingPointsVector;
     typedef std::vector<std::shared_ptr<EclEpsScalingPoints<Scalar> > > OilWaterScalingPointsVector;
-    typedef std::vector<std::shared_ptr<EclEpsScalingPointsInfo<Scalar> > > GasOilScalingInfoVector;
-    typedef std::vector<std::shared_ptr<EclEpsScalingPointsInfo<Scalar> > > OilWaterScalingInfoVector;
-    typedef std::vector<std::shared_ptr<GasOilTwoPhaseHystParams> > GasOilParamVector;
-    typedef std::vector<std::shared_ptr<OilWaterTwoPhaseHystParams> > OilWaterParamVector;
+    typedef std::vector<std::shared_ptr<EclEpsScalingPointsInfo<StorageScalar> > > OilWaterScalingInfoVector;
     typedef std::vector<std::shared_ptr<MaterialLawParams> > MaterialLawParamsVector;
 
 public:
     EclMaterialLawManager()
-    {}
+    {
+        enableUniformSegmentIndex_ = false;
+    }
+
+    /*!
+     * \brief Specify whether the segments of the saturation functions of each region
+     *        ought to be indexed using uniform saturation grids.
+     *
+     * This makes the relative permeability and capillary pressure lookups cheaper
+     * because the segment of a saturation can be determined by direct indexing. The
+     * results are unchanged. The method must be called before initFromDeck().
+     */
+    void setUniformSegmentIndex(bool yesno)
+    { enableUniformSegmentIndex_ = yesno; }
 
     void initFromDeck(Opm::DeckConstPtr deck,
                       Opm::EclipseStateConstPtr eclState,
@@ -187,8 +208,11 @@ public:
             Scalar pcowAtSw = pc[oilPhaseIdx] - pc[waterPhaseIdx];
             if (pcowAtSw > 0.0) {
                 elemScaledEpsInfo.maxPcow *= pcow/pcowAtSw;
-                auto& elemEclEpsScalingPoints = oilWaterScaledEpsPointsDrainage(elemIdx);
-                elemEclEpsScalingPoints.init(elemScaledEpsInfo, *oilWaterEclEpsConfig_, Opm::EclOilWaterSystem);
+                auto& elemDrainageParams = oilWaterDrainageParams_(elemIdx);
+                elemDrainageParams.scaledPoints().init(elemScaledEpsInfo, *oilWaterEclEpsConfig_, Opm::EclOilWaterSystem);
+
+                // update the precomputed scaling transformations
+                elemDrainageParams.finalize();
             }
         }
 
@@ -233,49 +257,61 @@ public:
         MaterialLaw::updateHysteresis(*threePhaseParams, fluidState);
     }
 
-    EclEpsScalingPoints<Scalar>& oilWaterScaledEpsPointsDrainage(unsigned elemIdx)
+    /*!
+     * \brief Returns the scaled end points of the oil-water drainage curve of an element.
+     *
+     * The scaling points can only be modified via applySwatinit() because the
+     * saturation transformations of the element need to be updated afterwards.
+     */
+    const EclEpsScalingPoints<StorageScalar>& oilWaterScaledEpsPointsDrainage(unsigned elemIdx) const
+    {
+        const OilWaterEpsTwoPhaseParams& drainageParams = oilWaterDrainageParams_(elemIdx);
+        return drainageParams.scaledPoints();
+    }
+
+    const Opm::EclEpsScalingPointsInfo<StorageScalar>& oilWaterScaledEpsInfoDrainage(size_t elemIdx) const
+    {
+        return *oilWaterScaledEpsInfoDrainage_[elemIdx];
+    }
+
+    const std::shared_ptr<EclEpsScalingPointsInfo<StorageScalar> >& oilWaterScaledEpsInfoDrainagePointer(unsigned elemIdx) const
+    {
+        return oilWaterScaledEpsInfoDrainage_[elemIdx];
+    }
+
+    std::shared_ptr<EclEpsScalingPointsInfo<StorageScalar> >& oilWaterScaledEpsInfoDrainagePointer(unsigned elemIdx)
+    {
+        return oilWaterScaledEpsInfoDrainage_[elemIdx];
+    }
+private:
+    OilWaterEpsTwoPhaseParams& oilWaterDrainageParams_(unsigned elemIdx) const
     {
         auto& materialParams = *materialLawParams_[elemIdx];
         switch (materialParams.approach()) {
         case EclStone1Approach: {
             auto& realParams = materialParams.template getRealParams<Opm::EclStone1Approach>();
-            return realParams.oilWaterParams().drainageParams().scaledPoints();
+            return realParams.oilWaterParams().drainageParams();
         }
 
         case EclStone2Approach: {
             auto& realParams = materialParams.template getRealParams<Opm::EclStone2Approach>();
-            return realParams.oilWaterParams().drainageParams().scaledPoints();
+            return realParams.oilWaterParams().drainageParams();
         }
 
         case EclDefaultApproach: {
             auto& realParams = materialParams.template getRealParams<Opm::EclDefaultApproach>();
-            return realParams.oilWaterParams().drainageParams().scaledPoints();
+            return realParams.oilWaterParams().drainageParams();
         }
 
         case EclTwoPhaseApproach: {
             auto& realParams = materialParams.template getRealParams<Opm::EclTwoPhaseApproach>();
-            return realParams.oilWaterParams().drainageParams().scaledPoints();
+            return realParams.oilWaterParams().drainageParams();
         }
         default:
             OPM_THROW(std::logic_error, "Enum value for material approach unknown!");
         }
     }
 
-    const Opm::EclEpsScalingPointsInfo<Scalar>& oilWaterScaledEpsInfoDrainage(size_t elemIdx) const
-    {
-        return *oilWaterScaledEpsInfoDrainage_[elemIdx];
-    }
-
-    const std::shared_ptr<EclEpsScalingPointsInfo<Scalar> >& oilWaterScaledEpsInfoDrainagePointer(unsigned elemIdx) const
-    {
-        return oilWaterScaledEpsInfoDrainage_[elemIdx];
-    }
-
-    std::shared_ptr<EclEpsScalingPointsInfo<Scalar> >& oilWaterScaledEpsInfoDrainagePointer(unsigned elemIdx)
-    {
-        return oilWaterScaledEpsInfoDrainage_[elemIdx];
-    }
-private:
     void readGlobalEpsOptions_(Opm::DeckConstPtr deck, Opm::EclipseStateConstPtr eclState)
     {
         oilWaterEclEpsConfig_ = std::make_shared<Opm::EclEpsConfig>();
@@ -384,145 +420,107 @@ private:
 
         }
 
-        // read the scaled end point scaling parameters which are specific for each
-        // element
-        GasOilScalingInfoVector gasOilScaledInfoVector(numCompressedElems);
-        oilWaterScaledEpsInfoDrainage_.resize(numCompressedElems);
-        GasOilScalingInfoVector gasOilScaledImbInfoVector;
-        OilWaterScalingInfoVector oilWaterScaledImbInfoVector;
-
-        GasOilScalingPointsVector gasOilScaledPointsVector(numCompressedElems);
-        GasOilScalingPointsVector oilWaterScaledEpsPointsDrainage(numCompressedElems);
-        GasOilScalingPointsVector gasOilScaledImbPointsVector;
-        OilWaterScalingPointsVector oilWaterScaledImbPointsVector;
-
-        if (enableHysteresis()) {
-            gasOilScaledImbInfoVector.resize(numCompressedElems);
-            gasOilScaledImbPointsVector.resize(numCompressedElems);
-            oilWaterScaledImbInfoVector.resize(numCompressedElems);
-            oilWaterScaledImbPointsVector.resize(numCompressedElems);
-        }
-
+        // create the parameter objects for the material laws of the individual
+        // elements. the scaled end points are computed on the fly, i.e., only the
+        // per-element quantities which are required after the initialization are
+        // kept. note that the grid properties are only referenced, so this does not
+        // copy any data for the full cartesian grid.
         EclEpsGridProperties epsGridProperties, epsImbGridProperties;
         epsGridProperties.initFromDeck(deck, eclState, /*imbibition=*/false);
         if (enableHysteresis())
             epsImbGridProperties.initFromDeck(deck, eclState, /*imbibition=*/true);
-        for (unsigned elemIdx = 0; elemIdx < numCompressedElems; ++elemIdx) {
-            unsigned cartElemIdx = static_cast<unsigned>(compressedToCartesianElemIdx[elemIdx]);
-            readGasOilScaledPoints_(gasOilScaledInfoVector,
-                                    gasOilScaledPointsVector,
-                                    gasOilConfig,
-                                    epsGridProperties,
-                                    elemIdx,
-                                    cartElemIdx);
-            readOilWaterScaledPoints_(oilWaterScaledEpsInfoDrainage_,
-                                      oilWaterScaledEpsPointsDrainage,
-                                      oilWaterConfig,
-                                      epsGridProperties,
-                                      elemIdx,
-                                      cartElemIdx);
 
-            if (enableHysteresis()) {
-                readGasOilScaledPoints_(gasOilScaledImbInfoVector,
-                                        gasOilScaledImbPointsVector,
-                                        gasOilConfig,
-                                        epsImbGridProperties,
-                                        elemIdx,
-                                        cartElemIdx);
-                readOilWaterScaledPoints_(oilWaterScaledImbInfoVector,
-                                          oilWaterScaledImbPointsVector,
-                                          oilWaterConfig,
-                                          epsImbGridProperties,
-                                          elemIdx,
-                                          cartElemIdx);
-            }
-        }
-
-        // create the parameter objects for the two-phase laws
-        GasOilParamVector gasOilParams(numCompressedElems);
-        OilWaterParamVector oilWaterParams(numCompressedElems);
-        GasOilParamVector gasOilImbParams;
-        OilWaterParamVector oilWaterImbParams;
-
-        if (enableHysteresis()) {
-            gasOilImbParams.resize(numCompressedElems);
-            oilWaterImbParams.resize(numCompressedElems);
-        }
-
-        const auto& imbnumData = eclState->getIntGridProperty("IMBNUM")->getData();
+        oilWaterScaledEpsInfoDrainage_.resize(numCompressedElems);
+        materialLawParams_.resize(numCompressedElems);
         assert(numCompressedElems == satnumRegionArray.size());
         for (unsigned elemIdx = 0; elemIdx < numCompressedElems; ++elemIdx) {
+            unsigned cartElemIdx = static_cast<unsigned>(compressedToCartesianElemIdx[elemIdx]);
             unsigned satnumIdx = static_cast<unsigned>(satnumRegionArray[elemIdx]);
 
-            gasOilParams[elemIdx] = std::make_shared<GasOilTwoPhaseHystParams>();
-            oilWaterParams[elemIdx] = std::make_shared<OilWaterTwoPhaseHystParams>();
-
-            gasOilParams[elemIdx]->setConfig(hysteresisConfig_);
-            oilWaterParams[elemIdx]->setConfig(hysteresisConfig_);
-
-            auto gasOilDrainParams = std::make_shared<GasOilEpsTwoPhaseParams>();
-            gasOilDrainParams->setConfig(gasOilConfig);
-            gasOilDrainParams->setUnscaledPoints(gasOilUnscaledPointsVector[satnumIdx]);
-            gasOilDrainParams->setScaledPoints(gasOilScaledPointsVector[elemIdx]);
-            gasOilDrainParams->setEffectiveLawParams(gasOilEffectiveParamVector[satnumIdx]);
-            gasOilDrainParams->finalize();
-
-            auto oilWaterDrainParams = std::make_shared<OilWaterEpsTwoPhaseParams>();
-            oilWaterDrainParams->setConfig(oilWaterConfig);
-            oilWaterDrainParams->setUnscaledPoints(oilWaterUnscaledPointsVector[satnumIdx]);
-            oilWaterDrainParams->setScaledPoints(oilWaterScaledEpsPointsDrainage[elemIdx]);
-            oilWaterDrainParams->setEffectiveLawParams(oilWaterEffectiveParamVector[satnumIdx]);
-            oilWaterDrainParams->finalize();
-
-            gasOilParams[elemIdx]->setDrainageParams(gasOilDrainParams,
-                                                         *gasOilScaledInfoVector[elemIdx],
-                                                         EclGasOilSystem);
-            oilWaterParams[elemIdx]->setDrainageParams(oilWaterDrainParams,
-                                                           *oilWaterScaledEpsInfoDrainage_[elemIdx],
-                                                           EclOilWaterSystem);
+            auto gasOilParams = std::make_shared<GasOilTwoPhaseHystParams>();
+            auto oilWaterParams = std::make_shared<OilWaterTwoPhaseHystParams>();
+
+            gasOilParams->setConfig(hysteresisConfig_);
+            oilWaterParams->setConfig(hysteresisConfig_);
+
+            EclEpsScalingPointsInfo<StorageScalar> gasOilScaledInfo;
+            auto gasOilDrainParams =
+                createScaledParams_<GasOilEpsTwoPhaseParams>(gasOilScaledInfo,
+                                                             gasOilConfig,
+                                                             EclGasOilSystem,
+                                                             gasOilUnscaledPointsVector,
+                                                             gasOilEffectiveParamVector,
+                                                             epsGridProperties,
+                                                             satnumIdx,
+                                                             cartElemIdx);
+
+            oilWaterScaledEpsInfoDrainage_[elemIdx] =
+                std::make_shared<EclEpsScalingPointsInfo<StorageScalar> >();
+            auto& oilWaterScaledInfo = *oilWaterScaledEpsInfoDrainage_[elemIdx];
+            auto oilWaterDrainParams =
+                createScaledParams_<OilWaterEpsTwoPhaseParams>(oilWaterScaledInfo,
+                                                               oilWaterConfig,
+                                                               EclOilWaterSystem,
+                                                               oilWaterUnscaledPointsVector,
+                                                               oilWaterEffectiveParamVector,
+                                                               epsGridProperties,
+                                                               satnumIdx,
+                                                               cartElemIdx);
+
+            gasOilParams->setDrainageParams(gasOilDrainParams,
+                                            gasOilScaledInfo,
+                                            EclGasOilSystem);
+            oilWaterParams->setDrainageParams(oilWaterDrainParams,
+                                              oilWaterScaledInfo,
+                                              EclOilWaterSystem);
 
             if (enableHysteresis()) {
-                unsigned imbRegionIdx = static_cast<unsigned>(imbnumData[elemIdx]) - 1;
-
-                auto gasOilImbParamsHyst = std::make_shared<GasOilEpsTwoPhaseParams>();
-                gasOilImbParamsHyst->setConfig(gasOilConfig);
-                gasOilImbParamsHyst->setUnscaledPoints(gasOilUnscaledPointsVector[imbRegionIdx]);
-                gasOilImbParamsHyst->setScaledPoints(gasOilScaledImbPointsVector[elemIdx]);
-                gasOilImbParamsHyst->setEffectiveLawParams(gasOilEffectiveParamVector[imbRegionIdx]);
-                gasOilImbParamsHyst->finalize();
-
-                auto oilWaterImbParamsHyst = std::make_shared<OilWaterEpsTwoPhaseParams>();
-                oilWaterImbParamsHyst->setConfig(oilWaterConfig);
-                oilWaterImbParamsHyst->setUnscaledPoints(oilWaterUnscaledPointsVector[imbRegionIdx]);
-                oilWaterImbParamsHyst->setScaledPoints(oilWaterScaledImbPointsVector[elemIdx]);
-                oilWaterImbParamsHyst->setEffectiveLawParams(oilWaterEffectiveParamVector[imbRegionIdx]);
-                oilWaterImbParamsHyst->finalize();
-
-                gasOilParams[elemIdx]->setImbibitionParams(gasOilImbParamsHyst,
-                                                               *gasOilScaledImbInfoVector[elemIdx],
-                                                               EclGasOilSystem);
-                oilWaterParams[elemIdx]->setImbibitionParams(oilWaterImbParamsHyst,
-                                                                 *gasOilScaledImbInfoVector[elemIdx],
-                                                                 EclGasOilSystem);
+                // IMBNUM is specified for the cartesian grid
+                unsigned imbRegionIdx =
+                    static_cast<unsigned>((*epsImbGridProperties.satnum)[cartElemIdx]) - 1; // ECL uses Fortran indices!
+
+                EclEpsScalingPointsInfo<StorageScalar> gasOilScaledImbInfo;
+                auto gasOilImbParamsHyst =
+                    createScaledParams_<GasOilEpsTwoPhaseParams>(gasOilScaledImbInfo,
+                                                                 gasOilConfig,
+                                                                 EclGasOilSystem,
+                                                                 gasOilUnscaledPointsVector,
+                                                                 gasOilEffectiveParamVector,
+                                                                 epsImbGridProperties,
+                                                                 imbRegionIdx,
+                                                                 cartElemIdx);
+
+                EclEpsScalingPointsInfo<StorageScalar> oilWaterScaledImbInfo;
+                auto oilWaterImbParamsHyst =
+                    createScaledParams_<OilWaterEpsTwoPhaseParams>(oilWaterScaledImbInfo,
+                                                                   oilWaterConfig,
+                                                                   EclOilWaterSystem,
+                                                                   oilWaterUnscaledPointsVector,
+                                                                   oilWaterEffectiveParamVector,
+                                                                   epsImbGridProperties,
+                                                                   imbRegionIdx,
+                                                                   cartElemIdx);
+
+                gasOilParams->setImbibitionParams(gasOilImbParamsHyst,
+                                                  gasOilScaledImbInfo,
+                                                  EclGasOilSystem);
+                oilWaterParams->setImbibitionParams(oilWaterImbParamsHyst,
+                                                    oilWaterScaledImbInfo,
+                                                    EclOilWaterSystem);
             }
 
-            gasOilParams[elemIdx]->finalize();
-            oilWaterParams[elemIdx]->finalize();
-        }
+            gasOilParams->finalize();
+            oilWaterParams->finalize();
 
-        // create the parameter objects for the three-phase law
-        materialLawParams_.resize(numCompressedElems);
-        for (unsigned elemIdx = 0; elemIdx < numCompressedElems; ++elemIdx) {
+            // create the parameter objects for the three-phase law
             materialLawParams_[elemIdx] = std::make_shared<MaterialLawParams>();
-            unsigned satnumIdx = static_cast<unsigned>(satnumRegionArray[elemIdx]);
-
             initThreePhaseParams_(deck,
                                   eclState,
                                   *materialLawParams_[elemIdx],
                                   satnumIdx,
-                                  *oilWaterScaledEpsInfoDrainage_[elemIdx],
-                                  oilWaterParams[elemIdx],
-                                  gasOilParams[elemIdx]);
+                                  oilWaterScaledInfo,
+                                  oilWaterParams,
+                                  gasOilParams);
 
             materialLawParams_[elemIdx]->finalize();
         }
@@ -664,7 +662,7 @@ private:
         effParams.setKrwSamples(SoKroSamples, sgofTable.getColumn("KROG").vectorCopy());
         effParams.setKrnSamples(SoSamples, sgofTable.getColumn("KRG").vectorCopy());
         effParams.setPcnwSamples(SoSamples, sgofTable.getColumn("PCOG").vectorCopy());
-        effParams.finalize();
+        finalizeEffectiveParams_(effParams);
     }
 
     void readGasOilEffectiveParametersSlgof_(GasOilEffectiveTwoPhaseParams& effParams,
@@ -682,7 +680,7 @@ private:
         effParams.setKrwSamples(SoKroSamples, slgofTable.getColumn("KROG").vectorCopy());
         effParams.setKrnSamples(SoSamples, slgofTable.getColumn("KRG").vectorCopy());
         effParams.setPcnwSamples(SoSamples, slgofTable.getColumn("PCOG").vectorCopy());
-        effParams.finalize();
+        finalizeEffectiveParams_(effParams);
     }
 
     void readGasOilEffectiveParametersFamily2_(GasOilEffectiveTwoPhaseParams& effParams,
@@ -700,6 +698,13 @@ private:
         effParams.setKrwSamples(SoColumn, sof3Table.getColumn("KROG").vectorCopy());
         effParams.setKrnSamples(SoSamples, sgfnTable.getColumn("KRG").vectorCopy());
         effParams.setPcnwSamples(SoSamples, sgfnTable.getColumn("PCOG").vectorCopy());
+        finalizeEffectiveParams_(effParams);
+    }
+
+    template <class EffParams>
+    void finalizeEffectiveParams_(EffParams& effParams)
+    {
+        effParams.setUniformSegmentIndex(enableUniformSegmentIndex_);
         effParams.finalize();
     }
 
@@ -729,7 +734,7 @@ private:
             effParams.setKrwSamples(SwColumn, swofTable.getColumn("KRW").vectorCopy());
             effParams.setKrnSamples(SwColumn, swofTable.getColumn("KROW").vectorCopy());
             effParams.setPcnwSamples(SwColumn, swofTable.getColumn("PCOW").vectorCopy());
-            effParams.finalize();
+            finalizeEffectiveParams_(effParams);
 
             // Todo (?): support for twophase simulations using family2?
             return;
@@ -748,7 +753,7 @@ private:
             effParams.setKrwSamples(SwColumn, swofTable.getColumn("KRW").vectorCopy());
             effParams.setKrnSamples(SwColumn, swofTable.getColumn("KROW").vectorCopy());
             effParams.setPcnwSamples(SwColumn, swofTable.getColumn("PCOW").vectorCopy());
-            effParams.finalize();
+            finalizeEffectiveParams_(effParams);
             break;
         }
         case FamilyII:
@@ -765,7 +770,7 @@ private:
             effParams.setKrwSamples(SwColumn, swfnTable.getColumn("KRW").vectorCopy());
             effParams.setKrnSamples(SwSamples, sof3Table.getColumn("KROW").vectorCopy());
             effParams.setPcnwSamples(SwColumn, swfnTable.getColumn("PCOW").vectorCopy());
-            effParams.finalize();
+            finalizeEffectiveParams_(effParams);
             break;
         }
 
@@ -799,45 +804,37 @@ private:
         dest[satnumIdx]->init(unscaledEpsInfo_[satnumIdx], *config, EclOilWaterSystem);
     }
 
-    template <class InfoContainer, class PointsContainer>
-    void readGasOilScaledPoints_(InfoContainer& destInfo,
-                                 PointsContainer& destPoints,
-                                 std::shared_ptr<EclEpsConfig> config,
-                                 const EclEpsGridProperties& epsGridProperties,
-                                 unsigned elemIdx,
-                                 unsigned cartElemIdx)
+    // create the end point scaling parameters of a two-phase system for an element.
+    // 'regionIdx' is the index of the saturation region which provides the unscaled
+    // end points and the parameters of the effective law.
+    template <class EpsParams, class UnscaledPointsContainer, class EffectiveParamsContainer>
+    std::shared_ptr<EpsParams> createScaledParams_(EclEpsScalingPointsInfo<StorageScalar>& scaledInfo,
+                                                   std::shared_ptr<EclEpsConfig> config,
+                                                   EclTwoPhaseSystemType twoPhaseSystem,
+                                                   const UnscaledPointsContainer& unscaledPoints,
+                                                   const EffectiveParamsContainer& effectiveParams,
+                                                   const EclEpsGridProperties& epsGridProperties,
+                                                   unsigned regionIdx,
+                                                   unsigned cartElemIdx)
     {
-        unsigned satnumIdx = static_cast<unsigned>((*epsGridProperties.satnum)[cartElemIdx]) - 1; // ECL uses Fortran indices!
+        scaledInfo.assign(unscaledEpsInfo_[regionIdx]);
+        scaledInfo.extractScaled(epsGridProperties, cartElemIdx);
 
-        destInfo[elemIdx] = std::make_shared<EclEpsScalingPointsInfo<Scalar> >(unscaledEpsInfo_[satnumIdx]);
-        destInfo[elemIdx]->extractScaled(epsGridProperties, cartElemIdx);
+        auto epsParams = std::make_shared<EpsParams>();
+        epsParams->setConfig(config);
+        epsParams->setUnscaledPoints(unscaledPoints[regionIdx]);
+        epsParams->scaledPoints().init(scaledInfo, *config, twoPhaseSystem);
+        epsParams->setEffectiveLawParams(effectiveParams[regionIdx]);
+        epsParams->finalize();
 
-        destPoints[elemIdx] = std::make_shared<EclEpsScalingPoints<Scalar> >();
-        destPoints[elemIdx]->init(*destInfo[elemIdx], *config, EclGasOilSystem);
-    }
-
-    template <class InfoContainer, class PointsContainer>
-    void readOilWaterScaledPoints_(InfoContainer& destInfo,
-                                   PointsContainer& destPoints,
-                                   std::shared_ptr<EclEpsConfig> config,
-                                   const EclEpsGridProperties& epsGridProperties,
-                                   unsigned elemIdx,
-                                   unsigned cartElemIdx)
-    {
-        unsigned satnumIdx = static_cast<unsigned>((*epsGridProperties.satnum)[cartElemIdx]) - 1; // ECL uses Fortran indices!
-
-        destInfo[elemIdx] = std::make_shared<EclEpsScalingPointsInfo<Scalar> >(unscaledEpsInfo_[satnumIdx]);
-        destInfo[elemIdx]->extractScaled(epsGridProperties, cartElemIdx);
-
-        destPoints[elemIdx] = std::make_shared<EclEpsScalingPoints<Scalar> >();
-        destPoints[elemIdx]->init(*destInfo[elemIdx], *config, EclOilWaterSystem);
+        return epsParams;
     }
 
     void initThreePhaseParams_(Opm::DeckConstPtr deck,
                                Opm::EclipseStateConstPtr /* eclState */,
                                MaterialLawParams& materialParams,
                                unsigned satnumIdx,
-                               const EclEpsScalingPointsInfo<Scalar>& epsInfo,
+                               const EclEpsScalingPointsInfo<StorageScalar>& epsInfo,
                                std::shared_ptr<OilWaterTwoPhaseHystParams> oilWaterParams,
                                std::shared_ptr<GasOilTwoPhaseHystParams> gasOilParams)
     {
@@ -893,6 +890,8 @@ private:
     bool enableEndPointScaling_;
     std::shared_ptr<EclHysteresisConfig> hysteresisConfig_;
 
+    bool enableUniformSegmentIndex_;
+
     std::shared_ptr<EclEpsConfig> oilWaterEclEpsConfig_;
     std::vector<Opm::EclEpsScalingPointsInfo<Scalar>> unscaledEpsInfo_;
     OilWaterScalingInfoVector oilWaterScaledEpsInfoDrainage_;
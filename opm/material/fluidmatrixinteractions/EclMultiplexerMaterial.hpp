@@ -279,6 +279,45 @@ public:
         }
     }
 
+    /*!
+     * \brief The capillary pressures and the relative permeabilities of all phases.
+     *
+     * This is equivalent to calling capillaryPressures() and relativePermeabilities(),
+     * but the nested two-phase laws are only evaluated once for all quantities.
+     */
+    template <class PcContainerT, class KrContainerT, class FluidState>
+    static void capillaryPressuresAndRelativePermeabilities(PcContainerT &pcValues,
+                                                            KrContainerT &krValues,
+                                                            const Params &params,
+                                                            const FluidState &fluidState)
+    {
+        switch (params.approach()) {
+        case EclStone1Approach:
+            Stone1Material::capillaryPressuresAndRelativePermeabilities(pcValues, krValues,
+                                                                        params.template getRealParams<EclStone1Approach>(),
+                                                                        fluidState);
+            break;
+
+        case EclStone2Approach:
+            Stone2Material::capillaryPressuresAndRelativePermeabilities(pcValues, krValues,
+                                                                        params.template getRealParams<EclStone2Approach>(),
+                                                                        fluidState);
+            break;
+
+        case EclDefaultApproach:
+            DefaultMaterial::capillaryPressuresAndRelativePermeabilities(pcValues, krValues,
+                                                                         params.template getRealParams<EclDefaultApproach>(),
+                                                                         fluidState);
+            break;
+
+        case EclTwoPhaseApproach:
+            TwoPhaseMaterial::capillaryPressuresAndRelativePermeabilities(pcValues, krValues,
+                                                                          params.template getRealParams<EclTwoPhaseApproach>(),
+                                                                          fluidState);
+            break;
+        }
+    }
+
     /*!
      * \brief The relative permeability of the gas phase.
      */
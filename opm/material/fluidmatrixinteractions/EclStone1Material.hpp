@@ -28,6 +28,7 @@
 #define OPM_ECL_STONE1_MATERIAL_HPP
 
 #include "EclStone1MaterialParams.hpp"
+#include "TwoPhaseSatPcnwKrwKrn.hpp"
 
 #include <opm/material/common/Valgrind.hpp>
 #include <opm/material/common/MathToolbox.hpp>
@@ -249,10 +250,65 @@ public:
                                        const FluidState &fluidState)
     {
         typedef typename std::remove_reference<decltype(values[0])>::type Evaluation;
+        typedef MathToolbox<typename FluidState::Scalar> FsToolbox;
+
+        Scalar Swco = params.Swl();
+
+        const Evaluation& Sw = FsToolbox::template toLhs<Evaluation>(fluidState.saturation(waterPhaseIdx));
+        const Evaluation& Sg = FsToolbox::template toLhs<Evaluation>(fluidState.saturation(gasPhaseIdx));
+
+        // evaluate each two-phase relperm only once. the capillary pressures are not
+        // needed here, use capillaryPressuresAndRelativePermeabilities() if they are.
+        const Evaluation& krw = OilWaterMaterialLaw::twoPhaseSatKrw(params.oilWaterParams(), Sw);
+        const Evaluation& kro_ow = OilWaterMaterialLaw::twoPhaseSatKrn(params.oilWaterParams(), Sw);
+        const Evaluation& kro_go = GasOilMaterialLaw::twoPhaseSatKrw(params.gasOilParams(), 1 - Sg - Swco);
+        const Evaluation& krg = GasOilMaterialLaw::twoPhaseSatKrn(params.gasOilParams(), 1 - Sg);
 
-        values[waterPhaseIdx] = krw<FluidState, Evaluation>(params, fluidState);
-        values[oilPhaseIdx] = krn<FluidState, Evaluation>(params, fluidState);
-        values[gasPhaseIdx] = krg<FluidState, Evaluation>(params, fluidState);
+        values[waterPhaseIdx] = krw;
+        values[oilPhaseIdx] = krnFromTwoPhase_(params, Sw, Sg, kro_ow, kro_go);
+        values[gasPhaseIdx] = krg;
+    }
+
+    /*!
+     * \brief The capillary pressures and the relative permeabilities of all phases.
+     *
+     * This computes the same quantities as capillaryPressures() and
+     * relativePermeabilities(), but each nested two-phase law is only evaluated
+     * once for all of them.
+     */
+    template <class PcContainerT, class KrContainerT, class FluidState>
+    static void capillaryPressuresAndRelativePermeabilities(PcContainerT &pcValues,
+                                                            KrContainerT &krValues,
+                                                            const Params &params,
+                                                            const FluidState &fluidState)
+    {
+        typedef typename std::remove_reference<decltype(krValues[0])>::type Evaluation;
+        typedef MathToolbox<typename FluidState::Scalar> FsToolbox;
+
+        Scalar Swco = params.Swl();
+
+        const Evaluation& Sw = FsToolbox::template toLhs<Evaluation>(fluidState.saturation(waterPhaseIdx));
+        const Evaluation& Sg = FsToolbox::template toLhs<Evaluation>(fluidState.saturation(gasPhaseIdx));
+        const Evaluation& SwGo = 1 - Sg;
+        const Evaluation& SoGo = 1 - Sg - Swco;
+
+        Evaluation pcow, krw, kro_ow;
+        twoPhaseSatPcnwKrwKrn<OilWaterMaterialLaw>(pcow, krw, kro_ow,
+                                                   params.oilWaterParams(),
+                                                   Sw, Sw, Sw);
+
+        Evaluation pcgo, kro_go, krg;
+        twoPhaseSatPcnwKrwKrn<GasOilMaterialLaw>(pcgo, kro_go, krg,
+                                                 params.gasOilParams(),
+                                                 SwGo, SoGo, SwGo);
+
+        pcValues[gasPhaseIdx] = pcgo;
+        pcValues[oilPhaseIdx] = 0;
+        pcValues[waterPhaseIdx] = - pcow;
+
+        krValues[waterPhaseIdx] = krw;
+        krValues[oilPhaseIdx] = krnFromTwoPhase_(params, Sw, Sg, kro_ow, kro_go);
+        krValues[gasPhaseIdx] = krg;
     }
 
     /*!
@@ -288,9 +344,49 @@ public:
     static Evaluation krn(const Params &params,
                           const FluidState &fluidState)
     {
-        typedef MathToolbox<Evaluation> Toolbox;
         typedef MathToolbox<typename FluidState::Scalar> FsToolbox;
 
+        Scalar Swco = params.Swl();
+
+        const Evaluation& Sw = FsToolbox::template toLhs<Evaluation>(fluidState.saturation(waterPhaseIdx));
+        const Evaluation& Sg = FsToolbox::template toLhs<Evaluation>(fluidState.saturation(gasPhaseIdx));
+
+        const Evaluation& kro_ow = OilWaterMaterialLaw::twoPhaseSatKrn(params.oilWaterParams(), Sw);
+        const Evaluation& kro_go = GasOilMaterialLaw::twoPhaseSatKrw(params.gasOilParams(), 1 - Sg - Swco);
+
+        return krnFromTwoPhase_(params, Sw, Sg, kro_ow, kro_go);
+    }
+
+    /*!
+     * \brief Update the hysteresis parameters after a time step.
+     *
+     * This assumes that the nested two-phase material laws are parameters for
+     * EclHysteresisLaw. If they are not, calling this methid will cause a compiler
+     * error. (But not calling it will still work.)
+     */
+    template <class FluidState>
+    static void updateHysteresis(Params &params, const FluidState &fluidState)
+    {
+        typedef MathToolbox<typename FluidState::Scalar> FsToolbox;
+
+        Scalar Sw = FsToolbox::value(fluidState.saturation(waterPhaseIdx));
+        Scalar Sg = FsToolbox::value(fluidState.saturation(gasPhaseIdx));
+
+        params.oilWaterParams().update(/*pcSw=*/Sw, /*krwSw=*/Sw, /*krnSw=*/Sw);
+        params.gasOilParams().update(/*pcSw=*/1 - Sg, /*krwSw=*/1 - Sg, /*krnSw=*/1 - Sg);
+    }
+
+private:
+    // combine the oil relperms of the two two-phase systems using Stone's first model
+    template <class Evaluation>
+    static Evaluation krnFromTwoPhase_(const Params &params,
+                                       const Evaluation& Sw,
+                                       const Evaluation& Sg,
+                                       const Evaluation& kro_ow,
+                                       const Evaluation& kro_go)
+    {
+        typedef MathToolbox<Evaluation> Toolbox;
+
         // the Eclipse docu is inconsistent with naming the variable of connate water: In
         // some places the connate water saturation is represented by "Swl", in others
         // "Swco" is used.
@@ -299,12 +395,6 @@ public:
         // oil relperm at connate water saturations (with Sg=0)
         Scalar krocw = params.krocw();
 
-        const Evaluation& Sw = FsToolbox::template toLhs<Evaluation>(fluidState.saturation(waterPhaseIdx));
-        const Evaluation& Sg = FsToolbox::template toLhs<Evaluation>(fluidState.saturation(gasPhaseIdx));
-
-        Evaluation kro_ow = OilWaterMaterialLaw::twoPhaseSatKrn(params.oilWaterParams(), Sw);
-        Evaluation kro_go = GasOilMaterialLaw::twoPhaseSatKrw(params.gasOilParams(), 1 - Sg - Swco);
-
         Evaluation beta;
         if (Sw <= Swco)
             beta = 1.0;
@@ -324,25 +414,6 @@ public:
 
         return Toolbox::max(0.0, Toolbox::min(1.0, beta*kro_ow*kro_go/krocw));
     }
-
-    /*!
-     * \brief Update the hysteresis parameters after a time step.
-     *
-     * This assumes that the nested two-phase material laws are parameters for
-     * EclHysteresisLaw. If they are not, calling this methid will cause a compiler
-     * error. (But not calling it will still work.)
-     */
-    template <class FluidState>
-    static void updateHysteresis(Params &params, const FluidState &fluidState)
-    {
-        typedef MathToolbox<typename FluidState::Scalar> FsToolbox;
-
-        Scalar Sw = FsToolbox::value(fluidState.saturation(waterPhaseIdx));
-        Scalar Sg = FsToolbox::value(fluidState.saturation(gasPhaseIdx));
-
-        params.oilWaterParams().update(/*pcSw=*/Sw, /*krwSw=*/Sw, /*krnSw=*/Sw);
-        params.gasOilParams().update(/*pcSw=*/1 - Sg, /*krwSw=*/1 - Sg, /*krnSw=*/1 - Sg);
-    }
 };
 } // namespace Opm
 
@@ -28,6 +28,7 @@
 #define OPM_ECL_STONE2_MATERIAL_HPP
 
 #include "EclStone2MaterialParams.hpp"
+#include "TwoPhaseSatPcnwKrwKrn.hpp"
 
 #include <opm/material/common/Valgrind.hpp>
 #include <opm/material/common/MathToolbox.hpp>
@@ -250,10 +251,60 @@ public:
                                        const FluidState &fluidState)
     {
         typedef typename std::remove_reference<decltype(values[0])>::type Evaluation;
+        typedef MathToolbox<typename FluidState::Scalar> FsToolbox;
+
+        const Evaluation& Sw = FsToolbox::template toLhs<Evaluation>(fluidState.saturation(waterPhaseIdx));
+        const Evaluation& Sg = FsToolbox::template toLhs<Evaluation>(fluidState.saturation(gasPhaseIdx));
 
-        values[waterPhaseIdx] = krw<FluidState, Evaluation>(params, fluidState);
-        values[oilPhaseIdx] = krn<FluidState, Evaluation>(params, fluidState);
-        values[gasPhaseIdx] = krg<FluidState, Evaluation>(params, fluidState);
+        // evaluate each two-phase relperm only once. the capillary pressures are not
+        // needed here, use capillaryPressuresAndRelativePermeabilities() if they are.
+        const Evaluation& krw = OilWaterMaterialLaw::twoPhaseSatKrw(params.oilWaterParams(), Sw);
+        const Evaluation& krow = OilWaterMaterialLaw::twoPhaseSatKrn(params.oilWaterParams(), Sw);
+        const Evaluation& krog = GasOilMaterialLaw::twoPhaseSatKrw(params.gasOilParams(), 1 - Sg);
+        const Evaluation& krg = GasOilMaterialLaw::twoPhaseSatKrn(params.gasOilParams(), 1 - Sg);
+
+        values[waterPhaseIdx] = krw;
+        values[oilPhaseIdx] = krnFromTwoPhase_(params, krow, krw, krog, krg);
+        values[gasPhaseIdx] = krg;
+    }
+
+    /*!
+     * \brief The capillary pressures and the relative permeabilities of all phases.
+     *
+     * This computes the same quantities as capillaryPressures() and
+     * relativePermeabilities(), but each nested two-phase law is only evaluated
+     * once for all of them.
+     */
+    template <class PcContainerT, class KrContainerT, class FluidState>
+    static void capillaryPressuresAndRelativePermeabilities(PcContainerT &pcValues,
+                                                            KrContainerT &krValues,
+                                                            const Params &params,
+                                                            const FluidState &fluidState)
+    {
+        typedef typename std::remove_reference<decltype(krValues[0])>::type Evaluation;
+        typedef MathToolbox<typename FluidState::Scalar> FsToolbox;
+
+        const Evaluation& Sw = FsToolbox::template toLhs<Evaluation>(fluidState.saturation(waterPhaseIdx));
+        const Evaluation& Sg = FsToolbox::template toLhs<Evaluation>(fluidState.saturation(gasPhaseIdx));
+        const Evaluation& SwGo = 1 - Sg;
+
+        Evaluation pcow, krw, krow;
+        twoPhaseSatPcnwKrwKrn<OilWaterMaterialLaw>(pcow, krw, krow,
+                                                   params.oilWaterParams(),
+                                                   Sw, Sw, Sw);
+
+        Evaluation pcgo, krog, krg;
+        twoPhaseSatPcnwKrwKrn<GasOilMaterialLaw>(pcgo, krog, krg,
+                                                 params.gasOilParams(),
+                                                 SwGo, SwGo, SwGo);
+
+        pcValues[gasPhaseIdx] = pcgo;
+        pcValues[oilPhaseIdx] = 0;
+        pcValues[waterPhaseIdx] = - pcow;
+
+        krValues[waterPhaseIdx] = krw;
+        krValues[oilPhaseIdx] = krnFromTwoPhase_(params, krow, krw, krog, krg);
+        krValues[gasPhaseIdx] = krg;
     }
 
     /*!
@@ -291,17 +342,15 @@ public:
     {
         typedef MathToolbox<typename FluidState::Scalar> FsToolbox;
 
-        Scalar Swco = params.Swl();
         const Evaluation& Sw = FsToolbox::template toLhs<Evaluation>(fluidState.saturation(waterPhaseIdx));
         const Evaluation& Sg = FsToolbox::template toLhs<Evaluation>(fluidState.saturation(gasPhaseIdx));
 
-        Scalar krocw = OilWaterMaterialLaw::twoPhaseSatKrn(params.oilWaterParams(), Swco);
-        Evaluation krow = OilWaterMaterialLaw::twoPhaseSatKrn(params.oilWaterParams(), Sw);
-        Evaluation krw = OilWaterMaterialLaw::twoPhaseSatKrw(params.oilWaterParams(), Sw);
-        Evaluation krg = GasOilMaterialLaw::twoPhaseSatKrn(params.gasOilParams(), 1 - Sg);
-        Evaluation krog = GasOilMaterialLaw::twoPhaseSatKrw(params.gasOilParams(), 1 - Sg);
+        const Evaluation& krow = OilWaterMaterialLaw::twoPhaseSatKrn(params.oilWaterParams(), Sw);
+        const Evaluation& krw = OilWaterMaterialLaw::twoPhaseSatKrw(params.oilWaterParams(), Sw);
+        const Evaluation& krg = GasOilMaterialLaw::twoPhaseSatKrn(params.gasOilParams(), 1 - Sg);
+        const Evaluation& krog = GasOilMaterialLaw::twoPhaseSatKrw(params.gasOilParams(), 1 - Sg);
 
-        return krocw*((krow/krocw + krw)*(krog/krocw + krg) - krw - krg);
+        return krnFromTwoPhase_(params, krow, krw, krog, krg);
     }
 
     /*!
@@ -322,6 +371,21 @@ public:
         params.oilWaterParams().update(/*pcSw=*/Sw, /*krwSw=*/Sw, /*krnSw=*/Sw);
         params.gasOilParams().update(/*pcSw=*/1 - Sg, /*krwSw=*/1 - Sg, /*krnSw=*/1 - Sg);
     }
+
+private:
+    // combine the oil relperms of the two two-phase systems using Stone's second model
+    template <class Evaluation>
+    static Evaluation krnFromTwoPhase_(const Params &params,
+                                       const Evaluation& krow,
+                                       const Evaluation& krw,
+                                       const Evaluation& krog,
+                                       const Evaluation& krg)
+    {
+        Scalar Swco = params.Swl();
+        Scalar krocw = OilWaterMaterialLaw::twoPhaseSatKrn(params.oilWaterParams(), Swco);
+
+        return krocw*((krow/krocw + krw)*(krog/krocw + krg) - krw - krg);
+    }
 };
 } // namespace Opm
 
@@ -28,6 +28,7 @@
 #define OPM_ECL_TWO_PHASE_MATERIAL_HPP
 
 #include "EclTwoPhaseMaterialParams.hpp"
+#include "TwoPhaseSatPcnwKrwKrn.hpp"
 
 #include <opm/material/common/Valgrind.hpp>
 #include <opm/material/common/MathToolbox.hpp>
@@ -292,6 +293,68 @@ public:
         }
     }
 
+    /*!
+     * \brief The capillary pressures and the relative permeabilities of all phases.
+     *
+     * This computes the same quantities as capillaryPressures() and
+     * relativePermeabilities(), but the nested two-phase law of the active phases is
+     * only evaluated once for all of them.
+     */
+    template <class PcContainerT, class KrContainerT, class FluidState>
+    static void capillaryPressuresAndRelativePermeabilities(PcContainerT &pcValues,
+                                                            KrContainerT &krValues,
+                                                            const Params &params,
+                                                            const FluidState &fluidState)
+    {
+        typedef typename std::remove_reference<decltype(krValues[0])>::type Evaluation;
+        typedef MathToolbox<typename FluidState::Scalar> FsToolbox;
+
+        switch (params.approach()) {
+        case EclTwoPhaseGasOil: {
+            const Evaluation& So =
+                FsToolbox::template toLhs<Evaluation>(fluidState.saturation(oilPhaseIdx));
+
+            Evaluation pcgo, krog, krg;
+            twoPhaseSatPcnwKrwKrn<GasOilMaterialLaw>(pcgo, krog, krg,
+                                                     params.gasOilParams(),
+                                                     So, So, So);
+
+            pcValues[oilPhaseIdx] = 0.0;
+            pcValues[gasPhaseIdx] = pcgo;
+            krValues[oilPhaseIdx] = krog;
+            krValues[gasPhaseIdx] = krg;
+            break;
+        }
+
+        case EclTwoPhaseOilWater: {
+            const Evaluation& Sw =
+                FsToolbox::template toLhs<Evaluation>(fluidState.saturation(waterPhaseIdx));
+
+            Evaluation pcow, krw, krow;
+            twoPhaseSatPcnwKrwKrn<OilWaterMaterialLaw>(pcow, krw, krow,
+                                                       params.oilWaterParams(),
+                                                       Sw, Sw, Sw);
+
+            pcValues[waterPhaseIdx] = 0.0;
+            pcValues[oilPhaseIdx] = pcow;
+            krValues[waterPhaseIdx] = krw;
+            krValues[oilPhaseIdx] = krow;
+            break;
+        }
+
+        case EclTwoPhaseGasWater:
+            // the quantities of the gas-water system are taken from different nested
+            // laws at different saturations, so there is nothing to share here
+            capillaryPressures(pcValues, params, fluidState);
+            relativePermeabilities(krValues, params, fluidState);
+            break;
+
+        default:
+            OPM_THROW(std::logic_error,
+                      "Cannot calculate capillary pressure: Invalid two-phase system");
+        }
+    }
+
     /*!
      * \brief The relative permeability of the gas phase.
      */
@@ -0,0 +1,286 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::PLScanningCurve
+ */
+#ifndef OPM_PL_SCANNING_CURVE_HPP
+#define OPM_PL_SCANNING_CURVE_HPP
+
+#include <array>
+#include <cstddef>
+
+namespace Opm {
+
+template <class ScalarT, unsigned maxDepthV>
+class PLScanningCurveStore;
+
+/*!
+ * \brief Represents a scanning curve in the Parker-Lenhard hysteresis model.
+ *
+ * The class has pointers to the scanning curves
+ * with higher and lower loop number, this saving
+ * the history of the imbibitions and drainages.
+ *
+ * Scanning curves are not allocated individually, they are always owned by a
+ * PLScanningCurveStore object.
+ */
+template <class ScalarT>
+class PLScanningCurve
+{
+    template <class S, unsigned d>
+    friend class PLScanningCurveStore;
+
+public:
+    typedef ScalarT Scalar;
+
+    PLScanningCurve()
+    {
+        init_(/*prev=*/NULL, /*loopNum=*/-1, /*Sw=*/0.0, /*pcnw=*/0.0, /*SwMic=*/0.0, /*SwMdc=*/0.0);
+        nextSlot_ = NULL;
+    }
+
+    /*!
+     * \brief Return the previous scanning curve, i.e. the curve
+     *        with one less reversal than the current one.
+     */
+    PLScanningCurve *prev() const
+    { return prev_; }
+
+    /*!
+     * \brief Return the next scanning curve, i.e. the curve
+     *        with one more reversal than the current one.
+     */
+    PLScanningCurve *next() const
+    { return next_; }
+
+    /*!
+     * \brief Set the next scanning curve.
+     *
+     * Next in the sense of the number of reversals
+     * from imbibition to drainage or vince versa. If this
+     * curve already has a list of next curves, it is
+     * forgotten.
+     *
+     * If the maximum number of scanning curves of the store has been reached, no
+     * next curve is created and next() returns NULL afterwards.
+     */
+    void setNext(Scalar SwReversal,
+                 Scalar pcnwReversal,
+                 Scalar SwMiCurve,
+                 Scalar SwMdCurve)
+    {
+        if (!nextSlot_) {
+            next_ = NULL;
+            return;
+        }
+
+        nextSlot_->init_(this, // prev
+                         loopNum() + 1,
+                         SwReversal,
+                         pcnwReversal,
+                         SwMiCurve,
+                         SwMdCurve);
+        next_ = nextSlot_;
+    }
+
+    /*!
+     * \brief Returns true iff the given effective saturation
+     *        Swei is within the scope of the curve, i.e.
+     *        whether Swei is part of the curve's
+     *        domain and the curve thus applies to Swi.
+     */
+    bool isValidAt_Sw(Scalar SwReversal)
+    {
+        if (isImbib())
+            // for inbibition the given saturation
+            // must be between the start of the
+            // current imbibition and the the start
+            // of the last drainage
+            return this->Sw() < SwReversal && SwReversal < prev_->Sw();
+        else
+            // for drainage the given saturation
+            // must be between the start of the
+            // last imbibition and the start
+            // of the current drainage
+            return prev_->Sw() < SwReversal && SwReversal < this->Sw();
+    }
+
+    /*!
+     * \brief Returns true iff the scanning curve is a
+     *        imbibition curve.
+     */
+    bool isImbib()
+    { return loopNum()%2 == 1; }
+
+    /*!
+     * \brief Returns true iff the scanning curve is a
+     *        drainage curve.
+     */
+    bool isDrain()
+    { return !isImbib(); }
+
+    /*!
+     * \brief The loop number of the scanning curve.
+     *
+     * The MDC is 0, PISC is 1, PDSC is 2, ...
+     */
+    int loopNum()
+    { return loopNum_; }
+
+    /*!
+     * \brief Absolute wetting-phase saturation at the
+     *        scanning curve's reversal point.
+     */
+    Scalar Sw() const
+    { return Sw_; }
+
+    /*!
+     * \brief Capillary pressure at the last reversal point.
+     */
+    Scalar pcnw() const
+    { return pcnw_; }
+
+    /*!
+     * \brief Apparent saturation of the last reversal point on
+     *        the pressure MIC.
+     */
+    Scalar SwMic()
+    { return SwMic_; }
+
+    /*!
+     * \brief Apparent saturation of the last reversal point on
+     *        the pressure MDC.
+     */
+    Scalar SwMdc()
+    { return SwMdc_; }
+
+private:
+    void init_(PLScanningCurve *prevSC,
+               int loopN,
+               Scalar SwReversal,
+               Scalar pcnwReversal,
+               Scalar SwMiCurve,
+               Scalar SwMdCurve)
+    {
+        prev_ = prevSC;
+        next_ = NULL;
+        loopNum_ = loopN;
+        Sw_ = SwReversal;
+        pcnw_ = pcnwReversal;
+        SwMic_ = SwMiCurve;
+        SwMdc_ = SwMdCurve;
+    }
+
+    PLScanningCurve *prev_;
+    PLScanningCurve *next_;
+
+    // the storage slot which is used if a next curve gets created. this is always the
+    // neighboring slot of the store or NULL if the maximum depth has been reached
+    PLScanningCurve *nextSlot_;
+
+    int loopNum_;
+
+    Scalar Sw_;
+    Scalar pcnw_;
+
+    Scalar SwMdc_;
+    Scalar SwMic_;
+};
+
+/*!
+ * \brief Provides the storage for all scanning curves of the Parker-Lenhard
+ *        hysteresis model for a single cell.
+ *
+ * The curves are stored in a contiguous array which is part of the object, i.e.,
+ * creating scanning curves never allocates memory on the heap. The price is that the
+ * number of scanning curves is bounded: besides the main drainage curve (MDC), at
+ * most 'maxDepth' nested scanning curves are kept. If a further reversal occurs, it is
+ * ignored and the current scanning curve continues to be used.
+ *
+ * Since the curves refer to each other using pointers, copying a store does not copy
+ * the history of the scanning curves, but only creates a new MDC.
+ */
+template <class ScalarT, unsigned maxDepthV>
+class PLScanningCurveStore
+{
+public:
+    typedef ScalarT Scalar;
+    typedef Opm::PLScanningCurve<Scalar> ScanningCurve;
+
+    //! The maximum number of scanning curves besides the MDC.
+    static const unsigned maxDepth = maxDepthV;
+
+    PLScanningCurveStore()
+    { reset(/*Swr=*/0.0); }
+
+    PLScanningCurveStore(const PLScanningCurveStore& other)
+    { reset(other.curves_[0].Sw()); }
+
+    PLScanningCurveStore& operator=(const PLScanningCurveStore& other)
+    {
+        reset(other.curves_[0].Sw());
+        return *this;
+    }
+
+    /*!
+     * \brief Forget all scanning curves except the MDC.
+     *
+     * \param Swr The residual saturation of the wetting phase for the capillary pressure
+     */
+    void reset(Scalar Swr)
+    {
+        for (unsigned slotIdx = 0; slotIdx < curves_.size(); ++slotIdx) {
+            if (slotIdx + 1 < curves_.size())
+                curves_[slotIdx].nextSlot_ = &curves_[slotIdx + 1];
+            else
+                curves_[slotIdx].nextSlot_ = NULL;
+        }
+
+        // the first slot is the curve "before" the MDC. It is only used as the
+        // reversal point of the MDC.
+        curves_[0].init_(/*prev=*/NULL, /*loopNum=*/-1, Swr, /*pcnw=*/1e12, Swr, Swr);
+        curves_[1].init_(/*prev=*/&curves_[0], /*loopNum=*/0,
+                         /*Sw=*/1.0, /*pcnw=*/0.0, /*SwMic=*/1.0, /*SwMdc=*/1.0);
+        curves_[0].next_ = &curves_[1];
+    }
+
+    /*!
+     * \brief Returns the main drainage curve.
+     */
+    ScanningCurve *mdc()
+    { return &curves_[1]; }
+
+    /*!
+     * \brief Returns the main drainage curve.
+     */
+    const ScanningCurve *mdc() const
+    { return &curves_[1]; }
+
+private:
+    std::array<ScanningCurve, maxDepth + 2> curves_;
+};
+
+} // namespace Opm
+
+#endif
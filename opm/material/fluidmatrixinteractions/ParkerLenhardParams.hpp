@@ -28,32 +28,35 @@
 #define OPM_PARKER_LENHARD_PARAMS_HPP
 
 #include <opm/material/fluidmatrixinteractions/RegularizedVanGenuchten.hpp>
+#include <opm/material/fluidmatrixinteractions/PLScanningCurve.hpp>
 
 #include <cassert>
 
 namespace Opm
 {
-// forward declaration
-template <class ScalarT>
-class PLScanningCurve;
-
 /*!
  * \brief Default parameter class for the Parker-Lenhard hysteresis
  *        model.
+ *
+ * The scanning curves are stored within the parameter object, so updating the
+ * hysteresis state does not allocate any memory. The 'maxScanningCurveDepth'
+ * template parameter specifies the maximum number of nested scanning curves.
  */
-template <class TraitsT>
+template <class TraitsT, unsigned maxScanningCurveDepth = 16>
 class ParkerLenhardParams
 {
 public:
     typedef typename TraitsT::Scalar Scalar;
     typedef Opm::RegularizedVanGenuchten<TraitsT> VanGenuchten;
     typedef typename VanGenuchten::Params VanGenuchtenParams;
-    typedef PLScanningCurve<Scalar> ScanningCurve;
+    typedef PLScanningCurveStore<Scalar, maxScanningCurveDepth> ScanningCurveStore;
+    typedef typename ScanningCurveStore::ScanningCurve ScanningCurve;
 
     ParkerLenhardParams()
     {
+        micParams_ = mdcParams_ = NULL;
+        SwrPc_ = SwrKr_ = Snr_ = 0;
         currentSnr_ = 0;
-        mdc_ = new ScanningCurve(/*Swr=*/0);
         pisc_ = csc_ = NULL;
 
 #ifndef NDEBUG
@@ -62,20 +65,27 @@ public:
     }
 
     ParkerLenhardParams(const ParkerLenhardParams &p)
+    { *this = p; }
+
+    // the scanning curves of the other object are not copied. instead, this object
+    // starts on the MDC.
+    ParkerLenhardParams& operator=(const ParkerLenhardParams &p)
     {
-        currentSnr_ = 0;
+        micParams_ = p.micParams_;
+        mdcParams_ = p.mdcParams_;
         SwrPc_ = p.SwrPc_;
-        mdc_ = new ScanningCurve(SwrPc_);
+        SwrKr_ = p.SwrKr_;
+        Snr_ = p.Snr_;
+        currentSnr_ = 0;
+        curveStore_.reset(SwrPc_);
         pisc_ = csc_ = NULL;
 
 #ifndef NDEBUG
         finalized_ = p.finalized_;
 #endif
+        return *this;
     }
 
-    ~ParkerLenhardParams()
-    { delete mdc_; }
-
     /*!
      * \brief Calculate all dependent quantities once the independent
      *        quantities of the parameter object have been set.
@@ -168,13 +178,13 @@ public:
      * \brief Returns the main drainage curve
      */
     ScanningCurve *mdc() const
-    { assertFinalized_(); return mdc_; }
+    { assertFinalized_(); return curveStore_.mdc(); }
 
     /*!
-     * \brief Set the main drainage curve.
+     * \brief Forget all scanning curves except the main drainage curve.
      */
-    void setMdc(ScanningCurve *val)
-    { mdc_ = val; }
+    void resetScanningCurves()
+    { curveStore_.reset(SwrPc()); }
 
     /*!
      * \brief Returns the primary imbibition scanning curve
@@ -217,7 +227,7 @@ private:
     Scalar SwrKr_;
     Scalar Snr_;
     Scalar currentSnr_;
-    mutable ScanningCurve *mdc_;
+    mutable ScanningCurveStore curveStore_;
     mutable ScanningCurve *pisc_;
     mutable ScanningCurve *csc_;
 };
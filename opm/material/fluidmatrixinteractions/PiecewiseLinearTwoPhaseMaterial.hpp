@@ -143,7 +143,12 @@ public:
      */
     template <class Evaluation>
     static Evaluation twoPhaseSatPcnw(const Params &params, const Evaluation& Sw)
-    { return eval_(params.SwPcwnSamples(), params.pcnwSamples(), Sw); }
+    {
+        if (params.useUniformSegmentIndex())
+            return evalIndexed_(params.pcnwSegmentIndex(), params.SwPcwnSamples(), params.pcnwSamples(), Sw);
+
+        return eval_(params.SwPcwnSamples(), params.pcnwSamples(), Sw);
+    }
 
     template <class Evaluation>
     static Evaluation twoPhaseSatPcnwInv(const Params &params, const Evaluation& pcnw)
@@ -188,7 +193,12 @@ public:
 
     template <class Evaluation>
     static Evaluation twoPhaseSatKrw(const Params &params, const Evaluation& Sw)
-    { return eval_(params.SwKrwSamples(), params.krwSamples(), Sw); }
+    {
+        if (params.useUniformSegmentIndex())
+            return evalIndexed_(params.krwSegmentIndex(), params.SwKrwSamples(), params.krwSamples(), Sw);
+
+        return eval_(params.SwKrwSamples(), params.krwSamples(), Sw);
+    }
 
     template <class Evaluation>
     static Evaluation twoPhaseSatKrwInv(const Params &params, const Evaluation& krw)
@@ -210,13 +220,120 @@ public:
 
     template <class Evaluation>
     static Evaluation twoPhaseSatKrn(const Params &params, const Evaluation& Sw)
-    { return eval_(params.SwKrnSamples(), params.krnSamples(), Sw); }
+    {
+        if (params.useUniformSegmentIndex())
+            return evalIndexed_(params.krnSegmentIndex(), params.SwKrnSamples(), params.krnSamples(), Sw);
+
+        return eval_(params.SwKrnSamples(), params.krnSamples(), Sw);
+    }
 
     template <class Evaluation>
     static Evaluation twoPhaseSatKrnInv(const Params &params, const Evaluation& krn)
     { return eval_(params.krnSamples(), params.SwKrnSamples(), krn); }
 
+    /*!
+     * \brief Evaluate the capillary pressure and both relative permeabilities at once.
+     *
+     * If all curves are sampled at the same saturations, the segment of the table is
+     * only searched once for each distinct saturation. If the uniform segment index is
+     * enabled, the segments are looked up using the index of the capillary pressure
+     * curve.
+     */
+    template <class Evaluation>
+    static void twoPhaseSatPcnwKrwKrn(Evaluation& pcnw,
+                                      Evaluation& krw,
+                                      Evaluation& krn,
+                                      const Params& params,
+                                      const Evaluation& pcSw,
+                                      const Evaluation& krwSw,
+                                      const Evaluation& krnSw)
+    {
+        typedef MathToolbox<Evaluation> Toolbox;
+
+        if (!params.commonSaturationSamples()) {
+            pcnw = twoPhaseSatPcnw(params, pcSw);
+            krw = twoPhaseSatKrw(params, krwSw);
+            krn = twoPhaseSatKrn(params, krnSw);
+            return;
+        }
+
+        const ValueVector& SwValues = params.SwPcwnSamples();
+
+        Scalar pcSwValue = Toolbox::value(pcSw);
+        Scalar krwSwValue = Toolbox::value(krwSw);
+        Scalar krnSwValue = Toolbox::value(krnSw);
+
+        size_t pcSegIdx = findSegmentIndex_(params, pcSwValue);
+        size_t krwSegIdx =
+            (krwSwValue == pcSwValue)
+            ? pcSegIdx
+            : findSegmentIndex_(params, krwSwValue);
+        size_t krnSegIdx =
+            (krnSwValue == krwSwValue)
+            ? krwSegIdx
+            : ((krnSwValue == pcSwValue)
+               ? pcSegIdx
+               : findSegmentIndex_(params, krnSwValue));
+
+        pcnw = evalAscendingSegment_(SwValues, params.pcnwSamples(), pcSw, pcSegIdx);
+        krw = evalAscendingSegment_(SwValues, params.krwSamples(), krwSw, krwSegIdx);
+        krn = evalAscendingSegment_(SwValues, params.krnSamples(), krnSw, krnSegIdx);
+    }
+
 private:
+    typedef typename ParamsT::UniformSegmentIndex UniformSegmentIndex;
+
+    // evaluate a curve using the uniform index of its segments. this avoids searching
+    // for the segment of the saturation and yields the same result as eval_().
+    template <class Evaluation>
+    static Evaluation evalIndexed_(const UniformSegmentIndex& index,
+                                   const ValueVector &xValues,
+                                   const ValueVector &yValues,
+                                   const Evaluation& x)
+    {
+        typedef MathToolbox<Evaluation> Toolbox;
+
+        if (index.cellSegmentIdx.empty())
+            return eval_(xValues, yValues, x);
+
+        size_t segIdx = findIndexedSegment_(index, xValues, Toolbox::value(x));
+        return evalAscendingSegment_(xValues, yValues, x, segIdx);
+    }
+
+    // find the segment of a saturation using the uniform index of a curve. this
+    // yields the same segment as findSegmentIndex_() for saturations within the table
+    static size_t findIndexedSegment_(const UniformSegmentIndex& index,
+                                      const ValueVector &xValues,
+                                      Scalar x)
+    {
+        if (x <= index.xMin)
+            return 0;
+        if (x >= index.xMax)
+            return xValues.size() - 2;
+
+        size_t cellIdx = static_cast<size_t>((x - index.xMin)*index.invDx);
+        cellIdx = std::min(cellIdx, index.cellSegmentIdx.size() - 1);
+
+        // the saturation is not necessarily in the cell's segment: the cell may contain
+        // sampling points and the boundaries of the cells are subject to round-off
+        size_t segIdx = index.cellSegmentIdx[cellIdx];
+        while (xValues[segIdx + 1] < x)
+            ++segIdx;
+        while (segIdx > 0 && xValues[segIdx] >= x)
+            --segIdx;
+
+        return segIdx;
+    }
+
+    // find the segment of a saturation in the common saturation column of all curves
+    static size_t findSegmentIndex_(const Params& params, Scalar Sw)
+    {
+        if (params.useUniformSegmentIndex())
+            return findIndexedSegment_(params.pcnwSegmentIndex(), params.SwPcwnSamples(), Sw);
+
+        return findSegmentIndex_(params.SwPcwnSamples(), Sw);
+    }
+
     template <class Evaluation>
     static Evaluation eval_(const ValueVector &xValues,
                             const ValueVector &yValues,
@@ -240,6 +357,21 @@ private:
             return yValues.back();
 
         size_t segIdx = findSegmentIndex_(xValues, Toolbox::value(x));
+        return evalAscendingSegment_(xValues, yValues, x, segIdx);
+    }
+
+    // evaluate a curve with ascending sampling points if the segment of x is already
+    // known
+    template <class Evaluation>
+    static Evaluation evalAscendingSegment_(const ValueVector &xValues,
+                                            const ValueVector &yValues,
+                                            const Evaluation& x,
+                                            size_t segIdx)
+    {
+        if (x <= xValues.front())
+            return yValues.front();
+        if (x >= xValues.back())
+            return yValues.back();
 
         Scalar x0 = xValues[segIdx];
         Scalar x1 = xValues[segIdx + 1];
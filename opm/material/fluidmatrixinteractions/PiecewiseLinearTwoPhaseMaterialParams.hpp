@@ -28,7 +28,9 @@
 #define OPM_PIECEWISE_LINEAR_TWO_PHASE_MATERIAL_PARAMS_HPP
 
 #include <vector>
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <cstddef>
 
 namespace Opm {
@@ -48,8 +50,32 @@ public:
 
     typedef TraitsT Traits;
 
+    /*!
+     * \brief An index which allows to find the segment of a curve which contains a
+     *        given saturation without a bisection search.
+     *
+     * The saturation range of the curve is divided into equidistant cells. For each
+     * cell, the index of the sampling point segment which contains the left boundary of
+     * the cell is stored. Starting from this segment, the segment of a saturation is
+     * found by a linear scan. Unless the number of cells is limited, the cells are at
+     * most as wide as the shortest segment, so the scan usually stops after at most one
+     * step. The curve itself is still evaluated using the original sampling points.
+     * The index is empty if the sampling points are not in ascending order.
+     */
+    struct UniformSegmentIndex
+    {
+        Scalar xMin;
+        Scalar xMax;
+        Scalar invDx;
+        std::vector<unsigned> cellSegmentIdx;
+    };
+
     PiecewiseLinearTwoPhaseMaterialParams()
     {
+        enableUniformSegmentIndex_ = false;
+        maxSegmentIndexCells_ = 1 << 14;
+        commonSaturationSamples_ = false;
+
 #ifndef NDEBUG
         finalized_ = false;
 #endif
@@ -77,8 +103,76 @@ public:
         if (SwKrnSamples_.front() > SwKrnSamples_.back())
             swapOrder_(SwKrnSamples_, krnSamples_);
 
+        // tables which are read from the deck usually specify all curves using the
+        // same saturation column. in this case, evaluating all quantities at once
+        // only requires a single search for the segment.
+        commonSaturationSamples_ =
+            SwPcwnSamples_.front() < SwPcwnSamples_.back()
+            && SwPcwnSamples_ == SwKrwSamples_
+            && SwPcwnSamples_ == SwKrnSamples_;
+
+        if (enableUniformSegmentIndex_) {
+            buildUniformSegmentIndex_(pcwnSegmentIndex_, SwPcwnSamples_);
+            buildUniformSegmentIndex_(krwSegmentIndex_, SwKrwSamples_);
+            buildUniformSegmentIndex_(krnSegmentIndex_, SwKrnSamples_);
+        }
     }
 
+    /*!
+     * \brief Specify whether the segments of the curves ought to be indexed using a
+     *        uniform saturation grid when finalize() is called.
+     *
+     * If this is enabled, the capillary pressure and relative permeability curves are
+     * evaluated using direct indexing instead of a bisection search for the segment of
+     * the saturation. The results are the same as without the index. The number of
+     * cells of the index is chosen for each curve such that no cell is wider than the
+     * shortest segment of the curve, but at most \a maxCells cells are used. The
+     * inverse functions always use the bisection search.
+     */
+    void setUniformSegmentIndex(bool yesno, unsigned maxCells = 1 << 14)
+    {
+        assert(maxCells >= 1);
+
+        enableUniformSegmentIndex_ = yesno;
+        maxSegmentIndexCells_ = maxCells;
+    }
+
+    /*!
+     * \brief Returns true iff the segments of the curves are determined using the
+     *        uniform saturation grids.
+     */
+    bool useUniformSegmentIndex() const
+    { return enableUniformSegmentIndex_; }
+
+    /*!
+     * \brief Returns true iff the capillary pressure and both relative permeability
+     *        curves are sampled at the same ascending saturations.
+     *
+     * This is only valid after finalize() has been called.
+     */
+    bool commonSaturationSamples() const
+    { assertFinalized_(); return commonSaturationSamples_; }
+
+    /*!
+     * \brief Return the uniform segment index of the capillary pressure curve.
+     */
+    const UniformSegmentIndex& pcnwSegmentIndex() const
+    { assertFinalized_(); return pcwnSegmentIndex_; }
+
+    /*!
+     * \brief Return the uniform segment index of the relative permeability curve of
+     *        the wetting phase.
+     */
+    const UniformSegmentIndex& krwSegmentIndex() const
+    { assertFinalized_(); return krwSegmentIndex_; }
+
+    /*!
+     * \brief Return the uniform segment index of the relative permeability curve of
+     *        the non-wetting phase.
+     */
+    const UniformSegmentIndex& krnSegmentIndex() const
+    { assertFinalized_(); return krnSegmentIndex_; }
+
     /*!
      * \brief Return the wetting-phase saturation values of all sampling points.
      */
@@ -205,12 +299,61 @@ private:
         }
     }
 
+    // build the uniform segment index for the saturations of the sampling points of
+    // a curve. the cell width is the length of the shortest segment of non-zero length
+    // unless this would require more than the maximum number of cells.
+    void buildUniformSegmentIndex_(UniformSegmentIndex& index,
+                                   const ValueVector& xValues) const
+    {
+        assert(xValues.size() > 1);
+
+        index.cellSegmentIdx.clear();
+        if (!(xValues.front() < xValues.back()))
+            // only ascending sampling points are indexed
+            return;
+
+        size_t numSegments = xValues.size() - 1;
+        index.xMin = xValues.front();
+        index.xMax = xValues.back();
+
+        Scalar range = index.xMax - index.xMin;
+        Scalar minDx = range;
+        for (size_t segIdx = 0; segIdx < numSegments; ++segIdx) {
+            Scalar dx = xValues[segIdx + 1] - xValues[segIdx];
+            if (dx > 0)
+                minDx = std::min(minDx, dx);
+        }
+
+        size_t numCells =
+            static_cast<size_t>(std::min<Scalar>(maxSegmentIndexCells_, std::ceil(range/minDx)));
+        numCells = std::max<size_t>(1, numCells);
+        index.invDx = numCells/range;
+
+        // the segment of a cell is the one which contains its left boundary, i.e., the
+        // last sampling point which is smaller than the boundary starts the segment
+        index.cellSegmentIdx.resize(numCells);
+        size_t segIdx = 0;
+        for (size_t cellIdx = 0; cellIdx < numCells; ++cellIdx) {
+            Scalar x = index.xMin + cellIdx*range/numCells;
+            while (segIdx + 1 < numSegments && xValues[segIdx + 1] < x)
+                ++segIdx;
+            index.cellSegmentIdx[cellIdx] = static_cast<unsigned>(segIdx);
+        }
+    }
+
     ValueVector SwPcwnSamples_;
     ValueVector SwKrwSamples_;
     ValueVector SwKrnSamples_;
     ValueVector pcwnSamples_;
     ValueVector krwSamples_;
     ValueVector krnSamples_;
+
+    bool commonSaturationSamples_;
+    bool enableUniformSegmentIndex_;
+    unsigned maxSegmentIndexCells_;
+    UniformSegmentIndex pcwnSegmentIndex_;
+    UniformSegmentIndex krwSegmentIndex_;
+    UniformSegmentIndex krnSegmentIndex_;
 };
 } // namespace Opm
 
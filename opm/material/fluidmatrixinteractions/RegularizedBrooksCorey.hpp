@@ -59,12 +59,17 @@ namespace Opm {
  *   - yes: use the regularization
  *   - no: forward to the standard material law.
  *
+ * The MathToolboxT template parameter is passed on to the BrooksCorey
+ * law.
+ *
  * \see BrooksCorey
  */
-template <class TraitsT, class ParamsT = RegularizedBrooksCoreyParams<TraitsT> >
+template <class TraitsT,
+          class ParamsT = RegularizedBrooksCoreyParams<TraitsT>,
+          template <class> class MathToolboxT = MathToolbox>
 class RegularizedBrooksCorey : public TraitsT
 {
-    typedef Opm::BrooksCorey<TraitsT, ParamsT> BrooksCorey;
+    typedef Opm::BrooksCorey<TraitsT, ParamsT, MathToolboxT> BrooksCorey;
 
 public:
     typedef TraitsT Traits;
@@ -290,7 +295,7 @@ public:
     template <class Evaluation>
     static Evaluation twoPhaseSatKrw(const Params &params, const Evaluation& Sw)
     {
-        typedef MathToolbox<Evaluation> Toolbox;
+        typedef MathToolboxT<Evaluation> Toolbox;
 
         if (Sw <= 0.0)
             return Toolbox::createConstant(0.0);
@@ -303,7 +308,7 @@ public:
     template <class Evaluation>
     static Evaluation twoPhaseSatKrwInv(const Params &params, const Evaluation& krw)
     {
-        typedef MathToolbox<Evaluation> Toolbox;
+        typedef MathToolboxT<Evaluation> Toolbox;
 
         if (krw <= 0.0)
             return Toolbox::createConstant(0.0);
@@ -340,7 +345,7 @@ public:
     template <class Evaluation>
     static Evaluation twoPhaseSatKrn(const Params &params, const Evaluation& Sw)
     {
-        typedef MathToolbox<Evaluation> Toolbox;
+        typedef MathToolboxT<Evaluation> Toolbox;
 
         if (Sw >= 1.0)
             return Toolbox::createConstant(0.0);
@@ -353,7 +358,7 @@ public:
     template <class Evaluation>
     static Evaluation twoPhaseSatKrnInv(const Params &params, const Evaluation& krn)
     {
-        typedef MathToolbox<Evaluation> Toolbox;
+        typedef MathToolboxT<Evaluation> Toolbox;
 
         if (krn <= 0.0)
             return Toolbox::createConstant(1.0);
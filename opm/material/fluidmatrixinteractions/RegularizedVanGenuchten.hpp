@@ -65,12 +65,17 @@ namespace Opm {
  * An example of the regularization of the capillary pressure curve is
  * shown below: \image html regularizedVanGenuchten.png
  *
+ * The MathToolboxT template parameter is passed on to the VanGenuchten
+ * law which computes the curves outside of the regularized regions.
+ *
  * \see VanGenuchten
  */
-template <class TraitsT, class ParamsT = RegularizedVanGenuchtenParams<TraitsT> >
+template <class TraitsT,
+          class ParamsT = RegularizedVanGenuchtenParams<TraitsT>,
+          template <class> class MathToolboxT = MathToolbox>
 class RegularizedVanGenuchten : public TraitsT
 {
-    typedef Opm::VanGenuchten<TraitsT, ParamsT> VanGenuchten;
+    typedef Opm::VanGenuchten<TraitsT, ParamsT, MathToolboxT> VanGenuchten;
 
 public:
     typedef TraitsT Traits;
@@ -306,7 +311,7 @@ public:
     template <class Evaluation>
     static Evaluation twoPhaseSatKrw(const Params &params, const Evaluation& Sw)
     {
-        typedef MathToolbox<Evaluation> Toolbox;
+        typedef MathToolboxT<Evaluation> Toolbox;
 
         // regularize
         if (Sw <= 0)
@@ -344,7 +349,7 @@ public:
     template <class Evaluation>
     static Evaluation twoPhaseSatKrn(const Params &params, const Evaluation& Sw)
     {
-        typedef MathToolbox<Evaluation> Toolbox;
+        typedef MathToolboxT<Evaluation> Toolbox;
 
         // regularize
         if (Sw <= 0)
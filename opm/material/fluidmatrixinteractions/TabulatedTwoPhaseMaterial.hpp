@@ -0,0 +1,63 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::TabulatedTwoPhaseMaterial
+ */
+#ifndef OPM_TABULATED_TWO_PHASE_MATERIAL_HPP
+#define OPM_TABULATED_TWO_PHASE_MATERIAL_HPP
+
+#include "TabulatedTwoPhaseMaterialParams.hpp"
+#include "PiecewiseLinearTwoPhaseMaterial.hpp"
+
+namespace Opm {
+/*!
+ * \ingroup FluidMatrixInteractions
+ *
+ * \brief An adapter which replaces the curves of an arbitrary two-phase material law
+ *        by tables.
+ *
+ * The base law must implement the two-phase saturation API. Its capillary pressure and
+ * relative permeability curves are sampled when the parameter object is finalized (see
+ * TabulatedTwoPhaseMaterialParams) and are then evaluated using piecewise linear
+ * interpolation. The derivatives are the slopes of the table segments. This is
+ * useful if the same curves are evaluated very often, e.g., if the parameters are
+ * specified per region instead of per cell.
+ */
+template <class BaseLawT, class ParamsT = TabulatedTwoPhaseMaterialParams<BaseLawT> >
+class TabulatedTwoPhaseMaterial
+    : public PiecewiseLinearTwoPhaseMaterial<typename BaseLawT::Traits, ParamsT>
+{
+    static_assert(BaseLawT::implementsTwoPhaseSatApi,
+                  "The tabulated material law must implement the two-phase saturation API!");
+
+public:
+    //! The material law which is tabulated
+    typedef BaseLawT BaseLaw;
+
+    //! The type of the parameter objects for this law
+    typedef ParamsT Params;
+};
+} // namespace Opm
+
+#endif
@@ -0,0 +1,278 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::TabulatedTwoPhaseMaterialParams
+ */
+#ifndef OPM_TABULATED_TWO_PHASE_MATERIAL_PARAMS_HPP
+#define OPM_TABULATED_TWO_PHASE_MATERIAL_PARAMS_HPP
+
+#include "PiecewiseLinearTwoPhaseMaterialParams.hpp"
+
+#include <opm/common/ErrorMacros.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace Opm {
+/*!
+ * \ingroup FluidMatrixInteractions
+ *
+ * \brief Specification of the material parameters for the TabulatedTwoPhaseMaterial
+ *        adapter.
+ *
+ * The parameters of the tabulated law are set using setBaseParams(). When finalize()
+ * is called, the capillary pressure and the relative permeabilities of the base law
+ * are sampled at common wetting phase saturations which are adaptively refined until
+ * the linear interpolation between two adjacent sampling points deviates from the
+ * base law by at most the tolerance at a quarter, the half and three quarters of the
+ * interval. The tolerance is thus only met approximately in between these points.
+ */
+template <class BaseLawT>
+class TabulatedTwoPhaseMaterialParams
+    : public PiecewiseLinearTwoPhaseMaterialParams<typename BaseLawT::Traits>
+{
+    typedef PiecewiseLinearTwoPhaseMaterialParams<typename BaseLawT::Traits> ParentType;
+    typedef typename BaseLawT::Params BaseParams;
+    typedef typename BaseLawT::Traits::Scalar Scalar;
+
+public:
+    typedef typename ParentType::ValueVector ValueVector;
+
+    TabulatedTwoPhaseMaterialParams()
+    {
+        SwMin_ = 0.0;
+        SwMax_ = 1.0;
+        tolerance_ = 1e-4;
+        initialSamples_ = 16;
+        maxSamples_ = 1 << 14;
+
+#ifndef NDEBUG
+        finalized_ = false;
+#endif
+    }
+
+    /*!
+     * \brief Sample the curves of the base law and calculate all dependent quantities
+     *        of the table.
+     *
+     * An std::invalid_argument exception is thrown if the base law yields a value
+     * which is not finite within the saturation range, e.g., the capillary pressure of
+     * the Brooks-Corey law at the residual saturation.
+     */
+    void finalize()
+    {
+        tabulate_();
+        ParentType::finalize();
+
+#ifndef NDEBUG
+        finalized_ = true;
+#endif
+    }
+
+    /*!
+     * \brief Set the parameters of the material law which ought to be tabulated.
+     *
+     * The parameter object must already be finalized.
+     */
+    void setBaseParams(const BaseParams& baseParams)
+    { baseParams_ = baseParams; }
+
+    /*!
+     * \brief Return the parameters of the tabulated material law.
+     */
+    const BaseParams& baseParams() const
+    { return baseParams_; }
+
+    /*!
+     * \brief Set the range of wetting phase saturations covered by the table.
+     *
+     * Outside of this range, the values at the closest end of the table are used. For
+     * laws where the capillary pressure is unbounded at the residual saturation (e.g.
+     * the non-regularized van Genuchten law), the range must exclude that saturation.
+     */
+    void setSaturationRange(Scalar SwMin, Scalar SwMax)
+    {
+        assert(SwMin < SwMax);
+
+        SwMin_ = SwMin;
+        SwMax_ = SwMax;
+    }
+
+    /*!
+     * \brief Set the tolerance of the tabulation.
+     *
+     * The tolerance is relative to the range of values of each curve, i.e., the
+     * capillary pressure may deviate by tolerance*(max(pcnw) - min(pcnw)) and the
+     * relative permeabilities by about tolerance. The deviation is checked at three
+     * points of each interval between two sampling points, so it can be slightly larger
+     * in between. At most \a maxSamples sampling points are used, so the tolerance may
+     * not be met for curves with very steep sections.
+     */
+    void setTolerance(Scalar tolerance, unsigned maxSamples = 1 << 14)
+    {
+        assert(tolerance > 0.0);
+        assert(maxSamples > initialSamples_);
+
+        tolerance_ = tolerance;
+        maxSamples_ = maxSamples;
+    }
+
+    /*!
+     * \brief Return the tolerance of the tabulation.
+     */
+    Scalar tolerance() const
+    { return tolerance_; }
+
+    /*!
+     * \brief Return the number of sampling points which were used for the table.
+     */
+    size_t numSamples() const
+    { assertFinalized_(); return this->SwPcwnSamples().size(); }
+
+private:
+#ifndef NDEBUG
+    void assertFinalized_() const
+    { assert(finalized_); }
+
+    bool finalized_;
+#else
+    void assertFinalized_() const
+    { }
+#endif
+
+    // refine a uniform initial grid by inserting the midpoints of all intervals where
+    // the linear interpolation of any of the three curves exceeds the tolerance at a
+    // quarter, the half or three quarters of the interval. all intervals are considered
+    // in each pass, so the refinement is spread evenly if the maximum number of
+    // sampling points is reached.
+    void tabulate_()
+    {
+        ValueVector Sw(initialSamples_ + 1);
+        ValueVector pcnw(Sw.size());
+        ValueVector krw(Sw.size());
+        ValueVector krn(Sw.size());
+        for (size_t i = 0; i < Sw.size(); ++i) {
+            Sw[i] = SwMin_ + (SwMax_ - SwMin_)*i/initialSamples_;
+            sampleBaseLaw_(pcnw[i], krw[i], krn[i], Sw[i]);
+        }
+
+        Scalar pcnwTol = tolerance_*valueRange_(pcnw);
+        Scalar krwTol = tolerance_*valueRange_(krw);
+        Scalar krnTol = tolerance_*valueRange_(krn);
+
+        ValueVector newSw, newPcnw, newKrw, newKrn;
+        while (Sw.size() < maxSamples_) {
+            newSw.clear();
+            newPcnw.clear();
+            newKrw.clear();
+            newKrn.clear();
+
+            size_t numRemaining = maxSamples_ - Sw.size();
+            for (size_t i = 0; i < Sw.size(); ++i) {
+                newSw.push_back(Sw[i]);
+                newPcnw.push_back(pcnw[i]);
+                newKrw.push_back(krw[i]);
+                newKrn.push_back(krn[i]);
+
+                if (i + 1 == Sw.size() || numRemaining == 0)
+                    continue;
+
+                Scalar SwMid = (Sw[i] + Sw[i + 1])/2;
+                Scalar pcnwMid, krwMid, krnMid;
+                sampleBaseLaw_(pcnwMid, krwMid, krnMid, SwMid);
+
+                bool refine = false;
+                for (int k = 1; k < 4 && !refine; ++k) {
+                    Scalar alpha = k/4.0;
+                    Scalar pcnwK = pcnwMid, krwK = krwMid, krnK = krnMid;
+                    if (k != 2)
+                        sampleBaseLaw_(pcnwK, krwK, krnK, Sw[i] + alpha*(Sw[i + 1] - Sw[i]));
+
+                    refine =
+                        std::abs(pcnwK - (pcnw[i] + alpha*(pcnw[i + 1] - pcnw[i]))) > pcnwTol
+                        || std::abs(krwK - (krw[i] + alpha*(krw[i + 1] - krw[i]))) > krwTol
+                        || std::abs(krnK - (krn[i] + alpha*(krn[i + 1] - krn[i]))) > krnTol;
+                }
+
+                if (refine) {
+                    newSw.push_back(SwMid);
+                    newPcnw.push_back(pcnwMid);
+                    newKrw.push_back(krwMid);
+                    newKrn.push_back(krnMid);
+                    -- numRemaining;
+                }
+            }
+
+            if (newSw.size() == Sw.size())
+                break; // all intervals meet the tolerance
+
+            Sw.swap(newSw);
+            pcnw.swap(newPcnw);
+            krw.swap(newKrw);
+            krn.swap(newKrn);
+        }
+
+        this->setPcnwSamples(Sw, pcnw);
+        this->setKrwSamples(Sw, krw);
+        this->setKrnSamples(Sw, krn);
+    }
+
+    void sampleBaseLaw_(Scalar& pcnw, Scalar& krw, Scalar& krn, Scalar Sw) const
+    {
+        pcnw = BaseLawT::twoPhaseSatPcnw(baseParams_, Sw);
+        krw = BaseLawT::twoPhaseSatKrw(baseParams_, Sw);
+        krn = BaseLawT::twoPhaseSatKrn(baseParams_, Sw);
+
+        if (!std::isfinite(pcnw) || !std::isfinite(krw) || !std::isfinite(krn))
+            OPM_THROW(std::invalid_argument,
+                      "The material law which ought to be tabulated is not finite at Sw = "
+                      << Sw << " (pcnw = " << pcnw << ", krw = " << krw << ", krn = " << krn
+                      << "). Use setSaturationRange() to exclude this saturation");
+    }
+
+    static Scalar valueRange_(const ValueVector& values)
+    {
+        Scalar range =
+            *std::max_element(values.begin(), values.end())
+            - *std::min_element(values.begin(), values.end());
+
+        // use an absolute tolerance for constant curves
+        return (range > 0)?range:1.0;
+    }
+
+    BaseParams baseParams_;
+
+    Scalar SwMin_;
+    Scalar SwMax_;
+    Scalar tolerance_;
+    size_t initialSamples_;
+    size_t maxSamples_;
+};
+} // namespace Opm
+
+#endif
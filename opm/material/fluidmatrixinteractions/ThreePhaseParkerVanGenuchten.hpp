@@ -44,9 +44,13 @@ namespace Opm {
  * Reference: J.B. Kool, J.C. Parker, M.Th. van Genuchten: Parameter
  * Estimation for Unsaturated Flow and Transport Models -- A Review;
  * Journal of Hydrology, 91 (1987) 255-293
+ *
+ * The MathToolboxT template parameter selects the toolbox which is used
+ * to compute the powers, e.g., Opm::FastMathToolbox.
  */
 template <class TraitsT,
-          class ParamsT = ThreePhaseParkerVanGenuchtenParams<TraitsT> >
+          class ParamsT = ThreePhaseParkerVanGenuchtenParams<TraitsT>,
+          template <class> class MathToolboxT = MathToolbox>
 class ThreePhaseParkerVanGenuchten
 {
 public:
@@ -123,7 +127,7 @@ public:
     static Evaluation pcgn(const Params &params, const FluidState &fluidState)
     {
         typedef MathToolbox<typename FluidState::Scalar> FsToolbox;
-        typedef MathToolbox<Evaluation> Toolbox;
+        typedef MathToolboxT<Evaluation> Toolbox;
 
         Scalar PC_VG_REG = 0.01;
 
@@ -179,7 +183,7 @@ public:
     static Evaluation pcnw(const Params &params, const FluidState &fluidState)
     {
         typedef MathToolbox<typename FluidState::Scalar> FsToolbox;
-        typedef MathToolbox<Evaluation> Toolbox;
+        typedef MathToolboxT<Evaluation> Toolbox;
 
         const Evaluation& Sw =
             FsToolbox::template toLhs<Evaluation>(fluidState.saturation(wettingPhaseIdx));
@@ -278,7 +282,7 @@ public:
     static Evaluation krw(const Params &params, const FluidState &fluidState)
     {
         typedef MathToolbox<typename FluidState::Scalar> FsToolbox;
-        typedef MathToolbox<Evaluation> Toolbox;
+        typedef MathToolboxT<Evaluation> Toolbox;
 
         const Evaluation& Sw =
             FsToolbox::template toLhs<Evaluation>(fluidState.saturation(wettingPhaseIdx));
@@ -309,7 +313,7 @@ public:
     static Evaluation krn(const Params &params, const FluidState &fluidState)
     {
         typedef MathToolbox<typename FluidState::Scalar> FsToolbox;
-        typedef MathToolbox<Evaluation> Toolbox;
+        typedef MathToolboxT<Evaluation> Toolbox;
 
         const Evaluation& Sn =
             FsToolbox::template toLhs<Evaluation>(fluidState.saturation(nonWettingPhaseIdx));
@@ -357,7 +361,7 @@ public:
     static Evaluation krg(const Params &params, const FluidState &fluidState)
     {
         typedef MathToolbox<typename FluidState::Scalar> FsToolbox;
-        typedef MathToolbox<Evaluation> Toolbox;
+        typedef MathToolboxT<Evaluation> Toolbox;
 
         const Evaluation& Sg =
             FsToolbox::template toLhs<Evaluation>(fluidState.saturation(gasPhaseIdx));
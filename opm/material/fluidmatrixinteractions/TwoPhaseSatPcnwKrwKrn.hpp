@@ -0,0 +1,96 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::twoPhaseSatPcnwKrwKrn
+ */
+#ifndef OPM_TWO_PHASE_SAT_PCNW_KRW_KRN_HPP
+#define OPM_TWO_PHASE_SAT_PCNW_KRW_KRN_HPP
+
+namespace Opm {
+namespace FluidMatrixInteractionsDetail {
+// use the fused kernel of the material law if it provides one...
+template <class MaterialLaw, class Evaluation>
+auto twoPhaseSatPcnwKrwKrn_(int,
+                            Evaluation& pcnw,
+                            Evaluation& krw,
+                            Evaluation& krn,
+                            const typename MaterialLaw::Params& params,
+                            const Evaluation& pcSw,
+                            const Evaluation& krwSw,
+                            const Evaluation& krnSw)
+    -> decltype(MaterialLaw::twoPhaseSatPcnwKrwKrn(pcnw, krw, krn, params, pcSw, krwSw, krnSw))
+{ return MaterialLaw::twoPhaseSatPcnwKrwKrn(pcnw, krw, krn, params, pcSw, krwSw, krnSw); }
+
+// ... else evaluate the three quantities individually
+template <class MaterialLaw, class Evaluation>
+void twoPhaseSatPcnwKrwKrn_(long,
+                            Evaluation& pcnw,
+                            Evaluation& krw,
+                            Evaluation& krn,
+                            const typename MaterialLaw::Params& params,
+                            const Evaluation& pcSw,
+                            const Evaluation& krwSw,
+                            const Evaluation& krnSw)
+{
+    pcnw = MaterialLaw::twoPhaseSatPcnw(params, pcSw);
+    krw = MaterialLaw::twoPhaseSatKrw(params, krwSw);
+    krn = MaterialLaw::twoPhaseSatKrn(params, krnSw);
+}
+} // namespace FluidMatrixInteractionsDetail
+
+/*!
+ * \ingroup FluidMatrixInteractions
+ *
+ * \brief Evaluate the capillary pressure and both relative permeabilities of a
+ *        two-phase material law in a single call.
+ *
+ * Each of the three quantities may be evaluated at a different wetting phase
+ * saturation. (This is analogous to the update() method of the hysteresis
+ * parameters.) If the material law provides a static method
+ * twoPhaseSatPcnwKrwKrn() with the same arguments, it is used. Such a method can
+ * share the work which is common to the three quantities, e.g., the transformations
+ * of the saturations or the lookup of the table segment. For all other laws, the
+ * quantities are evaluated using the individual methods of the two-phase
+ * saturation API.
+ */
+template <class MaterialLaw, class Evaluation>
+void twoPhaseSatPcnwKrwKrn(Evaluation& pcnw,
+                           Evaluation& krw,
+                           Evaluation& krn,
+                           const typename MaterialLaw::Params& params,
+                           const Evaluation& pcSw,
+                           const Evaluation& krwSw,
+                           const Evaluation& krnSw)
+{
+    static_assert(MaterialLaw::implementsTwoPhaseSatApi,
+                  "The material law must implement the two-phase saturation API!");
+
+    FluidMatrixInteractionsDetail::twoPhaseSatPcnwKrwKrn_<MaterialLaw>(/*preferFused=*/0,
+                                                                      pcnw, krw, krn,
+                                                                      params,
+                                                                      pcSw, krwSw, krnSw);
+}
+} // namespace Opm
+
+#endif
@@ -49,9 +49,16 @@ namespace Opm {
  * The converion from and to effective saturations can be done using,
  * e.g. EffToAbsLaw.
  *
+ * The toolbox which is used for the mathematical functions can be
+ * selected using the MathToolboxT template parameter. E.g.,
+ * Opm::FastMathToolbox provides faster approximations of pow(), exp()
+ * and log() for scalars.
+ *
  * \see VanGenuchtenParams
  */
-template <class TraitsT, class ParamsT = VanGenuchtenParams<TraitsT> >
+template <class TraitsT,
+          class ParamsT = VanGenuchtenParams<TraitsT>,
+          template <class> class MathToolboxT = MathToolbox>
 class VanGenuchten : public TraitsT
 {
 public:
@@ -195,7 +202,7 @@ public:
     template <class Evaluation>
     static Evaluation twoPhaseSatPcnw(const Params &params, const Evaluation& Sw)
     {
-        typedef MathToolbox<Evaluation> Toolbox;
+        typedef MathToolboxT<Evaluation> Toolbox;
 
         return Toolbox::pow(Toolbox::pow(Sw, -1.0/params.vgM()) - 1, 1.0/params.vgN())/params.vgAlpha();
     }
@@ -226,7 +233,7 @@ public:
     template <class Evaluation>
     static Evaluation twoPhaseSatSw(const Params &params, const Evaluation& pC)
     {
-        typedef MathToolbox<Evaluation> Toolbox;
+        typedef MathToolboxT<Evaluation> Toolbox;
 
         assert(pC >= 0);
 
@@ -269,7 +276,7 @@ public:
     template <class Evaluation>
     static Evaluation twoPhaseSatKrw(const Params &params, const Evaluation& Sw)
     {
-        typedef MathToolbox<Evaluation> Toolbox;
+        typedef MathToolboxT<Evaluation> Toolbox;
 
         assert(0.0 <= Sw && Sw <= 1.0);
 
@@ -300,7 +307,7 @@ public:
     template <class Evaluation>
     static Evaluation twoPhaseSatKrn(const Params &params, Evaluation Sw)
     {
-        typedef MathToolbox<Evaluation> Toolbox;
+        typedef MathToolboxT<Evaluation> Toolbox;
 
         assert(0 <= Sw && Sw <= 1);
 
@@ -199,6 +199,32 @@ public:
         OPM_THROW(std::runtime_error, "Not implemented: The fluid system '" << Opm::className<Implementation>() << "'  does not provide a fugacityCoefficient() method!");
     }
 
+    /*!
+     * \brief Calculate the fugacity coefficients of all components in a fluid phase
+     *        [-]
+     *
+     * By default, fugacityCoefficient() is called for each component. Fluid systems
+     * which can share intermediate results between the components should overload
+     * this method.
+     *
+     * \param fugCoeffs The array into which the fugacity coefficients are written
+     * \copydoc Doxygen::fluidSystemBaseParams
+     * \copydoc Doxygen::phaseIdxParam
+     */
+    template <class FluidState, class LhsEval = typename FluidState::Scalar, class ParameterCache = NullParameterCache>
+    static void fugacityCoefficients(LhsEval *fugCoeffs,
+                                     const FluidState &fluidState,
+                                     const ParameterCache &paramCache,
+                                     unsigned phaseIdx)
+    {
+        for (unsigned compIdx = 0; compIdx < Implementation::numComponents; ++compIdx)
+            fugCoeffs[compIdx] =
+                Implementation::template fugacityCoefficient<FluidState, LhsEval>(fluidState,
+                                                                                  paramCache,
+                                                                                  phaseIdx,
+                                                                                  compIdx);
+    }
+
     /*!
      * \brief Calculate the dynamic viscosity of a fluid phase [Pa*s]
      *
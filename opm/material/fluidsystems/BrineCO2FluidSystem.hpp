@@ -45,6 +45,7 @@
 
 #include <opm/material/common/Unused.hpp>
 
+#include <algorithm>
 #include <iostream>
 
 namespace Opm {
@@ -207,9 +208,14 @@ public:
      * \param pressMin The minimum pressure used for tabulation of water [Pa]
      * \param pressMax The maximum pressure used for tabulation of water [Pa]
      * \param nPress The number of ticks on the pressure axis of the  table of water
+     * \param tabulateSolubility If true, the mutual solubilities of brine and CO2 are
+     *        interpolated in tables of the same resolution instead of being computed
+     *        from the correlations. The tables are restricted to the range of the CO2
+     *        tables, which thus must be initialized before.
      */
     static void init(Scalar tempMin, Scalar tempMax, unsigned nTemp,
-                     Scalar pressMin, Scalar pressMax, unsigned nPress)
+                     Scalar pressMin, Scalar pressMax, unsigned nPress,
+                     bool tabulateSolubility = false)
     {
         if (H2O::isTabulated) {
             H2O_Tabulated::init(tempMin, tempMax, nTemp,
@@ -223,6 +229,16 @@ public:
             Brine_Tabulated::init(tempMin, tempMax, nTemp,
                                   pressMin, pressMax, nPress);
         }
+
+        if (tabulateSolubility)
+            BinaryCoeffBrineCO2::initSolubilityTables(std::max(tempMin, CO2::minTabulatedTemperature()),
+                                                      std::min(tempMax, CO2::maxTabulatedTemperature()),
+                                                      nTemp,
+                                                      std::max(pressMin, CO2::minTabulatedPressure()),
+                                                      std::min(pressMax, CO2::maxTabulatedPressure()),
+                                                      nPress);
+        else
+            BinaryCoeffBrineCO2::disableSolubilityTables();
     }
 
     /*!
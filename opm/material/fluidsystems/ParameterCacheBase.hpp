@@ -183,6 +183,28 @@ public:
         asImp_().updateComposition(fluidState, phaseIdx);
     }
 
+    /*!
+     * \brief Update all cached parameters of a specific fluid phase
+     *        which depend on the mole fractions of some components
+     *
+     * *Only* use this method if neither the pressure nor the temperature of the
+     * phase and only the listed concentrations changed between two update*()
+     * calls.
+     *
+     * \param fluidState The representation of the thermodynamic system of interest.
+     * \param phaseIdx The index of the fluid phase of interest.
+     * \param compIndices The indices of the components for which the mole fractions were modified in the fluid phase of interest.
+     * \param numModified The number of modified mole fractions.
+     */
+    template <class FluidState>
+    void updateMoleFractions(const FluidState &fluidState,
+                             unsigned phaseIdx,
+                             const unsigned * /*compIndices*/,
+                             unsigned /*numModified*/)
+    {
+        asImp_().updateComposition(fluidState, phaseIdx);
+    }
+
 private:
     Implementation &asImp_()
     { return *static_cast<Implementation*>(this); }
@@ -34,6 +34,9 @@
 #include <opm/material/eos/PengRobinsonMixture.hpp>
 
 #include <opm/material/common/Spline.hpp>
+#include <opm/material/common/MathToolbox.hpp>
+
+#include <type_traits>
 
 namespace Opm {
 namespace FluidSystems {
@@ -66,6 +69,17 @@ public:
     //! \copydoc BaseFluidSystem::ParameterCache
     typedef Opm::Spe5ParameterCache<Scalar, ThisType> ParameterCache;
 
+    /*!
+     * \brief The parameter cache which stores the Peng-Robinson parameters and the
+     *        molar volumes using a given evaluation type.
+     *
+     * This is required to get the derivatives of the fugacity coefficients with
+     * regard to the quantities of the fluid state.
+     */
+    template <class Evaluation>
+    struct EvaluationParameterCache
+    { typedef Opm::Spe5ParameterCache<Scalar, ThisType, Evaluation> type; };
+
     /****************************************
      * Fluid phase parameters
      ****************************************/
@@ -356,27 +370,29 @@ public:
     }
 
     //! \copydoc BaseFluidSystem::density
-    template <class FluidState, class Evaluation = Scalar>
-    static Scalar density(const FluidState &fluidState,
-                          const ParameterCache &paramCache,
-                          unsigned phaseIdx)
+    template <class FluidState, class LhsEval = typename FluidState::Scalar, class ParamCacheEval = LhsEval>
+    static LhsEval density(const FluidState &fluidState,
+                           const Opm::Spe5ParameterCache<Scalar, ThisType, ParamCacheEval> &paramCache,
+                           unsigned phaseIdx)
     {
-        assert(0 <= phaseIdx  && phaseIdx < numPhases);
-        static_assert(std::is_same<Evaluation, Scalar>::value,
-                      "The SPE-5 fluid system is currently only implemented for the scalar case.");
+        assert(phaseIdx < numPhases);
+        checkEvaluations_<LhsEval, ParamCacheEval>();
 
-        return fluidState.averageMolarMass(phaseIdx)/paramCache.molarVolume(phaseIdx);
+        typedef Opm::MathToolbox<typename FluidState::Scalar> FsToolbox;
+        typedef Opm::MathToolbox<ParamCacheEval> CacheToolbox;
+
+        return
+            FsToolbox::template toLhs<LhsEval>(fluidState.averageMolarMass(phaseIdx))
+            / CacheToolbox::template toLhs<LhsEval>(paramCache.molarVolume(phaseIdx));
     }
 
     //! \copydoc BaseFluidSystem::viscosity
-    template <class FluidState, class Evaluation = Scalar>
-    static Scalar viscosity(const FluidState &/*fluidState*/,
-                            const ParameterCache &/*paramCache*/,
-                            unsigned phaseIdx)
+    template <class FluidState, class LhsEval = typename FluidState::Scalar, class ParamCacheEval = LhsEval>
+    static LhsEval viscosity(const FluidState &/*fluidState*/,
+                             const Opm::Spe5ParameterCache<Scalar, ThisType, ParamCacheEval> &/*paramCache*/,
+                             unsigned phaseIdx)
     {
-        assert(0 <= phaseIdx  && phaseIdx <= numPhases);
-        static_assert(std::is_same<Evaluation, Scalar>::value,
-                      "The SPE-5 fluid system is currently only implemented for the scalar case.");
+        assert(phaseIdx < numPhases);
 
         if (phaseIdx == gasPhaseIdx) {
             // given by SPE-5 in table on page 64. we use a constant
@@ -395,32 +411,71 @@ public:
     }
 
     //! \copydoc BaseFluidSystem::fugacityCoefficient
-    template <class FluidState, class Evaluation = Scalar>
-    static Scalar fugacityCoefficient(const FluidState &fluidState,
-                                      const ParameterCache &paramCache,
-                                      unsigned phaseIdx,
-                                      unsigned compIdx)
+    template <class FluidState, class LhsEval = typename FluidState::Scalar, class ParamCacheEval = LhsEval>
+    static LhsEval fugacityCoefficient(const FluidState &fluidState,
+                                       const Opm::Spe5ParameterCache<Scalar, ThisType, ParamCacheEval> &paramCache,
+                                       unsigned phaseIdx,
+                                       unsigned compIdx)
+    {
+        assert(phaseIdx < numPhases);
+        assert(compIdx < numComponents);
+        checkEvaluations_<LhsEval, ParamCacheEval>();
+
+        if (phaseIdx == oilPhaseIdx || phaseIdx == gasPhaseIdx)
+            return PengRobinsonMixture::template computeFugacityCoefficient<FluidState,
+                                                                            Opm::Spe5ParameterCache<Scalar, ThisType, ParamCacheEval>,
+                                                                            LhsEval>(fluidState,
+                                                                                     paramCache,
+                                                                                     phaseIdx,
+                                                                                     compIdx);
+        else {
+            assert(phaseIdx == waterPhaseIdx);
+            typedef Opm::MathToolbox<typename FluidState::Scalar> FsToolbox;
+            const LhsEval& T = FsToolbox::template toLhs<LhsEval>(fluidState.temperature(waterPhaseIdx));
+            const LhsEval& p = FsToolbox::template toLhs<LhsEval>(fluidState.pressure(waterPhaseIdx));
+            return henryCoeffWater_(compIdx, T)/p;
+        }
+    }
+
+    //! \copydoc BaseFluidSystem::fugacityCoefficients
+    template <class FluidState, class LhsEval, class ParamCacheEval>
+    static void fugacityCoefficients(LhsEval *fugCoeffs,
+                                     const FluidState &fluidState,
+                                     const Opm::Spe5ParameterCache<Scalar, ThisType, ParamCacheEval> &paramCache,
+                                     unsigned phaseIdx)
     {
-        assert(0 <= phaseIdx  && phaseIdx <= numPhases);
-        assert(0 <= compIdx  && compIdx <= numComponents);
-        static_assert(std::is_same<Evaluation, Scalar>::value,
-                      "The SPE-5 fluid system is currently only implemented for the scalar case.");
+        assert(phaseIdx < numPhases);
+        checkEvaluations_<LhsEval, ParamCacheEval>();
 
         if (phaseIdx == oilPhaseIdx || phaseIdx == gasPhaseIdx)
-            return PengRobinsonMixture::computeFugacityCoefficient(fluidState,
-                                                                   paramCache,
-                                                                   phaseIdx,
-                                                                   compIdx);
+            PengRobinsonMixture::computeFugacityCoefficients(fugCoeffs,
+                                                             fluidState,
+                                                             paramCache,
+                                                             phaseIdx);
         else {
             assert(phaseIdx == waterPhaseIdx);
-            return
-                henryCoeffWater_(compIdx, fluidState.temperature(waterPhaseIdx))
-                / fluidState.pressure(waterPhaseIdx);
+            typedef Opm::MathToolbox<typename FluidState::Scalar> FsToolbox;
+            const LhsEval& T = FsToolbox::template toLhs<LhsEval>(fluidState.temperature(waterPhaseIdx));
+            const LhsEval& p = FsToolbox::template toLhs<LhsEval>(fluidState.pressure(waterPhaseIdx));
+            for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+                fugCoeffs[compIdx] = henryCoeffWater_(compIdx, T)/p;
         }
     }
 
 protected:
-    static Scalar henryCoeffWater_(unsigned compIdx, Scalar temperature)
+    // the derivatives of the quantities which depend on the Peng-Robinson EOS are
+    // only correct if the parameter cache provides them, too
+    template <class LhsEval, class ParamCacheEval>
+    static void checkEvaluations_()
+    {
+        static_assert(std::is_same<LhsEval, Scalar>::value
+                      || std::is_same<LhsEval, ParamCacheEval>::value,
+                      "Function evaluations of the SPE-5 fluid system require a parameter "
+                      "cache which uses the same evaluation type");
+    }
+
+    template <class Evaluation>
+    static Evaluation henryCoeffWater_(unsigned compIdx, const Evaluation& temperature)
     {
         // use henry's law for the solutes and the vapor pressure for
         // the solvent.
@@ -31,6 +31,7 @@
 
 #include <opm/material/components/H2O.hpp>
 #include <opm/material/fluidsystems/ParameterCacheBase.hpp>
+#include <opm/material/common/MathToolbox.hpp>
 
 #include <opm/material/eos/PengRobinson.hpp>
 #include <opm/material/eos/PengRobinsonParamsMixture.hpp>
@@ -40,12 +41,16 @@ namespace Opm {
 /*!
  * \ingroup Fluidsystems
  * \brief Specifies the parameter cache used by the SPE-5 fluid system.
+ *
+ * If Evaluation is a function evaluation for automatic differentiation, the
+ * Peng-Robinson parameters and the molar volumes of the phases carry the derivatives
+ * of the fluid states which the cache is updated with.
  */
-template <class Scalar, class FluidSystem>
+template <class Scalar, class FluidSystem, class EvaluationT = Scalar>
 class Spe5ParameterCache
-    : public Opm::ParameterCacheBase<Spe5ParameterCache<Scalar, FluidSystem> >
+    : public Opm::ParameterCacheBase<Spe5ParameterCache<Scalar, FluidSystem, EvaluationT> >
 {
-    typedef Spe5ParameterCache<Scalar, FluidSystem> ThisType;
+    typedef Spe5ParameterCache<Scalar, FluidSystem, EvaluationT> ThisType;
     typedef Opm::ParameterCacheBase<ThisType> ParentType;
 
     typedef Opm::PengRobinson<Scalar> PengRobinson;
@@ -57,10 +62,13 @@ class Spe5ParameterCache
     enum { gasPhaseIdx = FluidSystem::gasPhaseIdx };
 
 public:
+    //! The type of the cached quantities
+    typedef EvaluationT Evaluation;
+
     //! The cached parameters for the oil phase
-    typedef Opm::PengRobinsonParamsMixture<Scalar, FluidSystem, oilPhaseIdx, /*useSpe5=*/true> OilPhaseParams;
+    typedef Opm::PengRobinsonParamsMixture<Scalar, FluidSystem, oilPhaseIdx, /*useSpe5=*/true, Evaluation> OilPhaseParams;
     //! The cached parameters for the gas phase
-    typedef Opm::PengRobinsonParamsMixture<Scalar, FluidSystem, gasPhaseIdx, /*useSpe5=*/true> GasPhaseParams;
+    typedef Opm::PengRobinsonParamsMixture<Scalar, FluidSystem, gasPhaseIdx, /*useSpe5=*/true, Evaluation> GasPhaseParams;
 
     Spe5ParameterCache()
     {
@@ -102,12 +110,28 @@ public:
         updateMolarVolume_(fluidState, phaseIdx);
     }
 
+    //! \copydoc ParameterCacheBase::updateMoleFractions
+    template <class FluidState>
+    void updateMoleFractions(const FluidState &fluidState,
+                             unsigned phaseIdx,
+                             const unsigned *compIndices,
+                             unsigned numModified)
+    {
+        if (phaseIdx == oilPhaseIdx)
+            oilPhaseParams_.updateMoleFractions(fluidState, compIndices, numModified);
+        else if (phaseIdx == gasPhaseIdx)
+            gasPhaseParams_.updateMoleFractions(fluidState, compIndices, numModified);
+
+        // update the phase's molar volume
+        updateMolarVolume_(fluidState, phaseIdx);
+    }
+
     /*!
      * \brief The Peng-Robinson attractive parameter for a phase.
      *
      * \param phaseIdx The fluid phase of interest
      */
-    Scalar a(unsigned phaseIdx) const
+    Evaluation a(unsigned phaseIdx) const
     {
         switch (phaseIdx)
         {
@@ -125,7 +149,7 @@ public:
      *
      * \param phaseIdx The fluid phase of interest
      */
-    Scalar b(unsigned phaseIdx) const
+    Evaluation b(unsigned phaseIdx) const
     {
         switch (phaseIdx)
         {
@@ -146,7 +170,7 @@ public:
      * \param phaseIdx The fluid phase of interest
      * \param compIdx The component phase of interest
      */
-    Scalar aPure(unsigned phaseIdx, unsigned compIdx) const
+    Evaluation aPure(unsigned phaseIdx, unsigned compIdx) const
     {
         switch (phaseIdx)
         {
@@ -166,7 +190,7 @@ public:
      * \param phaseIdx The fluid phase of interest
      * \param compIdx The component phase of interest
      */
-    Scalar bPure(unsigned phaseIdx, unsigned compIdx) const
+    Evaluation bPure(unsigned phaseIdx, unsigned compIdx) const
     {
         switch (phaseIdx)
         {
@@ -179,12 +203,33 @@ public:
         };
     }
 
+    /*!
+     * \brief The attractive parameter of the mixing rule for a pair of components
+     *        given the same temperature and pressure of the phase.
+     *
+     * \param phaseIdx The fluid phase of interest
+     * \param compIIdx The first component of interest
+     * \param compJIdx The second component of interest
+     */
+    Evaluation aCache(unsigned phaseIdx, unsigned compIIdx, unsigned compJIdx) const
+    {
+        switch (phaseIdx)
+        {
+        case oilPhaseIdx: return oilPhaseParams_.aCache(compIIdx, compJIdx);
+        case gasPhaseIdx: return gasPhaseParams_.aCache(compIIdx, compJIdx);
+        default:
+            OPM_THROW(std::logic_error,
+                       "The aCache() parameter is only defined for "
+                       "oil and gas phases");
+        };
+    }
+
     /*!
      * \brief Returns the molar volume of a phase [m^3/mol]
      *
      * \param phaseIdx The fluid phase of interest
      */
-    Scalar molarVolume(unsigned phaseIdx) const
+    const Evaluation& molarVolume(unsigned phaseIdx) const
     { assert(VmUpToDate_[phaseIdx]); return Vm_[phaseIdx]; }
 
 
@@ -241,8 +286,10 @@ protected:
     template <class FluidState>
     void updatePure_(const FluidState &fluidState, unsigned phaseIdx)
     {
-        Scalar T = fluidState.temperature(phaseIdx);
-        Scalar p = fluidState.pressure(phaseIdx);
+        typedef Opm::MathToolbox<typename FluidState::Scalar> FsToolbox;
+
+        const Evaluation& T = FsToolbox::template toLhs<Evaluation>(fluidState.temperature(phaseIdx));
+        const Evaluation& p = FsToolbox::template toLhs<Evaluation>(fluidState.pressure(phaseIdx));
 
         switch (phaseIdx)
         {
@@ -292,10 +339,10 @@ protected:
             // system can get queried, so it is okay to calculate it
             // here...
             Vm_[gasPhaseIdx] =
-                PengRobinson::computeMolarVolume(fluidState,
-                                                 *this,
-                                                 phaseIdx,
-                                                 /*isGasPhase=*/true);
+                PengRobinson::template computeMolarVolume<FluidState, ThisType, Evaluation>(fluidState,
+                                                                                            *this,
+                                                                                            phaseIdx,
+                                                                                            /*isGasPhase=*/true);
             break;
         }
         case oilPhaseIdx: {
@@ -305,10 +352,10 @@ protected:
             // system can get queried, so it is okay to calculate it
             // here...
             Vm_[oilPhaseIdx] =
-                PengRobinson::computeMolarVolume(fluidState,
-                                                 *this,
-                                                 phaseIdx,
-                                                 /*isGasPhase=*/false);
+                PengRobinson::template computeMolarVolume<FluidState, ThisType, Evaluation>(fluidState,
+                                                                                            *this,
+                                                                                            phaseIdx,
+                                                                                            /*isGasPhase=*/false);
 
             break;
         }
@@ -319,19 +366,23 @@ protected:
             const Scalar stockTankWaterDensity = 62.4 * 0.45359237 / 0.028316847;
             // Water compressibility is specified as 3.3e-6 per psi
             // overpressure, where 1 psi = 6894.7573 Pa
-            Scalar overPressure = fluidState.pressure(waterPhaseIdx) - 1.013e5; // [Pa]
-            Scalar waterDensity =
+            typedef Opm::MathToolbox<typename FluidState::Scalar> FsToolbox;
+            const Evaluation& overPressure =
+                FsToolbox::template toLhs<Evaluation>(fluidState.pressure(waterPhaseIdx)) - 1.013e5; // [Pa]
+            const Evaluation& waterDensity =
                 stockTankWaterDensity * (1 + 3.3e-6*overPressure/6894.7573);
 
             // convert water density [kg/m^3] to molar volume [m^3/mol]
-            Vm_[waterPhaseIdx] = fluidState.averageMolarMass(waterPhaseIdx)/waterDensity;
+            Vm_[waterPhaseIdx] =
+                FsToolbox::template toLhs<Evaluation>(fluidState.averageMolarMass(waterPhaseIdx))
+                / waterDensity;
             break;
         };
         };
     }
 
     bool VmUpToDate_[numPhases];
-    Scalar Vm_[numPhases];
+    Evaluation Vm_[numPhases];
 
     OilPhaseParams oilPhaseParams_;
     GasPhaseParams gasPhaseParams_;
@@ -35,6 +35,7 @@
 #include "Evaluation.hpp"
 
 #include <opm/material/common/MathToolbox.hpp>
+#include <opm/material/common/FastMath.hpp>
 
 namespace Opm {
 namespace LocalAd {
@@ -480,6 +481,15 @@ public:
     { return Opm::LocalAd::pow(arg1, arg2); }
 };
 
+// the fast math toolbox for the automatic differentiation case. (The toolbox for the
+// scalar case is provided by the FastMath.hpp header file.) It uses the functions of
+// the standard library: computing the derivatives and copying the evaluations dominates
+// the costs, so using the approximations of the values only pays off for scalars.
+template <class ScalarT, class VariableSetTag, int numVars>
+struct FastMathToolbox<Opm::LocalAd::Evaluation<ScalarT, VariableSetTag, numVars>>
+    : public MathToolbox<Opm::LocalAd::Evaluation<ScalarT, VariableSetTag, numVars>>
+{ };
+
 }
 
 #endif
@@ -73,6 +73,10 @@ namespace ComponentsTest {
 
 #include <opm/common/utility/platform_dependent/reenable_warnings.h>
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
 
 template <class Scalar, class Evaluation>
 void testAllComponents()
@@ -95,6 +99,43 @@ void testAllComponents()
     checkComponent<Opm::Xylene<Scalar>, Evaluation>();
 }
 
+// compare the properties of water with the verification values of table 5 and
+// table 15 of the IAPWS-IF97 release
+template <class Scalar>
+void testH2OReferenceValues()
+{
+    typedef Opm::H2O<Scalar> H2O;
+
+    Scalar tolerance = std::max<Scalar>(1e-6, 1000*std::numeric_limits<Scalar>::epsilon());
+
+    // temperature [K], pressure [Pa], density [kg/m^3], enthalpy [J/kg], heat
+    // capacity [J/(kg K)]
+    static const Scalar liquidValues[3][5] = {
+        { 300.0, 3e6, 1.0/0.100215168e-2, 0.115331273e6, 0.417301218e4 },
+        { 300.0, 80e6, 1.0/0.971180894e-3, 0.184142828e6, 0.401008987e4 },
+        { 500.0, 3e6, 1.0/0.120241800e-2, 0.975542239e6, 0.465580682e4 }
+    };
+    static const Scalar gasValues[1][5] = {
+        { 300.0, 3.5e3, 1.0/0.394913866e2, 0.254991145e7, 0.191300162e4 }
+    };
+
+    for (int i = 0; i < 3; ++i) {
+        const Scalar* v = liquidValues[i];
+        if (std::abs(H2O::liquidDensity(v[0], v[1]) - v[2]) > tolerance*v[2]
+            || std::abs(H2O::liquidEnthalpy(v[0], v[1]) - v[3]) > tolerance*v[3]
+            || std::abs(H2O::liquidHeatCapacity(v[0], v[1]) - v[4]) > tolerance*v[4])
+            throw std::logic_error("oops: wrong properties of liquid water");
+    }
+
+    for (int i = 0; i < 1; ++i) {
+        const Scalar* v = gasValues[i];
+        if (std::abs(H2O::gasDensity(v[0], v[1]) - v[2]) > tolerance*v[2]
+            || std::abs(H2O::gasEnthalpy(v[0], v[1]) - v[3]) > tolerance*v[3]
+            || std::abs(H2O::gasHeatCapacity(v[0], v[1]) - v[4]) > tolerance*v[4])
+            throw std::logic_error("oops: wrong properties of steam");
+    }
+}
+
 class TestAdTag;
 
 template <class Scalar>
@@ -105,6 +146,8 @@ inline void testAll()
     // ensure that all components are API-compliant
     testAllComponents<Scalar, Scalar>();
     testAllComponents<Scalar, Evaluation>();
+
+    testH2OReferenceValues<Scalar>();
 }
 
 
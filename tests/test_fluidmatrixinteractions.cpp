@@ -43,6 +43,7 @@
 #include <opm/material/fluidmatrixinteractions/EffToAbsLaw.hpp>
 #include <opm/material/fluidmatrixinteractions/PiecewiseLinearTwoPhaseMaterial.hpp>
 #include <opm/material/fluidmatrixinteractions/SplineTwoPhaseMaterial.hpp>
+#include <opm/material/fluidmatrixinteractions/TabulatedTwoPhaseMaterial.hpp>
 #include <opm/material/fluidmatrixinteractions/ThreePhaseParkerVanGenuchten.hpp>
 #include <opm/material/fluidmatrixinteractions/EclEpsTwoPhaseLaw.hpp>
 #include <opm/material/fluidmatrixinteractions/EclHysteresisTwoPhaseLaw.hpp>
@@ -82,6 +83,8 @@
 
 #include <opm/common/utility/platform_dependent/reenable_warnings.h>
 
+#include <limits>
+#include <type_traits>
 
 // this function makes sure that a capillary pressure law adheres to
 // the generic programming interface for such laws. This API _must_ be
@@ -269,6 +272,663 @@ void testThreePhaseSatApi()
 {
 }
 
+// make sure that indexing the segments of the piecewise linear law using uniform
+// saturation grids yields exactly the same results as the bisection search
+template <class Scalar, class TwoPhaseTraits>
+void testPiecewiseLinearSegmentIndex()
+{
+    typedef Opm::PiecewiseLinearTwoPhaseMaterial<TwoPhaseTraits> MaterialLaw;
+    typedef typename MaterialLaw::Params Params;
+
+    // a SWOF-like table with a kink at the critical water saturation, a short segment
+    // and a pc curve which is many orders of magnitude larger than the relperms
+    const Scalar Swcr = 0.18;
+    std::vector<Scalar> SwSamples = { 0.12, Swcr, 0.24, 0.32, 0.321, 0.45, 0.61, 0.75, 0.88, 1.0 };
+    std::vector<Scalar> krwSamples = { 0.0, 0.0, 0.01, 0.05, 0.0505, 0.12, 0.3, 0.5, 0.71, 1.0 };
+    std::vector<Scalar> krnSamples = { 1.0, 0.83, 0.6, 0.4, 0.399, 0.2, 0.08, 0.02, 0.0, 0.0 };
+    std::vector<Scalar> pcnwSamples = { 4e5, 1.5e5, 8e4, 5e4, 4.9e4, 3e4, 2e4, 1e4, 5e3, 0.0 };
+
+    Params rawParams;
+    rawParams.setKrwSamples(SwSamples, krwSamples);
+    rawParams.setKrnSamples(SwSamples, krnSamples);
+    rawParams.setPcnwSamples(SwSamples, pcnwSamples);
+    rawParams.finalize();
+
+    // the index must also work if its cells contain several sampling points
+    for (unsigned maxCells : { 1U << 14, 3U }) {
+        Params indexedParams(rawParams);
+        indexedParams.setUniformSegmentIndex(true, maxCells);
+        indexedParams.finalize();
+        if (!indexedParams.useUniformSegmentIndex())
+            throw std::logic_error("oops: uniform indexing of piecewise linear tables is not enabled");
+
+        std::vector<Scalar> SwValues(SwSamples);
+        for (int i = 0; i <= 1000; ++i)
+            SwValues.push_back(0.1 + 0.9*i/1000);
+        for (Scalar Sw : SwSamples) {
+            SwValues.push_back(Sw*(1 - std::numeric_limits<Scalar>::epsilon()));
+            SwValues.push_back(Sw*(1 + std::numeric_limits<Scalar>::epsilon()));
+        }
+
+        for (Scalar Sw : SwValues) {
+            if (MaterialLaw::twoPhaseSatKrw(rawParams, Sw) != MaterialLaw::twoPhaseSatKrw(indexedParams, Sw)
+                || MaterialLaw::twoPhaseSatKrn(rawParams, Sw) != MaterialLaw::twoPhaseSatKrn(indexedParams, Sw)
+                || MaterialLaw::twoPhaseSatPcnw(rawParams, Sw) != MaterialLaw::twoPhaseSatPcnw(indexedParams, Sw))
+                throw std::logic_error("oops: uniformly indexed tables differ from the original ones");
+        }
+
+        // the critical saturation is kept exactly
+        Scalar eps = 1e-4;
+        if (MaterialLaw::twoPhaseSatKrw(indexedParams, Swcr - eps) != 0.0
+            || MaterialLaw::twoPhaseSatKrw(indexedParams, Swcr) != 0.0
+            || MaterialLaw::twoPhaseSatKrw(indexedParams, Swcr + eps) <= 0.0)
+            throw std::logic_error("oops: the critical saturation of the indexed tables is not exact");
+    }
+
+    // curves with descending sampling points are not indexed, but they must still be
+    // evaluated correctly if the index is enabled
+    Params reversedParams;
+    reversedParams.setKrwSamples(SwSamples, krwSamples);
+    reversedParams.setKrnSamples(std::vector<Scalar>(SwSamples.rbegin(), SwSamples.rend()),
+                                 std::vector<Scalar>(krnSamples.rbegin(), krnSamples.rend()));
+    reversedParams.setPcnwSamples(SwSamples, pcnwSamples);
+    reversedParams.setUniformSegmentIndex(true);
+    reversedParams.finalize();
+    for (int i = 0; i <= 100; ++i) {
+        Scalar Sw = 0.1 + 0.9*i/100;
+        if (std::abs(MaterialLaw::twoPhaseSatKrn(rawParams, Sw) - MaterialLaw::twoPhaseSatKrn(reversedParams, Sw)) > 1e-6)
+            throw std::logic_error("oops: descending tables are evaluated wrongly if the index is enabled");
+    }
+}
+
+// make sure that the tabulated version of an analytic law stays close to the original
+template <class Scalar, class TwoPhaseTraits>
+void testTabulatedTwoPhaseMaterial()
+{
+    typedef Opm::RegularizedVanGenuchten<TwoPhaseTraits> BaseLaw;
+    typedef Opm::TabulatedTwoPhaseMaterial<BaseLaw> MaterialLaw;
+
+    typename BaseLaw::Params baseParams(/*alpha=*/1e-4, /*n=*/2.3);
+    baseParams.finalize();
+
+    const Scalar tolerance = 1e-4;
+    typename MaterialLaw::Params params;
+    params.setBaseParams(baseParams);
+    params.setTolerance(tolerance);
+    params.finalize();
+
+    if (params.numSamples() <= 17 || params.numSamples() >= (1 << 14))
+        throw std::logic_error("oops: unexpected number of sampling points of the tabulated law");
+
+    Scalar pcnwMax = BaseLaw::twoPhaseSatPcnw(baseParams, Scalar(0.0));
+    Scalar pcnwMin = BaseLaw::twoPhaseSatPcnw(baseParams, Scalar(1.0));
+    for (int i = 0; i <= 1000; ++i) {
+        Scalar Sw = Scalar(i)/1000;
+
+        Scalar pcnw = MaterialLaw::twoPhaseSatPcnw(params, Sw);
+        Scalar krw = MaterialLaw::twoPhaseSatKrw(params, Sw);
+        Scalar krn = MaterialLaw::twoPhaseSatKrn(params, Sw);
+
+        if (std::abs(pcnw - BaseLaw::twoPhaseSatPcnw(baseParams, Sw)) > tolerance*(pcnwMax - pcnwMin)
+            || std::abs(krw - BaseLaw::twoPhaseSatKrw(baseParams, Sw)) > tolerance
+            || std::abs(krn - BaseLaw::twoPhaseSatKrn(baseParams, Sw)) > tolerance)
+            throw std::logic_error("oops: tabulated material law exceeds the tolerance");
+
+        Scalar pcnwFused, krwFused, krnFused;
+        Opm::twoPhaseSatPcnwKrwKrn<MaterialLaw>(pcnwFused, krwFused, krnFused, params, Sw, Sw, Sw);
+        if (pcnwFused != pcnw || krwFused != krw || krnFused != krn)
+            throw std::logic_error("oops: fused evaluation of the tabulated material law differs");
+    }
+
+    // the capillary pressure of the Brooks-Corey law is infinite at the residual
+    // saturation, so it cannot be tabulated unless this saturation is excluded
+    typedef Opm::BrooksCorey<TwoPhaseTraits> BrooksCoreyLaw;
+    typedef Opm::TabulatedTwoPhaseMaterial<BrooksCoreyLaw> TabulatedBrooksCoreyLaw;
+    typename BrooksCoreyLaw::Params brooksCoreyParams(/*entryPressure=*/1e4, /*lambda=*/2.0);
+    brooksCoreyParams.finalize();
+
+    typename TabulatedBrooksCoreyLaw::Params tabulatedBrooksCoreyParams;
+    tabulatedBrooksCoreyParams.setBaseParams(brooksCoreyParams);
+    bool hasThrown = false;
+    try {
+        tabulatedBrooksCoreyParams.finalize();
+    }
+    catch (const std::invalid_argument&) {
+        hasThrown = true;
+    }
+    if (!hasThrown)
+        throw std::logic_error("oops: a material law with an infinite capillary pressure was tabulated");
+
+    tabulatedBrooksCoreyParams.setSaturationRange(/*SwMin=*/0.01, /*SwMax=*/1.0);
+    tabulatedBrooksCoreyParams.finalize();
+}
+
+// the parameters of the piecewise linear law for a SWOF-like table with a kink at the
+// critical water saturation and a capillary pressure which is many orders of magnitude
+// larger than the relperms
+template <class EffParams>
+std::shared_ptr<EffParams> makeSwofParams_(bool uniformSegmentIndex = false)
+{
+    typedef typename EffParams::Traits::Scalar Scalar;
+
+    std::vector<Scalar> SwSamples = { 0.12, 0.18, 0.24, 0.32, 0.45, 0.61, 0.75, 0.88, 1.0 };
+    std::vector<Scalar> krwSamples = { 0.0, 0.0, 0.01, 0.05, 0.12, 0.3, 0.5, 0.71, 1.0 };
+    std::vector<Scalar> krnSamples = { 1.0, 0.83, 0.6, 0.4, 0.2, 0.08, 0.02, 0.0, 0.0 };
+    std::vector<Scalar> pcnwSamples = { 4e5, 1.5e5, 8e4, 5e4, 3e4, 2e4, 1e4, 5e3, 0.0 };
+
+    auto effParams = std::make_shared<EffParams>();
+    effParams->setKrwSamples(SwSamples, krwSamples);
+    effParams->setKrnSamples(SwSamples, krnSamples);
+    effParams->setPcnwSamples(SwSamples, pcnwSamples);
+    effParams->setUniformSegmentIndex(uniformSegmentIndex);
+    effParams->finalize();
+    return effParams;
+}
+
+// the end points of the table of makeSwofParams_()
+template <class Scalar>
+Opm::EclEpsScalingPointsInfo<Scalar> makeUnscaledInfo_()
+{
+    Opm::EclEpsScalingPointsInfo<Scalar> unscaledInfo;
+    unscaledInfo.Swl = 0.12; unscaledInfo.Sgl = 0.0; unscaledInfo.Sowl = 0.0; unscaledInfo.Sogl = 0.0;
+    unscaledInfo.Swcr = 0.18; unscaledInfo.Sgcr = 0.0; unscaledInfo.Sowcr = 0.12; unscaledInfo.Sogcr = 0.0;
+    unscaledInfo.Swu = 1.0; unscaledInfo.Sgu = 1.0; unscaledInfo.Sowu = 0.88; unscaledInfo.Sogu = 1.0;
+    unscaledInfo.maxPcow = 4e5; unscaledInfo.maxPcgo = 0.0;
+    unscaledInfo.maxKrw = 1.0; unscaledInfo.maxKrow = 1.0; unscaledInfo.maxKrog = 1.0; unscaledInfo.maxKrg = 1.0;
+    return unscaledInfo;
+}
+
+// the end points to which the table of makeSwofParams_() is scaled
+template <class Scalar>
+Opm::EclEpsScalingPointsInfo<Scalar> makeScaledInfo_()
+{
+    Opm::EclEpsScalingPointsInfo<Scalar> scaledInfo(makeUnscaledInfo_<Scalar>());
+    scaledInfo.Swl = 0.1371; scaledInfo.Swcr = 0.2113; scaledInfo.Sowcr = 0.1537;
+    scaledInfo.Swu = 0.9713; scaledInfo.maxPcow = 3.1415e5; scaledInfo.maxKrw = 0.8713;
+    scaledInfo.maxKrow = 0.9311;
+    return scaledInfo;
+}
+
+// make sure that storing the per-element end point scaling data in single precision
+// does only lead to small deviations of the relperms and of the capillary pressure
+template <class Scalar, class TwoPhaseTraits>
+void testCompactEclEpsStorage()
+{
+    typedef Opm::PiecewiseLinearTwoPhaseMaterial<TwoPhaseTraits> EffLaw;
+    typedef typename EffLaw::Params EffParams;
+    typedef Opm::EclEpsTwoPhaseLawParams<EffLaw> FullParams;
+    typedef Opm::EclEpsTwoPhaseLawParams<EffLaw, float> CompactParams;
+    typedef Opm::EclEpsTwoPhaseLaw<EffLaw, FullParams> FullLaw;
+    typedef Opm::EclEpsTwoPhaseLaw<EffLaw, CompactParams> CompactLaw;
+
+    static_assert(sizeof(CompactParams) <= sizeof(FullParams),
+                  "The compact end point scaling parameters must not be larger than the full ones");
+
+    auto effParams = makeSwofParams_<EffParams>();
+
+    auto config = std::make_shared<Opm::EclEpsConfig>();
+    config->setEnableSatScaling(true);
+    config->setEnableThreePointKrSatScaling(true);
+    config->setEnablePcScaling(true);
+    config->setEnableKrwScaling(true);
+    config->setEnableKrnScaling(true);
+
+    const auto unscaledInfo = makeUnscaledInfo_<Scalar>();
+    const auto scaledInfo = makeScaledInfo_<Scalar>();
+
+    auto unscaledPoints = std::make_shared<Opm::EclEpsScalingPoints<Scalar> >();
+    unscaledPoints->init(unscaledInfo, *config, Opm::EclOilWaterSystem);
+    auto scaledPoints = std::make_shared<Opm::EclEpsScalingPoints<Scalar> >();
+    scaledPoints->init(scaledInfo, *config, Opm::EclOilWaterSystem);
+
+    FullParams fullParams;
+    CompactParams compactParams;
+
+    fullParams.setConfig(config);
+    fullParams.setEffectiveLawParams(effParams);
+    fullParams.setUnscaledPoints(unscaledPoints);
+    fullParams.setScaledPoints(scaledPoints);
+    fullParams.finalize();
+
+    compactParams.setConfig(config);
+    compactParams.setEffectiveLawParams(effParams);
+    compactParams.setUnscaledPoints(unscaledPoints);
+    compactParams.setScaledPoints(scaledPoints);
+    compactParams.finalize();
+
+    // the relperms and the saturations are of order one and the bound below is a few
+    // ulps of single precision times the largest slope of the tables
+    const Scalar krTol = 5e-6;
+    const Scalar pcTol = 5e-6*unscaledInfo.maxPcow;
+    for (int i = 0; i <= 1000; ++i) {
+        Scalar Sw = 0.1 + 0.9*i/1000;
+
+        Scalar krwDiff = FullLaw::twoPhaseSatKrw(fullParams, Sw) - CompactLaw::twoPhaseSatKrw(compactParams, Sw);
+        Scalar krnDiff = FullLaw::twoPhaseSatKrn(fullParams, Sw) - CompactLaw::twoPhaseSatKrn(compactParams, Sw);
+        Scalar pcnwDiff = FullLaw::twoPhaseSatPcnw(fullParams, Sw) - CompactLaw::twoPhaseSatPcnw(compactParams, Sw);
+
+        if (std::abs(krwDiff) > krTol || std::abs(krnDiff) > krTol)
+            throw std::logic_error("oops: compact end point scaling data lead to a too large relperm error");
+        if (std::abs(pcnwDiff) > pcTol)
+            throw std::logic_error("oops: compact end point scaling data lead to a too large capillary pressure error");
+
+        // the fused evaluation must be consistent with the individual methods
+        Scalar pcnw, krw, krn;
+        Opm::twoPhaseSatPcnwKrwKrn<FullLaw>(pcnw, krw, krn, fullParams, Sw, Sw, Sw);
+        if (pcnw != FullLaw::twoPhaseSatPcnw(fullParams, Sw)
+            || krw != FullLaw::twoPhaseSatKrw(fullParams, Sw)
+            || krn != FullLaw::twoPhaseSatKrn(fullParams, Sw))
+            throw std::logic_error("oops: fused evaluation of the end point scaled law is inconsistent");
+    }
+}
+
+// the saturation mappings of the end point scaling as they were computed for each call
+// before the transformations were precomputed
+template <class Scalar, class FromPoints, class ToPoints>
+Scalar referenceEpsTwoPoint(Scalar x, const FromPoints& from, const ToPoints& to)
+{ return to[0] + (x - from[0])*((to[1] - to[0])/(from[1] - from[0])); }
+
+template <class Scalar, class FromPoints, class ToPoints, class UnscaledPoints>
+Scalar referenceEpsThreePoint(Scalar x,
+                              const FromPoints& from,
+                              const ToPoints& to,
+                              const UnscaledPoints& unscaled)
+{
+    if (unscaled[1] >= unscaled[2])
+        return referenceEpsTwoPoint(x, from, to);
+
+    unsigned i = (x < from[1]) ? 0 : 1;
+    Scalar delta = from[i + 1] - from[i];
+    if (delta <= 1e-20)
+        delta = 1.0;
+    return to[i] + (x - from[i])*((to[i + 1] - to[i])/delta);
+}
+
+// make sure that the precomputed end point scaling transformations are the same as
+// the per-call formulas and that the inverse capillary pressure is scaled correctly
+template <class Scalar, class TwoPhaseTraits>
+void testEclEpsTransforms()
+{
+    typedef Opm::PiecewiseLinearTwoPhaseMaterial<TwoPhaseTraits> EffLaw;
+    typedef typename EffLaw::Params EffParams;
+    typedef Opm::EclEpsTwoPhaseLawParams<EffLaw> EpsParams;
+    typedef Opm::EclEpsTwoPhaseLaw<EffLaw, EpsParams> EpsLaw;
+    typedef Opm::EclEpsScalingPoints<Scalar> ScalingPoints;
+
+    auto effParams = makeSwofParams_<EffParams>();
+    const auto unscaledInfo = makeUnscaledInfo_<Scalar>();
+    const auto scaledInfo = makeScaledInfo_<Scalar>();
+
+    const Scalar tol = 100*std::numeric_limits<Scalar>::epsilon();
+    for (int variantIdx = 0; variantIdx < 3; ++ variantIdx) {
+        // two-point scaling, three-point scaling and three-point scaling which falls
+        // back to two-point scaling because the unscaled points are degenerate
+        bool threePoint = variantIdx > 0;
+        auto config = std::make_shared<Opm::EclEpsConfig>();
+        config->setEnableSatScaling(true);
+        config->setEnableThreePointKrSatScaling(threePoint);
+        config->setEnablePcScaling(true);
+        config->setEnableKrwScaling(true);
+        config->setEnableKrnScaling(true);
+
+        auto unscaledPoints = std::make_shared<ScalingPoints>();
+        unscaledPoints->init(unscaledInfo, *config, Opm::EclOilWaterSystem);
+        if (variantIdx == 2)
+            unscaledPoints->setSaturationKrwPoint(1, unscaledPoints->saturationKrwPoints()[2]);
+        auto scaledPoints = std::make_shared<ScalingPoints>();
+        scaledPoints->init(scaledInfo, *config, Opm::EclOilWaterSystem);
+
+        EpsParams params;
+        params.setConfig(config);
+        params.setEffectiveLawParams(effParams);
+        params.setUnscaledPoints(unscaledPoints);
+        params.setScaledPoints(scaledPoints);
+        params.finalize();
+
+        const auto& unscaledPc = unscaledPoints->saturationPcPoints();
+        const auto& scaledPc = scaledPoints->saturationPcPoints();
+        const auto& unscaledKrw = unscaledPoints->saturationKrwPoints();
+        const auto& scaledKrw = scaledPoints->saturationKrwPoints();
+        const auto& unscaledKrn = unscaledPoints->saturationKrnPoints();
+        const auto& scaledKrn = scaledPoints->saturationKrnPoints();
+        for (int i = 0; i <= 1000; ++i) {
+            Scalar Sw = Scalar(i)/1000;
+
+            Scalar SwPc = referenceEpsTwoPoint(Sw, scaledPc, unscaledPc);
+            Scalar SwKrw, SwKrn, SwKrwInv, SwKrnInv;
+            if (threePoint) {
+                SwKrw = referenceEpsThreePoint(Sw, scaledKrw, unscaledKrw, unscaledKrw);
+                SwKrn = referenceEpsThreePoint(Sw, scaledKrn, unscaledKrn, unscaledKrn);
+                SwKrwInv = referenceEpsThreePoint(Sw, unscaledKrw, scaledKrw, unscaledKrw);
+                SwKrnInv = referenceEpsThreePoint(Sw, unscaledKrn, scaledKrn, unscaledKrn);
+            }
+            else {
+                SwKrw = referenceEpsTwoPoint(Sw, scaledKrw, unscaledKrw);
+                SwKrn = referenceEpsTwoPoint(Sw, scaledKrn, unscaledKrn);
+                SwKrwInv = referenceEpsTwoPoint(Sw, unscaledKrw, scaledKrw);
+                SwKrnInv = referenceEpsTwoPoint(Sw, unscaledKrn, scaledKrn);
+            }
+
+            if (std::abs(EpsLaw::scaledToUnscaledSatPc(params, Sw) - SwPc) > tol
+                || std::abs(EpsLaw::unscaledToScaledSatPc(params, SwPc) - Sw) > tol
+                || std::abs(EpsLaw::scaledToUnscaledSatKrw(params, Sw) - SwKrw) > tol
+                || std::abs(EpsLaw::scaledToUnscaledSatKrn(params, Sw) - SwKrn) > tol
+                || std::abs(EpsLaw::unscaledToScaledSatKrw(params, Sw) - SwKrwInv) > tol
+                || std::abs(EpsLaw::unscaledToScaledSatKrn(params, Sw) - SwKrnInv) > tol)
+                throw std::logic_error("oops: the precomputed end point scaling transformations are wrong");
+
+            Scalar pcnwRef =
+                EffLaw::twoPhaseSatPcnw(*effParams, SwPc)
+                *(scaledPoints->maxPcnw()/unscaledPoints->maxPcnw());
+            Scalar krwRef =
+                EffLaw::twoPhaseSatKrw(*effParams, SwKrw)
+                *(scaledPoints->maxKrw()/unscaledPoints->maxKrw());
+            if (std::abs(EpsLaw::twoPhaseSatPcnw(params, Sw) - pcnwRef) > tol*unscaledInfo.maxPcow
+                || std::abs(EpsLaw::twoPhaseSatKrw(params, Sw) - krwRef) > tol)
+                throw std::logic_error("oops: the end point scaled material law is wrong");
+        }
+
+        // the inverse capillary pressure must undo the scaling of the capillary pressure,
+        // i.e., it must divide by the same factor as the one the capillary pressure was
+        // multiplied with. (it used to apply the inverse of that factor twice.)
+        Scalar pcRatio = scaledPoints->maxPcnw()/unscaledPoints->maxPcnw();
+        for (int i = 1; i < 100; ++i) {
+            Scalar pcnw = scaledPoints->maxPcnw()*i/100;
+            Scalar Sw = EpsLaw::twoPhaseSatPcnwInv(params, pcnw);
+            if (std::abs(EpsLaw::twoPhaseSatPcnw(params, Sw) - pcnw) > 1e3*tol*unscaledInfo.maxPcow)
+                throw std::logic_error("oops: the inverse of the scaled capillary pressure is wrong");
+
+            Scalar SwOld =
+                referenceEpsTwoPoint(EffLaw::twoPhaseSatPcnwInv(*effParams, pcnw*pcRatio),
+                                     unscaledPc, scaledPc);
+            if (std::abs(Sw - SwOld) < 1e-4)
+                throw std::logic_error("oops: the inverse scaled capillary pressure uses the factor twice");
+        }
+    }
+}
+
+// make sure that the fused evaluation of the capillary pressure and the relative
+// permeabilities of a two-phase law yields the same results as the individual calls
+template <class MaterialLaw>
+void checkFusedTwoPhaseLaw(const typename MaterialLaw::Params& params,
+                           typename MaterialLaw::Scalar pcSw,
+                           typename MaterialLaw::Scalar krwSw,
+                           typename MaterialLaw::Scalar krnSw)
+{
+    typedef typename MaterialLaw::Scalar Scalar;
+
+    Scalar pcnw, krw, krn;
+    Opm::twoPhaseSatPcnwKrwKrn<MaterialLaw>(pcnw, krw, krn, params, pcSw, krwSw, krnSw);
+
+    if (pcnw != MaterialLaw::twoPhaseSatPcnw(params, pcSw)
+        || krw != MaterialLaw::twoPhaseSatKrw(params, krwSw)
+        || krn != MaterialLaw::twoPhaseSatKrn(params, krnSw))
+        throw std::logic_error("oops: the fused two-phase kernel is inconsistent");
+}
+
+template <class Scalar, class TwoPhaseTraits>
+void testFusedTwoPhaseLaws()
+{
+    typedef Opm::PiecewiseLinearTwoPhaseMaterial<TwoPhaseTraits> EffLaw;
+    typedef typename EffLaw::Params EffParams;
+    typedef Opm::EclEpsTwoPhaseLaw<EffLaw> EpsLaw;
+    typedef typename EpsLaw::Params EpsParams;
+    typedef Opm::EclHysteresisTwoPhaseLaw<EpsLaw> HystLaw;
+    typedef typename HystLaw::Params HystParams;
+    typedef Opm::EclEpsScalingPoints<Scalar> ScalingPoints;
+
+    const auto unscaledInfo = makeUnscaledInfo_<Scalar>();
+
+    // the scaled end points of the drainage and the imbibition curves
+    const auto drainageInfo = makeScaledInfo_<Scalar>();
+
+    Opm::EclEpsScalingPointsInfo<Scalar> imbibitionInfo(drainageInfo);
+    imbibitionInfo.Sowcr = 0.25;
+
+    auto epsConfig = std::make_shared<Opm::EclEpsConfig>();
+    epsConfig->setEnableSatScaling(true);
+    epsConfig->setEnableThreePointKrSatScaling(true);
+    epsConfig->setEnablePcScaling(true);
+    epsConfig->setEnableKrwScaling(true);
+    epsConfig->setEnableKrnScaling(true);
+
+    auto unscaledPoints = std::make_shared<ScalingPoints>();
+    unscaledPoints->init(unscaledInfo, *epsConfig, Opm::EclOilWaterSystem);
+    auto drainagePoints = std::make_shared<ScalingPoints>();
+    drainagePoints->init(drainageInfo, *epsConfig, Opm::EclOilWaterSystem);
+    auto imbibitionPoints = std::make_shared<ScalingPoints>();
+    imbibitionPoints->init(imbibitionInfo, *epsConfig, Opm::EclOilWaterSystem);
+
+    for (int uniform = 0; uniform < 2; ++ uniform) {
+        auto effParams = makeSwofParams_<EffParams>(/*uniformSegmentIndex=*/uniform > 0);
+
+        auto drainageParams = std::make_shared<EpsParams>();
+        drainageParams->setConfig(epsConfig);
+        drainageParams->setEffectiveLawParams(effParams);
+        drainageParams->setUnscaledPoints(unscaledPoints);
+        drainageParams->setScaledPoints(drainagePoints);
+        drainageParams->finalize();
+
+        auto imbibitionParams = std::make_shared<EpsParams>();
+        imbibitionParams->setConfig(epsConfig);
+        imbibitionParams->setEffectiveLawParams(effParams);
+        imbibitionParams->setUnscaledPoints(unscaledPoints);
+        imbibitionParams->setScaledPoints(imbibitionPoints);
+        imbibitionParams->finalize();
+
+        // the consistency check of the imbibition curve uses an absolute tolerance
+        // which cannot be met in single precision
+        int numHysteresisModes = std::is_same<Scalar, float>::value ? 1 : 2;
+        for (int hysteresis = 0; hysteresis < numHysteresisModes; ++ hysteresis) {
+            auto hystConfig = std::make_shared<Opm::EclHysteresisConfig>();
+            hystConfig->setEnableHysteresis(hysteresis > 0);
+
+            HystParams hystParams;
+            hystParams.setConfig(hystConfig);
+            hystParams.setDrainageParams(drainageParams, drainageInfo, Opm::EclOilWaterSystem);
+            hystParams.setImbibitionParams(imbibitionParams, imbibitionInfo, Opm::EclOilWaterSystem);
+            hystParams.finalize();
+
+            // switch to the imbibition curve for water saturations above 0.4
+            if (hysteresis > 0)
+                hystParams.update(/*pcSw=*/0.4, /*krwSw=*/0.4, /*krnSw=*/0.4);
+
+            for (int i = 0; i <= 100; ++i) {
+                Scalar Sw = Scalar(i)/100;
+                Scalar Sw2 = 1 - Sw;
+
+                checkFusedTwoPhaseLaw<EffLaw>(*effParams, Sw, Sw, Sw);
+                checkFusedTwoPhaseLaw<EffLaw>(*effParams, Sw, Sw2, Sw);
+                checkFusedTwoPhaseLaw<EpsLaw>(*drainageParams, Sw, Sw, Sw);
+                checkFusedTwoPhaseLaw<EpsLaw>(*drainageParams, Sw2, Sw, Sw2);
+                checkFusedTwoPhaseLaw<HystLaw>(hystParams, Sw, Sw, Sw);
+                checkFusedTwoPhaseLaw<HystLaw>(hystParams, Sw, Sw2, Sw);
+                checkFusedTwoPhaseLaw<HystLaw>(hystParams, Sw2, Sw2, Sw);
+            }
+
+            // make sure that the imbibition curve is actually used
+            if (hysteresis > 0
+                && HystLaw::twoPhaseSatKrn(hystParams, Scalar(0.6))
+                   == EpsLaw::twoPhaseSatKrn(*drainageParams, Scalar(0.6)))
+                throw std::logic_error("oops: the imbibition curve is not active");
+        }
+    }
+}
+
+// make sure that evaluating the capillary pressures and the relative permeabilities of
+// the three-phase ECL laws in a single pass yields the same results as the individual
+// methods
+template <class MaterialLaw, class FluidState>
+void checkFusedThreePhaseLaw(const typename MaterialLaw::Params& params, const FluidState& fs)
+{
+    typedef typename MaterialLaw::Scalar Scalar;
+
+    enum { numPhases = MaterialLaw::numPhases };
+    enum { waterPhaseIdx = MaterialLaw::waterPhaseIdx };
+    enum { oilPhaseIdx = MaterialLaw::oilPhaseIdx };
+    enum { gasPhaseIdx = MaterialLaw::gasPhaseIdx };
+
+    Scalar pc[numPhases];
+    Scalar pcFused[numPhases];
+    Scalar krFused[numPhases];
+    MaterialLaw::capillaryPressures(pc, params, fs);
+    MaterialLaw::capillaryPressuresAndRelativePermeabilities(pcFused, krFused, params, fs);
+
+    Scalar kr[numPhases];
+    kr[waterPhaseIdx] = MaterialLaw::template krw<FluidState, Scalar>(params, fs);
+    kr[oilPhaseIdx] = MaterialLaw::template krn<FluidState, Scalar>(params, fs);
+    kr[gasPhaseIdx] = MaterialLaw::template krg<FluidState, Scalar>(params, fs);
+
+    // relativePermeabilities() does not compute the capillary pressures
+    Scalar krAll[numPhases];
+    MaterialLaw::relativePermeabilities(krAll, params, fs);
+
+    // the individual methods partially compute the saturations in double precision,
+    // the capillary pressures are of the order of 1e5 Pa
+    const Scalar tol = 1e-5;
+    for (int phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+        if (std::abs(kr[phaseIdx] - krFused[phaseIdx]) > tol)
+            throw std::logic_error("oops: fused relative permeabilities are inconsistent");
+        if (std::abs(kr[phaseIdx] - krAll[phaseIdx]) > tol)
+            throw std::logic_error("oops: relative permeabilities are inconsistent");
+        if (std::abs(pc[phaseIdx] - pcFused[phaseIdx]) > tol*std::max<Scalar>(1e5, std::abs(pc[phaseIdx])))
+            throw std::logic_error("oops: fused capillary pressures are inconsistent");
+    }
+}
+
+template <class Scalar, class TwoPhaseTraits, class ThreePhaseTraits, class FluidState>
+void testFusedEclThreePhaseLaws()
+{
+    typedef Opm::PiecewiseLinearTwoPhaseMaterial<TwoPhaseTraits> TwoPhaseLaw;
+    typedef typename TwoPhaseLaw::Params TwoPhaseParams;
+    typedef Opm::EclStone1Material<ThreePhaseTraits, TwoPhaseLaw, TwoPhaseLaw> Stone1Law;
+    typedef Opm::EclStone2Material<ThreePhaseTraits, TwoPhaseLaw, TwoPhaseLaw> Stone2Law;
+    typedef Opm::EclDefaultMaterial<ThreePhaseTraits, TwoPhaseLaw, TwoPhaseLaw> DefaultLaw;
+    typedef Opm::EclMultiplexerMaterial<ThreePhaseTraits, TwoPhaseLaw, TwoPhaseLaw> MultiplexerLaw;
+
+    // a SWOF-like and a SGOF-like table. the saturations of the latter refer to oil
+    auto oilWaterParams = makeSwofParams_<TwoPhaseParams>();
+    const Scalar Swl = oilWaterParams->SwKrwSamples().front();
+
+    std::vector<Scalar> SoSamples = { 0.0, 0.12, 0.3, 0.5, 0.7, 0.85, 1.0 };
+    std::vector<Scalar> krogSamples = { 0.0, 0.0, 0.1, 0.3, 0.6, 0.8, 1.0 };
+    std::vector<Scalar> krgSamples = { 1.0, 0.8, 0.5, 0.25, 0.08, 0.0, 0.0 };
+    std::vector<Scalar> pcgoSamples = { 2e4, 1.2e4, 6e3, 3e3, 1e3, 0.0, 0.0 };
+
+    auto gasOilParams = std::make_shared<TwoPhaseParams>();
+    gasOilParams->setKrwSamples(SoSamples, krogSamples);
+    gasOilParams->setKrnSamples(SoSamples, krgSamples);
+    gasOilParams->setPcnwSamples(SoSamples, pcgoSamples);
+    gasOilParams->finalize();
+
+    if (!oilWaterParams->commonSaturationSamples())
+        throw std::logic_error("oops: common saturation samples not detected");
+
+    typename Stone1Law::Params stone1Params;
+    stone1Params.setOilWaterParams(oilWaterParams);
+    stone1Params.setGasOilParams(gasOilParams);
+    stone1Params.setSwl(Swl);
+    stone1Params.setEta(1.0);
+    stone1Params.finalize();
+
+    typename Stone2Law::Params stone2Params;
+    stone2Params.setOilWaterParams(oilWaterParams);
+    stone2Params.setGasOilParams(gasOilParams);
+    stone2Params.setSwl(Swl);
+    stone2Params.finalize();
+
+    typename DefaultLaw::Params defaultParams;
+    defaultParams.setOilWaterParams(oilWaterParams);
+    defaultParams.setGasOilParams(gasOilParams);
+    defaultParams.setSwl(Swl);
+    defaultParams.finalize();
+
+    typename MultiplexerLaw::Params multiplexerParams;
+    multiplexerParams.setApproach(Opm::EclStone1Approach);
+    auto& realParams = multiplexerParams.template getRealParams<Opm::EclStone1Approach>();
+    realParams.setOilWaterParams(oilWaterParams);
+    realParams.setGasOilParams(gasOilParams);
+    realParams.setSwl(Swl);
+    realParams.setEta(1.0);
+    realParams.finalize();
+    multiplexerParams.finalize();
+
+    FluidState fs;
+    for (int i = 0; i <= 20; ++i) {
+        for (int j = 0; i + j <= 20; ++j) {
+            Scalar Sw = i/20.0;
+            Scalar Sg = j/20.0;
+            fs.setSaturation(Stone1Law::waterPhaseIdx, Sw);
+            fs.setSaturation(Stone1Law::gasPhaseIdx, Sg);
+            fs.setSaturation(Stone1Law::oilPhaseIdx, 1 - Sw - Sg);
+
+            checkFusedThreePhaseLaw<Stone1Law>(stone1Params, fs);
+            checkFusedThreePhaseLaw<Stone2Law>(stone2Params, fs);
+            checkFusedThreePhaseLaw<DefaultLaw>(defaultParams, fs);
+
+            // the multiplexer must dispatch to the fused kernel of the selected law
+            Scalar pc[3], kr[3], pcRef[3], krRef[3];
+            MultiplexerLaw::capillaryPressuresAndRelativePermeabilities(pc, kr, multiplexerParams, fs);
+            Stone1Law::capillaryPressuresAndRelativePermeabilities(pcRef, krRef, stone1Params, fs);
+            for (int phaseIdx = 0; phaseIdx < 3; ++phaseIdx)
+                if (pc[phaseIdx] != pcRef[phaseIdx] || kr[phaseIdx] != krRef[phaseIdx])
+                    throw std::logic_error("oops: the multiplexer does not use the fused kernel");
+        }
+    }
+}
+
+// drive a few cells through a sequence of drainage and imbibition cycles which requires
+// more nested scanning curves than the parameter objects can store
+template <class MaterialLaw, class FluidState>
+void testParkerLenhardCycles()
+{
+    typedef typename MaterialLaw::Params Params;
+    typedef typename MaterialLaw::Scalar Scalar;
+
+    typename Params::VanGenuchtenParams micParams, mdcParams;
+    micParams.setVgAlpha(2e-4);
+    micParams.setVgN(3.0);
+    micParams.finalize();
+    mdcParams.setVgAlpha(1e-4);
+    mdcParams.setVgN(3.0);
+    mdcParams.finalize();
+
+    const unsigned numCells = 50;
+    std::vector<Params> params(numCells);
+    for (unsigned cellIdx = 0; cellIdx < numCells; ++cellIdx) {
+        params[cellIdx].setMicParams(&micParams);
+        params[cellIdx].setMdcParams(&mdcParams);
+        params[cellIdx].setSwr(0.1);
+        params[cellIdx].setSnr(0.1);
+        params[cellIdx].finalize();
+        MaterialLaw::reset(params[cellIdx]);
+    }
+
+    FluidState fs;
+    for (int stepIdx = 0; stepIdx < 200; ++stepIdx) {
+        for (unsigned cellIdx = 0; cellIdx < numCells; ++cellIdx) {
+            // damped oscillations: each half-period adds a new scanning curve
+            Scalar Sw = 0.55 + 0.4*std::cos(0.3*stepIdx + 0.01*cellIdx)*std::exp(-0.01*stepIdx);
+            fs.setSaturation(0, Sw);
+            fs.setSaturation(1, 1 - Sw);
+
+            MaterialLaw::update(params[cellIdx], fs);
+
+            Scalar pc[2];
+            MaterialLaw::capillaryPressures(pc, params[cellIdx], fs);
+            if (!std::isfinite(pc[1] - pc[0]) || pc[1] - pc[0] < 0)
+                throw std::logic_error("oops: invalid capillary pressure for the Parker-Lenhard law");
+            if (params[cellIdx].csc()->loopNum() > static_cast<int>(Params::ScanningCurveStore::maxDepth))
+                throw std::logic_error("oops: maximum number of scanning curves exceeded");
+        }
+    }
+
+    // copies of parameter objects start on the main drainage curve
+    Params paramsCopy(params[0]);
+    if (paramsCopy.mdc()->loopNum() != 0 || paramsCopy.mdc()->next() != 0)
+        throw std::logic_error("oops: copied Parker-Lenhard parameters do not start on the MDC");
+}
+
 class TestAdTag;
 
 template <class Scalar>
@@ -368,6 +1028,9 @@ inline void testAll()
         testGenericApi<MaterialLaw, ThreePhaseFluidState>();
         testThreePhaseApi<MaterialLaw, ThreePhaseFluidState>();
         //testThreePhaseSatApi<MaterialLaw, ThreePhaseFluidState>();
+
+        typedef Opm::ImmiscibleFluidState<Scalar, ThreePFluidSystem> ScalarFluidState;
+        testFusedEclThreePhaseLaws<Scalar, TwoPhaseTraits, ThreePhaseTraits, ScalarFluidState>();
     }
     {
         typedef Opm::ThreePhaseParkerVanGenuchten<ThreePhaseTraits> MaterialLaw;
@@ -392,12 +1055,17 @@ inline void testAll()
         testGenericApi<MaterialLaw, TwoPhaseFluidState>();
         testTwoPhaseApi<MaterialLaw, TwoPhaseFluidState>();
         testTwoPhaseSatApi<MaterialLaw, TwoPhaseFluidState>();
+
+        typedef Opm::ImmiscibleFluidState<Scalar, TwoPFluidSystem> ScalarFluidState;
+        testParkerLenhardCycles<MaterialLaw, ScalarFluidState>();
     }
     {
         typedef Opm::PiecewiseLinearTwoPhaseMaterial<TwoPhaseTraits> MaterialLaw;
         testGenericApi<MaterialLaw, TwoPhaseFluidState>();
         testTwoPhaseApi<MaterialLaw, TwoPhaseFluidState>();
         testTwoPhaseSatApi<MaterialLaw, TwoPhaseFluidState>();
+
+        testPiecewiseLinearSegmentIndex<Scalar, TwoPhaseTraits>();
     }
     {
         typedef Opm::SplineTwoPhaseMaterial<TwoPhaseTraits> MaterialLaw;
@@ -410,12 +1078,26 @@ inline void testAll()
         testGenericApi<MaterialLaw, TwoPhaseFluidState>();
         testTwoPhaseApi<MaterialLaw, TwoPhaseFluidState>();
         testTwoPhaseSatApi<MaterialLaw, TwoPhaseFluidState>();
+
+        typedef Opm::VanGenuchten<TwoPhaseTraits,
+                                  Opm::VanGenuchtenParams<TwoPhaseTraits>,
+                                  Opm::FastMathToolbox> FastMathLaw;
+        testGenericApi<FastMathLaw, TwoPhaseFluidState>();
+        testTwoPhaseApi<FastMathLaw, TwoPhaseFluidState>();
+        testTwoPhaseSatApi<FastMathLaw, TwoPhaseFluidState>();
     }
     {
         typedef Opm::RegularizedBrooksCorey<TwoPhaseTraits> MaterialLaw;
         testGenericApi<MaterialLaw, TwoPhaseFluidState>();
         testTwoPhaseApi<MaterialLaw, TwoPhaseFluidState>();
         testTwoPhaseSatApi<MaterialLaw, TwoPhaseFluidState>();
+
+        typedef Opm::RegularizedBrooksCorey<TwoPhaseTraits,
+                                            Opm::RegularizedBrooksCoreyParams<TwoPhaseTraits>,
+                                            Opm::FastMathToolbox> FastMathLaw;
+        testGenericApi<FastMathLaw, TwoPhaseFluidState>();
+        testTwoPhaseApi<FastMathLaw, TwoPhaseFluidState>();
+        testTwoPhaseSatApi<FastMathLaw, TwoPhaseFluidState>();
     }
     {
         typedef Opm::RegularizedVanGenuchten<TwoPhaseTraits> MaterialLaw;
@@ -423,6 +1105,15 @@ inline void testAll()
         testTwoPhaseApi<MaterialLaw, TwoPhaseFluidState>();
         testTwoPhaseSatApi<MaterialLaw, TwoPhaseFluidState>();
     }
+    {
+        typedef Opm::RegularizedVanGenuchten<TwoPhaseTraits> BaseLaw;
+        typedef Opm::TabulatedTwoPhaseMaterial<BaseLaw> MaterialLaw;
+        testGenericApi<MaterialLaw, TwoPhaseFluidState>();
+        testTwoPhaseApi<MaterialLaw, TwoPhaseFluidState>();
+        testTwoPhaseSatApi<MaterialLaw, TwoPhaseFluidState>();
+
+        testTabulatedTwoPhaseMaterial<Scalar, TwoPhaseTraits>();
+    }
 
     {
         typedef Opm::BrooksCorey<TwoPhaseTraits> RawMaterialLaw;
@@ -430,6 +1121,10 @@ inline void testAll()
         testGenericApi<MaterialLaw, TwoPhaseFluidState>();
         testTwoPhaseApi<MaterialLaw, TwoPhaseFluidState>();
         testTwoPhaseSatApi<MaterialLaw, TwoPhaseFluidState>();
+
+        testCompactEclEpsStorage<Scalar, TwoPhaseTraits>();
+        testEclEpsTransforms<Scalar, TwoPhaseTraits>();
+        testFusedTwoPhaseLaws<Scalar, TwoPhaseTraits>();
     }
     {
         typedef Opm::BrooksCorey<TwoPhaseTraits> RawMaterialLaw;
@@ -35,6 +35,7 @@
 #include <opm/material/constraintsolvers/MiscibleMultiPhaseComposition.hpp>
 #include <opm/material/constraintsolvers/ComputeFromReferencePhase.hpp>
 #include <opm/material/constraintsolvers/ImmiscibleFlash.hpp>
+#include <opm/material/common/FixedSizeLu.hpp>
 
 #include <opm/material/fluidstates/ImmiscibleFluidState.hpp>
 
@@ -45,6 +46,8 @@
 #include <opm/material/fluidmatrixinteractions/EffToAbsLaw.hpp>
 #include <opm/material/fluidmatrixinteractions/MaterialTraits.hpp>
 
+#include <type_traits>
+
 template <class Scalar, class FluidState>
 void checkSame(const FluidState &fsRef, const FluidState &fsFlash)
 {
@@ -117,6 +120,55 @@ void checkImmiscibleFlash(const FluidState &fsRef,
 }
 
 
+template <class Scalar, class FluidSystem, class MaterialLaw, class FluidState>
+void checkImmiscibleFlashBatch(const std::vector<FluidState> &fsRefs,
+                               const typename MaterialLaw::Params &matParams)
+{
+    enum { numPhases = FluidSystem::numPhases };
+    enum { numComponents = FluidSystem::numComponents };
+    typedef Dune::FieldVector<Scalar, numComponents> ComponentVector;
+    typedef Opm::ImmiscibleFlash<Scalar, FluidSystem> ImmiscibleFlash;
+
+    unsigned numCells = fsRefs.size();
+    std::vector<FluidState> fluidStates(numCells);
+    std::vector<ComponentVector> globalMolarities(numCells);
+    std::vector<Scalar> temperatures(numCells);
+    for (unsigned cellIdx = 0; cellIdx < numCells; ++cellIdx) {
+        const FluidState &fsRef = fsRefs[cellIdx];
+        for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx) {
+            globalMolarities[cellIdx][compIdx] = 0.0;
+            for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
+                globalMolarities[cellIdx][compIdx] +=
+                    fsRef.saturation(phaseIdx)*fsRef.molarity(phaseIdx, compIdx);
+        }
+
+        temperatures[cellIdx] = fsRef.temperature(/*phaseIdx=*/0);
+        typename FluidSystem::ParameterCache paramCache;
+        ImmiscibleFlash::guessInitial(fluidStates[cellIdx], paramCache, globalMolarities[cellIdx]);
+    }
+
+    std::vector<typename ImmiscibleFlash::SolveStatus> status;
+    auto cellMatParams = [&matParams](unsigned) -> const typename MaterialLaw::Params&
+        { return matParams; };
+    unsigned numFailed =
+        ImmiscibleFlash::template solveBatch<MaterialLaw>(fluidStates,
+                                                          status,
+                                                          cellMatParams,
+                                                          globalMolarities,
+                                                          temperatures);
+    if (numFailed != 0 || status.size() != numCells)
+        throw std::logic_error("oops: batch flash calculation failed");
+
+    for (unsigned cellIdx = 0; cellIdx < numCells; ++cellIdx) {
+        // the one-dimensional root finding must succeed for all cells including the
+        // single-phase ones, i.e., the Newton method must not be required
+        if (status[cellIdx].numIterations > 20)
+            throw std::logic_error("oops: root finding of the two-phase flash failed");
+
+        checkSame<Scalar>(fsRefs[cellIdx], fluidStates[cellIdx]);
+    }
+}
+
 template <class Scalar, class FluidSystem, class MaterialLaw, class FluidState>
 void completeReferenceFluidState(FluidState &fs,
                                  typename MaterialLaw::Params &matParams,
@@ -146,6 +198,68 @@ void completeReferenceFluidState(FluidState &fs,
     }
 }
 
+template <class Scalar>
+void testFixedSizeLu()
+{
+    typedef Dune::FieldMatrix<Scalar, 3, 3> Matrix;
+    typedef Dune::FieldVector<Scalar, 3> Vector;
+
+    Scalar tol = std::is_same<Scalar, float>::value ? 1e-5 : 1e-12;
+
+    // a system with a zero leading pivot
+    {
+        const Scalar AInit[3][3] = { { 0, 2, 1 }, { 1, 1, 1 }, { 4, 1, 3 } };
+        const Scalar xRef[3] = { 1, -2, 3 };
+
+        Matrix A;
+        Vector b(0.0), x(0.0);
+        for (unsigned i = 0; i < 3; ++i)
+            for (unsigned j = 0; j < 3; ++j) {
+                A[i][j] = AInit[i][j];
+                b[i] += AInit[i][j]*xRef[j];
+            }
+
+        if (!Opm::solveFixedSizeLu(x, A, b, /*singularLimit=*/1e-30))
+            throw std::logic_error("oops: regular matrix with zero leading pivot reported as singular");
+        for (unsigned i = 0; i < 3; ++i)
+            if (std::abs(x[i] - xRef[i]) > tol)
+                throw std::logic_error("oops: wrong solution for matrix with zero leading pivot");
+    }
+
+    // a tiny leading pivot which is above the singularity limit. without row
+    // interchanges the first unknown would be completely lost in round-off
+    {
+        Dune::FieldMatrix<Scalar, 2, 2> A;
+        Dune::FieldVector<Scalar, 2> b, x(0.0);
+        A[0][0] = 1e-20; A[0][1] = 1;
+        A[1][0] = 1; A[1][1] = 1;
+        b[0] = 1;
+        b[1] = 2;
+
+        if (!Opm::solveFixedSizeLu(x, A, b, /*singularLimit=*/1e-30))
+            throw std::logic_error("oops: regular matrix with tiny leading pivot reported as singular");
+        if (std::abs(x[0] - 1) > tol || std::abs(x[1] - 1) > tol)
+            throw std::logic_error("oops: no partial pivoting in the LU decomposition");
+    }
+
+    // a singular matrix: the solver must report it and leave the solution untouched
+    {
+        const Scalar AInit[3][3] = { { 1, 2, 3 }, { 2, 4, 6 }, { 1, 0, 1 } };
+
+        Matrix A;
+        Vector b(1.0), x(42.0);
+        for (unsigned i = 0; i < 3; ++i)
+            for (unsigned j = 0; j < 3; ++j)
+                A[i][j] = AInit[i][j];
+
+        if (Opm::solveFixedSizeLu(x, A, b, /*singularLimit=*/1e-10))
+            throw std::logic_error("oops: singular matrix not detected");
+        for (unsigned i = 0; i < 3; ++i)
+            if (x[i] != 42.0)
+                throw std::logic_error("oops: solution modified for singular matrix");
+    }
+}
+
 template <class Scalar>
 inline void testAll()
 {
@@ -193,6 +307,12 @@ inline void testAll()
     // set the fluid temperatures
     fsRef.setTemperature(T);
 
+    ////////////////
+    // linear solver
+    ////////////////
+    std::cout << "testing LU solver\n";
+    testFixedSizeLu<Scalar>();
+
     ////////////////
     // only liquid
     ////////////////
@@ -261,6 +381,20 @@ inline void testAll()
 
     // check the flash calculation
     checkImmiscibleFlash<Scalar, FluidSystem, MaterialLaw>(fsRef, matParams2);
+
+    ////////////////
+    // batch of cells
+    ////////////////
+    std::cout << "testing batch flash\n";
+
+    std::vector<ImmiscibleFluidState> fsRefs;
+    for (int cellIdx = 0; cellIdx < 9; ++cellIdx) {
+        fsRef.setSaturation(liquidPhaseIdx, cellIdx/8.0);
+        fsRef.setPressure(liquidPhaseIdx, 2e5 + cellIdx*1e5);
+        completeReferenceFluidState<Scalar, FluidSystem, MaterialLaw>(fsRef, matParams2, liquidPhaseIdx);
+        fsRefs.push_back(fsRef);
+    }
+    checkImmiscibleFlashBatch<Scalar, FluidSystem, MaterialLaw>(fsRefs, matParams2);
 }
 
 int main()
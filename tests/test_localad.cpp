@@ -471,6 +471,44 @@ void testAtan2()
     }
 }
 
+template <class Scalar, class VariablesDescriptor>
+void testFastMath()
+{
+    typedef Opm::LocalAd::Evaluation<Scalar, VariablesDescriptor, VariablesDescriptor::size> Eval;
+    typedef Opm::FastMathToolbox<Eval> Toolbox;
+    typedef Opm::MathToolbox<Eval> StdToolbox;
+
+    const Scalar tolerance = std::numeric_limits<Scalar>::epsilon()*1e2;
+
+    int n = 10*1000;
+    for (int i = 0; i < n; ++ i) {
+        // the approximations must agree with the functions of the standard library to
+        // a few ULPs
+        Scalar x = Scalar(i)/(n - 1)*100 - 50;
+        if (std::abs(Opm::fastExp(x) - std::exp(x)) > tolerance*std::exp(x))
+            throw std::logic_error("oops: fastExp() @"+std::to_string((long double) x));
+
+        Scalar y = std::exp(x/5);
+        if (std::abs(Opm::fastLog(y) - std::log(y)) > tolerance*std::abs(std::log(y)))
+            throw std::logic_error("oops: fastLog() @"+std::to_string((long double) y));
+
+        Scalar exp = 1.234;
+        Scalar z = std::pow(y, exp);
+        if (std::abs(Opm::fastPow(y, exp) - z) > tolerance*z)
+            throw std::logic_error("oops: fastPow() @"+std::to_string((long double) y));
+
+        // the toolbox for evaluations uses the functions of the standard library
+        const auto& xEval = Eval::createVariable(x, 0);
+        const auto& yEval = Eval::createVariable(y, 0);
+        const auto& expEval = Eval::createVariable(exp, 1);
+        if (!Toolbox::exp(xEval).isSame(StdToolbox::exp(xEval), /*tolerance=*/0.0)
+            || !Toolbox::log(yEval).isSame(StdToolbox::log(yEval), /*tolerance=*/0.0)
+            || !Toolbox::pow(yEval, exp).isSame(StdToolbox::pow(yEval, exp), /*tolerance=*/0.0)
+            || !Toolbox::pow(yEval, expEval).isSame(StdToolbox::pow(yEval, expEval), /*tolerance=*/0.0))
+            throw std::logic_error("oops: FastMathToolbox<Evaluation> @"+std::to_string((long double) x));
+    }
+}
+
 // prototypes
 double myScalarMin(double a, double b);
 double myScalarMax(double a, double b);
@@ -571,6 +609,9 @@ inline void testAll()
     test1DFunction<Scalar, VarsDescriptor>(Opm::LocalAd::log<Scalar, VarsDescriptor, VarsDescriptor::size>,
                                            static_cast<Scalar (*)(Scalar)>(std::log),
                                            1e-6, 1e9);
+
+    std::cout << "testing fast math toolbox\n";
+    testFastMath<Scalar, VarsDescriptor>();
 }
 
 int main()
@@ -35,16 +35,56 @@
 #include <opm/material/constraintsolvers/MiscibleMultiPhaseComposition.hpp>
 #include <opm/material/constraintsolvers/ComputeFromReferencePhase.hpp>
 #include <opm/material/constraintsolvers/NcpFlash.hpp>
+#include <opm/material/constraintsolvers/CompositionFromFugacities.hpp>
 
 #include <opm/material/fluidstates/CompositionalFluidState.hpp>
 
+#include <opm/material/localad/Evaluation.hpp>
+#include <opm/material/localad/Math.hpp>
+
 #include <opm/material/fluidsystems/H2ON2FluidSystem.hpp>
+#include <opm/material/fluidsystems/Spe5FluidSystem.hpp>
 
 #include <opm/material/fluidmatrixinteractions/LinearMaterial.hpp>
 #include <opm/material/fluidmatrixinteractions/RegularizedBrooksCorey.hpp>
 #include <opm/material/fluidmatrixinteractions/EffToAbsLaw.hpp>
 #include <opm/material/fluidmatrixinteractions/MaterialTraits.hpp>
 
+// the H2O-N2 fluid system, but with a gas phase that is a non-ideal mixture described
+// by the two-suffix Margules model
+template <class Scalar>
+class NonIdealGasH2ON2 : public Opm::FluidSystems::H2ON2<Scalar, false>
+{
+    typedef Opm::FluidSystems::H2ON2<Scalar, false> ParentType;
+
+public:
+    typedef typename ParentType::ParameterCache ParameterCache;
+
+    static bool isIdealMixture(unsigned phaseIdx)
+    { return phaseIdx != ParentType::gasPhaseIdx; }
+
+    template <class FluidState, class LhsEval = typename FluidState::Scalar>
+    static LhsEval fugacityCoefficient(const FluidState &fluidState,
+                                       const ParameterCache &paramCache,
+                                       unsigned phaseIdx,
+                                       unsigned compIdx)
+    {
+        typedef Opm::MathToolbox<typename FluidState::Scalar> FsToolbox;
+        typedef Opm::MathToolbox<LhsEval> LhsToolbox;
+
+        const LhsEval& phi =
+            ParentType::template fugacityCoefficient<FluidState, LhsEval>(fluidState,
+                                                                          paramCache,
+                                                                          phaseIdx,
+                                                                          compIdx);
+        if (phaseIdx != ParentType::gasPhaseIdx)
+            return phi;
+
+        const LhsEval& x = FsToolbox::template toLhs<LhsEval>(fluidState.moleFraction(phaseIdx, compIdx));
+        return phi*LhsToolbox::exp(0.8*(1.0 - x)*(1.0 - x));
+    }
+};
+
 template <class Scalar, class FluidState>
 void checkSame(const FluidState &fsRef, const FluidState &fsFlash)
 {
@@ -114,6 +154,102 @@ void checkNcpFlash(const FluidState &fsRef,
 
     // compare the "flashed" fluid state with the reference one
     checkSame<Scalar>(fsRef, fsFlash);
+
+    // repeat the flash calculation using the line search and the trust region as well
+    // as using the trust region alone and record its convergence history
+    for (int useLineSearch = 1; useLineSearch >= 0; -- useLineSearch) {
+        typename NcpFlash::SolverParameters solverParams;
+        solverParams.lineSearch = bool(useLineSearch);
+        solverParams.trustRegionRadius = 1.0;
+        typename NcpFlash::ConvergenceStatistics stats;
+        FluidState fsGlobalized;
+        fsGlobalized.setTemperature(fsRef.temperature(/*phaseIdx=*/0));
+        NcpFlash::guessInitial(fsGlobalized, paramCache, globalMolarities);
+        NcpFlash::template solve<MaterialLaw>(fsGlobalized, paramCache, matParams, globalMolarities, solverParams, &stats);
+        if (!stats.converged
+            || stats.updateHistory.size() != stats.numIterations
+            || stats.residualHistory.size() != stats.numIterations + 1
+            || !(stats.residualHistory.back() < stats.residualHistory.front()))
+            throw std::logic_error("oops: convergence statistics of the flash calculation are inconsistent");
+        checkSame<Scalar>(fsRef, fsGlobalized);
+    }
+
+    // use the stability analysis to get the initial solution. it must be at least as
+    // good as the default initial guess
+    FluidState fsStab;
+    fsStab.setTemperature(fsRef.temperature(/*phaseIdx=*/0));
+    NcpFlash::guessInitial(fsStab, paramCache, globalMolarities);
+    auto coldStatus = NcpFlash::template trySolve<MaterialLaw>(fsStab, paramCache, matParams, globalMolarities);
+
+    fsStab.setPressure(/*phaseIdx=*/0, fsRef.pressure(/*phaseIdx=*/0));
+    bool isStable = NcpFlash::guessFromStabilityAnalysis(fsStab, paramCache, globalMolarities);
+    auto stabStatus = NcpFlash::template trySolve<MaterialLaw>(fsStab, paramCache, matParams, globalMolarities);
+    if (!stabStatus.converged || stabStatus.numIterations > coldStatus.numIterations)
+        throw std::logic_error("oops: flash calculation initialized by the stability analysis failed");
+
+    bool isSinglePhase = false;
+    for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
+        isSinglePhase = isSinglePhase || fsRef.saturation(phaseIdx) == 1.0;
+    if (isStable != isSinglePhase)
+        throw std::logic_error("oops: stability analysis is wrong");
+
+    checkSame<Scalar>(fsRef, fsStab);
+}
+
+template <class Scalar, class FluidSystem, class MaterialLaw, class FluidState>
+void checkNcpFlashBatch(const FluidState &fsRef,
+                        const typename MaterialLaw::Params &matParams)
+{
+    enum { numPhases = FluidSystem::numPhases };
+    enum { numComponents = FluidSystem::numComponents };
+    typedef Dune::FieldVector<Scalar, numComponents> ComponentVector;
+    typedef Opm::NcpFlash<Scalar, FluidSystem> NcpFlash;
+
+    ComponentVector globalMolarities(0.0);
+    for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx) {
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            globalMolarities[compIdx] +=
+                fsRef.saturation(phaseIdx)*fsRef.molarity(phaseIdx, compIdx);
+        }
+    }
+
+    // the even cells are warm-started from the reference solution, the odd ones use
+    // the default initial solution
+    const unsigned numCells = 8;
+    std::vector<FluidState> fluidStates(numCells);
+    std::vector<ComponentVector> cellMolarities(numCells, globalMolarities);
+    std::vector<Scalar> temperatures(numCells, fsRef.temperature(/*phaseIdx=*/0));
+    for (unsigned cellIdx = 0; cellIdx < numCells; ++cellIdx) {
+        if (cellIdx % 2 == 0)
+            fluidStates[cellIdx].assign(fsRef);
+        else {
+            typename FluidSystem::ParameterCache paramCache;
+            fluidStates[cellIdx].setTemperature(temperatures[cellIdx]);
+            NcpFlash::guessInitial(fluidStates[cellIdx], paramCache, cellMolarities[cellIdx]);
+        }
+    }
+
+    std::vector<typename NcpFlash::SolveStatus> status;
+    auto cellMatParams = [&matParams](unsigned) -> const typename MaterialLaw::Params&
+        { return matParams; };
+    unsigned numFailed =
+        NcpFlash::template solveBatch<MaterialLaw>(fluidStates,
+                                                   status,
+                                                   cellMatParams,
+                                                   cellMolarities,
+                                                   temperatures);
+
+    if (numFailed != 0 || status.size() != numCells)
+        throw std::logic_error("oops: batch flash calculation failed");
+
+    for (unsigned cellIdx = 0; cellIdx < numCells; ++cellIdx) {
+        if (!status[cellIdx].converged)
+            throw std::logic_error("oops: batch flash calculation failed");
+        if (cellIdx % 2 == 0 && status[cellIdx].numIterations > status[1].numIterations)
+            throw std::logic_error("oops: warm-started flash calculation is slower than a cold start");
+
+        checkSame<Scalar>(fsRef, fluidStates[cellIdx]);
+    }
 }
 
 
@@ -150,6 +286,291 @@ void completeReferenceFluidState(FluidState &fs,
 }
 
 
+template <class Scalar>
+void testCompositionFromFugacities()
+{
+    typedef NonIdealGasH2ON2<Scalar> FluidSystem;
+    typedef Opm::CompositionalFluidState<Scalar, FluidSystem> FluidState;
+    typedef Opm::CompositionFromFugacities<Scalar, FluidSystem> CompositionFromFugacities;
+    typedef typename CompositionFromFugacities::ComponentVector ComponentVector;
+
+    enum { numComponents = FluidSystem::numComponents };
+    enum { gasPhaseIdx = FluidSystem::gasPhaseIdx };
+
+    FluidState fsRef;
+    fsRef.setTemperature(300.0);
+    fsRef.setPressure(gasPhaseIdx, 1e6);
+    fsRef.setMoleFraction(gasPhaseIdx, FluidSystem::H2OIdx, 0.3);
+    fsRef.setMoleFraction(gasPhaseIdx, FluidSystem::N2Idx, 0.7);
+
+    typename FluidSystem::ParameterCache paramCache;
+    ComponentVector targetFug;
+    for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+        targetFug[compIdx] =
+            FluidSystem::fugacityCoefficient(fsRef, paramCache, gasPhaseIdx, compIdx)
+            * fsRef.pressure(gasPhaseIdx)
+            * fsRef.moleFraction(gasPhaseIdx, compIdx);
+
+    // the Jacobian approximated by finite differences and the one obtained using
+    // automatic differentiation must lead to the same composition
+    FluidState fsFd(fsRef), fsAd(fsRef);
+    CompositionFromFugacities::guessInitial(fsFd, paramCache, gasPhaseIdx, targetFug);
+    CompositionFromFugacities::solve(fsFd, paramCache, gasPhaseIdx, targetFug);
+    CompositionFromFugacities::guessInitial(fsAd, paramCache, gasPhaseIdx, targetFug);
+    CompositionFromFugacities::template solve</*useAdJacobian=*/true>(fsAd, paramCache, gasPhaseIdx, targetFug);
+
+    for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx) {
+        Scalar xRef = fsRef.moleFraction(gasPhaseIdx, compIdx);
+        if (std::abs(fsFd.moleFraction(gasPhaseIdx, compIdx) - xRef) > 1e-6
+            || std::abs(fsAd.moleFraction(gasPhaseIdx, compIdx) - xRef) > 1e-6)
+            throw std::logic_error("oops: composition from fugacities is wrong");
+    }
+}
+
+// exposes the linearization of the composition calculation
+template <class Scalar, class FluidSystem>
+class CompositionFromFugacitiesLinearizer
+    : public Opm::CompositionFromFugacities<Scalar, FluidSystem>
+{
+    typedef Opm::CompositionFromFugacities<Scalar, FluidSystem> ParentType;
+
+public:
+    using ParentType::linearize_;
+};
+
+template <class Scalar>
+void testSpe5CompositionFromFugacities()
+{
+    typedef Opm::FluidSystems::Spe5<Scalar> FluidSystem;
+    typedef Opm::CompositionalFluidState<Scalar, FluidSystem> FluidState;
+    typedef Opm::CompositionFromFugacities<Scalar, FluidSystem> CompositionFromFugacities;
+    typedef CompositionFromFugacitiesLinearizer<Scalar, FluidSystem> Linearizer;
+    typedef typename CompositionFromFugacities::ComponentVector ComponentVector;
+
+    enum { numComponents = FluidSystem::numComponents };
+    enum { oilPhaseIdx = FluidSystem::oilPhaseIdx };
+    enum { gasPhaseIdx = FluidSystem::gasPhaseIdx };
+
+    FluidSystem::init();
+
+    // SPE-5 reservoir oil and a gas which is in contact with it
+    const Scalar oilComp[numComponents] = { 0.001, 0.499, 0.03, 0.07, 0.20, 0.15, 0.05 };
+    const Scalar gasComp[numComponents] = { 0.001, 0.799, 0.10, 0.05, 0.03, 0.015, 0.005 };
+
+    for (unsigned phaseIdx = 0; phaseIdx < FluidSystem::numPhases; ++phaseIdx) {
+        if (phaseIdx != oilPhaseIdx && phaseIdx != gasPhaseIdx)
+            continue;
+
+        FluidState fsRef;
+        fsRef.setTemperature(273.15 + 20);
+        fsRef.setPressure(phaseIdx, 4000 * 6894.7573);
+        for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+            fsRef.setMoleFraction(phaseIdx, compIdx,
+                                  (phaseIdx == oilPhaseIdx)?oilComp[compIdx]:gasComp[compIdx]);
+
+        typename FluidSystem::ParameterCache paramCache;
+        paramCache.updatePhase(fsRef, phaseIdx);
+        ComponentVector targetFug;
+        for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+            targetFug[compIdx] =
+                FluidSystem::fugacityCoefficient(fsRef, paramCache, phaseIdx, compIdx)
+                * fsRef.pressure(phaseIdx)
+                * fsRef.moleFraction(phaseIdx, compIdx);
+
+        // start with a composition which is somewhat off
+        FluidState fsInit(fsRef);
+        for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+            fsInit.setMoleFraction(phaseIdx, compIdx,
+                                   0.9*fsRef.moleFraction(phaseIdx, compIdx) + 0.1/numComponents);
+
+        // the Jacobian obtained using automatic differentiation must be the same as the
+        // one approximated by finite differences
+        Dune::FieldMatrix<Scalar, numComponents, numComponents> JFd, JAd;
+        Dune::FieldVector<Scalar, numComponents> defectFd, defectAd;
+        FluidState fsFd(fsInit), fsAd(fsInit);
+        typename FluidSystem::ParameterCache paramCacheFd, paramCacheAd;
+        paramCacheFd.updatePhase(fsFd, phaseIdx);
+        paramCacheAd.updatePhase(fsAd, phaseIdx);
+        Linearizer::linearize_(JFd, defectFd, fsFd, paramCacheFd, phaseIdx, targetFug, std::false_type());
+        Linearizer::linearize_(JAd, defectAd, fsAd, paramCacheAd, phaseIdx, targetFug, std::true_type());
+
+        for (unsigned i = 0; i < numComponents; ++i) {
+            if (std::abs(defectFd[i] - defectAd[i]) > 1e-10*std::abs(targetFug[i]))
+                throw std::logic_error("oops: the defects of the AD and FD linearizations differ");
+
+            Scalar maxJ = 0;
+            for (unsigned j = 0; j < numComponents; ++j)
+                maxJ = std::max(maxJ, std::abs(JFd[i][j]));
+            for (unsigned j = 0; j < numComponents; ++j)
+                if (std::abs(JFd[i][j] - JAd[i][j]) > 1e-5*maxJ)
+                    throw std::logic_error("oops: the AD and FD Jacobians of the fugacities differ");
+        }
+
+        // both variants must converge to the reference composition
+        fsFd = fsInit;
+        fsAd = fsInit;
+        CompositionFromFugacities::solve(fsFd, paramCacheFd, phaseIdx, targetFug);
+        CompositionFromFugacities::template solve</*useAdJacobian=*/true>(fsAd, paramCacheAd, phaseIdx, targetFug);
+        for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx) {
+            Scalar xRef = fsRef.moleFraction(phaseIdx, compIdx);
+            if (std::abs(fsFd.moleFraction(phaseIdx, compIdx) - xRef) > 1e-6
+                || std::abs(fsAd.moleFraction(phaseIdx, compIdx) - xRef) > 1e-6)
+                throw std::logic_error("oops: composition from fugacities is wrong for SPE-5");
+        }
+    }
+}
+
+// let the stability analysis determine the initial solution of the flash calculation
+// for a single-phase and a two-phase mixture of the SPE-5 fluid system
+template <class Scalar>
+void testSpe5StabilityAnalysis()
+{
+    typedef Opm::FluidSystems::Spe5<Scalar> FluidSystem;
+    typedef Opm::CompositionalFluidState<Scalar, FluidSystem> FluidState;
+    typedef Opm::NcpFlash<Scalar, FluidSystem> NcpFlash;
+    typedef Opm::NullMaterialTraits<Scalar, FluidSystem::numPhases> MaterialTraits;
+    typedef Opm::NullMaterial<MaterialTraits> MaterialLaw;
+    typedef Dune::FieldVector<Scalar, FluidSystem::numComponents> ComponentVector;
+
+    enum { numPhases = FluidSystem::numPhases };
+    enum { numComponents = FluidSystem::numComponents };
+    enum { oilPhaseIdx = FluidSystem::oilPhaseIdx };
+    enum { gasPhaseIdx = FluidSystem::gasPhaseIdx };
+
+    FluidSystem::init();
+
+    const Scalar oilComp[numComponents] = { 0.001, 0.499, 0.03, 0.07, 0.20, 0.15, 0.05 };
+    const Scalar gasComp[numComponents] = { 0.001, 0.799, 0.10, 0.05, 0.03, 0.015, 0.005 };
+    const Scalar psi = 6894.7573;
+
+    typename MaterialLaw::Params matParams;
+    typename NcpFlash::SolverParameters solverParams;
+    solverParams.stabilityAnalysis = true;
+
+    // the reference fluid states. the oil is undersaturated at 4000 psi, whereas
+    // mixing equal volumes of the oil and of the gas at 1000 psi yields two phases
+    for (int isTwoPhase = 0; isTwoPhase < 2; ++isTwoPhase) {
+        Scalar pRef = (isTwoPhase?1000:4000)*psi;
+
+        FluidState fsRef;
+        fsRef.setTemperature(344.26);
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            fsRef.setPressure(phaseIdx, pRef);
+            for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+                fsRef.setMoleFraction(phaseIdx, compIdx,
+                                      (phaseIdx == gasPhaseIdx)?gasComp[compIdx]:oilComp[compIdx]);
+        }
+        typename FluidSystem::ParameterCache paramCache;
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            paramCache.updatePhase(fsRef, phaseIdx);
+            fsRef.setDensity(phaseIdx, FluidSystem::density(fsRef, paramCache, phaseIdx));
+        }
+
+        ComponentVector globalMolarities;
+        for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx) {
+            globalMolarities[compIdx] = fsRef.molarity(oilPhaseIdx, compIdx);
+            if (isTwoPhase)
+                globalMolarities[compIdx] =
+                    (globalMolarities[compIdx] + fsRef.molarity(gasPhaseIdx, compIdx))/2;
+        }
+
+        FluidState fsFlash;
+        fsFlash.setTemperature(fsRef.temperature(/*phaseIdx=*/0));
+        NcpFlash::guessInitial(fsFlash, paramCache, globalMolarities);
+        fsFlash.setPressure(/*phaseIdx=*/0, (isTwoPhase?1000:3000)*psi);
+
+        FluidState fsGuess(fsFlash);
+        if (NcpFlash::guessFromStabilityAnalysis(fsGuess, paramCache, globalMolarities) == bool(isTwoPhase))
+            throw std::logic_error("oops: stability analysis of the SPE-5 fluid is wrong");
+
+        typename NcpFlash::ConvergenceStatistics stats;
+        NcpFlash::template solve<MaterialLaw>(fsFlash, paramCache, matParams, globalMolarities, solverParams, &stats);
+        if (!stats.converged)
+            throw std::logic_error("oops: flash calculation initialized by the stability analysis failed");
+
+        if (!isTwoPhase) {
+            // the Newton method must be skipped for single-phase fluids
+            if (stats.numIterations != 0
+                || fsFlash.saturation(oilPhaseIdx) != 1.0
+                || std::abs(fsFlash.pressure(oilPhaseIdx) - pRef) > 1e-6*pRef)
+                throw std::logic_error("oops: wrong solution for the single-phase SPE-5 fluid");
+            for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx)
+                if (std::abs(fsFlash.moleFraction(oilPhaseIdx, compIdx) - oilComp[compIdx]) > 1e-10)
+                    throw std::logic_error("oops: wrong composition of the single-phase SPE-5 fluid");
+            continue;
+        }
+
+        // the solution must be in equilibrium and conserve the amount of each component
+        if (stats.numIterations == 0
+            || !(fsFlash.saturation(oilPhaseIdx) > 0.1)
+            || !(fsFlash.saturation(gasPhaseIdx) > 0.1))
+            throw std::logic_error("oops: wrong phases for the two-phase SPE-5 fluid");
+        for (unsigned compIdx = 0; compIdx < numComponents; ++compIdx) {
+            Scalar molarity = 0.0;
+            for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
+                molarity += fsFlash.saturation(phaseIdx)*fsFlash.molarity(phaseIdx, compIdx);
+            if (std::abs(molarity - globalMolarities[compIdx]) > 1e-6*globalMolarities[compIdx])
+                throw std::logic_error("oops: two-phase SPE-5 flash does not conserve mass");
+
+            Scalar fugOil = fsFlash.fugacity(oilPhaseIdx, compIdx);
+            Scalar fugGas = fsFlash.fugacity(gasPhaseIdx, compIdx);
+            if (std::abs(fugOil - fugGas) > 1e-6*std::abs(fugOil))
+                throw std::logic_error("oops: two-phase SPE-5 flash is not in equilibrium");
+        }
+    }
+}
+
+// the stability analysis must also be usable if the flash calculation is done using
+// automatic differentiation. in this case, the Newton method is always applied, so the
+// result must be the same as the one without stability analysis
+class TestAdTag;
+
+template <class Scalar>
+void testStabilityAnalysisAd()
+{
+    typedef Opm::LocalAd::Evaluation<Scalar, TestAdTag, 1> Evaluation;
+    typedef Opm::FluidSystems::H2ON2<Scalar> FluidSystem;
+    typedef Opm::CompositionalFluidState<Evaluation, FluidSystem> FluidState;
+    typedef Opm::NcpFlash<Scalar, FluidSystem> NcpFlash;
+    typedef Opm::NullMaterialTraits<Scalar, FluidSystem::numPhases> MaterialTraits;
+    typedef Opm::NullMaterial<MaterialTraits> MaterialLaw;
+    typedef Dune::FieldVector<Evaluation, FluidSystem::numComponents> ComponentVector;
+
+    enum { numPhases = FluidSystem::numPhases };
+
+    FluidSystem::init();
+
+    ComponentVector globalMolarities;
+    globalMolarities[FluidSystem::H2OIdx] = Evaluation::createVariable(5000.0, 0);
+    globalMolarities[FluidSystem::N2Idx] = 10.0;
+
+    typename MaterialLaw::Params matParams;
+    typename FluidSystem::ParameterCache paramCache;
+    typename NcpFlash::SolverParameters solverParams;
+
+    FluidState fsRef;
+    fsRef.setTemperature(300.0);
+    NcpFlash::guessInitial(fsRef, paramCache, globalMolarities);
+    NcpFlash::template solve<MaterialLaw>(fsRef, paramCache, matParams, globalMolarities, solverParams);
+
+    solverParams.stabilityAnalysis = true;
+    FluidState fsFlash;
+    fsFlash.setTemperature(300.0);
+    NcpFlash::guessInitial(fsFlash, paramCache, globalMolarities);
+    typename NcpFlash::ConvergenceStatistics stats;
+    NcpFlash::template solve<MaterialLaw>(fsFlash, paramCache, matParams, globalMolarities, solverParams, &stats);
+    if (!stats.converged || stats.numIterations == 0)
+        throw std::logic_error("oops: flash calculation using AD and the stability analysis failed");
+
+    for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+        const Evaluation& SRef = fsRef.saturation(phaseIdx);
+        const Evaluation& SFlash = fsFlash.saturation(phaseIdx);
+        if (std::abs(SRef.value - SFlash.value) > 1e-8
+            || std::abs(SRef.derivatives[0] - SFlash.derivatives[0]) > 1e-8*std::abs(SRef.derivatives[0]) + 1e-14)
+            throw std::logic_error("oops: AD flash calculation depends on the stability analysis");
+    }
+}
+
 template <class Scalar>
 inline void testAll()
 {
@@ -293,6 +714,26 @@ inline void testAll()
 
     // check the flash calculation
     checkNcpFlash<Scalar, FluidSystem, MaterialLaw>(fsRef, matParams2);
+
+    ////////////////
+    // batch flash
+    ////////////////
+    std::cout << "testing batch flash\n";
+    checkNcpFlashBatch<Scalar, FluidSystem, MaterialLaw>(fsRef, matParams2);
+
+    ////////////////
+    // composition from fugacities of a non-ideal mixture
+    ////////////////
+    std::cout << "testing composition from fugacities\n";
+    testCompositionFromFugacities<Scalar>();
+    testSpe5CompositionFromFugacities<Scalar>();
+
+    ////////////////
+    // stability analysis of SPE-5 fluids
+    ////////////////
+    std::cout << "testing stability analysis of SPE-5 fluids\n";
+    testSpe5StabilityAnalysis<Scalar>();
+    testStabilityAnalysisAd<Scalar>();
 }
 
 int main()
@@ -31,12 +31,27 @@
  */
 #include "config.h"
 
+#include <opm/material/components/CO2.hpp>
+#include <opm/material/components/GeneratedCO2Tables.hpp>
 #include <opm/material/components/H2O.hpp>
 #include <opm/material/components/TabulatedComponent.hpp>
+#include <opm/material/binarycoefficients/Brine_CO2.hpp>
+#include <opm/material/localad/Evaluation.hpp>
+#include <opm/material/localad/Math.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
 
 extern bool success;
 bool success;
 
+class TestAdTag;
+
 template <class Scalar>
 void isSame(const char *str, Scalar v, Scalar vRef, Scalar tol=1e-3)
 {
@@ -115,12 +130,307 @@ inline void testAll()
 
     if (success)
         std::cout << "\nsuccess\n";
+
+    std::cout << "Checking cache file\n";
+    std::string cacheFileName = "test_tabulation_" + std::to_string(sizeof(Scalar)) + ".cache";
+    std::remove(cacheFileName.c_str());
+
+    Scalar T = tempMin + (tempMax - tempMin)/3;
+    Scalar pl = IapwsH2O::vaporPressure(T)*2;
+    Scalar pg = IapwsH2O::vaporPressure(T)/2;
+    Scalar hl = TabulatedH2O::liquidEnthalpy(T, pl);
+    Scalar rhog = TabulatedH2O::gasDensity(T, pg);
+
+    // the first call writes the cache, the second one reads it. both must result in
+    // the same tables as the ones computed without a cache.
+    for (int i = 0; i < 2; ++i) {
+        bool fromCache = TabulatedH2O::init(tempMin, tempMax, nTemp,
+                                            pMin, pMax, nPress,
+                                            cacheFileName);
+        if (fromCache != (i == 1))
+            throw std::logic_error("oops: the cache file of the tabulated component was not used as expected");
+
+        if (TabulatedH2O::liquidEnthalpy(T, pl) != hl || TabulatedH2O::gasDensity(T, pg) != rhog)
+            throw std::logic_error("oops: the tables read from the cache file differ from the computed ones");
+    }
+
+    // a cache file for a different resolution must not be used
+    if (TabulatedH2O::init(tempMin, tempMax, nTemp + 1,
+                           pMin, pMax, nPress,
+                           cacheFileName))
+        throw std::logic_error("oops: the cache file of a different table was used");
+
+    std::remove(cacheFileName.c_str());
+
+    // the temperatures obtained from the inverse tables must reproduce the ones which
+    // were used to compute the enthalpies and densities. the achievable accuracy
+    // depends on the quantity: for the gas phase, the largest errors occur close to
+    // the saturation line.
+    std::cout << "Checking inverse lookups\n";
+    Scalar maxErr[4] = { 0.0, 0.0, 0.0, 0.0 };
+    for (unsigned i = 0; i < 100; ++i) {
+        Scalar T = 310.0 + (tempMax - 320.0)*Scalar(i)/100;
+        Scalar pv = IapwsH2O::vaporPressure(T);
+        Scalar pl = pv*1.05 + (pMax - pv*1.05)*Scalar(i % 10)/10;
+        Scalar pg = std::max(pMin, pv*Scalar(i % 10 + 1)/12);
+
+        maxErr[0] = std::max(maxErr[0], std::abs(TabulatedH2O::liquidTemperatureFromEnthalpy(pl, IapwsH2O::liquidEnthalpy(T, pl)) - T));
+        maxErr[1] = std::max(maxErr[1], std::abs(TabulatedH2O::gasTemperatureFromEnthalpy(pg, IapwsH2O::gasEnthalpy(T, pg)) - T));
+        maxErr[2] = std::max(maxErr[2], std::abs(TabulatedH2O::liquidTemperatureFromDensity(pl, IapwsH2O::liquidDensity(T, pl)) - T));
+        maxErr[3] = std::max(maxErr[3], std::abs(TabulatedH2O::gasTemperatureFromDensity(pg, IapwsH2O::gasDensity(T, pg)) - T));
+    }
+    if (maxErr[0] > 2e-3 || maxErr[1] > 0.05 || maxErr[2] > 0.02 || maxErr[3] > 0.03)
+        throw std::logic_error("oops: inverse lookup of the tabulated component is inaccurate");
+
+    // the derivatives of the inverse lookups must be consistent with the values. this
+    // is checked inside of the pressure range of the tables, where the temperature is
+    // interpolated, and outside of it, where it is determined by the Newton method.
+    // (in single precision, finite differences are too inaccurate for this.)
+    typedef Opm::LocalAd::Evaluation<Scalar, TestAdTag, /*numVars=*/2> Evaluation;
+    if (std::is_same<Scalar, double>::value) {
+        std::cout << "Checking derivatives of inverse lookups\n";
+        for (unsigned i = 0; i < 20; ++i) {
+            Scalar T = 320.0 + 15.0*i;
+            for (int outside = 0; outside < 2; ++outside) {
+                Scalar pl = outside?(pMax*1.5):(IapwsH2O::vaporPressure(T)*1.05 + (pMax/2)*Scalar(i % 4)/4);
+                Scalar hl = IapwsH2O::liquidEnthalpy(T, pl);
+                const Evaluation& Tl =
+                    TabulatedH2O::liquidTemperatureFromEnthalpy(Evaluation::createVariable(pl, 0),
+                                                                Evaluation::createVariable(hl, 1));
+
+                Scalar pg = outside?(pMin/2):(IapwsH2O::vaporPressure(T)*Scalar(i % 10 + 1)/12);
+                Scalar rhog = IapwsH2O::gasDensity(T, pg);
+                const Evaluation& Tg =
+                    TabulatedH2O::gasTemperatureFromDensity(Evaluation::createVariable(pg, 0),
+                                                            Evaluation::createVariable(rhog, 1));
+
+                Scalar dp = 1e-5*pl, dh = 1e-6*hl;
+                Scalar dTl_dp =
+                    (TabulatedH2O::liquidTemperatureFromEnthalpy(pl + dp, hl)
+                     - TabulatedH2O::liquidTemperatureFromEnthalpy(pl - dp, hl))/(2*dp);
+                Scalar dTl_dh =
+                    (TabulatedH2O::liquidTemperatureFromEnthalpy(pl, hl + dh)
+                     - TabulatedH2O::liquidTemperatureFromEnthalpy(pl, hl - dh))/(2*dh);
+
+                dp = 1e-5*pg;
+                Scalar drho = 1e-5*rhog;
+                Scalar dTg_dp =
+                    (TabulatedH2O::gasTemperatureFromDensity(pg + dp, rhog)
+                     - TabulatedH2O::gasTemperatureFromDensity(pg - dp, rhog))/(2*dp);
+                Scalar dTg_drho =
+                    (TabulatedH2O::gasTemperatureFromDensity(pg, rhog + drho)
+                     - TabulatedH2O::gasTemperatureFromDensity(pg, rhog - drho))/(2*drho);
+
+                if (std::abs(Tl.derivatives[0]/dTl_dp - 1) > 1e-4
+                    || std::abs(Tl.derivatives[1]/dTl_dh - 1) > 1e-4
+                    || std::abs(Tg.derivatives[0]/dTg_dp - 1) > 1e-4
+                    || std::abs(Tg.derivatives[1]/dTg_drho - 1) > 1e-4)
+                    throw std::logic_error("oops: wrong derivatives of the inverse lookup of the tabulated component");
+            }
+        }
+    }
+
+    // the cubic interpolation must be much more accurate than the linear one, even on
+    // a table which is coarser by a factor of four in each direction
+    std::cout << "Checking cubic interpolation\n";
+    typedef Opm::TabulatedComponent<Scalar, IapwsH2O, /*useVaporPressure=*/true,
+                                    /*useCubicInterpolation=*/true> CubicH2O;
+    CubicH2O::init(tempMin, tempMax, nTemp/4,
+                   pMin, pMax, nPress/4);
+    for (unsigned i = 0; i < 100; ++i) {
+        Scalar T = 300.0 + (tempMax - 310.0)*Scalar(i)/100;
+        Scalar pv = IapwsH2O::vaporPressure(T);
+        Scalar pl = pv*1.05 + (pMax - pv*1.05)*Scalar(i % 10)/10;
+
+        Scalar maxErr = std::max(std::abs(CubicH2O::vaporPressure(T)/pv - 1),
+                                 std::abs(CubicH2O::liquidDensity(T, pl)/IapwsH2O::liquidDensity(T, pl) - 1));
+        maxErr = std::max(maxErr, std::abs(CubicH2O::liquidEnthalpy(T, pl)/IapwsH2O::liquidEnthalpy(T, pl) - 1));
+        if (maxErr > 5e-4)
+            throw std::logic_error("oops: cubic interpolation of the tabulated component is inaccurate");
+
+        // the derivatives of the cubic interpolation must be consistent with its values
+        if (!std::is_same<Scalar, double>::value)
+            continue;
+
+        Evaluation TEval = Evaluation::createVariable(T, 0);
+        Evaluation pEval = Evaluation::createVariable(pl, 1);
+        const Evaluation& rho = CubicH2O::liquidDensity(TEval, pEval);
+        const Evaluation& h = CubicH2O::liquidEnthalpy(TEval, pEval);
+
+        Scalar dT = 1e-4*T, dp = 1e-5*pl;
+        Scalar drho_dT = (CubicH2O::liquidDensity(T + dT, pl) - CubicH2O::liquidDensity(T - dT, pl))/(2*dT);
+        Scalar drho_dp = (CubicH2O::liquidDensity(T, pl + dp) - CubicH2O::liquidDensity(T, pl - dp))/(2*dp);
+        Scalar dh_dT = (CubicH2O::liquidEnthalpy(T + dT, pl) - CubicH2O::liquidEnthalpy(T - dT, pl))/(2*dT);
+        Scalar dh_dp = (CubicH2O::liquidEnthalpy(T, pl + dp) - CubicH2O::liquidEnthalpy(T, pl - dp))/(2*dp);
+        if (std::abs(rho.derivatives[0]/drho_dT - 1) > 1e-4
+            || std::abs(rho.derivatives[1]/drho_dp - 1) > 1e-4
+            || std::abs(h.derivatives[0]/dh_dT - 1) > 1e-4
+            || std::abs(h.derivatives[1]/dh_dp - 1) > 1e-4)
+            throw std::logic_error("oops: wrong derivatives of the cubic interpolation of the tabulated component");
+    }
 }
 
+template <class Scalar>
+inline void testGeneratedCO2Tables()
+{
+    typedef Opm::GeneratedCO2Tables<Scalar> CO2Tables;
+    typedef Opm::CO2<Scalar, CO2Tables> CO2;
+    typedef Opm::SpanWagner<double> SpanWagner;
+
+    std::cout << "Checking generated CO2 tables\n";
+    if (std::abs(SpanWagner::pressure(SpanWagner::criticalTemperature(),
+                                      SpanWagner::criticalDensity())
+                 /SpanWagner::criticalPressure() - 1) > 1e-4)
+        throw std::logic_error("oops: the Span-Wagner equation does not reproduce the critical point");
+
+    // the saturated phases at 273.15 K according to the tables of Span and Wagner
+    // (1996): p = 3.4851 MPa, rho_l = 927.43 kg/m^3, rho_g = 97.64 kg/m^3 and an
+    // enthalpy of vaporization of 230.9 kJ/kg
+    double Tsat = 273.15;
+    double psat = SpanWagner::vaporPressure(Tsat);
+    double rholSat = SpanWagner::density(Tsat, psat*(1 + 1e-9));
+    double rhogSat = SpanWagner::density(Tsat, psat*(1 - 1e-9));
+    if (std::abs(psat/3.4851e6 - 1) > 1e-4
+        || std::abs(rholSat/927.43 - 1) > 1e-4
+        || std::abs(rhogSat/97.64 - 1) > 1e-4
+        || std::abs(SpanWagner::enthalpy(Tsat, rhogSat) - SpanWagner::enthalpy(Tsat, rholSat) - 230.9e3) > 100)
+        throw std::logic_error("oops: the Span-Wagner equation does not reproduce the saturated phases");
+
+    std::string cacheFileName = "test_co2tables_" + std::to_string(sizeof(Scalar)) + ".cache";
+    std::remove(cacheFileName.c_str());
+    for (int i = 0; i < 2; ++i) {
+        bool fromCache = CO2Tables::init(/*tempMin=*/290.0, /*tempMax=*/340.0, /*nTemp=*/50,
+                                         /*pressMin=*/1e5, /*pressMax=*/1e8, /*nPress=*/200,
+                                         cacheFileName);
+        if (fromCache != (i == 1))
+            throw std::logic_error("oops: the cache file of the CO2 tables was not used as expected");
+    }
+    std::remove(cacheFileName.c_str());
+
+    // compare the tables with the equation of state for supercritical CO2 and for
+    // pressures which are not too close to the vapor pressure
+    Scalar T[4] = { 295.0, 310.0, 320.0, 335.0 };
+    Scalar p[4] = { 2e6, 9e6, 2e7, 6e7 };
+    for (unsigned i = 0; i < 4; ++i) {
+        for (unsigned j = 0; j < 4; ++j) {
+            double rho = SpanWagner::density(T[i], p[j]);
+            double h = SpanWagner::enthalpy(T[i], rho);
+            if (std::abs(CO2::gasDensity(T[i], p[j])/rho - 1) > 5e-3
+                || std::abs(CO2::gasEnthalpy(T[i], p[j]) - h) > 500)
+                throw std::logic_error("oops: the generated CO2 tables are inaccurate");
+
+            // the enthalpy must be consistent with the density:
+            // (dh/dp)_T = (1 + T/rho*(drho/dT)_p)/rho
+            double dp = 1e-6*p[j];
+            double dT = 1e-6*T[i];
+            double dh_dp =
+                (SpanWagner::enthalpy(T[i], SpanWagner::density(T[i], p[j] + dp))
+                 - SpanWagner::enthalpy(T[i], SpanWagner::density(T[i], p[j] - dp)))/(2*dp);
+            double drho_dT = (SpanWagner::density(T[i] + dT, p[j]) - SpanWagner::density(T[i] - dT, p[j]))/(2*dT);
+            if (std::abs(dh_dp*rho/(1 + T[i]/rho*drho_dT) - 1) > 1e-6)
+                throw std::logic_error("oops: the enthalpy of the Span-Wagner equation is inconsistent with the density");
+
+            // the same for the tables. their derivatives are only piecewise constant,
+            // so finite differences over several cells are used.
+            Scalar rhoTab = CO2::gasDensity(T[i], p[j]);
+            Scalar dpTab = 1e-2*p[j];
+            Scalar dTTab = 1e-3*T[i];
+            Scalar dhTab_dp = (CO2::gasEnthalpy(T[i], p[j] + dpTab) - CO2::gasEnthalpy(T[i], p[j] - dpTab))/(2*dpTab);
+            Scalar drhoTab_dT = (CO2::gasDensity(T[i] + dTTab, p[j]) - CO2::gasDensity(T[i] - dTTab, p[j]))/(2*dTTab);
+            if (std::abs(dhTab_dp*rhoTab/(1 + T[i]/rhoTab*drhoTab_dT) - 1) > 0.1)
+                throw std::logic_error("oops: the enthalpy of the generated CO2 tables is inconsistent with the density");
+        }
+    }
+
+    // supercritical densities according to the tables of Span and Wagner (1996)
+    if (std::abs(CO2::gasDensity(Scalar(313.15), Scalar(10e6))/628.61 - 1) > 5e-4
+        || std::abs(CO2::gasDensity(Scalar(308.15), Scalar(10e6))/712.81 - 1) > 5e-4
+        || std::abs(CO2::gasDensity(Scalar(323.15), Scalar(20e6))/784.29 - 1) > 5e-4)
+        throw std::logic_error("oops: the generated CO2 tables do not reproduce the published densities");
+
+    // the tabulated mutual solubilities of brine and CO2 must agree with the
+    // correlations and their derivatives must be the ones of the interpolation. the
+    // points are in the middle of the cells of the tables.
+    std::cout << "Checking tabulated solubilities\n";
+    typedef Opm::BinaryCoeff::Brine_CO2<Scalar, CO2Tables> BinaryCoeff;
+    typedef Opm::LocalAd::Evaluation<Scalar, TestAdTag, /*numVars=*/1> Evaluation;
+
+    std::vector<Evaluation> Ts, ps;
+    for (unsigned i = 0; i < 4; ++i) {
+        for (unsigned j = 0; j < 4; ++j) {
+            Ts.push_back(T[i] + 0.25);
+            ps.push_back(Evaluation::createVariable(p[j] + 0.125e6, /*varPos=*/0));
+        }
+    }
+    std::vector<Scalar> xlRef, ygRef;
+    for (unsigned k = 0; k < Ts.size(); ++k) {
+        Evaluation xlCO2, ygH2O;
+        BinaryCoeff::calculateMoleFractions(Ts[k], ps[k], /*salinity=*/0.1, /*knownPhaseIdx=*/-1, xlCO2, ygH2O);
+        xlRef.push_back(xlCO2.value);
+        ygRef.push_back(ygH2O.value);
+    }
+
+    BinaryCoeff::initSolubilityTables(/*tempMin=*/290.0, /*tempMax=*/340.0, /*nTemp=*/101,
+                                      /*pressMin=*/1e6, /*pressMax=*/1e8, /*nPress=*/397);
+    std::vector<Evaluation> xlCO2, ygH2O;
+    BinaryCoeff::calculateMoleFractionsBatch(Ts, ps, /*salinity=*/0.1, xlCO2, ygH2O);
+    for (unsigned k = 0; k < Ts.size(); ++k) {
+        if (std::abs(xlCO2[k].value/xlRef[k] - 1) > 5e-3 || std::abs(ygH2O[k].value/ygRef[k] - 1) > 1e-2)
+            throw std::logic_error("oops: the tabulated solubilities are inaccurate");
+
+        Scalar h = 1e5;
+        Evaluation xl1, xl2, yg1, yg2;
+        BinaryCoeff::calculateMoleFractions(Ts[k], ps[k] - h, /*salinity=*/0.1, /*knownPhaseIdx=*/-1, xl1, yg1);
+        BinaryCoeff::calculateMoleFractions(Ts[k], ps[k] + h, /*salinity=*/0.1, /*knownPhaseIdx=*/-1, xl2, yg2);
+        if (std::abs((xl2.value - xl1.value)/(2*h)/xlCO2[k].derivatives[0] - 1) > 1e-2
+            || std::abs((yg2.value - yg1.value)/(2*h)/ygH2O[k].derivatives[0] - 1) > 1e-2)
+            throw std::logic_error("oops: the derivatives of the tabulated solubilities are wrong");
+
+        // if the mole fraction of CO2 in brine is known, only the parameter A is
+        // interpolated
+        Evaluation ygKnown;
+        BinaryCoeff::calculateMoleFractions(Ts[k], ps[k], /*salinity=*/0.1, /*knownPhaseIdx=*/0, xlCO2[k], ygKnown);
+        if (std::abs(ygKnown.value/ygH2O[k].value - 1) > 1e-5)
+            throw std::logic_error("oops: the tabulated solubilities depend on the known phase");
+    }
+    BinaryCoeff::disableSolubilityTables();
+
+    // below the critical temperature, the solubilities jump at the vapor pressure of
+    // CO2. the correlations must be used within the cells of the tables which are
+    // affected by this, so that the error stays small close to the vapor pressure.
+    std::cout << "Checking tabulated solubilities close to the vapor pressure of CO2\n";
+    Ts.clear();
+    ps.clear();
+    for (Scalar TSat = 290.1; TSat < 304.0; TSat += 0.37) {
+        for (int k = -40; k <= 40; ++k) {
+            Ts.push_back(TSat);
+            ps.push_back(SpanWagner::vaporPressure(TSat)*(1 + 1.3e-3*k));
+        }
+    }
+    xlRef.clear();
+    ygRef.clear();
+    for (unsigned k = 0; k < Ts.size(); ++k) {
+        Evaluation xlCO2, ygH2O;
+        BinaryCoeff::calculateMoleFractions(Ts[k], ps[k], /*salinity=*/0.1, /*knownPhaseIdx=*/-1, xlCO2, ygH2O);
+        xlRef.push_back(xlCO2.value);
+        ygRef.push_back(ygH2O.value);
+    }
+
+    BinaryCoeff::initSolubilityTables(/*tempMin=*/290.0, /*tempMax=*/340.0, /*nTemp=*/101,
+                                      /*pressMin=*/1e6, /*pressMax=*/1e8, /*nPress=*/397);
+    BinaryCoeff::calculateMoleFractionsBatch(Ts, ps, /*salinity=*/0.1, xlCO2, ygH2O);
+    for (unsigned k = 0; k < Ts.size(); ++k) {
+        if (std::abs(xlCO2[k].value/xlRef[k] - 1) > 2e-3 || std::abs(ygH2O[k].value/ygRef[k] - 1) > 2e-3)
+            throw std::logic_error("oops: the tabulated solubilities are inaccurate close to the vapor pressure");
+    }
+    BinaryCoeff::disableSolubilityTables();
+}
 
 int main()
 {
     testAll< double >();
     testAll< float  >();
+    testGeneratedCO2Tables< double >();
+    testGeneratedCO2Tables< float  >();
     return 0;
 }